@@ -27,6 +27,7 @@
 #endif
 
 #include "conf/Config.h"
+#include "conf/Environment.h"
 #include "tools/ActivityMonitor.h"
 #include "tools/ActivitySendHandler.h"
 #include "service/PermissionManager.h"
@@ -60,6 +61,8 @@ MojErr ActivityManagerApp::open()
     MojErrCheck(err);
 
     try {
+        ActivityManager::getInstance().loadIdMark(Config::getInstance().getStateDir() +
+                                                  AM_ID_MARK_FILE);
         DB8Manager::getInstance().addListener(this);
         RequirementManager::getInstance().initialize();
         ActivityMonitor::getInstance().initialize();
@@ -109,6 +112,16 @@ MojErr ActivityManagerApp::ready()
     return MojErrNone;
 }
 
+MojErr ActivityManagerApp::close()
+{
+    LOG_AM_DEBUG("%s shutting down", name().data());
+
+    /* Leave the next start a snapshot that's as current as possible */
+    DB8Manager::getInstance().writeSnapshot();
+
+    return Base::close();
+}
+
 void ActivityManagerApp::onFinish()
 {
     ready();
@@ -149,10 +162,12 @@ MojErr ActivityManagerApp::online()
 
     /* Initialize main call handler:
      *    palm://com.palm.activitymanager/... */
-    m_handler.reset(
-            new ActivityCategoryHandler(std::make_shared<PermissionManager>()));
+    std::shared_ptr<PermissionManager> permissionManager = std::make_shared<PermissionManager>();
+    m_handler.reset(new ActivityCategoryHandler(permissionManager));
     MojAllocCheck(m_handler.get());
 
+    ActivitySendHandler::getInstance().setPermissionManager(permissionManager);
+
     err = m_handler->init();
     MojErrCheck(err);
 
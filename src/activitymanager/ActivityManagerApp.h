@@ -35,6 +35,7 @@ public:
 
     virtual MojErr open();
     virtual MojErr ready();
+    virtual MojErr close();
 
     virtual void onFinish();
     virtual void onFail();
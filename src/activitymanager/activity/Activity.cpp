@@ -24,9 +24,11 @@
 #include "state/AbstractActivityState.h"
 #include "state/ActivityStateNone.h"
 #include "activity/ActivityManager.h"
+#include "activity/EventReplies.h"
 #include "activity/requirement/ProxyRequirement.h"
 #include "conf/ActivityJson.h"
 #include "conf/Config.h"
+#include "service/RequestLatency.h"
 #include "util/Logging.h"
 
 #include "tools/ActivityMonitor.h"
@@ -50,8 +52,17 @@ Activity::Activity(activityId_t id)
     , m_requeue(false)
     , m_yielding(false)
     , m_released(true)
-    , m_state(ActivityStateNone::newInstance())
+    , m_state(ActivityStateNone::getInstance())
+    , m_transition(AbstractActivityState::kActivityTransitionNone)
     , m_triggerMode(TriggerConditionType::kMultiTriggerNone)
+    , m_nameRegistered(false)
+    , m_releasedTime(0)
+    , m_releasedGeneration(0)
+    , m_readyKey(0)
+    , m_readyTime(0)
+    , m_yieldKey(0)
+    , m_runStartTime(0)
+    , m_yieldCounted(false)
     , m_restartTime(0.0)
     , m_restartCount(0)
 {
@@ -81,7 +92,7 @@ const std::string& Activity::getName() const
 
 bool Activity::isNameRegistered() const
 {
-    return m_nameTableItem.is_linked();
+    return m_nameRegistered;
 }
 
 void Activity::setDescription(const std::string& description)
@@ -238,9 +249,12 @@ MojErr Activity::broadcastEvent(ActivityEvent event)
 
     MojErr err = MojErrNone;
 
+    /* Every subscriber gets the same reply */
+    EventReplies replies(shared_from_this());
+
     for (SubscriptionSet::iterator iter = m_subscriptions.begin() ;
             iter != m_subscriptions.end() ; ++iter) {
-        MojErr sendErr = iter->queueEvent(event);
+        MojErr sendErr = iter->queueEvent(event, replies);
 
         /* Catch the last error, if any */
         if (sendErr)
@@ -269,9 +283,13 @@ void Activity::unplugAllSubscriptions()
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("[Activity %llu] Unplugging all subscriptions", m_id);
 
+    /* Nothing changes while the queued events go out, so the replies are
+     * shared by all subscribers */
+    EventReplies replies(shared_from_this());
+
     for (SubscriptionSet::iterator iter = m_subscriptions.begin() ;
             iter != m_subscriptions.end() ; ++iter) {
-        iter->unplug();
+        iter->unplug(replies);
     }
 }
 
@@ -715,7 +733,7 @@ void Activity::setPersistToken(std::shared_ptr<PersistToken> token)
     m_persistToken = token;
 }
 
-std::shared_ptr<PersistToken> Activity::getPersistToken()
+std::shared_ptr<PersistToken> Activity::getPersistToken() const
 {
     return m_persistToken;
 }
@@ -817,6 +835,15 @@ std::shared_ptr<AbstractPersistCommand> Activity::getHookedPersistCommand()
     return m_persistCommands.front();
 }
 
+std::shared_ptr<AbstractPersistCommand> Activity::getLastPersistCommand()
+{
+    if (m_persistCommands.empty()) {
+        return nullptr;
+    }
+
+    return m_persistCommands.back();
+}
+
 void Activity::setPriority(ActivityPriority_t priority)
 {
     m_priority = priority;
@@ -964,6 +991,7 @@ void Activity::respondForStart(std::string errorText)
 
     if (errorText.length() > 0) {
         (void) m_msgForStart->replyError(MojErrInternal, errorText.c_str());
+        RequestLatency::getInstance().finish(m_msgForStart.get());
         m_msgForStart.reset();
         return;
     }
@@ -1001,6 +1029,7 @@ Respond:
     err = m_msgForStart->replySuccess(reply);
     MojErrAccumulate(errs, err);
 
+    RequestLatency::getInstance().finish(m_msgForStart.get());
     m_msgForStart.reset();
 
     if (MojErrNone != errs) {
@@ -1354,24 +1383,24 @@ void Activity::setState(std::shared_ptr<AbstractActivityState> state)
                  m_state->getName().c_str(), state->getName().c_str());
 
     m_state = state;
+    m_transition = AbstractActivityState::kActivityTransitionNone;
     ActivityMonitor::getInstance().send(shared_from_this());
-    g_timeout_add_full(G_PRIORITY_HIGH, 0, &Activity::setStateInternal, &m_id, NULL);
+    ActivityManager::getInstance().queueTransition(
+            TransitionQueue::EnterState, m_id);
 }
 
-gboolean Activity::setStateInternal(gpointer data)
+void Activity::setStateInternal(activityId_t id)
 {
-    activityId_t* id = static_cast<activityId_t*>(data);
     std::shared_ptr<Activity> self;
     try {
-        self = ActivityManager::getInstance().getActivity((*id));
+        self = ActivityManager::getInstance().getActivity(id);
     } catch (const std::runtime_error& except) {
         LOG_AM_WARNING("SET_STATE_ERR", 0, "%s", except.what());
-        return G_SOURCE_REMOVE;
+        return;
     }
 
     LOG_AM_DEBUG("[Activity %llu] State \"%s\"", self->getId(), self->m_state->getName().c_str());
     self->m_state->enter(self);
-    return G_SOURCE_REMOVE;
 }
 
 std::shared_ptr<AbstractActivityState> Activity::getState() const
@@ -1443,7 +1472,7 @@ pbnjson::JValue Activity::toJson() const
     pbnjson::JValue obj =  pbnjson::JObject{
             {"activityId", (int64_t)m_id},
             {"name", m_name},
-            {"state", m_state->toString()},
+            {"state", m_state->toString(*this)},
             {"parent", m_parent.expired() ? "" : m_parent.lock()->getSubscriber().getString().c_str()},
             {"requirements", requirementsToJson()},
             {"trigger", triggerToJson()}};
@@ -1584,7 +1613,7 @@ MojErr Activity::toJson(MojObject& rep, unsigned flags) const
     MojErrCheck(err);
 
     if (!(flags & ACTIVITY_JSON_PERSIST)) {
-        err = rep.putString(_T("state"), m_state->toString().c_str());
+        err = rep.putString(_T("state"), m_state->toString(*this).c_str());
         MojErrCheck(err);
 
         if (flags & ACTIVITY_JSON_SUBSCRIBERS) {
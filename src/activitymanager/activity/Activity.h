@@ -138,7 +138,7 @@ public:
     bool isPersistent() const;
 
     void setPersistToken(std::shared_ptr<PersistToken> token);
-    std::shared_ptr<PersistToken> getPersistToken();
+    std::shared_ptr<PersistToken> getPersistToken() const;
     void clearPersistToken();
     bool isPersistTokenSet() const;
 
@@ -146,6 +146,8 @@ public:
     void unhookPersistCommand(std::shared_ptr<AbstractPersistCommand> cmd);
     bool isPersistCommandHooked() const;
     std::shared_ptr<AbstractPersistCommand> getHookedPersistCommand();
+    /* The most recently hooked command, or NULL */
+    std::shared_ptr<AbstractPersistCommand> getLastPersistCommand();
 
     /* Priority management */
     void setPriority(ActivityPriority_t priority);
@@ -209,6 +211,8 @@ public:
 protected:
     /* Activity Manager may access "private" control interfaces. */
     friend class ActivityManager;
+    friend class FairShareQueue;
+    friend class YieldQueue;
     friend class AbstractActivityState;
     friend class ActivityStateNone;
     friend class ActivityStateCreated;
@@ -243,7 +247,7 @@ protected:
 
     bool isFastRestart();
 
-    static gboolean setStateInternal(gpointer data);
+    static void setStateInternal(activityId_t id);
 
     /* DISALLOW */
     Activity();
@@ -252,12 +256,12 @@ protected:
     bool operator==(const Activity& rhs) const;
 
 protected:
-    typedef boost::intrusive::set_member_hook<
-            boost::intrusive::link_mode<boost::intrusive::auto_unlink>> ActivityTableItem;
-
     typedef boost::intrusive::list_member_hook<
             boost::intrusive::link_mode<boost::intrusive::auto_unlink>> ActivityListItem;
 
+    typedef boost::intrusive::set_member_hook<
+            boost::intrusive::link_mode<boost::intrusive::auto_unlink>> ActivitySetItem;
+
     typedef boost::intrusive::member_hook<Subscriber, Subscriber::SetItem,
             &Subscriber::m_item> SubscriberSetOption;
     typedef boost::intrusive::multiset<Subscriber, SubscriberSetOption,
@@ -353,6 +357,10 @@ protected:
 
     std::shared_ptr<AbstractActivityState> m_state;
 
+    /* Transition out of m_state currently being made, if any.  Kept here
+     * rather than in the state so the states can be shared. */
+    AbstractActivityState::ActivityTransition m_transition;
+
     AdopterQueue m_adopters;
     SubscriptionSet m_subscriptions;
     SubscriberSet m_subscribers;
@@ -374,16 +382,39 @@ protected:
      * awake while Activity is running. */
     std::shared_ptr<AbstractPowerActivity> m_powerActivity;
 
-    /* Index this in table of Activity names (and auto-unlink) */
-    ActivityTableItem m_nameTableItem;
+    /* Activity is listed in the Activity Manager's name index */
+    bool m_nameRegistered;
+
+    /* Link in the Activity Manager's list of released Activities that are
+     * still referenced (auto-unlinks) */
+    ActivityListItem m_releasedItem;
 
-    /* Index this in table of Activity IDs (and auto-unlink).  This includes
-     * Activities that have been released but still have references. */
-    ActivityTableItem m_idTableItem;
+    /* When the Activity was released: monotonic time in milliseconds, and
+     * the Activity Manager's leak sweep generation */
+    int64_t m_releasedTime;
+    unsigned m_releasedGeneration;
 
-    /* Start/Ready/Run queue link */
+    /* Start/Run queue link */
     ActivityListItem m_runQueueItem;
 
+    /* Ready queue link (and auto-unlink).  Ready queues are ordered by
+     * m_readyKey, which must not change while the Activity is queued. */
+    ActivitySetItem m_readyQueueItem;
+    int64_t m_readyKey;
+
+    /* Monotonic time (in milliseconds) the Activity became ready */
+    int64_t m_readyTime;
+
+    /* Yield candidate link (and auto-unlink), while running in the
+     * background interactive run queue.  Candidates are ordered by
+     * m_yieldKey, then by when they started running (monotonic time in
+     * milliseconds).  m_yieldCounted is set once the Activity has been asked
+     * to yield and counts against the yield queue's yielding total. */
+    ActivitySetItem m_yieldQueueItem;
+    int64_t m_yieldKey;
+    int64_t m_runStartTime;
+    bool m_yieldCounted;
+
     /* List of pending Persist commands */
     CommandQueue m_persistCommands;
 
@@ -22,9 +22,68 @@
 
 #include "activity/callback/ActivityCallback.h"
 #include "activity/schedule/IntervalSchedule.h"
+#include "conf/Config.h"
 #include "service/BusConnection.h"
 #include "util/Logging.h"
 
+/* The cached template for a spec, parsing it if there's none.  Specs that
+ * fail to parse aren't cached; they throw every time. */
+template <class T>
+static std::shared_ptr<const T> lookupTemplate(
+        SpecCache<T>& templates, const MojObject& spec,
+        std::shared_ptr<const T> (*compile)(const MojObject&))
+{
+    MojString json;
+    if (!templates.getCapacity() || spec.toJson(json)) {
+        return compile(spec);
+    }
+
+    std::string key(json.data());
+    std::shared_ptr<const T> compiled = templates.find(key);
+    if (!compiled) {
+        compiled = compile(spec);
+        templates.insert(key, compiled);
+    }
+
+    return compiled;
+}
+
+/* The template cache, resized whenever the configuration has been reloaded
+ * since it was last used.  Templates don't depend on the configuration, so
+ * the ones that still fit are kept. */
+template <class T>
+static SpecCache<T>& configureTemplates(SpecCache<T>& templates, unsigned int& generation)
+{
+    const Config& config = Config::getInstance();
+
+    if (config.getGeneration() != generation) {
+        generation = config.getGeneration();
+        templates.setCapacity(config.getSpecCacheSize());
+    }
+
+    return templates;
+}
+
+template <class T>
+static MojErr templatesToJson(const SpecCache<T>& templates, MojObject& rep)
+{
+    MojErr err = MojErrNone;
+
+    err = rep.putInt(_T("size"), (MojInt64) templates.size());
+    MojErrCheck(err);
+
+    err = rep.putInt(_T("capacity"), (MojInt64) templates.getCapacity());
+    MojErrCheck(err);
+
+    err = rep.putInt(_T("hits"), (MojInt64) templates.getHits());
+    MojErrCheck(err);
+
+    err = rep.putInt(_T("misses"), (MojInt64) templates.getMisses());
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
+
 std::shared_ptr<Activity> ActivityExtractor::createActivity(const MojObject& spec, bool reload)
 {
     MojString activityName;
@@ -374,12 +433,27 @@ std::vector<std::shared_ptr<ITrigger>> ActivityExtractor::createTriggers(
 
 std::shared_ptr<ITrigger> ActivityExtractor::createTrigger(std::shared_ptr<Activity> activity,
                                                            const MojObject& spec)
+{
+    std::shared_ptr<const TriggerTemplate> compiled =
+            lookupTemplate(getTriggerTemplates(), spec, &ActivityExtractor::compileTrigger);
+
+    std::shared_ptr<ITrigger> trigger = TriggerFactory::createTrigger(
+            activity, compiled->m_url, compiled->m_params, compiled->m_matcher);
+
+    if (compiled->m_named) {
+        trigger->setName(compiled->m_name);
+    }
+
+    return trigger;
+}
+
+std::shared_ptr<const ActivityExtractor::TriggerTemplate> ActivityExtractor::compileTrigger(
+        const MojObject& spec)
 {
     MojErr err;
 
-    std::shared_ptr<ITrigger> trigger;
+    std::shared_ptr<TriggerTemplate> compiled = std::make_shared<TriggerTemplate>();
 
-    MojObject params;
     MojObject where;
     MojObject compare;
     MojObject value;
@@ -392,15 +466,15 @@ std::shared_ptr<ITrigger> ActivityExtractor::createTrigger(std::shared_ptr<Activ
         throw std::runtime_error("Method URL for Trigger is required");
     }
 
-    LunaURL url(method);
+    compiled->m_url = method;
 
     /* If no params, no problem. */
-    spec.get(_T("params"), params);
+    spec.get(_T("params"), compiled->m_params);
 
     if (spec.contains(_T("where"))) {
         spec.get(_T("where"), where);
 
-        trigger = TriggerFactory::createWhereTrigger(activity, url, params, where);
+        compiled->m_matcher = TriggerFactory::createWhereMatcher(where);
     } else if (spec.contains(_T("compare"))) {
         spec.get(_T("compare"), compare);
 
@@ -414,58 +488,128 @@ std::shared_ptr<ITrigger> ActivityExtractor::createTrigger(std::shared_ptr<Activ
         compare.getRequired(_T("key"), key);
         compare.get(_T("value"), value);
 
-        trigger = TriggerFactory::createCompareTrigger(activity, url, params, key, value);
+        compiled->m_matcher = TriggerFactory::createCompareMatcher(key, value);
     } else if (spec.contains(_T("key"))) {
         spec.getRequired(_T("key"), key);
 
-        trigger = TriggerFactory::createKeyedTrigger(activity, url, params, key);
-    } else {
-        trigger = TriggerFactory::createBasicTrigger(activity, url, params);
+        compiled->m_matcher = TriggerFactory::createKeyMatcher(key);
     }
 
     MojObject nameObj;
     MojString nameStr;
+    compiled->m_named = false;
     if (spec.get(_T("name"), nameObj) &&
             nameObj.type() == MojObject::TypeString &&
             nameObj.stringValue(nameStr) == MojErrNone) {
-        trigger->setName(nameStr.data());
+        compiled->m_named = true;
+        compiled->m_name = nameStr.data();
     }
 
-    return trigger;
+    return compiled;
 }
 
 std::shared_ptr<AbstractCallback> ActivityExtractor::createCallback(std::shared_ptr<Activity> activity,
                                                                     const MojObject& spec)
+{
+    std::shared_ptr<const CallbackTemplate> compiled =
+            lookupTemplate(getCallbackTemplates(), spec, &ActivityExtractor::compileCallback);
+
+    bool ignoreReturnValue = activity->isContinuous() ? true : false;
+    if (compiled->m_ignoreReturnSet) {
+        ignoreReturnValue = compiled->m_ignoreReturn;
+    }
+
+    std::shared_ptr<AbstractCallback> callback = std::make_shared<
+            ActivityCallback>(activity, compiled->m_url, compiled->m_params, ignoreReturnValue);
+
+    return callback;
+}
+
+std::shared_ptr<const ActivityExtractor::CallbackTemplate> ActivityExtractor::compileCallback(
+        const MojObject& spec)
 {
     MojErr err;
 
+    std::shared_ptr<CallbackTemplate> compiled = std::make_shared<CallbackTemplate>();
+
     MojString method;
-    MojObject params;
-    bool ignoreReturnValue = activity->isContinuous() ? true : false;
 
     err = spec.getRequired(_T("method"), method);
     if (err) {
         throw std::runtime_error("Method URL for Callback is required");
     }
 
-    LunaURL url(method);
+    compiled->m_url = method;
 
     /* If no params, no problem. */
-    spec.get(_T("params"), params);
+    spec.get(_T("params"), compiled->m_params);
+
+    compiled->m_ignoreReturnSet = false;
+    compiled->m_ignoreReturn = false;
 
     MojObject ignoreObj;
     if (spec.get(_T("ignoreReturn"), ignoreObj) && ignoreObj.type() == MojObject::TypeBool) {
-        ignoreReturnValue = ignoreObj.boolValue();
+        compiled->m_ignoreReturnSet = true;
+        compiled->m_ignoreReturn = ignoreObj.boolValue();
     }
 
-    std::shared_ptr<AbstractCallback> callback = std::make_shared<
-            ActivityCallback>(activity, url, params, ignoreReturnValue);
-
-    return callback;
+    return compiled;
 }
 
 std::shared_ptr<Schedule> ActivityExtractor::createSchedule(
         std::shared_ptr<Activity> activity, const MojObject& spec)
+{
+    std::shared_ptr<const ScheduleTemplate> compiled =
+            lookupTemplate(getScheduleTemplates(), spec, &ActivityExtractor::compileSchedule);
+
+    std::shared_ptr<Schedule> schedule;
+
+    if (compiled->m_hasInterval) {
+        std::shared_ptr<IntervalSchedule> intervalSchedule;
+
+        if (compiled->m_relative) {
+            intervalSchedule = std::make_shared<RelativeIntervalSchedule>(
+                    activity, compiled->m_start, compiled->m_interval, compiled->m_end);
+        } else if (compiled->m_precise) {
+            intervalSchedule = std::make_shared<PreciseIntervalSchedule>(
+                    activity, compiled->m_start, compiled->m_interval, compiled->m_end);
+        } else {
+            intervalSchedule = std::make_shared<IntervalSchedule>(activity,
+                                                                  compiled->m_start,
+                                                                  compiled->m_interval,
+                                                                  compiled->m_end);
+        }
+
+        if (compiled->m_skip) {
+            intervalSchedule->setSkip(compiled->m_skip);
+        }
+
+        if (!compiled->m_isUTC) {
+            intervalSchedule->setLocal(!compiled->m_isUTC);
+        }
+
+        if (compiled->m_hasLastFinished) {
+            intervalSchedule->setLastFinishedTime(compiled->m_lastFinished);
+        }
+
+        schedule = intervalSchedule;
+    } else {
+        schedule = std::make_shared<Schedule>(activity, compiled->m_start);
+
+        if (!compiled->m_startIsUTC) {
+            schedule->setLocal(true);
+        }
+    }
+
+    if (compiled->m_hasLocal) {
+        schedule->setLocal(compiled->m_local);
+    }
+
+    return schedule;
+}
+
+std::shared_ptr<const ActivityExtractor::ScheduleTemplate> ActivityExtractor::compileSchedule(
+        const MojObject& spec)
 {
     MojErr err;
 
@@ -474,17 +618,26 @@ std::shared_ptr<Schedule> ActivityExtractor::createSchedule(
     MojString lastFinishedStr;
 
     bool found = false;
-    bool startIsUTC = true;
     bool endIsUTC = true;
-    bool precise = false;
-    bool relative = false;
-    bool skip = false;
     bool lastFinishedIsUTC = true;
-    bool local;
 
-    std::shared_ptr<Schedule> schedule;
-    time_t startTime = IntervalSchedule::kDayOne;
-    time_t endTime = Schedule::kUnbounded;
+    std::shared_ptr<ScheduleTemplate> compiled = std::make_shared<ScheduleTemplate>();
+    compiled->m_start = IntervalSchedule::kDayOne;
+    compiled->m_startIsUTC = true;
+    compiled->m_end = Schedule::kUnbounded;
+    compiled->m_hasInterval = false;
+    compiled->m_interval = 0;
+    compiled->m_precise = false;
+    compiled->m_relative = false;
+    compiled->m_skip = false;
+    compiled->m_isUTC = false;
+    compiled->m_hasLastFinished = false;
+    compiled->m_lastFinished = 0;
+    compiled->m_hasLocal = false;
+    compiled->m_local = false;
+
+    time_t& startTime = compiled->m_start;
+    time_t& endTime = compiled->m_end;
 
     err = spec.get(_T("start"), startTimeStr, found);
     if (err) {
@@ -492,7 +645,8 @@ std::shared_ptr<Schedule> ActivityExtractor::createSchedule(
     }
 
     if (found) {
-        startTime = AbstractScheduleManager::stringToTime(startTimeStr.data(), startIsUTC);
+        startTime = AbstractScheduleManager::stringToTime(startTimeStr.data(),
+                                                          compiled->m_startIsUTC);
     }
 
     found = false;
@@ -503,6 +657,8 @@ std::shared_ptr<Schedule> ActivityExtractor::createSchedule(
 
 
     if (found) {
+        compiled->m_hasInterval = true;
+
         found = false;
         MojString endTimeStr;
         err = spec.get(_T("end"), endTimeStr, found);
@@ -513,63 +669,44 @@ std::shared_ptr<Schedule> ActivityExtractor::createSchedule(
             endTime = AbstractScheduleManager::stringToTime(endTimeStr.data(), endIsUTC);
         }
 
-        spec.get(_T("precise"), precise);
+        spec.get(_T("precise"), compiled->m_precise);
 
-        spec.get(_T("relative"), relative);
+        spec.get(_T("relative"), compiled->m_relative);
 
-        spec.get(_T("skip"), skip);
+        spec.get(_T("skip"), compiled->m_skip);
 
-        unsigned interval = IntervalSchedule::stringToInterval(
-                intervalStr.data(), !precise);
+        compiled->m_interval = IntervalSchedule::stringToInterval(
+                intervalStr.data(), !compiled->m_precise);
 
-        if (!precise && ((startTime != Schedule::kDayOne)
+        if (!compiled->m_precise && ((startTime != Schedule::kDayOne)
                 || (endTime != Schedule::kUnbounded))) {
             throw std::runtime_error(
                     "Unless precise time is specified, time intervals"
                     " may not specify a start or end time");
         }
 
-        std::shared_ptr<IntervalSchedule> intervalSchedule;
-
-        if (!precise && relative) {
+        if (!compiled->m_precise && compiled->m_relative) {
             throw std::runtime_error(
                     "An interval schedule can be specified as normal, precise, or precise and relative.");
-        } else if (relative) {
-            intervalSchedule = std::make_shared<RelativeIntervalSchedule>(
-                    activity, startTime, interval, endTime);
-        } else if (precise) {
-            intervalSchedule = std::make_shared<PreciseIntervalSchedule>(
-                    activity, startTime, interval, endTime);
-        } else {
-            intervalSchedule = std::make_shared<IntervalSchedule>(activity,
-                                                                  startTime,
-                                                                  interval,
-                                                                  endTime);
-        }
-
-        if (skip) {
-            intervalSchedule->setSkip(skip);
         }
 
         bool isUTC = false;
 
         if ((startTime != Schedule::kDayOne) && (endTime != Schedule::kUnbounded)) {
-            if (startIsUTC != endIsUTC) {
+            if (compiled->m_startIsUTC != endIsUTC) {
                 throw std::runtime_error(
                         "Start and end time must both be specified in UTC "
                         "or local time");
             }
 
-            isUTC = startIsUTC;
+            isUTC = compiled->m_startIsUTC;
         } else if (startTime != Schedule::kDayOne) {
-            isUTC = startIsUTC;
+            isUTC = compiled->m_startIsUTC;
         } else if (endTime != Schedule::kUnbounded) {
             isUTC = endIsUTC;
         }
 
-        if (!isUTC) {
-            intervalSchedule->setLocal(!isUTC);
-        }
+        compiled->m_isUTC = isUTC;
 
         found = false;
         err = spec.get(_T("lastFinished"), lastFinishedStr, found);
@@ -577,34 +714,77 @@ std::shared_ptr<Schedule> ActivityExtractor::createSchedule(
             throw std::runtime_error(
                     "Error decoding end time string from schedule specification");
         } else if (found) {
-            time_t lastFinishedTime = AbstractScheduleManager::stringToTime(lastFinishedStr.data(), lastFinishedIsUTC);
+            compiled->m_lastFinished = AbstractScheduleManager::stringToTime(
+                    lastFinishedStr.data(), lastFinishedIsUTC);
+            compiled->m_hasLastFinished = true;
             if (isUTC != lastFinishedIsUTC) {
                 LOG_AM_DEBUG(
                         "Last finished should use the same time format as the other times in the schedule");
             }
-            intervalSchedule->setLastFinishedTime(lastFinishedTime);
         }
-
-        schedule = intervalSchedule;
     } else {
         if (startTime == IntervalSchedule::kDayOne) {
             throw std::runtime_error(
                     "Non Interval Schedules must specify a start time");
         }
+    }
 
-        schedule = std::make_shared<Schedule>(activity, startTime);
+    compiled->m_hasLocal = spec.get(_T("local"), compiled->m_local);
 
-        if (!startIsUTC) {
-            schedule->setLocal(true);
-        }
-    }
+    return compiled;
+}
 
-    found = spec.get(_T("local"), local);
-    if (found) {
-        schedule->setLocal(local);
-    }
+SpecCache<ActivityExtractor::TriggerTemplate>& ActivityExtractor::getTriggerTemplates()
+{
+    static SpecCache<TriggerTemplate> templates(Config::getInstance().getSpecCacheSize());
+    static unsigned int generation = Config::getInstance().getGeneration();
+    return configureTemplates(templates, generation);
+}
 
-    return schedule;
+SpecCache<ActivityExtractor::CallbackTemplate>& ActivityExtractor::getCallbackTemplates()
+{
+    static SpecCache<CallbackTemplate> templates(Config::getInstance().getSpecCacheSize());
+    static unsigned int generation = Config::getInstance().getGeneration();
+    return configureTemplates(templates, generation);
+}
+
+SpecCache<ActivityExtractor::ScheduleTemplate>& ActivityExtractor::getScheduleTemplates()
+{
+    static SpecCache<ScheduleTemplate> templates(Config::getInstance().getSpecCacheSize());
+    static unsigned int generation = Config::getInstance().getGeneration();
+    return configureTemplates(templates, generation);
+}
+
+MojErr ActivityExtractor::infoToJson(MojObject& rep)
+{
+    MojErr err = MojErrNone;
+    MojObject specCache;
+
+    MojObject triggers;
+    err = templatesToJson(getTriggerTemplates(), triggers);
+    MojErrCheck(err);
+
+    err = specCache.put(_T("triggers"), triggers);
+    MojErrCheck(err);
+
+    MojObject callbacks;
+    err = templatesToJson(getCallbackTemplates(), callbacks);
+    MojErrCheck(err);
+
+    err = specCache.put(_T("callbacks"), callbacks);
+    MojErrCheck(err);
+
+    MojObject schedules;
+    err = templatesToJson(getScheduleTemplates(), schedules);
+    MojErrCheck(err);
+
+    err = specCache.put(_T("schedules"), schedules);
+    MojErrCheck(err);
+
+    err = rep.put(_T("specCache"), specCache);
+    MojErrCheck(err);
+
+    return MojErrNone;
 }
 
 void ActivityExtractor::processTypeProperty(std::shared_ptr<Activity> activity,
@@ -26,10 +26,12 @@
 
 #include "activity/Activity.h"
 #include "activity/ActivityManager.h"
+#include "activity/SpecCache.h"
 #include "activity/schedule/Schedule.h"
 #include "base/AbstractCallback.h"
 #include "base/BusId.h"
 #include "base/ITrigger.h"
+#include "base/LunaURL.h"
 #include "requirement/RequirementManager.h"
 
 class ActivityExtractor {
@@ -51,11 +53,67 @@ public:
     static std::shared_ptr<AbstractCallback> createCallback(
             std::shared_ptr<Activity> activity, const MojObject& spec);
 
+    /* Reports the parsed spec caches */
+    static MojErr infoToJson(MojObject& rep);
+
 private:
     ActivityExtractor() {};
     typedef std::list<std::string> RequirementNameList;
     typedef std::list<std::shared_ptr<IRequirement>> RequirementList;
 
+    /*
+     * Parsed and validated Trigger, Callback and Schedule specs.  Only what
+     * every Activity created from the same spec has in common; the
+     * Activity's own objects are made from these.
+     */
+    struct TriggerTemplate {
+        LunaURL m_url;
+        MojObject m_params;
+
+        /* Shared by every Trigger made from the template.  Not set for
+         * basic Triggers, whose Matchers have state of their own. */
+        std::shared_ptr<Matcher> m_matcher;
+
+        bool m_named;
+        std::string m_name;
+    };
+
+    struct CallbackTemplate {
+        LunaURL m_url;
+        MojObject m_params;
+
+        /* Otherwise the return is ignored only for continuous Activities */
+        bool m_ignoreReturnSet;
+        bool m_ignoreReturn;
+    };
+
+    struct ScheduleTemplate {
+        time_t m_start;
+        bool m_startIsUTC;
+        time_t m_end;
+
+        bool m_hasInterval;
+        unsigned m_interval;
+        bool m_precise;
+        bool m_relative;
+        bool m_skip;
+        bool m_isUTC;
+
+        bool m_hasLastFinished;
+        time_t m_lastFinished;
+
+        bool m_hasLocal;
+        bool m_local;
+    };
+
+    static SpecCache<TriggerTemplate>& getTriggerTemplates();
+    static SpecCache<CallbackTemplate>& getCallbackTemplates();
+    static SpecCache<ScheduleTemplate>& getScheduleTemplates();
+
+    static std::shared_ptr<const TriggerTemplate> compileTrigger(const MojObject& spec);
+    static std::shared_ptr<const CallbackTemplate> compileCallback(const MojObject& spec);
+    static std::shared_ptr<const ScheduleTemplate> compileSchedule(const MojObject& spec);
+
     static BusId processBusId(const MojObject& spec);
 
     static std::shared_ptr<ITrigger> createTrigger(
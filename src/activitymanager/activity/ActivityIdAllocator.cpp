@@ -0,0 +1,118 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ActivityIdAllocator.h"
+
+#include <cstdlib>
+#include <glib.h>
+
+#include "util/Logging.h"
+
+ActivityIdAllocator::ActivityIdAllocator(const std::string& path)
+    : m_path(path)
+    , m_next(1) /* Activity ID 0 is reserved */
+    , m_mark(1)
+{
+}
+
+ActivityIdAllocator::~ActivityIdAllocator()
+{
+}
+
+void ActivityIdAllocator::setPath(const std::string& path)
+{
+    m_path = path;
+}
+
+void ActivityIdAllocator::load()
+{
+    if (m_path.empty()) {
+        return;
+    }
+
+    gchar *contents = NULL;
+    if (!g_file_get_contents(m_path.c_str(), &contents, NULL, NULL)) {
+        LOG_AM_DEBUG("No persisted Activity ID high-water mark at %s", m_path.c_str());
+        return;
+    }
+
+    char *end = NULL;
+    activityId_t mark = strtoull(contents, &end, 10);
+    if ((end == contents) || (mark == 0)) {
+        LOG_AM_WARNING(MSGID_ACTIVITY_ID_MARK_ERR, 1,
+                       PMLOGKS("file", m_path.c_str()),
+                       "Ignoring invalid Activity ID high-water mark");
+    } else {
+        reserve(mark - 1);
+        LOG_AM_DEBUG("Resuming Activity IDs from %llu", m_next);
+    }
+
+    g_free(contents);
+}
+
+activityId_t ActivityIdAllocator::allocate()
+{
+    if (m_next == 0) {
+        m_next = 1;
+    }
+
+    /* Reserve the next block before handing out any of it.  If that can't
+     * be persisted, carry on regardless; it's retried with the next block. */
+    if (m_next >= m_mark) {
+        m_mark = m_next + kReserveBlock;
+        persist(m_mark);
+    }
+
+    return m_next++;
+}
+
+void ActivityIdAllocator::reserve(activityId_t id)
+{
+    if (id >= m_next) {
+        m_next = id + 1;
+    }
+}
+
+activityId_t ActivityIdAllocator::peek() const
+{
+    return m_next;
+}
+
+activityId_t ActivityIdAllocator::getHighWaterMark() const
+{
+    return m_mark;
+}
+
+void ActivityIdAllocator::persist(activityId_t mark)
+{
+    if (m_path.empty()) {
+        return;
+    }
+
+    gchar *dir = g_path_get_dirname(m_path.c_str());
+    g_mkdir_with_parents(dir, 0755);
+    g_free(dir);
+
+    std::string contents = std::to_string(mark);
+
+    GError *error = NULL;
+    if (!g_file_set_contents(m_path.c_str(), contents.c_str(), (gssize) contents.size(), &error)) {
+        LOG_AM_WARNING(MSGID_ACTIVITY_ID_MARK_ERR, 1,
+                       PMLOGKS("file", m_path.c_str()),
+                       "Failed to persist Activity ID high-water mark: %s", error->message);
+        g_error_free(error);
+    }
+}
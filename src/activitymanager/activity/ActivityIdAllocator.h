@@ -0,0 +1,67 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __ACTIVITY_ID_ALLOCATOR_H__
+#define __ACTIVITY_ID_ALLOCATOR_H__
+
+#include <string>
+
+#include "Main.h"
+
+/*
+ * Hands out Activity IDs above a high-water mark.
+ *
+ * IDs are never reused, so allocation doesn't have to search for a free ID
+ * among those held by reloaded Activities; it only has to stay above the
+ * highest one.  The mark is persisted a block at a time, so IDs from before
+ * a restart aren't handed out again (a stale ID held by a client won't
+ * refer to a different Activity), at the cost of skipping the rest of the
+ * block the last run had reserved.
+ */
+class ActivityIdAllocator {
+public:
+    static const activityId_t kReserveBlock = 1024;
+
+    /* An empty path disables persistence */
+    ActivityIdAllocator(const std::string& path = "");
+    virtual ~ActivityIdAllocator();
+
+    /* Where the mark is persisted; an empty path disables persistence */
+    void setPath(const std::string& path);
+
+    /* Resume above the mark persisted by a previous run, if any */
+    void load();
+
+    activityId_t allocate();
+
+    /* An ID is in use that wasn't allocated here (a reloaded Activity) */
+    void reserve(activityId_t id);
+
+    /* The next ID that will be allocated */
+    activityId_t peek() const;
+
+    /* IDs below this may have been handed out by this or a previous run */
+    activityId_t getHighWaterMark() const;
+
+protected:
+    void persist(activityId_t mark);
+
+    std::string m_path;
+    activityId_t m_next;
+    activityId_t m_mark;
+};
+
+#endif /* __ACTIVITY_ID_ALLOCATOR_H__ */
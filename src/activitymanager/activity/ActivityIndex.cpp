@@ -0,0 +1,335 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ActivityIndex.h"
+
+#include "activity/Activity.h"
+
+ActivityIndex::ActivityIndex()
+    : m_idSlots(kInitialCapacity)
+    , m_nameSlots(kInitialCapacity)
+    , m_idCount(0)
+    , m_nameCount(0)
+{
+}
+
+ActivityIndex::~ActivityIndex()
+{
+}
+
+std::shared_ptr<Activity> ActivityIndex::find(activityId_t id) const
+{
+    size_t pos = findIdSlot(id);
+    if (m_idSlots[pos].m_id == kEmptyId) {
+        return std::shared_ptr<Activity>();
+    }
+
+    return m_idSlots[pos].m_activity;
+}
+
+bool ActivityIndex::contains(activityId_t id) const
+{
+    return m_idSlots[findIdSlot(id)].m_id != kEmptyId;
+}
+
+bool ActivityIndex::insert(std::shared_ptr<Activity> act)
+{
+    activityId_t id = act->getId();
+    if (id == kEmptyId) {
+        return false;
+    }
+
+    size_t pos = findIdSlot(id);
+    if (m_idSlots[pos].m_id != kEmptyId) {
+        return false;
+    }
+
+    if (needsGrow(m_idCount + 1, m_idSlots.size())) {
+        growIds();
+        pos = findIdSlot(id);
+    }
+
+    m_idOrder[id] = act.get();
+
+    m_idSlots[pos].m_id = id;
+    m_idSlots[pos].m_activity = std::move(act);
+    m_idCount++;
+
+    return true;
+}
+
+bool ActivityIndex::erase(const Activity& act)
+{
+    size_t pos = findIdSlot(act.getId());
+
+    /* Only remove the entry if it's for this instance.  An Activity reloaded
+     * with a duplicate ID may be released while the original is still live. */
+    if ((m_idSlots[pos].m_id == kEmptyId) || (m_idSlots[pos].m_activity.get() != &act)) {
+        return false;
+    }
+
+    m_idOrder.erase(act.getId());
+
+    eraseIdSlot(pos);
+    return true;
+}
+
+std::shared_ptr<Activity> ActivityIndex::find(const std::string& name,
+                                              const BusId& creator,
+                                              bool nameOnly) const
+{
+    if (nameOnly) {
+        NameOnlyIndex::const_iterator found = m_nameOnly.find(name);
+        if (found == m_nameOnly.end()) {
+            return std::shared_ptr<Activity>();
+        }
+
+        return m_nameSlots[findNameSlot(**found->second.begin())].m_activity;
+    }
+
+    size_t pos = findNameSlot(hashName(name, creator), name, creator);
+    return m_nameSlots[pos].m_activity;
+}
+
+bool ActivityIndex::insertName(std::shared_ptr<Activity> act)
+{
+    size_t hash = hashName(act->getName(), act->getCreator());
+
+    size_t pos = findNameSlot(hash, act->getName(), act->getCreator());
+    if (m_nameSlots[pos].m_activity) {
+        return false;
+    }
+
+    if (needsGrow(m_nameCount + 1, m_nameSlots.size())) {
+        growNames();
+        pos = findNameSlot(hash, act->getName(), act->getCreator());
+    }
+
+    m_nameOnly[act->getName()].insert(act.get());
+
+    m_nameSlots[pos].m_hash = hash;
+    m_nameSlots[pos].m_activity = std::move(act);
+    m_nameCount++;
+
+    return true;
+}
+
+bool ActivityIndex::eraseName(const Activity& act)
+{
+    size_t pos = findNameSlot(act);
+    if (!m_nameSlots[pos].m_activity) {
+        return false;
+    }
+
+    NameOnlyIndex::iterator found = m_nameOnly.find(act.getName());
+    found->second.erase(&act);
+    if (found->second.empty()) {
+        m_nameOnly.erase(found);
+    }
+
+    eraseNameSlot(pos);
+    return true;
+}
+
+size_t ActivityIndex::size() const
+{
+    return m_idCount;
+}
+
+size_t ActivityIndex::nameSize() const
+{
+    return m_nameCount;
+}
+
+void ActivityIndex::clear()
+{
+    IdSlots(kInitialCapacity).swap(m_idSlots);
+    m_idOrder.clear();
+    NameSlots(kInitialCapacity).swap(m_nameSlots);
+    m_nameOnly.clear();
+    m_idCount = 0;
+    m_nameCount = 0;
+}
+
+size_t ActivityIndex::hashId(activityId_t id)
+{
+    /* IDs are mostly sequential; mix them so neighbouring IDs don't form
+     * long runs of occupied slots (64-bit finalizer from MurmurHash3). */
+    uint64_t h = id;
+    h ^= h >> 33;
+    h *= 0xff51afd7ed558ccdULL;
+    h ^= h >> 33;
+    h *= 0xc4ceb9fe1a85ec53ULL;
+    h ^= h >> 33;
+    return (size_t) h;
+}
+
+size_t ActivityIndex::hashName(const std::string& name, const BusId& creator)
+{
+    /* Combined as boost::hash_combine does */
+    size_t h = std::hash<std::string>()(name);
+    h ^= std::hash<std::string>()(creator.getId()) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    h ^= (size_t) creator.getType() + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
+
+bool ActivityIndex::isBetween(size_t home, size_t hole, size_t pos)
+{
+    /* Is 'home' cyclically within (hole, pos]?  If so, the entry at 'pos'
+     * can't be moved back into 'hole' without becoming unreachable. */
+    if (hole <= pos) {
+        return (hole < home) && (home <= pos);
+    } else {
+        return (hole < home) || (home <= pos);
+    }
+}
+
+bool ActivityIndex::needsGrow(size_t count, size_t capacity)
+{
+    /* Keep the load factor at or below 1/2.  Linear probing degrades
+     * quickly past that. */
+    return (count * 2) > capacity;
+}
+
+size_t ActivityIndex::findIdSlot(activityId_t id) const
+{
+    size_t mask = m_idSlots.size() - 1;
+    size_t pos = hashId(id) & mask;
+
+    while ((m_idSlots[pos].m_id != kEmptyId) && (m_idSlots[pos].m_id != id)) {
+        pos = (pos + 1) & mask;
+    }
+
+    return pos;
+}
+
+size_t ActivityIndex::findNameSlot(size_t hash, const std::string& name,
+                                   const BusId& creator) const
+{
+    size_t mask = m_nameSlots.size() - 1;
+    size_t pos = hash & mask;
+
+    while (m_nameSlots[pos].m_activity) {
+        const NameSlot& slot = m_nameSlots[pos];
+        if ((slot.m_hash == hash) && (slot.m_activity->getName() == name) &&
+                (slot.m_activity->getCreator() == creator)) {
+            break;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return pos;
+}
+
+size_t ActivityIndex::findNameSlot(const Activity& act) const
+{
+    size_t mask = m_nameSlots.size() - 1;
+    size_t pos = hashName(act.getName(), act.getCreator()) & mask;
+
+    while (m_nameSlots[pos].m_activity && (m_nameSlots[pos].m_activity.get() != &act)) {
+        pos = (pos + 1) & mask;
+    }
+
+    return pos;
+}
+
+void ActivityIndex::eraseIdSlot(size_t hole)
+{
+    size_t mask = m_idSlots.size() - 1;
+    size_t pos = hole;
+
+    while (true) {
+        pos = (pos + 1) & mask;
+        if (m_idSlots[pos].m_id == kEmptyId) {
+            break;
+        }
+
+        if (!isBetween(hashId(m_idSlots[pos].m_id) & mask, hole, pos)) {
+            m_idSlots[hole].m_id = m_idSlots[pos].m_id;
+            m_idSlots[hole].m_activity = std::move(m_idSlots[pos].m_activity);
+            hole = pos;
+        }
+    }
+
+    m_idSlots[hole].m_id = kEmptyId;
+    m_idSlots[hole].m_activity.reset();
+    m_idCount--;
+}
+
+void ActivityIndex::eraseNameSlot(size_t hole)
+{
+    size_t mask = m_nameSlots.size() - 1;
+    size_t pos = hole;
+
+    while (true) {
+        pos = (pos + 1) & mask;
+        if (!m_nameSlots[pos].m_activity) {
+            break;
+        }
+
+        if (!isBetween(m_nameSlots[pos].m_hash & mask, hole, pos)) {
+            m_nameSlots[hole].m_hash = m_nameSlots[pos].m_hash;
+            m_nameSlots[hole].m_activity = std::move(m_nameSlots[pos].m_activity);
+            hole = pos;
+        }
+    }
+
+    m_nameSlots[hole].m_hash = 0;
+    m_nameSlots[hole].m_activity.reset();
+    m_nameCount--;
+}
+
+void ActivityIndex::growIds()
+{
+    IdSlots old(m_idSlots.size() * 2);
+    old.swap(m_idSlots);
+
+    size_t mask = m_idSlots.size() - 1;
+    for (IdSlots::iterator iter = old.begin() ; iter != old.end() ; ++iter) {
+        if (iter->m_id == kEmptyId) {
+            continue;
+        }
+
+        size_t pos = hashId(iter->m_id) & mask;
+        while (m_idSlots[pos].m_id != kEmptyId) {
+            pos = (pos + 1) & mask;
+        }
+
+        m_idSlots[pos].m_id = iter->m_id;
+        m_idSlots[pos].m_activity = std::move(iter->m_activity);
+    }
+}
+
+void ActivityIndex::growNames()
+{
+    NameSlots old(m_nameSlots.size() * 2);
+    old.swap(m_nameSlots);
+
+    size_t mask = m_nameSlots.size() - 1;
+    for (NameSlots::iterator iter = old.begin() ; iter != old.end() ; ++iter) {
+        if (!iter->m_activity) {
+            continue;
+        }
+
+        size_t pos = iter->m_hash & mask;
+        while (m_nameSlots[pos].m_activity) {
+            pos = (pos + 1) & mask;
+        }
+
+        m_nameSlots[pos].m_hash = iter->m_hash;
+        m_nameSlots[pos].m_activity = std::move(iter->m_activity);
+    }
+}
@@ -0,0 +1,141 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __ACTIVITY_INDEX_H__
+#define __ACTIVITY_INDEX_H__
+
+#include <map>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "Main.h"
+#include "base/BusId.h"
+
+class Activity;
+
+/*
+ * Open addressing (linear probing) hash index of the live Activities, keyed
+ * by Activity ID and by (name, creator).
+ *
+ * The name table is probed from the hash of the (name, creator) pair, so
+ * many creators using the same Activity name don't share a probe chain.
+ * The name-only lookup used for anonymous (luna-send) callers can't use
+ * that hash, so a secondary index maps each name to the Activities using
+ * it, and the one it returns is then located in the name table.
+ *
+ * IDs are also kept in order, so listings can resume from a given ID
+ * without going over the ones before it.
+ *
+ * Deletion uses backward shifting rather than tombstones, so lookups never
+ * have to skip over dead slots no matter how much churn the table sees.
+ */
+class ActivityIndex {
+public:
+    ActivityIndex();
+    virtual ~ActivityIndex();
+
+    /* ID table */
+    std::shared_ptr<Activity> find(activityId_t id) const;
+    bool contains(activityId_t id) const;
+    bool insert(std::shared_ptr<Activity> act);
+    bool erase(const Activity& act);
+
+    /* Name table */
+    std::shared_ptr<Activity> find(const std::string& name, const BusId& creator,
+                                   bool nameOnly = false) const;
+    bool insertName(std::shared_ptr<Activity> act);
+    bool eraseName(const Activity& act);
+
+    size_t size() const;
+    size_t nameSize() const;
+
+    void clear();
+
+    template<class Function>
+    void forEach(Function func) const
+    {
+        for (size_t i = 0 ; i < m_idSlots.size() ; ++i) {
+            if (m_idSlots[i].m_id != kEmptyId) {
+                func(m_idSlots[i].m_activity);
+            }
+        }
+    }
+
+    /* In ID order, starting after the given ID, until the function returns
+     * false */
+    template<class Function>
+    void forEachAfter(activityId_t after, Function func) const
+    {
+        for (IdOrder::const_iterator iter = m_idOrder.upper_bound(after) ;
+                iter != m_idOrder.end() ; ++iter) {
+            if (!func(*iter->second)) {
+                break;
+            }
+        }
+    }
+
+    static const size_t kInitialCapacity = 64;
+
+protected:
+    /* Activity ID 0 is reserved, and marks an empty slot. */
+    static const activityId_t kEmptyId = 0;
+
+    struct IdSlot {
+        IdSlot() : m_id(kEmptyId) {}
+
+        activityId_t m_id;
+        std::shared_ptr<Activity> m_activity;
+    };
+
+    struct NameSlot {
+        NameSlot() : m_hash(0) {}
+
+        size_t m_hash;
+        std::shared_ptr<Activity> m_activity;
+    };
+
+    typedef std::vector<IdSlot> IdSlots;
+    typedef std::map<activityId_t, const Activity *> IdOrder;
+    typedef std::vector<NameSlot> NameSlots;
+    typedef std::unordered_map<std::string, std::set<const Activity *>> NameOnlyIndex;
+
+    static size_t hashId(activityId_t id);
+    static size_t hashName(const std::string& name, const BusId& creator);
+    static bool isBetween(size_t home, size_t hole, size_t pos);
+    static bool needsGrow(size_t count, size_t capacity);
+
+    size_t findIdSlot(activityId_t id) const;
+    size_t findNameSlot(size_t hash, const std::string& name, const BusId& creator) const;
+    size_t findNameSlot(const Activity& act) const;
+
+    void eraseIdSlot(size_t pos);
+    void eraseNameSlot(size_t pos);
+
+    void growIds();
+    void growNames();
+
+    IdSlots m_idSlots;
+    IdOrder m_idOrder;
+    NameSlots m_nameSlots;
+    NameOnlyIndex m_nameOnly;
+
+    size_t m_idCount;
+    size_t m_nameCount;
+};
+
+#endif /* __ACTIVITY_INDEX_H__ */
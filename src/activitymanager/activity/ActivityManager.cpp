@@ -16,12 +16,13 @@
 
 #include "ActivityManager.h"
 
-#include <boost/iterator/transform_iterator.hpp>
 #include <cstdlib>
 #include <stdexcept>
 #include <algorithm>
 
 #include "activity/ContinuousActivity.h"
+#include "base/ProcPressureSource.h"
+#include "conf/Config.h"
 #include "tools/ActivityMonitor.h"
 #include "util/Logging.h"
 
@@ -40,18 +41,71 @@ const char* const ActivityManager::kClientName = "com.webos.service.activitymana
 const char* const ActivityManager::kServiceName = "com.webos.service.activitymanager";
 
 ActivityManager::ActivityManager()
-    : m_enabled(kExternalEnable)
+    : m_leakGeneration(0)
+    , m_enabled(kExternalEnable)
     , m_backgroundConcurrencyLevel(kDefaultBackgroundConcurrencyLevel)
     , m_backgroundInteractiveConcurrencyLevel(kDefaultBackgroundInteractiveConcurrencyLevel)
-    , m_yieldTimeoutSeconds(kDefaultBackgroundInteractiveYieldSeconds)
+    , m_yieldTimeoutSeconds(YieldQueue::getDefaultYieldSeconds(YieldQueue::PolicyLongestRunning))
+    , m_transitions(&ActivityManager::dispatchTransition,
+                    Config::getInstance().getTransitionBatchSize())
+    , m_activationBucket(Config::getInstance().getActivationRate(),
+                         Config::getInstance().getActivationBurst())
+    , m_activationSource(0)
+    , m_activating(false)
+    , m_activatedCount(0)
+    , m_activationStart(0)
+    , m_activationElapsed(0)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
-    /* Activity ID 0 is reserved */
-    m_nextActivityId = 1;
+
+    m_readyQueue.setWeights(Config::getInstance().getFairShareWeights(),
+                            Config::getInstance().getFairShareDefaultWeight());
+
+    const std::string& policyName = Config::getInstance().getPreemptionPolicy();
+    YieldQueue::Policy policy;
+    if (YieldQueue::getPolicy(policyName, policy)) {
+        m_yieldQueue.setPolicy(policy);
+    } else {
+        LOG_AM_WARNING(MSGID_CONFIG_LOAD_FAIL, 1,
+                       PMLOGKS("policy", policyName.c_str()),
+                       "Unknown preemption policy, using %s",
+                       YieldQueue::kPolicyNames[m_yieldQueue.getPolicy()]);
+    }
+
+    const std::map<std::string, unsigned int>& yieldSeconds =
+            Config::getInstance().getYieldSeconds();
+    std::map<std::string, unsigned int>::const_iterator found =
+            yieldSeconds.find(YieldQueue::kPolicyNames[m_yieldQueue.getPolicy()]);
+    if (found != yieldSeconds.end()) {
+        m_yieldTimeoutSeconds = found->second;
+    } else {
+        m_yieldTimeoutSeconds = YieldQueue::getDefaultYieldSeconds(m_yieldQueue.getPolicy());
+    }
+
+    const ConcurrencyInfo& concurrency = Config::getInstance().getConcurrencyInfo();
+    if (concurrency.enabled) {
+        m_concurrencyController = std::make_shared<ConcurrencyController>(
+                concurrency,
+                std::make_shared<ProcPressureSource>(),
+                m_backgroundConcurrencyLevel,
+                m_backgroundInteractiveConcurrencyLevel);
+        m_backgroundConcurrencyLevel = m_concurrencyController->getBackgroundLevel();
+        m_backgroundInteractiveConcurrencyLevel =
+                m_concurrencyController->getBackgroundInteractiveLevel();
+
+        m_pressureTimeout = std::make_shared<TimeoutPtr<ActivityManager>>(
+                this,
+                concurrency.intervalSeconds,
+                &ActivityManager::pressureTimeout);
+        m_pressureTimeout->arm();
+    }
 }
 
 ActivityManager::~ActivityManager()
 {
+    if (m_activationSource) {
+        g_source_remove(m_activationSource);
+    }
 }
 
 void ActivityManager::registerActivityId(std::shared_ptr<Activity> act)
@@ -59,12 +113,10 @@ void ActivityManager::registerActivityId(std::shared_ptr<Activity> act)
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("[Activity %llu] Registering ID", act->getId());
 
-    ActivityMap::const_iterator found = m_activities.find(act->getId());
-    if (found != m_activities.end()) {
+    bool success = m_index.insert(std::move(act));
+    if (!success) {
         throw std::runtime_error("Activity ID is already registered");
     }
-
-    m_activities[act->getId()] = act;
 }
 
 void ActivityManager::registerActivityName(std::shared_ptr<Activity> act)
@@ -73,12 +125,13 @@ void ActivityManager::registerActivityName(std::shared_ptr<Activity> act)
     LOG_AM_DEBUG("[Activity %llu] Registering as %s/\"%s\"", act->getId(),
                  act->getCreator().getString().c_str(), act->getName().c_str());
 
-    bool success = m_nameTable.insert(*act).second;
+    bool success = m_index.insertName(act);
     if (!success) {
         throw std::runtime_error("Activity name is already registered");
     }
 
-    act->setState(ActivityStateCreated::newInstance());
+    act->m_nameRegistered = true;
+    act->setState(ActivityStateCreated::getInstance());
 }
 
 void ActivityManager::unregisterActivityName(std::shared_ptr<Activity> act)
@@ -87,8 +140,8 @@ void ActivityManager::unregisterActivityName(std::shared_ptr<Activity> act)
     LOG_AM_DEBUG("[Activity %llu] Unregistering from %s/\"%s\"", act->getId(),
                  act->getCreator().getString().c_str(), act->getName().c_str());
 
-    if (act->m_nameTableItem.is_linked()) {
-        act->m_nameTableItem.unlink();
+    if (act->m_nameRegistered && m_index.eraseName(*act)) {
+        act->m_nameRegistered = false;
     } else {
         throw std::runtime_error("Activity name is not registered");
     }
@@ -97,29 +150,27 @@ void ActivityManager::unregisterActivityName(std::shared_ptr<Activity> act)
 std::shared_ptr<Activity> ActivityManager::getActivity(const std::string& name,
                                                        const BusId& creator)
 {
-    ActivityNameTable::iterator iter;
-
-    if (creator.getType() == BusAnon) {
-        iter = m_nameTable.find(ActivityKey(name, creator),
-                                ActivityNameOnlyComp());
-    } else {
-        iter = m_nameTable.find(ActivityKey(name, creator), ActivityNameComp());
-    }
-
-    if (iter == m_nameTable.end()) {
+    /* Anonymous callers (luna-send) may operate on any Activity by name */
+    std::shared_ptr<Activity> act = m_index.find(name, creator, creator.getType() == BusAnon);
+    if (!act) {
         throw std::runtime_error("Activity name/creator pair not found");
     }
 
-    return iter->shared_from_this();
+    return act;
+}
+
+bool ActivityManager::hasActivity(const std::string& name, const BusId& creator) const
+{
+    return (bool) m_index.find(name, creator, creator.getType() == BusAnon);
 }
 
 std::shared_ptr<Activity> ActivityManager::getActivity(activityId_t id)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
-    ActivityMap::iterator iter = m_activities.find(id);
-    if (iter != m_activities.end()) {
-        return iter->second;
+    std::shared_ptr<Activity> act = m_index.find(id);
+    if (act) {
+        return act;
     }
 
     throw std::runtime_error("activityId not found");
@@ -131,20 +182,18 @@ std::shared_ptr<Activity> ActivityManager::getNewActivity(bool continuous)
 
     std::shared_ptr<Activity> act;
 
-    /* Use sequential ID */
-    while (true) {
-        ActivityIdTable::const_iterator hint = m_idTable.lower_bound(m_nextActivityId, ActivityIdComp());
-        if ((hint == m_idTable.end()) || (hint->getId() != m_nextActivityId)) {
-            if (continuous) {
-                act = std::make_shared<ContinuousActivity>(m_nextActivityId++);
-            } else {
-                act = std::make_shared<Activity>(m_nextActivityId++);
-            }
-            m_idTable.insert(hint, *act);
-            break;
-        } else {
-            m_nextActivityId++;
-        }
+    /* Reloaded Activities keep the IDs they were persisted with, and push
+     * the allocator past them, so the first ID allocated is normally free.
+     * Still check, in case the persisted mark was lost. */
+    activityId_t id;
+    do {
+        id = m_idAllocator.allocate();
+    } while (m_index.contains(id));
+
+    if (continuous) {
+        act = std::make_shared<ContinuousActivity>(id);
+    } else {
+        act = std::make_shared<Activity>(id);
     }
 
     LOG_AM_DEBUG("[Activity %llu] Allocated", act->getId());
@@ -156,38 +205,67 @@ std::shared_ptr<Activity> ActivityManager::getNewActivity(activityId_t id, bool
 {
     LOG_AM_DEBUG("[Activity %llu] Forcing allocation", id);
 
-    ActivityMap::iterator iter = m_activities.find(id);
-    if (iter != m_activities.end()) {
+    if (m_index.contains(id)) {
         LOG_AM_WARNING(MSGID_SAME_ACTIVITY_ID_FOUND, 1,
                        PMLOGKFV("Activity","%llu",id), "");
     }
 
+    m_idAllocator.reserve(id);
+
     std::shared_ptr<Activity> act;
     if (continuous) {
         act = std::make_shared<ContinuousActivity>(id);
     } else {
         act = std::make_shared<Activity>(id);
     }
-    m_idTable.insert(*act);
 
     return act;
 }
 
+void ActivityManager::loadIdMark(const std::string& path)
+{
+    m_idAllocator.setPath(path);
+    m_idAllocator.load();
+}
+
 void ActivityManager::releaseActivity(std::shared_ptr<Activity> act)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("[Activity %llu] Releasing", act->getId());
 
     evictQueue(act);
+    m_transitions.cancel(act->getId());
 
-    ActivityMap::iterator iter = m_activities.find(act->getId());
-    if (iter == m_activities.end()) {
+    /* The name index holds a reference too; an Activity released without
+     * first being unregistered must not stay reachable by name. */
+    if (act->m_nameRegistered) {
+        m_index.eraseName(*act);
+        act->m_nameRegistered = false;
+    }
+
+    if (!m_index.contains(act->getId())) {
         LOG_AM_WARNING(
                 MSGID_RELEASE_ACTIVITY_NOTFOUND, 1,
                 PMLOGKFV("Activity", "%llu", act->getId()),
                 "Not found in Activity table while attempting to release");
-    } else if (iter->second == act) {
-        m_activities.erase(iter);
+    } else {
+        m_index.erase(*act);
+    }
+
+    /* Track it until the last reference is dropped */
+    if (act->m_releasedItem.is_linked()) {
+        act->m_releasedItem.unlink();
+    }
+    act->m_releasedTime = g_get_monotonic_time() / 1000;
+    act->m_releasedGeneration = m_leakGeneration;
+    m_releasedActivities.push_back(*act);
+
+    if (!m_leakSweepTimeout) {
+        m_leakSweepTimeout = std::make_shared<TimeoutPtr<ActivityManager>>(
+                this,
+                Config::getInstance().getLeakSweepInterval(),
+                &ActivityManager::leakSweepTimeout);
+        m_leakSweepTimeout->arm();
     }
 
     checkReadyQueue();
@@ -198,50 +276,101 @@ ActivityManager::ActivityVec ActivityManager::getActivities() const
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
     ActivityVec out;
-    out.reserve(m_activities.size());
+    out.reserve(m_index.size());
 
-    std::transform(m_activities.begin(),
-                   m_activities.end(),
-                   std::back_inserter(out),
-                   boost::bind(&ActivityMap::value_type::second, _1));
+    m_index.forEach([&out](const std::shared_ptr<Activity>& act) {
+        out.push_back(act);
+    });
 
     return out;
 }
 
+bool ActivityManager::queryActivities(const ActivityQuery& query, ActivityVec& out) const
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    out.clear();
+
+    auto consider = [&query, &out](const Activity& act) {
+        if (query.matches(act)) {
+            out.push_back(act.shared_from_this());
+        }
+    };
+
+    /* Walk the IDs in order from the cursor, stopping once there's one
+     * match more than fits the page */
+    if (!query.hasQueue()) {
+        size_t wanted = query.getLimit() ? (query.getLimit() + 1) : 0;
+
+        m_index.forEachAfter(query.getCursor(), [&consider, &out, wanted](const Activity& act) {
+            consider(act);
+            return !wanted || (out.size() < wanted);
+        });
+
+        return query.selectPage(out);
+    }
+
+    int queue = 0;
+    while ((queue < RunQueueMax) && (query.getQueue() != kRunQueueNames[queue])) {
+        queue++;
+    }
+
+    if (queue == RunQueueReady) {
+        m_readyQueue.forEach(consider);
+    } else if (queue == RunQueueReadyInteractive) {
+        std::for_each(m_readyInteractiveQueue.begin(), m_readyInteractiveQueue.end(), consider);
+    } else if (queue < RunQueueMax) {
+        std::for_each(m_runQueue[queue].begin(), m_runQueue[queue].end(), consider);
+    } else {
+        throw std::runtime_error("Unknown run queue \"" + query.getQueue() + "\"");
+    }
+
+    return query.selectPage(out);
+}
+
 MojErr ActivityManager::startActivity(std::shared_ptr<Activity> act, MojServiceMessage *msg)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("[Activity %llu] Start", act->getId());
 
     act->setMessageForStart(msg);
-    g_timeout_add_full(G_PRIORITY_HIGH, 0, &ActivityManager::_startActivity, act.get(), NULL);
+    queueTransition(TransitionQueue::Start, act->getId());
 
     return MojErrNone;
 }
 
-gboolean ActivityManager::_startActivity(gpointer data)
+void ActivityManager::startActivityInternal(activityId_t id)
 {
-    Activity* activity = static_cast<Activity*>(data);
-    if (!activity) {
-        LOG_AM_ERROR(MSGID_ACTIVITYID_NOT_FOUND, 0, "%s", "activity is null");
-        return G_SOURCE_REMOVE;
-    }
     std::shared_ptr<Activity> self;
     try {
-        self = ActivityManager::getInstance().getActivity(activity->getId());
+        self = ActivityManager::getInstance().getActivity(id);
     } catch (const std::runtime_error& except) {
         LOG_AM_ERROR(MSGID_ACTIVITYID_NOT_FOUND, 0, "%s", except.what());
-        return G_SOURCE_REMOVE;
+        return;
     }
 
     try {
         self->getState()->start(self);
     } catch (const std::runtime_error& except) {
         self->respondForStart(std::string("Failed to start activity: ") + except.what());
-        return G_SOURCE_REMOVE;
     }
+}
 
-    return G_SOURCE_REMOVE;
+void ActivityManager::queueTransition(TransitionQueue::Type type, activityId_t id)
+{
+    m_transitions.push(type, id);
+}
+
+void ActivityManager::dispatchTransition(TransitionQueue::Type type, activityId_t id)
+{
+    switch (type) {
+    case TransitionQueue::EnterState:
+        Activity::setStateInternal(id);
+        break;
+    case TransitionQueue::Start:
+        startActivityInternal(id);
+        break;
+    }
 }
 
 MojErr ActivityManager::stopActivity(std::shared_ptr<Activity> act)
@@ -337,18 +466,19 @@ void ActivityManager::informActivityInitialized(std::shared_ptr<Activity> act)
 
     /* If an Activity is restarting, it will be parked (temporarily) in
      * the ended queue. */
-    if (act->m_runQueueItem.is_linked()) {
-        act->m_runQueueItem.unlink();
-    }
+    unlinkQueue(*act);
 
-    /* If the Activity Manager isn't enabled yet, just queue the Activities.
-     * otherwise, schedule them immediately. */
-    if (isEnabled()) {
+    /* If the Activity Manager isn't enabled yet, or is still working through
+     * the Activities queued before it was, queue the Activity.  The queue is
+     * sorted by priority once, when activation begins; ones queued while it
+     * runs go behind.  Otherwise, schedule it immediately. */
+    if (isEnabled() && !m_activating) {
         m_runQueue[RunQueueScheduled].push_back(*act);
         act->scheduleActivity();
-    } else {
-        m_runQueue[RunQueueInitialized].push_back(*act);
+        return;
     }
+
+    m_runQueue[RunQueueInitialized].push_back(*act);
 }
 
 void ActivityManager::informActivityReady(std::shared_ptr<Activity> act)
@@ -356,9 +486,7 @@ void ActivityManager::informActivityReady(std::shared_ptr<Activity> act)
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("[Activity %llu] Now ready to run", act->getId());
 
-    if (act->m_runQueueItem.is_linked()) {
-        act->m_runQueueItem.unlink();
-    } else {
+    if (!unlinkQueue(*act)) {
         LOG_AM_DEBUG("[Activity %llu] not found on any run queue when moving to ready state", act->getId());
     }
 
@@ -368,11 +496,7 @@ void ActivityManager::informActivityReady(std::shared_ptr<Activity> act)
         return;
     }
 
-    if (act->isUserInitiated()) {
-        m_runQueue[RunQueueReadyInteractive].push_back(*act);
-    } else {
-        m_runQueue[RunQueueReady].push_back(*act);
-    }
+    enqueueReady(*act);
 
     checkReadyQueue();
 }
@@ -382,9 +506,7 @@ void ActivityManager::informActivityNotReady(std::shared_ptr<Activity> act)
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("[Activity %llu] No longer ready to run", act->getId());
 
-    if (act->m_runQueueItem.is_linked()) {
-        act->m_runQueueItem.unlink();
-    } else {
+    if (!unlinkQueue(*act)) {
         LOG_AM_DEBUG("[Activity %llu] not found on any run queue when moving to not ready state", act->getId());
     }
 
@@ -413,9 +535,7 @@ void ActivityManager::informActivityEnd(std::shared_ptr<Activity> act)
 
     /* If Activity was never fully initialized, it's ok for it not to be on
      * a queue here */
-    if (act->m_runQueueItem.is_linked()) {
-        act->m_runQueueItem.unlink();
-    }
+    unlinkQueue(*act);
 
     m_runQueue[RunQueueEnded].push_back(*act);
 
@@ -428,24 +548,118 @@ void ActivityManager::scheduleAllActivities()
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Scheduling all Activities");
 
+    if (m_runQueue[RunQueueInitialized].empty() || m_activationSource) {
+        return;
+    }
+
+    if (!m_activating) {
+        m_activating = true;
+        m_activationStart = g_get_monotonic_time() / 1000;
+        m_activationBucket.reset(m_activationStart);
+
+        /* Stable, so equal priorities keep their arrival order */
+        m_runQueue[RunQueueInitialized].sort(&ActivityManager::isHigherPriority);
+    }
+
+    runActivation();
+}
+
+void ActivityManager::runActivation()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    /* Disabled part way through: pick up again when re-enabled */
+    if (!isEnabled()) {
+        return;
+    }
+
     while (!m_runQueue[RunQueueInitialized].empty()) {
+        int64_t now = g_get_monotonic_time() / 1000;
+
+        if (!m_activationBucket.tryConsume(now)) {
+            m_activationSource = g_timeout_add(m_activationBucket.getDelay(now),
+                                               &ActivityManager::activationTimeout, this);
+            return;
+        }
+
         Activity& act = m_runQueue[RunQueueInitialized].front();
         act.m_runQueueItem.unlink();
 
         LOG_AM_DEBUG("Granting [Activity %llu] permission to schedule", act.getId());
 
         m_runQueue[RunQueueScheduled].push_back(act);
+        m_activatedCount++;
         act.scheduleActivity();
     }
+
+    if (m_activating) {
+        m_activating = false;
+        m_activationElapsed = (g_get_monotonic_time() / 1000) - m_activationStart;
+
+        LOG_AM_INFO(MSGID_ACTIVATION_DONE, 2,
+                    PMLOGKFV("activated", "%u", m_activatedCount),
+                    PMLOGKFV("elapsedMs", "%lld", (long long) m_activationElapsed), "");
+    }
+}
+
+gboolean ActivityManager::activationTimeout(gpointer data)
+{
+    ActivityManager *self = static_cast<ActivityManager *>(data);
+
+    self->m_activationSource = 0;
+    self->runActivation();
+
+    return G_SOURCE_REMOVE;
+}
+
+bool ActivityManager::isHigherPriority(const Activity& act1, const Activity& act2)
+{
+    return act1.getPriority() > act2.getPriority();
 }
 
 void ActivityManager::evictQueue(std::shared_ptr<Activity> act)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
-    if (act->m_runQueueItem.is_linked()) {
+    if (unlinkQueue(*act)) {
         LOG_AM_DEBUG("[Activity %llu] evicted from run queue on release", act->getId());
-        act->m_runQueueItem.unlink();
+    }
+}
+
+bool ActivityManager::unlinkQueue(Activity& act)
+{
+    m_yieldQueue.remove(act);
+
+    if (act.m_runQueueItem.is_linked()) {
+        act.m_runQueueItem.unlink();
+        return true;
+    } else if (act.m_readyQueueItem.is_linked()) {
+        act.m_readyQueueItem.unlink();
+        return true;
+    }
+
+    return false;
+}
+
+void ActivityManager::enqueueReady(Activity& act)
+{
+    /* Aging is applied by back-dating the queue key: each priority level is
+     * worth one aging interval of waiting.  Once an Activity has waited that
+     * long, it ranks with Activities one level higher that just became ready.
+     * The key never changes while the Activity is queued, so insertion and
+     * removal stay O(log n).  An interval of 0 degenerates to FIFO. */
+    int64_t now = g_get_monotonic_time() / 1000;
+    int64_t agingInterval = (int64_t) Config::getInstance().getPriorityAgingInterval();
+
+    int64_t key = FairShareQueue::agedKey(now, act.getPriority(), agingInterval);
+
+    act.m_readyTime = now;
+
+    if (act.isUserInitiated()) {
+        act.m_readyKey = key;
+        m_readyInteractiveQueue.insert(act);
+    } else {
+        m_readyQueue.push(act, key);
     }
 }
 
@@ -462,9 +676,7 @@ void ActivityManager::runReadyBackgroundActivity(Activity& act)
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Running background [Activity %llu]", act.getId());
 
-    if (act.m_runQueueItem.is_linked()) {
-        act.m_runQueueItem.unlink();
-    } else {
+    if (!unlinkQueue(act)) {
         LOG_AM_WARNING(MSGID_ATTEMPT_RUN_BACKGRND_ACTIVITY, 1,
                        PMLOGKFV("Activity","%llu",act.getId()), "");
     }
@@ -479,15 +691,14 @@ void ActivityManager::runReadyBackgroundInteractiveActivity(Activity& act)
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Running background interactive [Activity %llu]", act.getId());
 
-    if (act.m_runQueueItem.is_linked()) {
-        act.m_runQueueItem.unlink();
-    } else {
+    if (!unlinkQueue(act)) {
         LOG_AM_DEBUG(
                 "[Activity %llu] was not queued attempting to run background interactive Activity",
                 act.getId());
     }
 
     m_runQueue[RunQueueBackgroundInteractive].push_back(act);
+    m_yieldQueue.push(act, g_get_monotonic_time() / 1000);
 
     runActivity(act);
 }
@@ -507,12 +718,12 @@ void ActivityManager::checkReadyQueue()
 
     while (((getRunningBackgroundActivitiesCount() < m_backgroundInteractiveConcurrencyLevel) ||
             (m_backgroundInteractiveConcurrencyLevel == kUnlimitedBackgroundConcurrency)) &&
-            !m_runQueue[RunQueueReadyInteractive].empty()) {
-        runReadyBackgroundInteractiveActivity(m_runQueue[RunQueueReadyInteractive].front());
+            !m_readyInteractiveQueue.empty()) {
+        runReadyBackgroundInteractiveActivity(*m_readyInteractiveQueue.begin());
         ranInteractive = true;
     }
 
-    if (!m_runQueue[RunQueueReadyInteractive].empty()) {
+    if (!m_readyInteractiveQueue.empty()) {
         if (ranInteractive) {
             updateYieldTimeout();
         } else if (!m_interactiveYieldTimeout) {
@@ -522,10 +733,69 @@ void ActivityManager::checkReadyQueue()
         cancelYieldTimeout();
     }
 
-    while (((getRunningBackgroundActivitiesCount() < m_backgroundConcurrencyLevel) ||
-            (m_backgroundConcurrencyLevel == kUnlimitedBackgroundConcurrency)) &&
-            !m_runQueue[RunQueueReady].empty()) {
-        runReadyBackgroundActivity(m_runQueue[RunQueueReady].front());
+    while ((getRunningBackgroundActivitiesCount() < m_backgroundConcurrencyLevel) ||
+            (m_backgroundConcurrencyLevel == kUnlimitedBackgroundConcurrency)) {
+        Activity *act = m_readyQueue.select();
+        if (!act) {
+            break;
+        }
+
+        runReadyBackgroundActivity(*act);
+    }
+}
+
+void ActivityManager::pressureTimeout()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    if (m_concurrencyController->update()) {
+        unsigned background = m_concurrencyController->getBackgroundLevel();
+        unsigned interactive = m_concurrencyController->getBackgroundInteractiveLevel();
+
+        LOG_AM_INFO(MSGID_CONCURRENCY_CHANGED, 3,
+                    PMLOGKFV("pressure", "%.2f", m_concurrencyController->getPressure()),
+                    PMLOGKFV("background", "%u", background),
+                    PMLOGKFV("backgroundInteractive", "%u", interactive), "");
+
+        bool raised = (background > m_backgroundConcurrencyLevel) ||
+                      (interactive > m_backgroundInteractiveConcurrencyLevel);
+
+        m_backgroundConcurrencyLevel = background;
+        m_backgroundInteractiveConcurrencyLevel = interactive;
+
+        /* Lowering the levels lets running Activities finish; raising them
+         * may make room for ready ones right away */
+        if (raised) {
+            checkReadyQueue();
+        }
+    }
+
+    m_pressureTimeout->arm();
+}
+
+void ActivityManager::leakSweepTimeout()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    m_leakGeneration++;
+
+    /* Report each leak once, on the sweep where it first qualifies */
+    int64_t now = g_get_monotonic_time() / 1000;
+    for (ActivityReleasedList::const_iterator iter = m_releasedActivities.cbegin();
+            iter != m_releasedActivities.cend() ; ++iter) {
+        if ((m_leakGeneration - iter->m_releasedGeneration) == kLeakedGenerations) {
+            LOG_AM_WARNING(MSGID_ACTIVITY_LEAKED, 2,
+                           PMLOGKFV("Activity", "%llu", iter->getId()),
+                           PMLOGKFV("leakedMs", "%lld", (long long) (now - iter->m_releasedTime)),
+                           "Released Activity is still referenced");
+        }
+    }
+
+    if (m_releasedActivities.empty()) {
+        LOG_AM_DEBUG("No released Activities remain, stopping leak sweep");
+        m_leakSweepTimeout.reset();
+    } else {
+        m_leakSweepTimeout->arm();
     }
 }
 
@@ -563,103 +833,77 @@ void ActivityManager::interactiveYieldTimeout()
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Background interactive yield timeout triggered");
 
-    if (m_runQueue[RunQueueReadyInteractive].empty()) {
+    if (m_readyInteractiveQueue.empty()) {
         LOG_AM_DEBUG("Ready interactive queue is empty, cancelling yield timeout");
         cancelYieldTimeout();
         return;
     }
 
-    /* XXX make 1 more Activity yield, but only if there are fewer Activities
+    /* Make 1 more Activity yield, but only if there are fewer Activities
      * yielding than waiting in the interactive queue. */
-    unsigned waiting = (unsigned) m_runQueue[RunQueueReadyInteractive].size();
-    unsigned yielding = 0;
+    unsigned waiting = (unsigned) m_readyInteractiveQueue.size();
 
-    std::shared_ptr<Activity> victim;
-
-    ActivityRunQueue::iterator iter;
-
-    for (iter = m_runQueue[RunQueueBackgroundInteractive].begin();
-            iter != m_runQueue[RunQueueBackgroundInteractive].end() ; ++iter) {
-        if (iter->isYielding()) {
-            if (++yielding >= waiting) {
-                break;
-            }
-        } else {
-            if (!victim) {
-                victim = iter->shared_from_this();
-            }
-        }
-    }
-
-    /* If there aren't already too many yielding... */
-    if (iter == m_runQueue[RunQueueBackgroundInteractive].end()) {
-        if (victim) {
-            LOG_AM_DEBUG("Requesting that [Activity %llu] yield", victim->getId());
-            victim->yieldActivity();
-        } else {
-            LOG_AM_DEBUG("All running background interactive Activities are already yielding");
-        }
-    } else {
+    if (m_yieldQueue.getYieldingCount() >= waiting) {
         LOG_AM_DEBUG(
                 "Number of yielding Activities is already equal to the number of ready interactive Activities waiting in the queue");
+    } else if (Activity *victim = m_yieldQueue.selectVictim()) {
+        LOG_AM_DEBUG("Requesting that [Activity %llu] yield (%s)", victim->getId(),
+                     YieldQueue::kPolicyNames[m_yieldQueue.getPolicy()]);
+        victim->shared_from_this()->yieldActivity();
+    } else {
+        LOG_AM_DEBUG("All running background interactive Activities are already yielding");
     }
 
     updateYieldTimeout();
 }
 
-bool ActivityManager::ActivityNameComp::operator()(const Activity& act1,
-                                                   const Activity& act2) const
+void ActivityManager::pushLeakedJson(const Activity& act, MojObject& activities,
+                                     int64_t now) const
 {
-    const std::string& act1Name = act1.getName();
-    const std::string& act2Name = act2.getName();
+    if ((m_leakGeneration - act.m_releasedGeneration) < kLeakedGenerations) {
+        return;
+    }
 
-    if (act1Name != act2Name) {
-        return act1Name < act2Name;
-    } else {
-        return act1.getCreator() < act2.getCreator();
+    MojErr errs = MojErrNone;
+
+    MojObject identity(MojObject::TypeObject);
+
+    MojErr err = act.identityToJson(identity);
+    MojErrAccumulate(errs, err);
+
+    err = identity.putInt(_T("leakedMs"), (MojInt64) (now - act.m_releasedTime));
+    MojErrAccumulate(errs, err);
+
+    err = activities.push(identity);
+    MojErrAccumulate(errs, err);
+
+    if (errs) {
+        throw std::runtime_error("Unable to convert from Activity to JSON object");
     }
 }
 
-bool ActivityManager::ActivityNameComp::operator()(const ActivityKey& key,
-                                                   const Activity& act) const
+void ActivityManager::pushReadyJson(const Activity& act, MojObject& activities,
+                                    int64_t now) const
 {
-    return key < ActivityKey(act.getName(), act.getCreator());
-}
+    MojErr errs = MojErrNone;
 
-bool ActivityManager::ActivityNameComp::operator()(const Activity& act,
-                                                   const ActivityKey& key) const
-{
-    return ActivityKey(act.getName(), act.getCreator()) < key;
-}
+    MojObject identity(MojObject::TypeObject);
 
-bool ActivityManager::ActivityNameOnlyComp::operator()(
-        const ActivityKey& key, const Activity& act) const
-{
-    return key.first < act.getName();
-}
+    MojErr err = act.identityToJson(identity);
+    MojErrAccumulate(errs, err);
 
-bool ActivityManager::ActivityNameOnlyComp::operator()(
-        const Activity& act, const ActivityKey& key) const
-{
-    return act.getName() < key.first;
-}
+    err = identity.putString(_T("priority"), ActivityPriorityNames[act.getPriority()]);
+    MojErrAccumulate(errs, err);
 
-bool ActivityManager::ActivityIdComp::operator()(const Activity& act1,
-                                                 const Activity& act2) const
-{
-    return act1.getId() < act2.getId();
-}
+    err = identity.putInt(_T("waitMs"), (MojInt64) (now - act.m_readyTime));
+    MojErrAccumulate(errs, err);
 
-bool ActivityManager::ActivityIdComp::operator()(const activityId_t& id,
-                                                 const Activity& act) const
-{
-    return id < act.getId();
-}
+    err = activities.push(identity);
+    MojErrAccumulate(errs, err);
 
-bool ActivityManager::ActivityIdComp::operator()(const Activity& act,
-                                                 const activityId_t& id) const
-{
-    return act.getId() < id;
+    if (errs) {
+        throw std::runtime_error("Unable to convert from Activity to JSON object");
+    }
 }
 
 MojErr ActivityManager::infoToJson(MojObject& rep) const
@@ -671,15 +915,29 @@ MojErr ActivityManager::infoToJson(MojObject& rep) const
     /* Scan the various run queues of the Activity Manager */
     MojObject queues(MojObject::TypeArray);
 
+    int64_t now = g_get_monotonic_time() / 1000;
+
     for (int i = 0 ; i < RunQueueMax ; i++) {
-        if (!m_runQueue[i].empty()) {
-            MojObject activities(MojObject::TypeArray);
+        MojObject activities(MojObject::TypeArray);
 
+        if (i == RunQueueReady) {
+            m_readyQueue.forEach(
+                    boost::bind(&ActivityManager::pushReadyJson, this, _1,
+                                std::ref(activities), now));
+        } else if (i == RunQueueReadyInteractive) {
+            std::for_each(
+                    m_readyInteractiveQueue.begin(),
+                    m_readyInteractiveQueue.end(),
+                    boost::bind(&ActivityManager::pushReadyJson, this, _1,
+                                std::ref(activities), now));
+        } else {
             std::for_each(
                     m_runQueue[i].begin(),
                     m_runQueue[i].end(),
                     boost::bind(&Activity::pushIdentityJson, _1, std::ref(activities)));
+        }
 
+        if (!activities.empty()) {
             MojObject queue;
             err = queue.putString(_T("name"), kRunQueueNames[i]);
             MojErrCheck(err);
@@ -697,24 +955,65 @@ MojErr ActivityManager::infoToJson(MojObject& rep) const
         MojErrCheck(err);
     }
 
-    std::vector<std::shared_ptr<const Activity> > leaked;
+    MojObject activation;
+    err = activation.putInt(_T("activated"), m_activatedCount);
+    MojErrCheck(err);
+
+    err = activation.putInt(_T("pending"), (MojInt64) m_runQueue[RunQueueInitialized].size());
+    MojErrCheck(err);
+
+    err = activation.putInt(_T("rate"), (MojInt64) m_activationBucket.getRate());
+    MojErrCheck(err);
+
+    err = activation.putInt(_T("elapsedMs"), m_activating ?
+            ((g_get_monotonic_time() / 1000) - m_activationStart) : m_activationElapsed);
+    MojErrCheck(err);
+
+    err = activation.putBool(_T("inProgress"), m_activating);
+    MojErrCheck(err);
+
+    err = rep.put(_T("activation"), activation);
+    MojErrCheck(err);
+
+    MojObject concurrency;
+    err = concurrency.putInt(_T("background"), m_backgroundConcurrencyLevel);
+    MojErrCheck(err);
+
+    err = concurrency.putInt(_T("backgroundInteractive"),
+                             m_backgroundInteractiveConcurrencyLevel);
+    MojErrCheck(err);
+
+    if (m_concurrencyController && (m_concurrencyController->getPressure() >= 0)) {
+        err = concurrency.putInt(_T("pressure"),
+                                 (MojInt64) (m_concurrencyController->getPressure() + 0.5));
+        MojErrCheck(err);
+    }
+
+    err = rep.put(_T("concurrency"), concurrency);
+    MojErrCheck(err);
+
+    MojObject preemption;
+    err = preemption.putString(_T("policy"), YieldQueue::kPolicyNames[m_yieldQueue.getPolicy()]);
+    MojErrCheck(err);
+
+    err = preemption.putInt(_T("yieldSeconds"), m_yieldTimeoutSeconds);
+    MojErrCheck(err);
+
+    err = preemption.putInt(_T("yielding"), m_yieldQueue.getYieldingCount());
+    MojErrCheck(err);
 
-    std::shared_ptr<const Activity> (Activity::*shared_from_this_ptr)() const = &Activity::shared_from_this;
-    std::set_difference(
-            boost::make_transform_iterator(m_idTable.cbegin(), boost::bind(shared_from_this_ptr, _1)),
-            boost::make_transform_iterator(m_idTable.cend(), boost::bind(shared_from_this_ptr, _1)),
-            boost::make_transform_iterator(m_activities.begin(), boost::bind(&ActivityMap::value_type::second, _1)),
-            boost::make_transform_iterator(m_activities.end(), boost::bind(&ActivityMap::value_type::second, _1)),
-            std::back_inserter(leaked));
+    err = rep.put(_T("preemption"), preemption);
+    MojErrCheck(err);
 
-    if (!leaked.empty()) {
-        MojObject leakedActivities(MojObject::TypeArray);
+    MojObject leakedActivities(MojObject::TypeArray);
 
-        std::for_each(
-                leaked.begin(),
-                leaked.end(),
-                boost::bind(&Activity::pushIdentityJson, _1, std::ref(leakedActivities)));
+    std::for_each(
+            m_releasedActivities.begin(),
+            m_releasedActivities.end(),
+            boost::bind(&ActivityManager::pushLeakedJson, this, _1,
+                        std::ref(leakedActivities), now));
 
+    if (!leakedActivities.empty()) {
         err = rep.put(_T("leakedActivities"), leakedActivities);
         MojErrCheck(err);
     }
@@ -17,13 +17,20 @@
 #ifndef __ACTIVITY_MANAGER_H__
 #define __ACTIVITY_MANAGER_H__
 
-#include <map>
 #include <vector>
 
 #include "Main.h"
 #include "activity/Activity.h"
+#include "activity/ActivityIdAllocator.h"
+#include "activity/ActivityIndex.h"
+#include "activity/ActivityQuery.h"
+#include "activity/ConcurrencyController.h"
+#include "activity/FairShareQueue.h"
+#include "activity/TransitionQueue.h"
+#include "activity/YieldQueue.h"
 #include "base/Subscriber.h"
 #include "base/Timeout.h"
+#include "base/TokenBucket.h"
 
 /*
  * Central Activity registry and control object.
@@ -38,7 +45,6 @@ public:
     }
     virtual ~ActivityManager();
 
-    typedef std::map<activityId_t, std::shared_ptr<Activity>> ActivityMap;
     typedef std::vector<std::shared_ptr<const Activity>> ActivityVec;
 
     void registerActivityId(std::shared_ptr<Activity> act);
@@ -48,13 +54,26 @@ public:
     std::shared_ptr<Activity> getActivity(activityId_t id);
     std::shared_ptr<Activity> getActivity(const std::string& name, const BusId& creator);
 
+    /* As getActivity, without throwing when there's no match */
+    bool hasActivity(const std::string& name, const BusId& creator) const;
+
     std::shared_ptr<Activity> getNewActivity(bool continuous);
     std::shared_ptr<Activity> getNewActivity(activityId_t id, bool continuous);
 
+    /* Persists the Activity ID high-water mark at path, resuming above the
+     * one there from the previous run.  Until this is called, IDs aren't
+     * persisted. */
+    void loadIdMark(const std::string& path);
+
     void releaseActivity(std::shared_ptr<Activity> act);
 
     ActivityVec getActivities() const;
 
+    /* One page of the Activities matching the query, in ID order.  Returns
+     * true if more match after it.  Throws if the query names a run queue
+     * that doesn't exist. */
+    bool queryActivities(const ActivityQuery& query, ActivityVec& out) const;
+
     /* Activity Commands Interface */
     MojErr startActivity(std::shared_ptr<Activity> act, MojServiceMessage *msg = NULL);
     MojErr stopActivity(std::shared_ptr<Activity> act);
@@ -105,6 +124,10 @@ public:
 
     /* END INTERFACE  */
 
+    /* Deferred Activity transitions.  These run from the main loop, in the
+     * order they were queued, a batch at a time. */
+    void queueTransition(TransitionQueue::Type type, activityId_t id);
+
     /* Activity Manager info state gatherer */
     MojErr infoToJson(MojObject& rep) const;
 
@@ -114,7 +137,6 @@ public:
     static const unsigned kDefaultBackgroundConcurrencyLevel = 1;
     static const unsigned kDefaultBackgroundInteractiveConcurrencyLevel = 2;
     static const unsigned kUnlimitedBackgroundConcurrency = 0;
-    static const unsigned kDefaultBackgroundInteractiveYieldSeconds = 60;
 
 private:
     ActivityManager();
@@ -122,15 +144,24 @@ private:
     ActivityManager& operator=(const ActivityManager& copy);
 
 protected:
-    static gboolean _startActivity(gpointer data);
+    static void startActivityInternal(activityId_t id);
+    static void dispatchTransition(TransitionQueue::Type type, activityId_t id);
     void scheduleAllActivities();
+    void runActivation();
+    static gboolean activationTimeout(gpointer data);
+    static bool isHigherPriority(const Activity& act1, const Activity& act2);
     void evictQueue(std::shared_ptr<Activity> act);
+    bool unlinkQueue(Activity& act);
+    void enqueueReady(Activity& act);
     void runActivity(Activity& act);
     void runReadyBackgroundActivity(Activity& act);
     void runReadyBackgroundInteractiveActivity(Activity& act);
     unsigned getRunningBackgroundActivitiesCount() const;
     void checkReadyQueue();
 
+    void pressureTimeout();
+    void leakSweepTimeout();
+
     void updateYieldTimeout();
     void cancelYieldTimeout();
     void interactiveYieldTimeout();
@@ -149,69 +180,52 @@ protected:
         RunQueueMax
     } RunQueueId;
 
-    /* Lightweight comparator object to search the Activity Name Table for
-     * a particular name */
-    typedef std::pair<std::string, BusId> ActivityKey;
-    struct ActivityNameComp {
-        bool operator()(const Activity& act1, const Activity& act2) const;
-        bool operator()(const ActivityKey& key, const Activity& act) const;
-        bool operator()(const Activity& act, const ActivityKey& key) const;
-    };
-
-    struct ActivityNameOnlyComp {
-        bool operator()(const ActivityKey& key, const Activity& act) const;
-        bool operator()(const Activity& act, const ActivityKey& key) const;
-    };
-
-    typedef boost::intrusive::member_hook<Activity, Activity::ActivityTableItem,
-            &Activity::m_nameTableItem> ActivityNameTableOption;
-    typedef boost::intrusive::set<Activity, ActivityNameTableOption,
-            boost::intrusive::constant_time_size<false>,
-            boost::intrusive::compare<ActivityNameComp> > ActivityNameTable;
-
-    /* Comparator object for the Activity Id Table */
-    struct ActivityIdComp {
-        bool operator()(const Activity& act1, const Activity& act2) const;
-        bool operator()(const activityId_t& id, const Activity& act) const;
-        bool operator()(const Activity& act, const activityId_t& id) const;
-    };
-
-    typedef boost::intrusive::member_hook<Activity, Activity::ActivityTableItem,
-            &Activity::m_idTableItem> ActivityIdTableOption;
-    typedef boost::intrusive::multiset<Activity, ActivityIdTableOption,
-            boost::intrusive::constant_time_size<false>,
-            boost::intrusive::compare<ActivityIdComp>> ActivityIdTable;
+    typedef boost::intrusive::member_hook<Activity, Activity::ActivityListItem,
+            &Activity::m_releasedItem> ActivityReleasedListOption;
+    typedef boost::intrusive::list<Activity, ActivityReleasedListOption,
+            boost::intrusive::constant_time_size<false>> ActivityReleasedList;
 
     typedef boost::intrusive::member_hook<Activity, Activity::ActivityListItem,
             &Activity::m_runQueueItem> ActivityRunQueueOption;
     typedef boost::intrusive::list<Activity, ActivityRunQueueOption,
             boost::intrusive::constant_time_size<false>> ActivityRunQueue;
 
+    typedef FairShareQueue::ReadyQueue ActivityReadyQueue;
+
+    void pushReadyJson(const Activity& act, MojObject& activities, int64_t now) const;
+    void pushLeakedJson(const Activity& act, MojObject& activities, int64_t now) const;
+
     static const char *kRunQueueNames[];
 
-    /* Activity Name Table
-     * The most recent Activity to attempt to claim a name will be listed
-     * in the Table, and all Activties in the table are currently live and
-     * not ending.  Activities should be removed from the table as soon as
-     * they enter an ending state through cancel, stop, or complete (if it
-     * isn't going to restart the Activity). */
-    ActivityNameTable m_nameTable;
-
-    /* Activity Id Table
-     * Tracks currently instantiated Activities by Id.  This is slgihtly
-     * different from the main Activity map, which tracks Activities that are
-     * live.  This includes Activities that are still in the process of
-     * being torn down.  (And will also enable automated tracking of Activities
-     * which were otherwise leaked). */
-    ActivityIdTable m_idTable;
+    /* Activity Index
+     * Hash index of the live Activities, by ID and by name/creator.
+     *
+     * The ID table holds every registered Activity, including those still in
+     * the process of being torn down.
+     *
+     * The name table lists the most recent Activity to claim each name, and
+     * all Activities in it are currently live and not ending.  Activities
+     * should be removed from it as soon as they enter an ending state through
+     * cancel, stop, or complete (if it isn't going to restart the Activity). */
+    ActivityIndex m_index;
+
+    /* Released Activities
+     * Activities added by releaseActivity, which drop off on their own once
+     * the last reference goes away.
+     *
+     * Released Activities still here after a full leak sweep interval are
+     * reported as leaked.  Each sweep advances the generation; an Activity
+     * released in generation g is leaked from generation g + 2 on. */
+    ActivityReleasedList m_releasedActivities;
+
+    std::shared_ptr<TimeoutPtr<ActivityManager> > m_leakSweepTimeout;
+    unsigned m_leakGeneration;
+
+    static const unsigned kLeakedGenerations = 2;
 
     /* Activity Run Queues
      * Start Queue: Activities may wait here if the Activity Manager isn't
      *     prepared to schedule the Activity (generally, just on startup)
-     * Ready Queue: Background Activities that are ready to run, but haven't
-     *     gotten permission to do so yet
-     * Ready Interactive Queue: Ready Background Activities initiated by the
-     *     user
      * Background Run Queue: Background Activities that are currently running
      * Background Interactive Run Queue: Background Interactive Activities
      *     that are currently running
@@ -219,19 +233,51 @@ protected:
      */
     ActivityRunQueue m_runQueue[RunQueueMax];
 
-    /* Background Interactive Queue yield timeout */
+    /* Activity Ready Queues
+     * Ready Queue: Background Activities that are ready to run, but haven't
+     *     gotten permission to do so yet
+     * Ready Interactive Queue: Ready Background Activities initiated by the
+     *     user
+     *
+     * Both are ordered by priority, aged by the time spent waiting so that
+     * low priority Activities can't be starved.  The background Ready Queue
+     * is additionally shared fairly between creators, so one creator can't
+     * monopolize the background run slots.  (The RunQueueReady and
+     * RunQueueReadyInteractive run queues are unused.) */
+    FairShareQueue m_readyQueue;
+    ActivityReadyQueue m_readyInteractiveQueue;
+
+    /* Background Interactive Queue yield timeout.  Each time it fires, the
+     * preemption policy's first candidate in the Yield Queue is asked to
+     * yield, unless as many are already yielding as are waiting. */
     std::shared_ptr<TimeoutPtr<ActivityManager> > m_interactiveYieldTimeout;
-
-    ActivityMap m_activities;
+    YieldQueue m_yieldQueue;
 
     unsigned m_enabled;
 
     unsigned m_backgroundConcurrencyLevel;
     unsigned m_backgroundInteractiveConcurrencyLevel;
 
+    /* Adjusts the concurrency levels from system pressure, if enabled */
+    std::shared_ptr<ConcurrencyController> m_concurrencyController;
+    std::shared_ptr<TimeoutPtr<ActivityManager> > m_pressureTimeout;
+
     unsigned m_yieldTimeoutSeconds;
 
-    activityId_t m_nextActivityId;
+    TransitionQueue m_transitions;
+
+    /* Activation pipeline
+     * Initialized Activities are armed (scheduled) highest priority first,
+     * at the rate allowed by the token bucket, so enabling the Activity
+     * Manager at boot doesn't send out every trigger subscription at once. */
+    TokenBucket m_activationBucket;
+    guint m_activationSource;
+    bool m_activating;
+    unsigned m_activatedCount;
+    int64_t m_activationStart;
+    int64_t m_activationElapsed;
+
+    ActivityIdAllocator m_idAllocator;
 };
 
 #endif /* __ACTIVITY_MANAGER_H__ */
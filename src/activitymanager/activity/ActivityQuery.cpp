@@ -0,0 +1,141 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "ActivityQuery.h"
+
+#include <algorithm>
+
+#include "activity/Activity.h"
+#include "activity/state/AbstractActivityState.h"
+
+static bool isLowerId(const std::shared_ptr<const Activity>& act1,
+                      const std::shared_ptr<const Activity>& act2)
+{
+    return act1->getId() < act2->getId();
+}
+
+ActivityQuery::ActivityQuery()
+    : m_hasState(false)
+    , m_hasCreator(false)
+    , m_hasNamePrefix(false)
+    , m_hasQueue(false)
+    , m_cursor(0)
+    , m_limit(0)
+{
+}
+
+ActivityQuery::~ActivityQuery()
+{
+}
+
+void ActivityQuery::setState(const std::string& state)
+{
+    m_state = state;
+    m_hasState = true;
+}
+
+void ActivityQuery::setCreator(const std::string& creator)
+{
+    m_creator = creator;
+    m_hasCreator = true;
+}
+
+void ActivityQuery::setNamePrefix(const std::string& prefix)
+{
+    m_namePrefix = prefix;
+    m_hasNamePrefix = true;
+}
+
+void ActivityQuery::setQueue(const std::string& queue)
+{
+    m_queue = queue;
+    m_hasQueue = true;
+}
+
+const std::string& ActivityQuery::getQueue() const
+{
+    return m_queue;
+}
+
+bool ActivityQuery::hasQueue() const
+{
+    return m_hasQueue;
+}
+
+void ActivityQuery::setCursor(activityId_t cursor)
+{
+    m_cursor = cursor;
+}
+
+activityId_t ActivityQuery::getCursor() const
+{
+    return m_cursor;
+}
+
+void ActivityQuery::setLimit(size_t limit)
+{
+    m_limit = limit;
+}
+
+size_t ActivityQuery::getLimit() const
+{
+    return m_limit;
+}
+
+bool ActivityQuery::matches(const Activity& act) const
+{
+    if (act.getId() <= m_cursor) {
+        return false;
+    }
+
+    /* Prefix check without building a substring */
+    if (m_hasNamePrefix && (act.getName().compare(0, m_namePrefix.size(), m_namePrefix) != 0)) {
+        return false;
+    }
+
+    /* The creator may be given either as a bare app/service ID or in its
+     * typed form, ie. "appId:com.example.app" */
+    if (m_hasCreator && (act.getCreator().getId() != m_creator) &&
+            (act.getCreator().getString() != m_creator)) {
+        return false;
+    }
+
+    if (m_hasState) {
+        std::shared_ptr<AbstractActivityState> state = act.getState();
+        if (!state || (state->getName() != m_state)) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool ActivityQuery::selectPage(ActivityVec& matches) const
+{
+    bool more = false;
+
+    /* Only the page itself needs to end up sorted */
+    if (m_limit && (matches.size() > m_limit)) {
+        std::nth_element(matches.begin(), matches.begin() + m_limit, matches.end(), isLowerId);
+        matches.resize(m_limit);
+        more = true;
+    }
+
+    std::sort(matches.begin(), matches.end(), isLowerId);
+
+    return more;
+}
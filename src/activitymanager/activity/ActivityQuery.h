@@ -0,0 +1,85 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __ACTIVITY_QUERY_H__
+#define __ACTIVITY_QUERY_H__
+
+#include <string>
+#include <vector>
+
+#include "Main.h"
+
+class Activity;
+
+/*
+ * Filter and page selection for Activity listings (getActivityInfo).
+ *
+ * Each filter set must match; unset filters match everything.  Pages are in
+ * Activity ID order and resume from a cursor, the last ID of the previous
+ * page, so Activities created or released between pages don't shift the
+ * rest of the listing.
+ *
+ * The run queue filter is resolved by the Activity Manager, which owns the
+ * queues; the query only carries the name.
+ */
+class ActivityQuery {
+public:
+    typedef std::vector<std::shared_ptr<const Activity>> ActivityVec;
+
+    ActivityQuery();
+    virtual ~ActivityQuery();
+
+    void setState(const std::string& state);
+    void setCreator(const std::string& creator);
+    void setNamePrefix(const std::string& prefix);
+    void setQueue(const std::string& queue);
+
+    const std::string& getQueue() const;
+    bool hasQueue() const;
+
+    /* Only Activities with IDs after the cursor are listed */
+    void setCursor(activityId_t cursor);
+    activityId_t getCursor() const;
+
+    /* Page size.  0 lists all of them. */
+    void setLimit(size_t limit);
+    size_t getLimit() const;
+
+    /* Checks the cursor and the state, creator and name prefix filters.
+     * The run queue filter is left to the caller. */
+    bool matches(const Activity& act) const;
+
+    /* Sorts the matches by ID and trims them to the page size.  Returns
+     * true if any were trimmed. */
+    bool selectPage(ActivityVec& matches) const;
+
+protected:
+    std::string m_state;
+    std::string m_creator;
+    std::string m_namePrefix;
+    std::string m_queue;
+
+    bool m_hasState;
+    bool m_hasCreator;
+    bool m_hasNamePrefix;
+    bool m_hasQueue;
+
+    activityId_t m_cursor;
+    size_t m_limit;
+};
+
+#endif /* __ACTIVITY_QUERY_H__ */
@@ -0,0 +1,103 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ConcurrencyController.h"
+
+#include <algorithm>
+
+ConcurrencyController::ConcurrencyController(const ConcurrencyInfo& info,
+                                             std::shared_ptr<IPressureSource> source,
+                                             unsigned int background,
+                                             unsigned int interactive)
+    : m_info(info)
+    , m_source(source)
+    , m_backgroundLevel(clamp(background, info.backgroundMin, info.backgroundMax))
+    , m_interactiveLevel(clamp(interactive, info.interactiveMin, info.interactiveMax))
+    , m_pressure(-1.0)
+{
+}
+
+ConcurrencyController::~ConcurrencyController()
+{
+}
+
+void ConcurrencyController::setSource(std::shared_ptr<IPressureSource> source)
+{
+    m_source = source;
+}
+
+bool ConcurrencyController::update()
+{
+    double cpu = 0;
+    double memory = 0;
+
+    if (!m_source || !m_source->read(cpu, memory)) {
+        return false;
+    }
+
+    m_pressure = std::max(cpu, memory);
+
+    unsigned int background = adjust(m_backgroundLevel, m_info.backgroundMin,
+                                     m_info.backgroundMax);
+    unsigned int interactive = adjust(m_interactiveLevel, m_info.interactiveMin,
+                                      m_info.interactiveMax);
+
+    if ((background == m_backgroundLevel) && (interactive == m_interactiveLevel)) {
+        return false;
+    }
+
+    m_backgroundLevel = background;
+    m_interactiveLevel = interactive;
+    return true;
+}
+
+unsigned int ConcurrencyController::getBackgroundLevel() const
+{
+    return m_backgroundLevel;
+}
+
+unsigned int ConcurrencyController::getBackgroundInteractiveLevel() const
+{
+    return m_interactiveLevel;
+}
+
+double ConcurrencyController::getPressure() const
+{
+    return m_pressure;
+}
+
+const ConcurrencyInfo& ConcurrencyController::getInfo() const
+{
+    return m_info;
+}
+
+unsigned int ConcurrencyController::clamp(unsigned int level, unsigned int min,
+                                          unsigned int max)
+{
+    return std::min(std::max(level, min), max);
+}
+
+unsigned int ConcurrencyController::adjust(unsigned int level, unsigned int min,
+                                           unsigned int max) const
+{
+    if (m_pressure >= m_info.pressureHigh) {
+        return clamp(level / 2, min, max);
+    } else if (m_pressure <= m_info.pressureLow) {
+        return clamp(level + 1, min, max);
+    }
+
+    return level;
+}
@@ -0,0 +1,69 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __CONCURRENCY_CONTROLLER_H__
+#define __CONCURRENCY_CONTROLLER_H__
+
+#include <memory>
+
+#include "base/IPressureSource.h"
+#include "conf/Config.h"
+
+/*
+ * Adjusts the background and background interactive concurrency levels
+ * from system pressure.
+ *
+ * Each sample takes the higher of CPU and memory pressure.  Above the high
+ * threshold both levels are halved; below the low threshold they grow by
+ * one.  Levels never leave their configured bounds, and hold steady in
+ * between so they don't oscillate around a single threshold.
+ */
+class ConcurrencyController {
+public:
+    ConcurrencyController(const ConcurrencyInfo& info,
+                          std::shared_ptr<IPressureSource> source,
+                          unsigned int background,
+                          unsigned int interactive);
+    virtual ~ConcurrencyController();
+
+    void setSource(std::shared_ptr<IPressureSource> source);
+
+    /* Take a pressure sample and adjust the levels.  Returns true if
+     * either level changed. */
+    bool update();
+
+    unsigned int getBackgroundLevel() const;
+    unsigned int getBackgroundInteractiveLevel() const;
+
+    /* Pressure from the last successful sample, or a negative value if
+     * none has been taken */
+    double getPressure() const;
+
+    const ConcurrencyInfo& getInfo() const;
+
+protected:
+    static unsigned int clamp(unsigned int level, unsigned int min, unsigned int max);
+    unsigned int adjust(unsigned int level, unsigned int min, unsigned int max) const;
+
+    ConcurrencyInfo m_info;
+    std::shared_ptr<IPressureSource> m_source;
+
+    unsigned int m_backgroundLevel;
+    unsigned int m_interactiveLevel;
+    double m_pressure;
+};
+
+#endif /* __CONCURRENCY_CONTROLLER_H__ */
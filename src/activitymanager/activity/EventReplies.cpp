@@ -0,0 +1,94 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "EventReplies.h"
+
+#include <core/MojServiceMessage.h>
+
+#include "activity/Activity.h"
+
+EventReplies::EventReplies(std::weak_ptr<Activity> activity)
+    : m_activity(activity)
+    , m_detailsBuilt(false)
+    , m_details(MojObject::TypeObject)
+{
+}
+
+EventReplies::~EventReplies()
+{
+}
+
+MojErr EventReplies::get(ActivityEvent event, bool detailed, const MojObject*& reply)
+{
+    std::pair<ActivityEvent, bool> key(event, detailed);
+
+    std::map<std::pair<ActivityEvent, bool>, MojObject>::const_iterator found =
+            m_replies.find(key);
+    if (found != m_replies.end()) {
+        reply = &found->second;
+        return MojErrNone;
+    }
+
+    std::shared_ptr<Activity> activity = m_activity.lock();
+    if (!activity) {
+        return MojErrInternal;
+    }
+
+    MojObject& built = m_replies[key];
+
+    MojErr err = build(*activity, event, detailed, built);
+    if (err) {
+        m_replies.erase(key);
+        return err;
+    }
+
+    reply = &built;
+    return MojErrNone;
+}
+
+MojErr EventReplies::build(const Activity& activity, ActivityEvent event, bool detailed,
+                           MojObject& reply)
+{
+    MojErr err = MojErrNone;
+
+    err = reply.putString(_T("event"), ActivityEventNames[event]);
+    MojErrCheck(err);
+
+    err = reply.putInt(_T("activityId"), activity.getId());
+    MojErrCheck(err);
+
+    err = reply.putBool(_T("subscribed"), true);
+    MojErrCheck(err);
+
+    err = reply.putBool(MojServiceMessage::ReturnValueKey, true);
+    MojErrCheck(err);
+
+    if (detailed) {
+        /* Shared by the detailed replies to every event */
+        if (!m_detailsBuilt) {
+            err = activity.activityInfoToJson(m_details);
+            MojErrCheck(err);
+
+            m_detailsBuilt = true;
+        }
+
+        err = reply.put(_T("$activity"), m_details);
+        MojErrCheck(err);
+    }
+
+    return MojErrNone;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __EVENT_REPLIES_H__
+#define __EVENT_REPLIES_H__
+
+#include <map>
+#include <memory>
+
+#include "Main.h"
+#include "conf/ActivityTypes.h"
+
+class Activity;
+
+/*
+ * The replies sent to an Activity's subscribers for its events:
+ *
+ * { "event": "start", "activityId": 12, "subscribed": true,
+ *   "returnValue": true, "$activity": { ... } }
+ *
+ * Each reply (and the "$activity" details) is built the first time a
+ * subscriber needs it, and the same object goes to every other subscriber.
+ * The details are only current as long as the Activity doesn't change, so
+ * a set of replies is made for one broadcast, or one flush of queued
+ * events, and then thrown away.
+ */
+class EventReplies {
+public:
+    EventReplies(std::weak_ptr<Activity> activity);
+    virtual ~EventReplies();
+
+    /* The reply stays valid as long as this object does */
+    MojErr get(ActivityEvent event, bool detailed, const MojObject*& reply);
+
+private:
+    EventReplies(const EventReplies& copy);
+    EventReplies& operator=(const EventReplies& copy);
+
+    MojErr build(const Activity& activity, ActivityEvent event, bool detailed,
+                 MojObject& reply);
+
+    std::weak_ptr<Activity> m_activity;
+
+    bool m_detailsBuilt;
+    MojObject m_details;
+
+    std::map<std::pair<ActivityEvent, bool>, MojObject> m_replies;
+};
+
+#endif /* __EVENT_REPLIES_H__ */
@@ -0,0 +1,143 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "FairShareQueue.h"
+
+FairShareQueue::FairShareQueue()
+    : m_defaultWeight(kDefaultWeight)
+{
+}
+
+FairShareQueue::~FairShareQueue()
+{
+}
+
+void FairShareQueue::setWeights(const WeightMap& weights, unsigned int defaultWeight)
+{
+    m_weights = weights;
+    m_defaultWeight = (defaultWeight > 0) ? defaultWeight : kDefaultWeight;
+
+    for (CreatorMap::iterator iter = m_creators.begin() ; iter != m_creators.end() ; ++iter) {
+        if (!iter->second.m_queue.empty()) {
+            iter->second.m_weight = getWeight(iter->second.m_queue.begin()->getCreator());
+        }
+    }
+}
+
+unsigned int FairShareQueue::getWeight(const BusId& creator) const
+{
+    WeightMap::const_iterator found = m_weights.find(creator.getId());
+    if ((found == m_weights.end()) || (found->second == 0)) {
+        return m_defaultWeight;
+    }
+
+    return found->second;
+}
+
+void FairShareQueue::push(Activity& act, int64_t key)
+{
+    act.m_readyKey = key;
+
+    std::string creator = act.getCreator().getString();
+
+    CreatorQueue& queue = m_creators[creator];
+    if (queue.m_queue.empty()) {
+        queue.m_weight = getWeight(act.getCreator());
+    }
+
+    queue.m_queue.insert(act);
+}
+
+int64_t FairShareQueue::agedKey(int64_t now, ActivityPriority_t priority, int64_t agingInterval)
+{
+    return now - ((int64_t) priority * agingInterval);
+}
+
+Activity *FairShareQueue::select()
+{
+    CreatorMap::iterator iter = m_creators.lower_bound(m_cursor);
+
+    while (!m_creators.empty()) {
+        if (iter == m_creators.end()) {
+            iter = m_creators.begin();
+        }
+
+        CreatorQueue& creator = iter->second;
+
+        /* Activities auto-unlink from the queues as they're run, evicted,
+         * or become unready, so creators are only dropped once found empty
+         * here (which also forfeits any unused credit). */
+        if (creator.m_queue.empty()) {
+            iter = m_creators.erase(iter);
+            continue;
+        }
+
+        if (creator.m_credit == 0) {
+            creator.m_credit = creator.m_weight;
+        }
+
+        Activity *act = &(*creator.m_queue.begin());
+
+        if (--creator.m_credit == 0) {
+            ++iter;
+            m_cursor = (iter == m_creators.end()) ? std::string() : iter->first;
+        } else {
+            m_cursor = iter->first;
+        }
+
+        return act;
+    }
+
+    m_cursor.clear();
+    return NULL;
+}
+
+void FairShareQueue::remove(Activity& act)
+{
+    if (act.m_readyQueueItem.is_linked()) {
+        act.m_readyQueueItem.unlink();
+    }
+}
+
+bool FairShareQueue::empty()
+{
+    CreatorMap::iterator iter = m_creators.begin();
+    while (iter != m_creators.end()) {
+        if (!iter->second.m_queue.empty()) {
+            return false;
+        }
+        iter = m_creators.erase(iter);
+    }
+
+    return true;
+}
+
+size_t FairShareQueue::size() const
+{
+    size_t count = 0;
+
+    for (CreatorMap::const_iterator iter = m_creators.begin() ; iter != m_creators.end() ; ++iter) {
+        count += iter->second.m_queue.size();
+    }
+
+    return count;
+}
+
+bool FairShareQueue::ReadyComp::operator()(const Activity& act1,
+                                           const Activity& act2) const
+{
+    return act1.m_readyKey < act2.m_readyKey;
+}
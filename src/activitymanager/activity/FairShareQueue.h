@@ -0,0 +1,108 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __FAIR_SHARE_QUEUE_H__
+#define __FAIR_SHARE_QUEUE_H__
+
+#include <map>
+#include <string>
+#include <boost/intrusive/set.hpp>
+
+#include "Main.h"
+#include "activity/Activity.h"
+
+/*
+ * Ready queue that shares the background run slots fairly between creators.
+ *
+ * Each creator (BusId) has its own priority ordered queue.  Creators are
+ * served by deficit round robin: on its turn a creator may start as many
+ * Activities as its weight before the turn moves on, so a single creator
+ * flooding the queue only delays its own Activities.
+ */
+class FairShareQueue {
+public:
+    /* Comparator object for the ready queues.  Lower keys run first. */
+    struct ReadyComp {
+        bool operator()(const Activity& act1, const Activity& act2) const;
+    };
+
+    typedef boost::intrusive::member_hook<Activity, Activity::ActivitySetItem,
+            &Activity::m_readyQueueItem> ReadyQueueOption;
+    typedef boost::intrusive::multiset<Activity, ReadyQueueOption,
+            boost::intrusive::constant_time_size<false>,
+            boost::intrusive::compare<ReadyComp>> ReadyQueue;
+
+    typedef std::map<std::string, unsigned int> WeightMap;
+
+    static const unsigned int kDefaultWeight = 1;
+
+    FairShareQueue();
+    virtual ~FairShareQueue();
+
+    /* Weights are keyed by the creator's bare app or service id */
+    void setWeights(const WeightMap& weights, unsigned int defaultWeight = kDefaultWeight);
+    unsigned int getWeight(const BusId& creator) const;
+
+    /* Queue an Activity, ordered by 'key' within its creator's queue */
+    void push(Activity& act, int64_t key);
+
+    /* The key of an Activity that became ready at 'now' (ms): each
+     * priority level is worth one aging interval of waiting */
+    static int64_t agedKey(int64_t now, ActivityPriority_t priority, int64_t agingInterval);
+
+    /* Select the next Activity to run and charge it to its creator.  The
+     * Activity remains queued until the caller unlinks it. */
+    Activity *select();
+
+    /* Remove an Activity from whichever creator queue holds it */
+    static void remove(Activity& act);
+
+    bool empty();
+    size_t size() const;
+
+    template<class Function>
+    void forEach(Function func) const
+    {
+        for (CreatorMap::const_iterator creator = m_creators.begin() ;
+                creator != m_creators.end() ; ++creator) {
+            for (ReadyQueue::const_iterator iter = creator->second.m_queue.begin() ;
+                    iter != creator->second.m_queue.end() ; ++iter) {
+                func(*iter);
+            }
+        }
+    }
+
+protected:
+    struct CreatorQueue {
+        CreatorQueue() : m_weight(kDefaultWeight), m_credit(0) {}
+
+        unsigned int m_weight;
+        unsigned int m_credit;
+        ReadyQueue m_queue;
+    };
+
+    typedef std::map<std::string, CreatorQueue> CreatorMap;
+
+    CreatorMap m_creators;
+
+    /* Creator whose turn it is (or the one after it, if it has left) */
+    std::string m_cursor;
+
+    WeightMap m_weights;
+    unsigned int m_defaultWeight;
+};
+
+#endif /* __FAIR_SHARE_QUEUE_H__ */
@@ -0,0 +1,88 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __SPEC_CACHE_H__
+#define __SPEC_CACHE_H__
+
+#include <memory>
+#include <string>
+
+#include "util/LruCache.h"
+
+/*
+ * Parsed and validated parts of Activity specs (Triggers, Callbacks,
+ * Schedules), keyed by the JSON text of the spec they came from.
+ *
+ * Services recreate the same Activities over and over, so the same specs
+ * keep coming back.  Holds at most a fixed number of entries, dropping the
+ * least recently used when full.  Entries are immutable and may be shared
+ * by any number of Activities.  A capacity of 0 disables caching.
+ */
+template <class T>
+class SpecCache {
+public:
+    explicit SpecCache(size_t capacity)
+        : m_entries(capacity)
+        , m_hits(0)
+        , m_misses(0)
+    {
+    }
+
+    virtual ~SpecCache() {}
+
+    std::shared_ptr<const T> find(const std::string& key)
+    {
+        std::shared_ptr<const T> *found = m_entries.find(key);
+        if (!found) {
+            m_misses++;
+            return std::shared_ptr<const T>();
+        }
+
+        m_hits++;
+        return *found;
+    }
+
+    void insert(const std::string& key, std::shared_ptr<const T> value)
+    {
+        m_entries.insert(key, value);
+    }
+
+    void clear()
+    {
+        m_entries.clear();
+    }
+
+    /* Drops least recently used entries to fit a new capacity */
+    void setCapacity(size_t capacity)
+    {
+        m_entries.setCapacity(capacity);
+    }
+
+    size_t size() const { return m_entries.size(); }
+    size_t getCapacity() const { return m_entries.getCapacity(); }
+
+    unsigned long getHits() const { return m_hits; }
+    unsigned long getMisses() const { return m_misses; }
+
+private:
+    LruCache<std::string, std::shared_ptr<const T> > m_entries;
+
+    unsigned long m_hits;
+    unsigned long m_misses;
+};
+
+#endif /* __SPEC_CACHE_H__ */
@@ -0,0 +1,107 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "TransitionQueue.h"
+
+#include <algorithm>
+
+#include "util/Logging.h"
+
+TransitionQueue::TransitionQueue(DispatchCallback dispatch, unsigned batchSize)
+    : m_dispatch(dispatch)
+    , m_batchSize(batchSize)
+    , m_source(0)
+{
+}
+
+TransitionQueue::~TransitionQueue()
+{
+    if (m_source) {
+        g_source_remove(m_source);
+    }
+}
+
+void TransitionQueue::push(Type type, activityId_t id)
+{
+    m_pending.push_back(PendingTransition(type, id));
+
+    if (!m_source) {
+        m_source = g_idle_add_full(G_PRIORITY_HIGH, &TransitionQueue::dispatchCallback,
+                                   this, NULL);
+    }
+}
+
+void TransitionQueue::cancel(activityId_t id)
+{
+    m_pending.erase(std::remove_if(m_pending.begin(), m_pending.end(),
+            [id](const PendingTransition& transition) { return transition.second == id; }),
+            m_pending.end());
+}
+
+size_t TransitionQueue::getPending() const
+{
+    return m_pending.size();
+}
+
+bool TransitionQueue::isScheduled() const
+{
+    return (m_source != 0);
+}
+
+gint TransitionQueue::getPriority() const
+{
+    if (!m_source) {
+        return G_PRIORITY_DEFAULT;
+    }
+
+    return g_source_get_priority(g_main_context_find_source_by_id(NULL, m_source));
+}
+
+gboolean TransitionQueue::dispatchCallback(gpointer data)
+{
+    TransitionQueue *self = static_cast<TransitionQueue *>(data);
+
+    if (self->dispatch()) {
+        return G_SOURCE_CONTINUE;
+    }
+
+    self->m_source = 0;
+    return G_SOURCE_REMOVE;
+}
+
+/* Returns true if transitions remain for another iteration */
+bool TransitionQueue::dispatch()
+{
+    /* Transitions queued while dispatching (entering one state commonly
+     * sets the next) go to the back and count against the same batch. */
+    unsigned dispatched = 0;
+    while (!m_pending.empty()) {
+        if (m_batchSize && (dispatched++ >= m_batchSize)) {
+            LOG_AM_DEBUG("%zu transitions still pending after batch of %u",
+                         m_pending.size(), m_batchSize);
+            g_source_set_priority(g_main_current_source(), G_PRIORITY_DEFAULT);
+            return true;
+        }
+
+        PendingTransition transition = m_pending.front();
+        m_pending.pop_front();
+
+        m_dispatch(transition.first, transition.second);
+    }
+
+    return false;
+}
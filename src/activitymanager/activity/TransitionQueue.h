@@ -0,0 +1,75 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __TRANSITION_QUEUE_H__
+#define __TRANSITION_QUEUE_H__
+
+#include <deque>
+#include <functional>
+#include <glib.h>
+
+#include "Main.h"
+
+/*
+ * Deferred Activity transitions.
+ *
+ * Transitions run from the main loop, in the order they were queued, by a
+ * single high priority idle source.  Each iteration dispatches at most a
+ * batch of them; once the budget is spent the source drops to default
+ * priority, so bus traffic interleaves with the remaining backlog instead
+ * of waiting for all of it.  Transitions are queued by id, so one for an
+ * Activity that has since been released is dropped rather than run.
+ */
+class TransitionQueue {
+public:
+    typedef enum {
+        EnterState,
+        Start
+    } Type;
+
+    typedef std::function<void (Type type, activityId_t id)> DispatchCallback;
+
+    /* A batch size of 0 dispatches the whole backlog at once */
+    TransitionQueue(DispatchCallback dispatch, unsigned batchSize);
+    virtual ~TransitionQueue();
+
+    void push(Type type, activityId_t id);
+
+    /* Drops any transitions still queued for the Activity */
+    void cancel(activityId_t id);
+
+    size_t getPending() const;
+    bool isScheduled() const;
+
+    /* Priority of the dispatching source, if scheduled */
+    gint getPriority() const;
+
+protected:
+    static gboolean dispatchCallback(gpointer data);
+
+    bool dispatch();
+
+    typedef std::pair<Type, activityId_t> PendingTransition;
+
+    DispatchCallback m_dispatch;
+    unsigned m_batchSize;
+
+    std::deque<PendingTransition> m_pending;
+    guint m_source;
+};
+
+#endif /* __TRANSITION_QUEUE_H__ */
@@ -0,0 +1,161 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "YieldQueue.h"
+
+#include <vector>
+
+const char *YieldQueue::kPolicyNames[] = {
+    "longest-running",
+    "lowest-priority",
+    "shortest-running"
+};
+
+YieldQueue::YieldQueue(Policy policy)
+    : m_policy(policy)
+    , m_yieldingCount(0)
+{
+}
+
+YieldQueue::~YieldQueue()
+{
+}
+
+bool YieldQueue::getPolicy(const std::string& name, Policy& policy)
+{
+    for (int i = 0 ; i < PolicyMax ; i++) {
+        if (name == kPolicyNames[i]) {
+            policy = (Policy) i;
+            return true;
+        }
+    }
+
+    return false;
+}
+
+unsigned int YieldQueue::getDefaultYieldSeconds(Policy policy)
+{
+    switch (policy) {
+    case PolicyLowestPriority:
+        return 30;
+    case PolicyShortestRunning:
+        return 15;
+    default:
+        return 60;
+    }
+}
+
+void YieldQueue::setPolicy(Policy policy)
+{
+    if (policy == m_policy) {
+        return;
+    }
+
+    m_policy = policy;
+
+    /* Keys can't change while queued, so re-insert everything */
+    std::vector<Activity *> candidates;
+    while (!m_candidates.empty()) {
+        Activity& act = *m_candidates.begin();
+        m_candidates.erase(m_candidates.begin());
+        candidates.push_back(&act);
+    }
+
+    for (std::vector<Activity *>::iterator iter = candidates.begin() ;
+            iter != candidates.end() ; ++iter) {
+        (*iter)->m_yieldKey = getKey(**iter);
+        m_candidates.insert(**iter);
+    }
+}
+
+YieldQueue::Policy YieldQueue::getPolicy() const
+{
+    return m_policy;
+}
+
+void YieldQueue::push(Activity& act, int64_t now)
+{
+    remove(act);
+
+    act.m_runStartTime = now;
+    act.m_yieldKey = getKey(act);
+
+    m_candidates.insert(act);
+}
+
+Activity *YieldQueue::selectVictim()
+{
+    if (m_candidates.empty()) {
+        return NULL;
+    }
+
+    Activity& victim = *m_candidates.begin();
+    m_candidates.erase(m_candidates.begin());
+
+    victim.m_yieldCounted = true;
+    m_yieldingCount++;
+
+    return &victim;
+}
+
+void YieldQueue::remove(Activity& act)
+{
+    if (act.m_yieldQueueItem.is_linked()) {
+        act.m_yieldQueueItem.unlink();
+    }
+
+    if (act.m_yieldCounted) {
+        act.m_yieldCounted = false;
+        if (m_yieldingCount > 0) {
+            m_yieldingCount--;
+        }
+    }
+}
+
+unsigned int YieldQueue::getYieldingCount() const
+{
+    return m_yieldingCount;
+}
+
+bool YieldQueue::empty()
+{
+    return m_candidates.empty();
+}
+
+int64_t YieldQueue::getKey(const Activity& act) const
+{
+    switch (m_policy) {
+    case PolicyLowestPriority:
+        return (int64_t) act.getPriority();
+    case PolicyShortestRunning:
+        return -act.m_runStartTime;
+    default:
+        return 0;
+    }
+}
+
+bool YieldQueue::CandidateComp::operator()(const Activity& act1, const Activity& act2) const
+{
+    if (act1.m_yieldKey != act2.m_yieldKey) {
+        return act1.m_yieldKey < act2.m_yieldKey;
+    }
+
+    if (act1.m_runStartTime != act2.m_runStartTime) {
+        return act1.m_runStartTime < act2.m_runStartTime;
+    }
+
+    return act1.getId() < act2.getId();
+}
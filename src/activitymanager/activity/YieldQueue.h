@@ -0,0 +1,95 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __YIELD_QUEUE_H__
+#define __YIELD_QUEUE_H__
+
+#include <string>
+#include <boost/intrusive/set.hpp>
+
+#include "Main.h"
+#include "activity/Activity.h"
+
+/*
+ * Running background interactive Activities that may be asked to yield to
+ * ready interactive ones, ordered so the preemption policy's preferred
+ * victim is always first.
+ *
+ * Activities asked to yield leave the candidates and are counted until they
+ * leave the run queue, so neither picking a victim nor checking how many
+ * are already yielding has to walk the run queue.
+ */
+class YieldQueue {
+public:
+    typedef enum {
+        /* Longest running first.  Equivalent to the original first-started
+         * choice. */
+        PolicyLongestRunning = 0,
+        /* Lowest priority first, then longest running */
+        PolicyLowestPriority,
+        /* Most recently started first, so the least work is thrown away */
+        PolicyShortestRunning,
+        PolicyMax
+    } Policy;
+
+    static const char *kPolicyNames[];
+
+    /* Comparator object for the candidates.  Lower keys yield first. */
+    struct CandidateComp {
+        bool operator()(const Activity& act1, const Activity& act2) const;
+    };
+
+    typedef boost::intrusive::member_hook<Activity, Activity::ActivitySetItem,
+            &Activity::m_yieldQueueItem> CandidateOption;
+    typedef boost::intrusive::multiset<Activity, CandidateOption,
+            boost::intrusive::constant_time_size<false>,
+            boost::intrusive::compare<CandidateComp>> CandidateQueue;
+
+    YieldQueue(Policy policy = PolicyLongestRunning);
+    virtual ~YieldQueue();
+
+    static bool getPolicy(const std::string& name, Policy& policy);
+
+    /* Seconds between yield requests under each policy.  Policies that
+     * preempt less expensive work can afford to ask more often. */
+    static unsigned int getDefaultYieldSeconds(Policy policy);
+
+    /* Changing the policy re-orders the current candidates */
+    void setPolicy(Policy policy);
+    Policy getPolicy() const;
+
+    /* The Activity started running ('now' in milliseconds) */
+    void push(Activity& act, int64_t now);
+
+    /* Select the next Activity to yield and count it as yielding until it is
+     * removed.  Returns NULL if every Activity is already yielding. */
+    Activity *selectVictim();
+
+    /* The Activity left the run queue */
+    void remove(Activity& act);
+
+    unsigned int getYieldingCount() const;
+    bool empty();
+
+protected:
+    int64_t getKey(const Activity& act) const;
+
+    Policy m_policy;
+    CandidateQueue m_candidates;
+    unsigned int m_yieldingCount;
+};
+
+#endif /* __YIELD_QUEUE_H__ */
@@ -21,11 +21,6 @@
 #include "tools/ActivityMonitor.h"
 #include "util/Logging.h"
 
-AbstractActivityState::AbstractActivityState()
-    : m_transition(kActivityTransitionNone)
-{
-}
-
 void AbstractActivityState::enter(std::shared_ptr<Activity> activity)
 {
 }
@@ -34,47 +29,47 @@ void AbstractActivityState::create(std::shared_ptr<Activity> activity)
 {
     LOG_AM_WARNING("STATE_TRANSITION_FAIL", 3,
                    PMLOGKFV("Activity", "%llu", activity->getId()),
-                   PMLOGKS("state", toString().c_str()),
+                   PMLOGKS("state", toString(*activity).c_str()),
                    PMLOGKS("func", __FUNCTION__), "");
 
-    throw std::runtime_error("Invalid transition: " + toString() + " -> " + __FUNCTION__);
+    throw std::runtime_error("Invalid transition: " + toString(*activity) + " -> " + __FUNCTION__);
 }
 
 void AbstractActivityState::start(std::shared_ptr<Activity> activity)
 {
     LOG_AM_WARNING("STATE_TRANSITION_FAIL", 3,
                    PMLOGKFV("Activity", "%llu", activity->getId()),
-                   PMLOGKS("state", toString().c_str()),
+                   PMLOGKS("state", toString(*activity).c_str()),
                    PMLOGKS("func", __FUNCTION__), "");
 
-    throw std::runtime_error("Invalid transition: " + toString() + " -> " + __FUNCTION__);
+    throw std::runtime_error("Invalid transition: " + toString(*activity) + " -> " + __FUNCTION__);
 }
 
 void AbstractActivityState::pause(std::shared_ptr<Activity> activity)
 {
     LOG_AM_WARNING("STATE_TRANSITION_FAIL", 3,
                    PMLOGKFV("Activity", "%llu", activity->getId()),
-                   PMLOGKS("state", toString().c_str()),
+                   PMLOGKS("state", toString(*activity).c_str()),
                    PMLOGKS("func", __FUNCTION__), "");
 
-    throw std::runtime_error("Invalid transition: " + toString() + " -> " + __FUNCTION__);
+    throw std::runtime_error("Invalid transition: " + toString(*activity) + " -> " + __FUNCTION__);
 }
 
 void AbstractActivityState::complete(std::shared_ptr<Activity> activity)
 {
     LOG_AM_WARNING("STATE_TRANSITION_FAIL", 3,
                    PMLOGKFV("Activity", "%llu", activity->getId()),
-                   PMLOGKS("state", toString().c_str()),
+                   PMLOGKS("state", toString(*activity).c_str()),
                    PMLOGKS("func", __FUNCTION__), "");
 
-    throw std::runtime_error("Invalid transition: " + toString() + " -> " + __FUNCTION__);
+    throw std::runtime_error("Invalid transition: " + toString(*activity) + " -> " + __FUNCTION__);
 }
 
 void AbstractActivityState::destroy(std::shared_ptr<Activity> activity)
 {
     setTransition(kActivityTransitionDestroying, activity);
     activity->unscheduleActivity();
-    activity->setState(ActivityStateDestroyed::newInstance());
+    activity->setState(ActivityStateDestroyed::getInstance());
 }
 
 void AbstractActivityState::onTriggerFail(
@@ -85,11 +80,11 @@ void AbstractActivityState::onTriggerFail(
     LOG_AM_WARNING("TRIGGER_FAIL", 4,
                    PMLOGKFV("Activity", "%llu", activity->getId()),
                    PMLOGKFV("continuous", "%d", activity->isContinuous()),
-                   PMLOGKS("state", toString().c_str()),
+                   PMLOGKS("state", toString(*activity).c_str()),
                    PMLOGKS("trigger", trigger->getName().c_str()), "");
 
     setTransition(kActivityTransitionFailing, activity);
-    activity->setState(ActivityStateFailed::newInstance());
+    activity->setState(ActivityStateFailed::getInstance());
 }
 
 void AbstractActivityState::onTriggerUpdate(
@@ -106,10 +101,10 @@ void AbstractActivityState::onCallbackFail(
     LOG_AM_WARNING("CALLBACK_FAIL", 3,
                    PMLOGKFV("Activity", "%llu", activity->getId()),
                    PMLOGKFV("continuous", "%d", activity->isContinuous()),
-                   PMLOGKS("state", toString().c_str()), "");
+                   PMLOGKS("state", toString(*activity).c_str()), "");
 
     setTransition(kActivityTransitionFailing, activity);
-    activity->setState(ActivityStateFailed::newInstance());
+    activity->setState(ActivityStateFailed::getInstance());
 }
 
 void AbstractActivityState::onCallbackSucceed(
@@ -134,8 +129,8 @@ void AbstractActivityState::onSchedule(
 void AbstractActivityState::setTransition(
         ActivityTransition transition, std::shared_ptr<Activity> activity)
 {
-    m_transition = transition;
-    LOG_AM_DEBUG("[Activity %llu] Transition \"%s\"", activity->getId(), toString().c_str());
+    activity->m_transition = transition;
+    LOG_AM_DEBUG("[Activity %llu] Transition \"%s\"", activity->getId(), toString(*activity).c_str());
 
     ActivityMonitor::getInstance().send(activity);
 
@@ -158,9 +153,10 @@ void AbstractActivityState::setTransition(
     }
 }
 
-bool AbstractActivityState::getActivityTransitionName(std::string& name)
+bool AbstractActivityState::getActivityTransitionName(ActivityTransition transition,
+                                                      std::string& name)
 {
-    switch (m_transition) {
+    switch (transition) {
         case kActivityTransitionCreating:
             name = "creating";
             return true;
@@ -194,10 +190,10 @@ bool AbstractActivityState::getActivityTransitionName(std::string& name)
     }
 }
 
-std::string AbstractActivityState::toString()
+std::string AbstractActivityState::toString(const Activity& activity)
 {
     std::string transition;
-    if (!getActivityTransitionName(transition)) {
+    if (!getActivityTransitionName(activity.m_transition, transition)) {
         return getName();
     }
     return transition;
@@ -207,13 +203,13 @@ void ActivityStateCreated::start(std::shared_ptr<Activity> activity)
 {
     setTransition(kActivityTransitionStarting, activity);
     activity->requestScheduleActivity();
-    activity->setState(ActivityStateUnsatisfied::newInstance());
+    activity->setState(ActivityStateUnsatisfied::getInstance());
 }
 
 void ActivityStateCreated::pause(std::shared_ptr<Activity> activity)
 {
     setTransition(kActivityTransitionPausing, activity);
-    activity->setState(ActivityStatePaused::newInstance());
+    activity->setState(ActivityStatePaused::getInstance());
 }
 
 std::string ActivityStateCreated::getName()
@@ -227,7 +223,7 @@ void ActivityStatePaused::start(std::shared_ptr<Activity> activity)
 {
     setTransition(kActivityTransitionResuming, activity);
     activity->requestScheduleActivity();
-    activity->setState(ActivityStateUnsatisfied::newInstance());
+    activity->setState(ActivityStateUnsatisfied::getInstance());
 }
 
 std::string ActivityStatePaused::getName()
@@ -241,14 +237,14 @@ void ActivityStateUnsatisfied::enter(std::shared_ptr<Activity> activity)
 {
     if (activity->isRunnable()) {
         setTransition(kActivityTransitionSatisfying, activity);
-        activity->setState(ActivityStateSatisfied::newInstance());
+        activity->setState(ActivityStateSatisfied::getInstance());
     }
 }
 
 void ActivityStateUnsatisfied::pause(std::shared_ptr<Activity> activity)
 {
     setTransition(kActivityTransitionPausing, activity);
-    activity->setState(ActivityStatePaused::newInstance());
+    activity->setState(ActivityStatePaused::getInstance());
 }
 
 void ActivityStateUnsatisfied::onTriggerUpdate(
@@ -258,7 +254,7 @@ void ActivityStateUnsatisfied::onTriggerUpdate(
 
     if (activity->isRunnable()) {
         setTransition(kActivityTransitionSatisfying, activity);
-        activity->setState(ActivityStateSatisfied::newInstance());
+        activity->setState(ActivityStateSatisfied::getInstance());
     }
 }
 
@@ -269,7 +265,7 @@ void ActivityStateUnsatisfied::onRequirementUpdate(
 
     if (activity->isRunnable()) {
         setTransition(kActivityTransitionSatisfying, activity);
-        activity->setState(ActivityStateSatisfied::newInstance());
+        activity->setState(ActivityStateSatisfied::getInstance());
     }
 }
 
@@ -280,7 +276,7 @@ void ActivityStateUnsatisfied::onSchedule(
 
     if (activity->isRunnable()) {
         setTransition(kActivityTransitionSatisfying, activity);
-        activity->setState(ActivityStateSatisfied::newInstance());
+        activity->setState(ActivityStateSatisfied::getInstance());
     }
 }
 
@@ -296,7 +292,7 @@ void ActivityStateSatisfied::enter(std::shared_ptr<Activity> activity)
     setTransition(kActivityTransitionExpiring, activity);
     activity->requestRunActivity();
     activity->unscheduleActivity();
-    activity->setState(ActivityStateExpired::newInstance());
+    activity->setState(ActivityStateExpired::getInstance());
 }
 
 void ActivityStateSatisfied::onRequirementUpdate(
@@ -323,16 +319,16 @@ void ActivityStateExpired::complete(std::shared_ptr<Activity> activity)
         } else {
             setTransition(kActivityTransitionDestroying, activity);
             activity->unscheduleActivity();
-            activity->setState(ActivityStateDestroyed::newInstance());
+            activity->setState(ActivityStateDestroyed::getInstance());
         }
     } else {
         if (activity->isFastRestart()) {
             setTransition(kActivityTransitionFailing, activity);
-            activity->setState(ActivityStateFailed::newInstance());
+            activity->setState(ActivityStateFailed::getInstance());
         } else {
             setTransition(kActivityTransitionRestarting, activity);
             activity->requestScheduleActivity();
-            activity->setState(ActivityStateUnsatisfied::newInstance());
+            activity->setState(ActivityStateUnsatisfied::getInstance());
         }
     }
 }
@@ -343,10 +339,10 @@ void ActivityStateExpired::onCallbackSucceed(
     if (activity->isContinuous()) {
         if (activity->isFastRestart()) {
             setTransition(kActivityTransitionFailing, activity);
-            activity->setState(ActivityStateFailed::newInstance());
+            activity->setState(ActivityStateFailed::getInstance());
         } else {
             setTransition(kActivityTransitionRestarting, activity);
-            activity->setState(ActivityStateUnsatisfied::newInstance());
+            activity->setState(ActivityStateUnsatisfied::getInstance());
         }
     }
 }
@@ -386,7 +382,7 @@ void ActivityStateFailed::destroy(std::shared_ptr<Activity> activity)
 {
     setTransition(kActivityTransitionDestroying, activity);
     activity->unscheduleActivity();
-    activity->setState(ActivityStateDestroyed::newInstance());
+    activity->setState(ActivityStateDestroyed::getInstance());
 }
 
 void ActivityStateFailed::onTriggerFail(
@@ -27,6 +27,10 @@
 
 class Activity;
 
+/*
+ * States hold no per-Activity data.  Each concrete state is a single shared
+ * instance, and the transition an Activity is making is kept in the Activity.
+ */
 class AbstractActivityState {
 public:
     enum ActivityTransition {
@@ -42,7 +46,6 @@ public:
         kActivityTransitionDestroying,
     };
 
-    AbstractActivityState();
     virtual ~AbstractActivityState() {};
 
     virtual void enter(std::shared_ptr<Activity> activity);
@@ -67,13 +70,13 @@ public:
             std::shared_ptr<Activity> activity, std::shared_ptr<Schedule> schedule);
 
     virtual std::string getName() = 0;
-    bool getActivityTransitionName(std::string& name);
-    std::string toString();
+    static bool getActivityTransitionName(ActivityTransition transition, std::string& name);
+    std::string toString(const Activity& activity);
 
 protected:
-    void setTransition(ActivityTransition transition, std::shared_ptr<Activity> activity);
+    AbstractActivityState() {};
 
-    ActivityTransition m_transition;
+    void setTransition(ActivityTransition transition, std::shared_ptr<Activity> activity);
 };
 
 
@@ -82,9 +85,10 @@ protected:
 
 class ActivityStateCreated : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStateCreated> newInstance()
+    static std::shared_ptr<ActivityStateCreated> getInstance()
     {
-        return std::shared_ptr<ActivityStateCreated>(new ActivityStateCreated);
+        static std::shared_ptr<ActivityStateCreated> _instance(new ActivityStateCreated);
+        return _instance;
     }
 
     virtual ~ActivityStateCreated() {};
@@ -102,9 +106,10 @@ private:
 
 class ActivityStatePaused : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStatePaused> newInstance()
+    static std::shared_ptr<ActivityStatePaused> getInstance()
     {
-        return std::shared_ptr<ActivityStatePaused>(new ActivityStatePaused);
+        static std::shared_ptr<ActivityStatePaused> _instance(new ActivityStatePaused);
+        return _instance;
     }
 
     virtual ~ActivityStatePaused() {};
@@ -121,9 +126,10 @@ private:
 
 class ActivityStateUnsatisfied : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStateUnsatisfied> newInstance()
+    static std::shared_ptr<ActivityStateUnsatisfied> getInstance()
     {
-        return std::shared_ptr<ActivityStateUnsatisfied>(new ActivityStateUnsatisfied);
+        static std::shared_ptr<ActivityStateUnsatisfied> _instance(new ActivityStateUnsatisfied);
+        return _instance;
     }
 
     virtual ~ActivityStateUnsatisfied() {};
@@ -149,9 +155,10 @@ private:
 
 class ActivityStateSatisfied : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStateSatisfied> newInstance()
+    static std::shared_ptr<ActivityStateSatisfied> getInstance()
     {
-        return std::shared_ptr<ActivityStateSatisfied>(new ActivityStateSatisfied);
+        static std::shared_ptr<ActivityStateSatisfied> _instance(new ActivityStateSatisfied);
+        return _instance;
     }
 
     virtual ~ActivityStateSatisfied() {};
@@ -171,9 +178,10 @@ private:
 
 class ActivityStateExpired : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStateExpired> newInstance()
+    static std::shared_ptr<ActivityStateExpired> getInstance()
     {
-        return std::shared_ptr<ActivityStateExpired>(new ActivityStateExpired);
+        static std::shared_ptr<ActivityStateExpired> _instance(new ActivityStateExpired);
+        return _instance;
     }
 
     virtual ~ActivityStateExpired() {};
@@ -195,9 +203,10 @@ private:
 
 class ActivityStateFailed : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStateFailed> newInstance()
+    static std::shared_ptr<ActivityStateFailed> getInstance()
     {
-        return std::shared_ptr<ActivityStateFailed>(new ActivityStateFailed);
+        static std::shared_ptr<ActivityStateFailed> _instance(new ActivityStateFailed);
+        return _instance;
     }
 
     virtual ~ActivityStateFailed() {};
@@ -229,9 +238,10 @@ private:
 
 class ActivityStateDestroyed : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStateDestroyed> newInstance()
+    static std::shared_ptr<ActivityStateDestroyed> getInstance()
     {
-        return std::shared_ptr<ActivityStateDestroyed>(new ActivityStateDestroyed);
+        static std::shared_ptr<ActivityStateDestroyed> _instance(new ActivityStateDestroyed);
+        return _instance;
     }
 
     virtual ~ActivityStateDestroyed() {};
@@ -20,7 +20,7 @@
 void ActivityStateNone::create(std::shared_ptr<Activity> activity)
 {
     setTransition(kActivityTransitionCreating, activity);
-    activity->setState(ActivityStateCreated::newInstance());
+    activity->setState(ActivityStateCreated::getInstance());
 }
 
 std::string ActivityStateNone::getName()
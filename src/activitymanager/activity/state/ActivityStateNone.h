@@ -21,9 +21,10 @@
 
 class ActivityStateNone : public AbstractActivityState {
 public:
-    static std::shared_ptr<ActivityStateNone> newInstance()
+    static std::shared_ptr<ActivityStateNone> getInstance()
     {
-        return std::shared_ptr<ActivityStateNone>(new ActivityStateNone);
+        static std::shared_ptr<ActivityStateNone> _instance(new ActivityStateNone);
+        return _instance;
     }
 
     virtual ~ActivityStateNone() {};
@@ -37,9 +37,7 @@ std::shared_ptr<ITrigger> TriggerFactory::createKeyedTrigger(
         const MojObject& params,
         const MojString& key)
 {
-    std::shared_ptr<Matcher> matcher = std::make_shared<KeyMatcher>(key);
-
-    return createTrigger(activity, url, params, matcher);
+    return createTrigger(activity, url, params, createKeyMatcher(key));
 }
 
 std::shared_ptr<ITrigger> TriggerFactory::createBasicTrigger(
@@ -47,9 +45,7 @@ std::shared_ptr<ITrigger> TriggerFactory::createBasicTrigger(
         const LunaURL& url,
         const MojObject& params)
 {
-    std::shared_ptr<Matcher> matcher = std::make_shared<SimpleMatcher>();
-
-    return createTrigger(activity, url, params, matcher);
+    return createTrigger(activity, url, params, std::shared_ptr<Matcher>());
 }
 
 std::shared_ptr<ITrigger> TriggerFactory::createCompareTrigger(
@@ -59,9 +55,7 @@ std::shared_ptr<ITrigger> TriggerFactory::createCompareTrigger(
         const MojString& key,
         const MojObject& value)
 {
-    std::shared_ptr<Matcher> matcher = std::make_shared<CompareMatcher>(key, value);
-
-    return createTrigger(activity, url, params, matcher);
+    return createTrigger(activity, url, params, createCompareMatcher(key, value));
 }
 
 std::shared_ptr<ITrigger> TriggerFactory::createWhereTrigger(
@@ -70,9 +64,23 @@ std::shared_ptr<ITrigger> TriggerFactory::createWhereTrigger(
         const MojObject& params,
         const MojObject& where)
 {
-    std::shared_ptr<Matcher> matcher = std::make_shared<WhereMatcher>(where);
+    return createTrigger(activity, url, params, createWhereMatcher(where));
+}
 
-    return createTrigger(activity, url, params, matcher);
+std::shared_ptr<Matcher> TriggerFactory::createKeyMatcher(const MojString& key)
+{
+    return std::make_shared<KeyMatcher>(key);
+}
+
+std::shared_ptr<Matcher> TriggerFactory::createCompareMatcher(
+        const MojString& key, const MojObject& value)
+{
+    return std::make_shared<CompareMatcher>(key, value);
+}
+
+std::shared_ptr<Matcher> TriggerFactory::createWhereMatcher(const MojObject& where)
+{
+    return std::make_shared<WhereMatcher>(where);
 }
 
 std::shared_ptr<ITrigger> TriggerFactory::createTrigger(
@@ -81,6 +89,10 @@ std::shared_ptr<ITrigger> TriggerFactory::createTrigger(
         const MojObject& params,
         std::shared_ptr<Matcher> matcher)
 {
+    if (!matcher) {
+        matcher = std::make_shared<SimpleMatcher>();
+    }
+
     std::shared_ptr<ConcreteTrigger> trigger =
             std::make_shared<ConcreteTrigger>(activity, matcher);
 
@@ -91,4 +103,3 @@ std::shared_ptr<ITrigger> TriggerFactory::createTrigger(
 
     return trigger;
 }
-
@@ -51,14 +51,22 @@ public:
             const MojObject& params,
             const MojObject& where);
 
-private:
-    TriggerFactory();
+    /* Key, compare and where Matchers keep no per-Trigger state, so one
+     * may be shared by any number of Triggers */
+    static std::shared_ptr<Matcher> createKeyMatcher(const MojString& key);
+    static std::shared_ptr<Matcher> createCompareMatcher(
+            const MojString& key, const MojObject& value);
+    static std::shared_ptr<Matcher> createWhereMatcher(const MojObject& where);
 
+    /* Without a matcher, the Trigger gets its own Simple Matcher */
     static std::shared_ptr<ITrigger> createTrigger(
             std::shared_ptr<Activity> activity,
             const LunaURL& url,
             const MojObject& params,
             std::shared_ptr<Matcher> matcher);
+
+private:
+    TriggerFactory();
 };
 
 #endif /* __TRIGGER_MANAGER_H__ */
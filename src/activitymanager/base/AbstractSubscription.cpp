@@ -19,17 +19,22 @@
 #include <stdexcept>
 
 #include "activity/Activity.h"
+#include "activity/EventReplies.h"
 #include "util/Logging.h"
 
 AbstractSubscription::AbstractSubscription(std::shared_ptr<Activity> activity, bool detailedUpdates)
     : m_detailedEvents(detailedUpdates)
     , m_plugged(false)
+    , m_coalesceWindow(0)
+    , m_windowSource(0)
+    , m_updatePending(false)
     , m_activity(activity)
 {
 }
 
 AbstractSubscription::~AbstractSubscription()
 {
+    closeWindow();
 }
 
 void AbstractSubscription::handleCancelWrapper()
@@ -42,6 +47,10 @@ void AbstractSubscription::handleCancelWrapper()
             m_activity.lock()->removeSubscription(shared_from_this());
         }
 
+        /* Nobody's left to send a held back update to */
+        closeWindow();
+        m_updatePending = false;
+
         /* Any specialized implementation for the specific Subscription type */
         handleCancel();
     } catch (const std::exception& except) {
@@ -62,6 +71,13 @@ bool AbstractSubscription::operator<(const AbstractSubscription& rhs) const
 }
 
 MojErr AbstractSubscription::queueEvent(ActivityEvent event)
+{
+    EventReplies replies(m_activity);
+
+    return queueEvent(event, replies);
+}
+
+MojErr AbstractSubscription::queueEvent(ActivityEvent event, EventReplies& replies)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
@@ -71,7 +87,7 @@ MojErr AbstractSubscription::queueEvent(ActivityEvent event)
     }
 
     if (!isPlugged()) {
-        return sendEvent(event);
+        return deliverEvent(event, replies);
     }
 
     /* If there's already an event queued, suppress this one.
@@ -92,7 +108,7 @@ void AbstractSubscription::plug()
     m_plugged = true;
 }
 
-void AbstractSubscription::unplug()
+void AbstractSubscription::unplug(EventReplies& replies)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
@@ -106,7 +122,7 @@ void AbstractSubscription::unplug()
     while (!m_eventQueue.empty()) {
         ActivityEvent event = m_eventQueue.front();
         m_eventQueue.pop_front();
-        sendEvent(event);
+        deliverEvent(event, replies);
     }
 }
 
@@ -115,3 +131,95 @@ bool AbstractSubscription::isPlugged() const
     return (m_plugged || (!m_activity.expired() && m_activity.lock()->isPersistCommandHooked()));
 }
 
+void AbstractSubscription::setCoalesceWindow(unsigned milliseconds)
+{
+    m_coalesceWindow = milliseconds;
+}
+
+unsigned AbstractSubscription::getCoalesceWindow() const
+{
+    return m_coalesceWindow;
+}
+
+MojErr AbstractSubscription::deliverEvent(ActivityEvent event, EventReplies& replies)
+{
+    if (!m_coalesceWindow) {
+        return sendEvent(event, replies);
+    }
+
+    if (event == kActivityUpdateEvent) {
+        /* The first update opens a window; the rest wait for it to end */
+        if (m_windowSource) {
+            m_updatePending = true;
+            return MojErrNone;
+        }
+
+        openWindow();
+        return sendEvent(event, replies);
+    }
+
+    /* Keep the order events happened in */
+    if (m_updatePending) {
+        m_updatePending = false;
+
+        MojErr err = sendEvent(kActivityUpdateEvent, replies);
+        if (err) {
+            LOG_AM_DEBUG("%s: failed to send held back update event (%d)",
+                         getSubscriber().getString().c_str(), (int) err);
+        }
+    }
+
+    return sendEvent(event, replies);
+}
+
+gboolean AbstractSubscription::windowCallback(gpointer data)
+{
+    AbstractSubscription *self = static_cast<AbstractSubscription *>(data);
+
+    self->m_windowSource = 0;
+
+    if (!self->m_updatePending) {
+        return G_SOURCE_REMOVE;
+    }
+
+    self->m_updatePending = false;
+
+    /* Events are being held for a persist command; the update waits with
+     * them (unless one is already there to carry the details) */
+    if (self->isPlugged()) {
+        if (self->m_eventQueue.empty()) {
+            self->m_eventQueue.push_back(kActivityUpdateEvent);
+        }
+        return G_SOURCE_REMOVE;
+    }
+
+    /* Keeps a burst that's still going to one update per window */
+    std::shared_ptr<AbstractSubscription> keep = self->shared_from_this();
+    self->openWindow();
+
+    EventReplies replies(self->m_activity);
+    MojErr err = self->sendEvent(kActivityUpdateEvent, replies);
+    if (err) {
+        LOG_AM_DEBUG("%s: failed to send held back update event (%d)",
+                     self->getSubscriber().getString().c_str(), (int) err);
+    }
+
+    return G_SOURCE_REMOVE;
+}
+
+void AbstractSubscription::openWindow()
+{
+    if (!m_windowSource) {
+        m_windowSource = g_timeout_add_full(G_PRIORITY_DEFAULT, m_coalesceWindow,
+                                            &AbstractSubscription::windowCallback,
+                                            this, NULL);
+    }
+}
+
+void AbstractSubscription::closeWindow()
+{
+    if (m_windowSource) {
+        g_source_remove(m_windowSource);
+        m_windowSource = 0;
+    }
+}
@@ -19,12 +19,14 @@
 
 #include <list>
 #include <boost/intrusive/set.hpp>
+#include <glib.h>
 
 #include "Main.h"
 #include "base/Subscriber.h"
 #include "conf/ActivityTypes.h"
 
 class Activity;
+class EventReplies;
 
 class AbstractSubscription : public std::enable_shared_from_this<AbstractSubscription> {
 public:
@@ -36,14 +38,24 @@ public:
     virtual Subscriber& getSubscriber() = 0;
     virtual const Subscriber& getSubscriber() const = 0;
 
-    virtual MojErr sendEvent(ActivityEvent event) = 0;
+    /* The reply comes from (or is added to) replies shared with the
+     * Activity's other subscribers */
+    virtual MojErr sendEvent(ActivityEvent event, EventReplies& replies) = 0;
 
     MojErr queueEvent(ActivityEvent event);
+    MojErr queueEvent(ActivityEvent event, EventReplies& replies);
 
     void plug();
-    void unplug();
+    void unplug(EventReplies& replies);
     bool isPlugged() const;
 
+    /* Milliseconds during which "update" events collapse into one, sent
+     * with the latest details when the window ends.  Other events still go
+     * out right away, after any update held back before them.  0 (the
+     * default) sends every update. */
+    void setCoalesceWindow(unsigned milliseconds);
+    unsigned getCoalesceWindow() const;
+
     void handleCancelWrapper();
 
     bool operator<(const AbstractSubscription& rhs) const;
@@ -54,6 +66,12 @@ private:
 protected:
     virtual void handleCancel() = 0;
 
+    MojErr deliverEvent(ActivityEvent event, EventReplies& replies);
+
+    static gboolean windowCallback(gpointer data);
+    void openWindow();
+    void closeWindow();
+
     friend class Activity;
 
     typedef boost::intrusive::set_member_hook<boost::intrusive::link_mode<
@@ -64,6 +82,10 @@ protected:
     bool m_plugged;
     std::list<ActivityEvent> m_eventQueue;
 
+    unsigned m_coalesceWindow;
+    guint m_windowSource;
+    bool m_updatePending;
+
     std::weak_ptr<Activity> m_activity;
 };
 
@@ -0,0 +1,35 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __IPRESSURE_SOURCE_H__
+#define __IPRESSURE_SOURCE_H__
+
+/*
+ * Source of system load information for the adaptive concurrency controller.
+ *
+ * Pressure is reported as the percentage (0-100) of recent wall time that
+ * tasks were stalled waiting for the resource, as in /proc/pressure.
+ */
+class IPressureSource {
+public:
+    IPressureSource() {};
+    virtual ~IPressureSource() {};
+
+    /* Returns false if no pressure information is currently available */
+    virtual bool read(double& cpu, double& memory) = 0;
+};
+
+#endif /* __IPRESSURE_SOURCE_H__ */
@@ -0,0 +1,74 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "ProcPressureSource.h"
+
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+
+ProcPressureSource::ProcPressureSource()
+{
+}
+
+ProcPressureSource::~ProcPressureSource()
+{
+}
+
+bool ProcPressureSource::read(double& cpu, double& memory)
+{
+    if (!readPsi("/proc/pressure/cpu", cpu)) {
+        memory = 0;
+        return readLoadAvg(cpu);
+    }
+
+    if (!readPsi("/proc/pressure/memory", memory)) {
+        memory = 0;
+    }
+
+    return true;
+}
+
+bool ProcPressureSource::readPsi(const std::string& path, double& avg10)
+{
+    std::ifstream file(path.c_str());
+    std::string line;
+
+    /* some avg10=0.00 avg60=0.00 avg300=0.00 total=0 */
+    while (std::getline(file, line)) {
+        if (sscanf(line.c_str(), "some avg10=%lf", &avg10) == 1) {
+            return true;
+        }
+    }
+
+    return false;
+}
+
+bool ProcPressureSource::readLoadAvg(double& cpu)
+{
+    std::ifstream file("/proc/loadavg");
+    double load;
+
+    if (!(file >> load)) {
+        return false;
+    }
+
+    long online = sysconf(_SC_NPROCESSORS_ONLN);
+    double cpus = (online > 0) ? (double) online : 1.0;
+
+    cpu = (load > cpus) ? ((load - cpus) * 100.0 / load) : 0.0;
+    return true;
+}
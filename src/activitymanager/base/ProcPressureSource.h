@@ -0,0 +1,43 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __PROC_PRESSURE_SOURCE_H__
+#define __PROC_PRESSURE_SOURCE_H__
+
+#include <string>
+
+#include "base/IPressureSource.h"
+
+/*
+ * Reads pressure stall information from /proc/pressure/{cpu,memory}.
+ *
+ * Kernels without PSI fall back to /proc/loadavg: the share of runnable
+ * tasks in excess of the online CPUs stands in for CPU pressure, and memory
+ * pressure is reported as 0.
+ */
+class ProcPressureSource : public IPressureSource {
+public:
+    ProcPressureSource();
+    virtual ~ProcPressureSource();
+
+    virtual bool read(double& cpu, double& memory);
+
+protected:
+    static bool readPsi(const std::string& path, double& avg10);
+    static bool readLoadAvg(double& cpu);
+};
+
+#endif /* __PROC_PRESSURE_SOURCE_H__ */
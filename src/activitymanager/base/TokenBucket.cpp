@@ -0,0 +1,97 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "TokenBucket.h"
+
+#include <algorithm>
+#include <cmath>
+
+TokenBucket::TokenBucket(double rate, double burst)
+    : m_rate(0)
+    , m_burst(1)
+    , m_tokens(0)
+    , m_last(0)
+{
+    setRate(rate, burst);
+    m_tokens = m_burst;
+}
+
+TokenBucket::~TokenBucket()
+{
+}
+
+void TokenBucket::setRate(double rate, double burst)
+{
+    m_rate = std::max(rate, 0.0);
+    m_burst = std::max(burst, 1.0);
+    m_tokens = std::min(m_tokens, m_burst);
+}
+
+double TokenBucket::getRate() const
+{
+    return m_rate;
+}
+
+bool TokenBucket::isUnlimited() const
+{
+    return m_rate <= 0;
+}
+
+void TokenBucket::reset(int64_t now)
+{
+    m_tokens = m_burst;
+    m_last = now;
+}
+
+bool TokenBucket::tryConsume(int64_t now)
+{
+    if (isUnlimited()) {
+        return true;
+    }
+
+    m_tokens = tokensAt(now);
+    m_last = std::max(m_last, now);
+
+    if (m_tokens < 1.0) {
+        return false;
+    }
+
+    m_tokens -= 1.0;
+    return true;
+}
+
+unsigned int TokenBucket::getDelay(int64_t now) const
+{
+    if (isUnlimited()) {
+        return 0;
+    }
+
+    double tokens = tokensAt(now);
+    if (tokens >= 1.0) {
+        return 0;
+    }
+
+    return (unsigned int) std::ceil((1.0 - tokens) * 1000.0 / m_rate);
+}
+
+double TokenBucket::tokensAt(int64_t now) const
+{
+    if (now <= m_last) {
+        return m_tokens;
+    }
+
+    return std::min(m_burst, m_tokens + ((double) (now - m_last) * m_rate / 1000.0));
+}
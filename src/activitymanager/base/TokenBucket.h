@@ -0,0 +1,55 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __TOKEN_BUCKET_H__
+#define __TOKEN_BUCKET_H__
+
+#include <cstdint>
+
+/*
+ * Token bucket rate limiter.
+ *
+ * Tokens accrue at 'rate' per second, up to 'burst'.  A rate of 0 disables
+ * limiting.  Times are in milliseconds from any monotonic clock.
+ */
+class TokenBucket {
+public:
+    TokenBucket(double rate = 0, double burst = 1);
+    virtual ~TokenBucket();
+
+    void setRate(double rate, double burst);
+    double getRate() const;
+    bool isUnlimited() const;
+
+    /* Fill the bucket, as of 'now' */
+    void reset(int64_t now);
+
+    /* Take a token if one is available at 'now' */
+    bool tryConsume(int64_t now);
+
+    /* Milliseconds from 'now' until a token will be available */
+    unsigned int getDelay(int64_t now) const;
+
+protected:
+    double tokensAt(int64_t now) const;
+
+    double m_rate;
+    double m_burst;
+    double m_tokens;
+    int64_t m_last;
+};
+
+#endif /* __TOKEN_BUCKET_H__ */
@@ -28,9 +28,28 @@
 #include "util/SchemaResolver.h"
 
 Config::Config()
-    : m_failedLimitCount(0)
+    : m_generation(0)
+    , m_failedLimitCount(0)
     , m_restartLimitCount(0)
     , m_restartLimitInterval(0)
+    , m_priorityAgingInterval(kDefaultPriorityAgingInterval)
+    , m_transitionBatchSize(kDefaultTransitionBatchSize)
+    , m_activationRate(kDefaultActivationRate)
+    , m_activationBurst(kDefaultActivationBurst)
+    , m_leakSweepInterval(kDefaultLeakSweepInterval)
+    , m_permissionMaxInFlight(kDefaultPermissionMaxInFlight)
+    , m_permissionCheckTimeout(kDefaultPermissionCheckTimeout)
+    , m_permissionCacheSize(kDefaultPermissionCacheSize)
+    , m_permissionCacheTtl(kDefaultPermissionCacheTtl)
+    , m_specCacheSize(kDefaultSpecCacheSize)
+    , m_persistBatchSize(kDefaultPersistBatchSize)
+    , m_persistBatchDelay(kDefaultPersistBatchDelay)
+    , m_loadChunkSize(kDefaultLoadChunkSize)
+    , m_snapshotEnabled(true)
+    , m_snapshotInterval(kDefaultSnapshotInterval)
+    , m_stateDir(AM_STATE_DIR)
+    , m_fairShareDefaultWeight(1)
+    , m_preemptionPolicy("longest-running")
     , m_validateCallerEnabled(true)
 {
     load(CONFIG_BASE_PATH, false);
@@ -97,6 +116,180 @@ void Config::load(std::string filename, bool append)
             m_restartLimitInterval = restartLimit["interval-ms"].asNumber<int32_t>() / 1000.0;
         }
 
+        if (common.hasKey("priority-aging")) {
+            int agingInterval = common["priority-aging"]["interval-ms"].asNumber<int32_t>();
+            if (agingInterval >= 0) {
+                m_priorityAgingInterval = agingInterval;
+            }
+        }
+
+        if (common.hasKey("fair-share")) {
+            pbnjson::JValue fairShare = common["fair-share"];
+            if (fairShare.hasKey("default-weight")) {
+                int defaultWeight = fairShare["default-weight"].asNumber<int32_t>();
+                if (defaultWeight > 0) {
+                    m_fairShareDefaultWeight = defaultWeight;
+                }
+            }
+
+            pbnjson::JValue weights = fairShare["weights"];
+            if (weights.isObject()) {
+                for (pbnjson::JValue::KeyValue weight : weights.children()) {
+                    int value = weight.second.asNumber<int32_t>();
+                    if (value > 0) {
+                        m_fairShareWeights[weight.first.asString()] = value;
+                    }
+                }
+            }
+        }
+
+        if (common.hasKey("transition-dispatch")) {
+            int batchSize = common["transition-dispatch"]["batch-size"].asNumber<int32_t>();
+            if (batchSize >= 0) {
+                m_transitionBatchSize = batchSize;
+            }
+        }
+
+        if (common.hasKey("activation")) {
+            pbnjson::JValue activation = common["activation"];
+            if (activation.hasKey("rate")) {
+                int rate = activation["rate"].asNumber<int32_t>();
+                if (rate >= 0) {
+                    m_activationRate = rate;
+                }
+            }
+
+            if (activation.hasKey("burst")) {
+                int burst = activation["burst"].asNumber<int32_t>();
+                if (burst > 0) {
+                    m_activationBurst = burst;
+                }
+            }
+        }
+
+        if (common.hasKey("leak-sweep")) {
+            int interval = common["leak-sweep"]["interval-seconds"].asNumber<int32_t>();
+            if (interval > 0) {
+                m_leakSweepInterval = interval;
+            }
+        }
+
+        if (common.hasKey("permission-check")) {
+            pbnjson::JValue permissionCheck = common["permission-check"];
+            if (permissionCheck.hasKey("max-in-flight")) {
+                int maxInFlight = permissionCheck["max-in-flight"].asNumber<int32_t>();
+                if (maxInFlight > 0) {
+                    m_permissionMaxInFlight = maxInFlight;
+                }
+            }
+
+            if (permissionCheck.hasKey("timeout-seconds")) {
+                int timeout = permissionCheck["timeout-seconds"].asNumber<int32_t>();
+                if (timeout > 0) {
+                    m_permissionCheckTimeout = timeout;
+                }
+            }
+        }
+
+        if (common.hasKey("permission-cache")) {
+            pbnjson::JValue permissionCache = common["permission-cache"];
+            if (permissionCache.hasKey("size")) {
+                int size = permissionCache["size"].asNumber<int32_t>();
+                if (size >= 0) {
+                    m_permissionCacheSize = size;
+                }
+            }
+
+            if (permissionCache.hasKey("ttl-seconds")) {
+                int ttl = permissionCache["ttl-seconds"].asNumber<int32_t>();
+                if (ttl > 0) {
+                    m_permissionCacheTtl = ttl;
+                }
+            }
+        }
+
+        if (common.hasKey("spec-cache")) {
+            int size = common["spec-cache"]["size"].asNumber<int32_t>();
+            if (size >= 0) {
+                m_specCacheSize = size;
+            }
+        }
+
+        if (common.hasKey("persist-batch")) {
+            pbnjson::JValue persistBatch = common["persist-batch"];
+            if (persistBatch.hasKey("size")) {
+                int size = persistBatch["size"].asNumber<int32_t>();
+                if (size >= 0) {
+                    m_persistBatchSize = size;
+                }
+            }
+
+            if (persistBatch.hasKey("delay-ms")) {
+                int delay = persistBatch["delay-ms"].asNumber<int32_t>();
+                if (delay >= 0) {
+                    m_persistBatchDelay = delay;
+                }
+            }
+        }
+
+        if (common.hasKey("startup-load")) {
+            pbnjson::JValue startupLoad = common["startup-load"];
+            if (startupLoad.hasKey("chunk-size")) {
+                int size = startupLoad["chunk-size"].asNumber<int32_t>();
+                if (size >= 0) {
+                    m_loadChunkSize = size;
+                }
+            }
+        }
+
+        if (common.hasKey("snapshot")) {
+            pbnjson::JValue snapshot = common["snapshot"];
+            if (snapshot.hasKey("enabled")) {
+                m_snapshotEnabled = snapshot["enabled"].asBool();
+            }
+
+            if (snapshot.hasKey("interval-seconds")) {
+                int interval = snapshot["interval-seconds"].asNumber<int32_t>();
+                if (interval >= 0) {
+                    m_snapshotInterval = interval;
+                }
+            }
+        }
+
+        if (common.hasKey("state")) {
+            pbnjson::JValue state = common["state"];
+            if (state.hasKey("dir")) {
+                std::string dir = state["dir"].asString();
+                if (!dir.empty()) {
+                    if (dir[dir.size() - 1] != '/') {
+                        dir += '/';
+                    }
+                    m_stateDir = dir;
+                }
+            }
+        }
+
+        if (common.hasKey("preemption")) {
+            pbnjson::JValue preemption = common["preemption"];
+            if (preemption.hasKey("policy")) {
+                m_preemptionPolicy = preemption["policy"].asString();
+            }
+
+            pbnjson::JValue yieldSeconds = preemption["yield-seconds"];
+            if (yieldSeconds.isObject()) {
+                for (pbnjson::JValue::KeyValue seconds : yieldSeconds.children()) {
+                    int value = seconds.second.asNumber<int32_t>();
+                    if (value > 0) {
+                        m_yieldSeconds[seconds.first.asString()] = value;
+                    }
+                }
+            }
+        }
+
+        if (common.hasKey("adaptive-concurrency")) {
+            loadConcurrencyInfo(common["adaptive-concurrency"]);
+        }
+
         if (common.hasKey("validate-caller")) {
             m_validateCallerEnabled = common["validate-caller"].asBool();
         }
@@ -127,6 +320,54 @@ void Config::load(std::string filename, bool append)
                     PMLOGJSON("params", MojoObjectJson(info->params).c_str()),
                     PMLOGJSON("where", MojoObjectJson(info->where).c_str()), "");
     }
+
+    m_generation++;
+}
+
+void Config::loadConcurrencyInfo(pbnjson::JValue concurrency)
+{
+    ConcurrencyInfo info = m_concurrencyInfo;
+
+    if (concurrency.hasKey("enabled")) {
+        info.enabled = concurrency["enabled"].asBool();
+    }
+
+    if (concurrency.hasKey("interval-seconds")) {
+        int interval = concurrency["interval-seconds"].asNumber<int32_t>();
+        if (interval > 0) {
+            info.intervalSeconds = interval;
+        }
+    }
+
+    if (concurrency.hasKey("background")) {
+        pbnjson::JValue background = concurrency["background"];
+        info.backgroundMin = background["min"].asNumber<int32_t>();
+        info.backgroundMax = background["max"].asNumber<int32_t>();
+    }
+
+    if (concurrency.hasKey("background-interactive")) {
+        pbnjson::JValue interactive = concurrency["background-interactive"];
+        info.interactiveMin = interactive["min"].asNumber<int32_t>();
+        info.interactiveMax = interactive["max"].asNumber<int32_t>();
+    }
+
+    if (concurrency.hasKey("pressure-high")) {
+        info.pressureHigh = concurrency["pressure-high"].asNumber<double>();
+    }
+
+    if (concurrency.hasKey("pressure-low")) {
+        info.pressureLow = concurrency["pressure-low"].asNumber<double>();
+    }
+
+    if ((info.backgroundMin < 1) || (info.backgroundMax < info.backgroundMin) ||
+            (info.interactiveMin < 1) || (info.interactiveMax < info.interactiveMin) ||
+            (info.pressureLow > info.pressureHigh)) {
+        LOG_AM_WARNING(MSGID_CONFIG_LOAD_FAIL, 0,
+                       "Invalid adaptive-concurrency configuration, ignoring");
+        return;
+    }
+
+    m_concurrencyInfo = info;
 }
 
 std::shared_ptr<RequirementInfo> Config::getRequirement(const std::string& name) const
@@ -160,6 +401,11 @@ MojObject Config::convertToMojObject(pbnjson::JValue&& jvalue)
     }
 }
 
+unsigned int Config::getGeneration() const
+{
+    return m_generation;
+}
+
 unsigned int Config::getFailedLimitCount() const
 {
     return m_failedLimitCount;
@@ -175,6 +421,111 @@ double Config::getRestartLimitInterval() const
     return m_restartLimitInterval;
 }
 
+unsigned int Config::getPriorityAgingInterval() const
+{
+    return m_priorityAgingInterval;
+}
+
+unsigned int Config::getTransitionBatchSize() const
+{
+    return m_transitionBatchSize;
+}
+
+unsigned int Config::getActivationRate() const
+{
+    return m_activationRate;
+}
+
+unsigned int Config::getActivationBurst() const
+{
+    return m_activationBurst;
+}
+
+unsigned int Config::getLeakSweepInterval() const
+{
+    return m_leakSweepInterval;
+}
+
+unsigned int Config::getPermissionMaxInFlight() const
+{
+    return m_permissionMaxInFlight;
+}
+
+unsigned int Config::getPermissionCheckTimeout() const
+{
+    return m_permissionCheckTimeout;
+}
+
+unsigned int Config::getPermissionCacheSize() const
+{
+    return m_permissionCacheSize;
+}
+
+unsigned int Config::getPermissionCacheTtl() const
+{
+    return m_permissionCacheTtl;
+}
+
+unsigned int Config::getSpecCacheSize() const
+{
+    return m_specCacheSize;
+}
+
+unsigned int Config::getPersistBatchSize() const
+{
+    return m_persistBatchSize;
+}
+
+unsigned int Config::getPersistBatchDelay() const
+{
+    return m_persistBatchDelay;
+}
+
+unsigned int Config::getLoadChunkSize() const
+{
+    return m_loadChunkSize;
+}
+
+bool Config::snapshotEnabled() const
+{
+    return m_snapshotEnabled;
+}
+
+unsigned int Config::getSnapshotInterval() const
+{
+    return m_snapshotInterval;
+}
+
+const std::string& Config::getStateDir() const
+{
+    return m_stateDir;
+}
+
+unsigned int Config::getFairShareDefaultWeight() const
+{
+    return m_fairShareDefaultWeight;
+}
+
+const std::map<std::string, unsigned int>& Config::getFairShareWeights() const
+{
+    return m_fairShareWeights;
+}
+
+const ConcurrencyInfo& Config::getConcurrencyInfo() const
+{
+    return m_concurrencyInfo;
+}
+
+const std::string& Config::getPreemptionPolicy() const
+{
+    return m_preemptionPolicy;
+}
+
+const std::map<std::string, unsigned int>& Config::getYieldSeconds() const
+{
+    return m_yieldSeconds;
+}
+
 bool Config::validateCallerEnabled() const
 {
     return m_validateCallerEnabled;
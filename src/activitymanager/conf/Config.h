@@ -18,6 +18,7 @@
 #define __CONFIG_H__
 
 #include <list>
+#include <map>
 #include <memory>
 #include <string>
 #include <vector>
@@ -55,18 +56,124 @@ struct RequirementInfo : public IStringify {
     }
 };
 
+/* Bounds and thresholds for the adaptive background concurrency levels */
+struct ConcurrencyInfo {
+    ConcurrencyInfo()
+        : enabled(false)
+        , intervalSeconds(5)
+        , backgroundMin(1)
+        , backgroundMax(1)
+        , interactiveMin(2)
+        , interactiveMax(2)
+        , pressureHigh(40)
+        , pressureLow(10)
+    {
+    }
+
+    bool enabled;
+    unsigned int intervalSeconds;
+    unsigned int backgroundMin;
+    unsigned int backgroundMax;
+    unsigned int interactiveMin;
+    unsigned int interactiveMax;
+
+    /* Stall percentages above which levels are cut, and below which they
+     * may grow */
+    double pressureHigh;
+    double pressureLow;
+};
+
 class Config {
 public:
     static Config& getInstance();
 
     static const char *kMonitorSocketAddress;
 
+    static const unsigned int kDefaultPriorityAgingInterval = 30000;
+    static const unsigned int kDefaultTransitionBatchSize = 64;
+    static const unsigned int kDefaultActivationRate = 50;
+    static const unsigned int kDefaultActivationBurst = 10;
+    static const unsigned int kDefaultLeakSweepInterval = 30;
+    static const unsigned int kDefaultPermissionMaxInFlight = 8;
+    static const unsigned int kDefaultPermissionCheckTimeout = 5;
+    static const unsigned int kDefaultPermissionCacheSize = 256;
+    static const unsigned int kDefaultPermissionCacheTtl = 300;
+    static const unsigned int kDefaultSpecCacheSize = 128;
+    static const unsigned int kDefaultPersistBatchSize = 32;
+    static const unsigned int kDefaultPersistBatchDelay = 5;
+    static const unsigned int kDefaultLoadChunkSize = 32;
+    static const unsigned int kDefaultSnapshotInterval = 300;
+
     void load(std::string filename, bool append = true);
 
+    /* Changes every time configuration is loaded, so anything derived from
+     * it can tell when to start over */
+    unsigned int getGeneration() const;
+
     unsigned int getFailedLimitCount() const;
     int getRestartLimitCount() const;
     double getRestartLimitInterval() const;
 
+    /* Milliseconds a ready Activity must wait to gain one priority level */
+    unsigned int getPriorityAgingInterval() const;
+
+    /* Maximum Activity transitions to dispatch per main loop iteration */
+    unsigned int getTransitionBatchSize() const;
+
+    /* Activities armed per second when scheduling is enabled (0 is
+     * unlimited), and how many may be armed at once */
+    unsigned int getActivationRate() const;
+    unsigned int getActivationBurst() const;
+
+    /* Seconds between sweeps for released Activities that are still
+     * referenced */
+    unsigned int getLeakSweepInterval() const;
+
+    /* Permission checks (isCallAllowed calls) allowed in flight at once,
+     * and seconds to wait for each */
+    unsigned int getPermissionMaxInFlight() const;
+    unsigned int getPermissionCheckTimeout() const;
+
+    /* Permission decisions remembered (0 disables the cache), and seconds
+     * each is trusted for */
+    unsigned int getPermissionCacheSize() const;
+    unsigned int getPermissionCacheTtl() const;
+
+    /* Parsed trigger, callback and schedule specs remembered, of each kind
+     * (0 disables the caches) */
+    unsigned int getSpecCacheSize() const;
+
+    /* Stores put to MojoDB together at most (1 or less puts each on its
+     * own), and milliseconds the first of them may wait for the others */
+    unsigned int getPersistBatchSize() const;
+    unsigned int getPersistBatchDelay() const;
+
+    /* Persisted Activities set up per main loop iteration while loading
+     * them at startup (0 sets up each page at once) */
+    unsigned int getLoadChunkSize() const;
+
+    /* Whether persisted Activities are also kept in a local snapshot, to
+     * start from before MojoDB has been read, and seconds between writes
+     * of it (0 writes it only at shutdown) */
+    bool snapshotEnabled() const;
+    unsigned int getSnapshotInterval() const;
+
+    /* Directory the service keeps its own state in, such as the snapshot
+     * and the Activity ID high-water mark, with a trailing '/' */
+    const std::string& getStateDir() const;
+
+    /* Background run slot weights, by creator app or service id */
+    unsigned int getFairShareDefaultWeight() const;
+    const std::map<std::string, unsigned int>& getFairShareWeights() const;
+
+    const ConcurrencyInfo& getConcurrencyInfo() const;
+
+    /* Background interactive preemption policy name, and seconds between
+     * yield requests by policy name (policies not listed use their own
+     * default) */
+    const std::string& getPreemptionPolicy() const;
+    const std::map<std::string, unsigned int>& getYieldSeconds() const;
+
     /** should check null */
     std::shared_ptr<RequirementInfo> getRequirement(const std::string& name) const;
     std::list<std::shared_ptr<RequirementInfo>> getRequirements() const;
@@ -81,10 +188,33 @@ private:
     static MojObject convertToMojObject(pbnjson::JValue&& jvalue);
 
     void clear();
+    void loadConcurrencyInfo(pbnjson::JValue concurrency);
 
+    unsigned int m_generation;
     unsigned int m_failedLimitCount;
     int m_restartLimitCount;
     double m_restartLimitInterval;
+    unsigned int m_priorityAgingInterval;
+    unsigned int m_transitionBatchSize;
+    unsigned int m_activationRate;
+    unsigned int m_activationBurst;
+    unsigned int m_leakSweepInterval;
+    unsigned int m_permissionMaxInFlight;
+    unsigned int m_permissionCheckTimeout;
+    unsigned int m_permissionCacheSize;
+    unsigned int m_permissionCacheTtl;
+    unsigned int m_specCacheSize;
+    unsigned int m_persistBatchSize;
+    unsigned int m_persistBatchDelay;
+    unsigned int m_loadChunkSize;
+    bool m_snapshotEnabled;
+    unsigned int m_snapshotInterval;
+    std::string m_stateDir;
+    unsigned int m_fairShareDefaultWeight;
+    std::map<std::string, unsigned int> m_fairShareWeights;
+    ConcurrencyInfo m_concurrencyInfo;
+    std::string m_preemptionPolicy;
+    std::map<std::string, unsigned int> m_yieldSeconds;
     std::list<std::shared_ptr<RequirementInfo>> m_requirements;
     bool m_validateCallerEnabled;
 };
@@ -28,6 +28,7 @@ AbstractPersistCommand::AbstractPersistCommand(std::shared_ptr<Activity> activit
                                                std::shared_ptr<ICompletion> completion)
     : m_activity(activity)
     , m_completion(completion)
+    , m_issued(false)
 {
 }
 
@@ -49,6 +50,24 @@ std::string AbstractPersistCommand::getString() const
     }
 }
 
+bool AbstractPersistCommand::absorb(std::shared_ptr<ICompletion> completion)
+{
+    if (m_issued || m_next || !isStore()) {
+        return false;
+    }
+
+    LOG_AM_DEBUG("[Activity %llu] [PersistCommand %s]: Absorbing later store",
+                 m_activity->getId(), getString().c_str());
+
+    m_absorbed.push_back(completion);
+    return true;
+}
+
+bool AbstractPersistCommand::isStore() const
+{
+    return false;
+}
+
 /* Append the new command to the end of the command chain that this
  * command is a member of. */
 void AbstractPersistCommand::append(std::shared_ptr<AbstractPersistCommand> command)
@@ -82,21 +101,12 @@ void AbstractPersistCommand::complete(bool success)
 
     /* All steps of Complete must execute, including launching the next
      * command in the chain.  All exceptions must be handled locally. */
-    try {
-        m_completion->complete(success);
-    } catch (const std::exception& except) {
-        LOG_AM_WARNING(MSGID_CMD_COMPLETE_EXCEPTION, 3,
-                       PMLOGKFV("activity", "%llu" ,m_activity->getId()),
-                       PMLOGKS("persist_command", getString().c_str()),
-                       PMLOGKS("exception", except.what()),
-                       "Unexpected exception while trying to complete");
-    } catch (...) {
-        LOG_AM_WARNING(MSGID_CMD_COMPLETE_EXCEPTION, 2,
-                       PMLOGKFV("activity", "%llu", m_activity->getId()),
-                       PMLOGKS("persist_command", getString().c_str()),
-                       "exception while trying to complete");
+    runCompletion(m_completion, success);
 
+    for (size_t i = 0; i < m_absorbed.size(); ++i) {
+        runCompletion(m_absorbed[i], success);
     }
+    m_absorbed.clear();
 
     /* Tricky order here.  Unhooking this command will probably destroy it,
      * so we have to pick up a local reference to the next command in the
@@ -131,6 +141,25 @@ void AbstractPersistCommand::complete(bool success)
     }
 }
 
+void AbstractPersistCommand::runCompletion(std::shared_ptr<ICompletion> completion, bool success)
+{
+    try {
+        completion->complete(success);
+    } catch (const std::exception& except) {
+        LOG_AM_WARNING(MSGID_CMD_COMPLETE_EXCEPTION, 3,
+                       PMLOGKFV("activity", "%llu" ,m_activity->getId()),
+                       PMLOGKS("persist_command", getString().c_str()),
+                       PMLOGKS("exception", except.what()),
+                       "Unexpected exception while trying to complete");
+    } catch (...) {
+        LOG_AM_WARNING(MSGID_CMD_COMPLETE_EXCEPTION, 2,
+                       PMLOGKFV("activity", "%llu", m_activity->getId()),
+                       PMLOGKS("persist_command", getString().c_str()),
+                       "exception while trying to complete");
+
+    }
+}
+
 void AbstractPersistCommand::validate(bool checkTokenValid) const
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
@@ -17,6 +17,8 @@
 #ifndef __ABSTRACT_PERSIST_COMMAND_H__
 #define __ABSTRACT_PERSIST_COMMAND_H__
 
+#include <vector>
+
 #include <db/ICompletion.h>
 #include "Main.h"
 
@@ -57,18 +59,35 @@ public:
      * it may have been updated (or removed) by preceeding PersistCommands. */
     virtual void persist() = 0;
 
+    /* Takes on the completion of a later store of the same Activity.  Only
+     * a store that hasn't been issued and is last in its chain can: it
+     * serializes the Activity when issued, so it will write the later
+     * state anyway.  Returns false if the caller should chain its own
+     * command instead. */
+    bool absorb(std::shared_ptr<ICompletion> completion);
+
 protected:
     virtual std::string getMethod() const = 0;
+    virtual bool isStore() const;
+
     /* Specific subclass command implementation should call Complete once
      * the command has finished.  Non-virtual because it shouldn't be
      * overridden. */
     void complete(bool success);
     void validate(bool checkTokenValid) const;
 
+    void runCompletion(std::shared_ptr<ICompletion> completion, bool success);
+
 protected:
     std::shared_ptr<Activity> m_activity;
     std::shared_ptr<ICompletion> m_completion;
 
+    /* Completions of later stores folded into this one, in order */
+    std::vector<std::shared_ptr<ICompletion> > m_absorbed;
+
+    /* Set once the command has been issued (and its parameters built) */
+    bool m_issued;
+
     std::shared_ptr<AbstractPersistCommand> m_next;
 
     static MojLogger s_log;
@@ -0,0 +1,515 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <db/DB8BatchCommand.h>
+#include <db/DB8Manager.h>
+#include <stdexcept>
+
+#include "PersistTokenDB.h"
+#include "conf/ActivityJson.h"
+#include "util/Logging.h"
+#include "util/MojoObjectJson.h"
+#include "util/MojoObjectString.h"
+
+DB8BatchCommand::DB8BatchCommand(std::shared_ptr<DB8Batch> batch,
+                                 std::shared_ptr<Activity> activity,
+                                 std::shared_ptr<ICompletion> completion)
+    : AbstractPersistCommand(activity, completion)
+    , m_batch(batch)
+    , m_ready(false)
+{
+}
+
+DB8BatchCommand::~DB8BatchCommand()
+{
+}
+
+void DB8BatchCommand::persist()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("[Activity %llu] [PersistCommand %s]: Ready to issue with batch",
+                 m_activity->getId(), getString().c_str());
+
+    if (m_ready) {
+        return;
+    }
+
+    m_ready = true;
+    m_issued = true;
+    m_batch->commandReady();
+}
+
+bool DB8BatchCommand::isStore() const
+{
+    return m_batch && (m_batch->getType() == AbstractPersistManager::StoreCommandType);
+}
+
+std::string DB8BatchCommand::getMethod() const
+{
+    if (m_batch->getType() == AbstractPersistManager::DeleteCommandType) {
+        return "BatchDelete";
+    } else {
+        return "BatchStore";
+    }
+}
+
+DB8Batch::DB8Batch(AbstractPersistManager::CommandType type)
+    : m_type(type)
+    , m_readyCount(0)
+    , m_sealed(false)
+    , m_issuing(false)
+    , m_merging(false)
+{
+    if ((type != AbstractPersistManager::StoreCommandType) &&
+            (type != AbstractPersistManager::DeleteCommandType)) {
+        throw std::runtime_error("Only store and delete commands can be batched");
+    }
+}
+
+DB8Batch::~DB8Batch()
+{
+}
+
+AbstractPersistManager::CommandType DB8Batch::getType() const
+{
+    return m_type;
+}
+
+std::shared_ptr<AbstractPersistCommand> DB8Batch::prepareCommand(
+        std::shared_ptr<Activity> activity, std::shared_ptr<ICompletion> completion)
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("Preparing batched command for [Activity %llu]", activity->getId());
+
+    if (m_sealed) {
+        throw std::runtime_error("Attempt to add a command to a sealed batch");
+    }
+
+    /* A second command for the same Activity would be chained behind the
+     * first, and wait for the batch that the first is waiting on */
+    for (CommandList::iterator iter = m_commands.begin() ; iter != m_commands.end() ; ++iter) {
+        if ((*iter)->m_activity == activity) {
+            throw std::runtime_error("Activity is already part of this batch");
+        }
+    }
+
+    std::shared_ptr<DB8BatchCommand> cmd =
+            std::make_shared<DB8BatchCommand>(shared_from_this(), activity, completion);
+    m_commands.push_back(cmd);
+
+    return cmd;
+}
+
+void DB8Batch::adoptCommand(std::shared_ptr<DB8BatchCommand> cmd)
+{
+    if (m_sealed) {
+        throw std::runtime_error("Attempt to add a command to a sealed batch");
+    }
+
+    cmd->m_batch = shared_from_this();
+    cmd->m_ready = true;
+    cmd->m_issued = true;
+    m_commands.push_back(cmd);
+    m_readyCount++;
+}
+
+void DB8Batch::seal()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    m_sealed = true;
+    issueIfReady();
+}
+
+size_t DB8Batch::size() const
+{
+    return m_commands.size();
+}
+
+void DB8Batch::commandReady()
+{
+    m_readyCount++;
+    issueIfReady();
+}
+
+void DB8Batch::issueIfReady()
+{
+    if (!m_sealed || m_issuing || m_call || (m_readyCount < m_commands.size())) {
+        return;
+    }
+
+    if (m_commands.empty()) {
+        return;
+    }
+
+    LOG_AM_DEBUG("Issuing batched %s for %zu Activities",
+                 (m_type == AbstractPersistManager::DeleteCommandType) ? "delete" : "store",
+                 m_commands.size());
+
+    /* Commands that can't be issued fail on their own; completing them runs
+     * the next command in their chain, which mustn't re-enter here. */
+    m_issuing = true;
+
+    MojObject params;
+    LunaURL method;
+
+    if (m_type == AbstractPersistManager::DeleteCommandType) {
+        method = "luna://com.webos.service.db/del";
+        updateDeleteParams(params);
+    } else {
+        updateStoreParams(params);
+        method = m_merging ? "luna://com.webos.service.db/merge" : "luna://com.webos.service.db/put";
+    }
+
+    m_issuing = false;
+
+    if (m_issued.empty()) {
+        m_commands.clear();
+        return;
+    }
+
+    call(method, params);
+}
+
+void DB8Batch::call(const LunaURL& method, const MojObject& params)
+{
+    try {
+        m_call = std::make_shared<LunaWeakPtrCall<DB8Batch>>(
+                shared_from_this(), &DB8Batch::persistResponse, true, method, params);
+        m_call->call();
+    } catch (const std::exception& except) {
+        LOG_AM_ERROR(MSGID_PERSIST_ATMPT_UNEXPECTD_EXCPTN, 2,
+                     PMLOGKFV("count", "%zu", m_issued.size()),
+                     PMLOGKS("Exception", except.what()),
+                     "Unexpected exception while attempting to persist batch");
+        completeAll(false);
+    }
+}
+
+std::shared_ptr<DB8Batch> DB8Batch::createBatch() const
+{
+    return std::make_shared<DB8Batch>(m_type);
+}
+
+bool DB8Batch::isPermanentFailure(MojServiceMessage *msg, const MojObject& response,
+                                  MojErr err) const
+{
+    return LunaCall::isPermanentFailure(msg, response, err);
+}
+
+/* The batch merges only the changed properties if every Activity in it is
+ * known to be stored, and puts whole objects otherwise. */
+void DB8Batch::updateStoreParams(MojObject& params)
+{
+    MojObject objectsArray(MojObject::TypeArray);
+    MojObject deltasArray(MojObject::TypeArray);
+    bool merge = true;
+
+    for (CommandList::iterator iter = m_commands.begin() ; iter != m_commands.end() ; ++iter) {
+        std::shared_ptr<DB8BatchCommand> cmd = *iter;
+        std::shared_ptr<Activity> act = cmd->m_activity;
+
+        MojErr errs = MojErrNone;
+        MojObject rep;
+        MojObject delta;
+
+        try {
+            cmd->validate(false);
+
+            MojErr err = act->toJson(rep, ACTIVITY_JSON_PERSIST | ACTIVITY_JSON_DETAIL);
+            MojErrAccumulate(errs, err);
+
+            cmd->m_written = rep;
+
+            std::shared_ptr<PersistTokenDB> pt =
+                    std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(act->getPersistToken());
+
+            if (merge && !(pt && pt->getDelta(rep, delta))) {
+                merge = false;
+            }
+
+            if (pt && pt->isValid()) {
+                err = pt->toJson(rep);
+                MojErrAccumulate(errs, err);
+            }
+
+            err = rep.putString(_T("_kind"), DB8Manager::kActivityKind);
+            MojErrAccumulate(errs, err);
+        } catch (const std::exception& except) {
+            LOG_AM_WARNING(MSGID_PERSIST_CMD_VALIDATE_EXCEPTION, 3,
+                           PMLOGKFV("activity", "%llu", act->getId()),
+                           PMLOGKS("persist_command", cmd->getString().c_str()),
+                           PMLOGKS("exception", except.what()), "");
+            errs = MojErrInternal;
+        }
+
+        if (errs || objectsArray.push(rep)) {
+            LOG_AM_WARNING(MSGID_PERSIST_ATMPT_UNEXPECTD_EXCPTN, 3,
+                           PMLOGKFV("Activity", "%llu", act->getId()),
+                           PMLOGKS("PersistCommand", cmd->getString().c_str()),
+                           PMLOGKFV("err", "%d", errs),
+                           "Failed to add Activity to batched DB update query");
+            cmd->complete(false);
+            continue;
+        }
+
+        if (merge && deltasArray.push(delta)) {
+            merge = false;
+        }
+
+        m_issued.push_back(cmd);
+    }
+
+    m_merging = merge;
+
+    MojErr err = params.put(_T("objects"), m_merging ? deltasArray : objectsArray);
+    if (err) {
+        LOG_AM_WARNING(MSGID_PERSIST_ATMPT_UNEXPECTD_EXCPTN, 1,
+                       PMLOGKFV("err", "%d", err),
+                       "Failed to make batched DB update query");
+    }
+}
+
+/* Reissues a failed merge as a put of the whole objects, as they were when
+ * the merge was issued */
+void DB8Batch::reissueAsPut()
+{
+    MojErr errs = MojErrNone;
+    MojObject objectsArray(MojObject::TypeArray);
+
+    for (CommandList::iterator iter = m_issued.begin() ; iter != m_issued.end() ; ++iter) {
+        std::shared_ptr<DB8BatchCommand> cmd = *iter;
+        MojObject rep = cmd->m_written;
+
+        std::shared_ptr<PersistTokenDB> pt = std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(
+                cmd->m_activity->getPersistToken());
+        if (pt) {
+            pt->clearWritten();
+            if (pt->isValid()) {
+                /* Without the stale _rev, so the put overwrites */
+                MojErr err = rep.putString(_T("_id"), pt->getId());
+                MojErrAccumulate(errs, err);
+            }
+        }
+
+        MojErr err = rep.putString(_T("_kind"), DB8Manager::kActivityKind);
+        MojErrAccumulate(errs, err);
+
+        err = objectsArray.push(rep);
+        MojErrAccumulate(errs, err);
+    }
+
+    MojObject params;
+    MojErr err = params.put(_T("objects"), objectsArray);
+    MojErrAccumulate(errs, err);
+
+    if (errs) {
+        LOG_AM_WARNING(MSGID_PERSIST_ATMPT_UNEXPECTD_EXCPTN, 1,
+                       PMLOGKFV("err", "%d", errs),
+                       "Failed to make batched DB update query");
+        completeAll(false);
+        return;
+    }
+
+    m_merging = false;
+
+    /* This is still the failed call's callback, so hold on to it */
+    m_failedCall = m_call;
+
+    call("luna://com.webos.service.db/put", params);
+}
+
+/* MojoDB rejects a whole put or del over one bad object or id, so the
+ * commands in a failed batch are reissued each in a batch of its own.  Only
+ * the ones that fail again on their own report failure. */
+void DB8Batch::split()
+{
+    CommandList issued;
+    issued.swap(m_issued);
+    m_commands.clear();
+
+    /* This is still the failed call's callback, so hold on to it */
+    m_failedCall = m_call;
+    m_call.reset();
+
+    for (CommandList::iterator iter = issued.begin() ; iter != issued.end() ; ++iter) {
+        std::shared_ptr<DB8Batch> single = createBatch();
+        single->adoptCommand(*iter);
+        single->seal();
+    }
+}
+
+void DB8Batch::updateDeleteParams(MojObject& params)
+{
+    MojObject idsArray(MojObject::TypeArray);
+
+    for (CommandList::iterator iter = m_commands.begin() ; iter != m_commands.end() ; ++iter) {
+        std::shared_ptr<DB8BatchCommand> cmd = *iter;
+        std::shared_ptr<Activity> act = cmd->m_activity;
+
+        std::shared_ptr<PersistTokenDB> pt;
+
+        try {
+            cmd->validate(true);
+            pt = std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(act->getPersistToken());
+        } catch (const std::exception& except) {
+            LOG_AM_WARNING(MSGID_PERSIST_CMD_VALIDATE_EXCEPTION, 3,
+                           PMLOGKFV("activity", "%llu", act->getId()),
+                           PMLOGKS("persist_command", cmd->getString().c_str()),
+                           PMLOGKS("exception", except.what()), "");
+        }
+
+        if (!pt || idsArray.push(pt->getId())) {
+            cmd->complete(false);
+            continue;
+        }
+
+        m_issued.push_back(cmd);
+    }
+
+    MojErr err = params.put(_T("ids"), idsArray);
+    if (err) {
+        LOG_AM_WARNING(MSGID_PERSIST_ATMPT_UNEXPECTD_EXCPTN, 1,
+                       PMLOGKFV("err", "%d", err),
+                       "Failed to make batched DB delete query");
+    }
+}
+
+void DB8Batch::persistResponse(MojServiceMessage *msg, const MojObject& response, MojErr err)
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("Batched command for %zu Activities: Processing response %s",
+                 m_issued.size(), MojoObjectJson(response).c_str());
+
+    if (err) {
+        if (m_merging && DB8Manager::isRevisionMismatch(response, err)) {
+            LOG_AM_WARNING(MSGID_PERSIST_MERGE_FALLBACK, 2,
+                           PMLOGKFV("count", "%zu", m_issued.size()),
+                           PMLOGKS("Errtext", MojoObjectString(response, _T("errorText")).c_str()),
+                           "Stored Activity changed under the batched merge, storing whole Activities instead");
+            reissueAsPut();
+        } else if (isPermanentFailure(msg, response, err) && (m_issued.size() > 1)) {
+            LOG_AM_WARNING(MSGID_PERSIST_BATCH_SPLIT, 2,
+                           PMLOGKFV("count", "%zu", m_issued.size()),
+                           PMLOGKS("Errtext", MojoObjectString(response, _T("errorText")).c_str()),
+                           "Batch failed, issuing its Activities one at a time");
+            split();
+        } else if (isPermanentFailure(msg, response, err)) {
+            LOG_AM_WARNING(MSGID_PERSIST_CMD_RESP_FAIL, 3,
+                           PMLOGKFV("count", "%zu", m_issued.size()),
+                           PMLOGKS("Errtext", MojoObjectString(response, _T("errorText")).c_str()),
+                           PMLOGKFV("Errcode", "%d", (int)err), "");
+            completeAll(false);
+        } else {
+            LOG_AM_WARNING(MSGID_PERSIST_CMD_TRANSIENT_ERR, 1,
+                           PMLOGKFV("count", "%zu", m_issued.size()),
+                           "Batch failed with transient error, retrying: %s",
+                           MojoObjectJson(response).c_str());
+            m_call->call();
+        }
+        return;
+    }
+
+    if (m_type == AbstractPersistManager::StoreCommandType) {
+        storeResults(response);
+        return;
+    }
+
+    for (CommandList::iterator iter = m_issued.begin() ; iter != m_issued.end() ; ++iter) {
+        std::shared_ptr<PersistTokenDB> pt = std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(
+                (*iter)->m_activity->getPersistToken());
+        if (pt) {
+            pt->clear();
+        }
+    }
+
+    completeAll(true);
+}
+
+void DB8Batch::storeResults(const MojObject& response)
+{
+    MojObject resultArray;
+    if (!response.get(_T("results"), resultArray) ||
+            (resultArray.size() != m_issued.size())) {
+        LOG_AM_WARNING(MSGID_PERSIST_CMD_NO_RESULTS, 1,
+                       PMLOGKFV("count", "%zu", m_issued.size()),
+                       "Results of batched MojoDB persist command missing or incomplete");
+        completeAll(false);
+        return;
+    }
+
+    /* Results are in the order the objects were put */
+    CommandList issued;
+    issued.swap(m_issued);
+    m_commands.clear();
+
+    MojObject::ConstArrayIterator result = resultArray.arrayBegin();
+    for (CommandList::iterator iter = issued.begin() ; iter != issued.end() ; ++iter, ++result) {
+        std::shared_ptr<DB8BatchCommand> cmd = *iter;
+
+        MojString id;
+        MojInt64 rev;
+        bool found = false;
+
+        MojErr err = result->get(_T("id"), id, found);
+        if (err || !found || !result->get(_T("rev"), rev)) {
+            LOG_AM_WARNING(MSGID_PERSIST_CMD_NO_ID, 2,
+                           PMLOGKFV("activity", "%llu", cmd->m_activity->getId()),
+                           PMLOGKS("persist_command", cmd->getString().c_str()),
+                           "_id or _rev not found in batched MojoDB persist command response");
+            cmd->complete(false);
+            continue;
+        }
+
+        std::shared_ptr<PersistTokenDB> pt = std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(
+                cmd->m_activity->getPersistToken());
+        if (!pt) {
+            cmd->complete(false);
+            continue;
+        }
+
+        try {
+            if (!pt->isValid()) {
+                pt->set(id, rev);
+            } else {
+                pt->update(id, rev);
+            }
+            pt->setWritten(cmd->m_written);
+        } catch (...) {
+            LOG_AM_ERROR(MSGID_PERSIST_TOKEN_VAL_UPDATE_FAIL, 2,
+                         PMLOGKFV("activity", "%llu", cmd->m_activity->getId()),
+                         PMLOGKS("persist_command", cmd->getString().c_str()),
+                         "Failed to set or update value of persist token");
+            cmd->complete(false);
+            continue;
+        }
+
+        cmd->complete(true);
+    }
+}
+
+void DB8Batch::completeAll(bool success)
+{
+    /* The commands reference the batch, so drop them here to free it once
+     * they've been unhooked from their Activities */
+    CommandList issued;
+    issued.swap(m_issued);
+    m_commands.clear();
+
+    for (CommandList::iterator iter = issued.begin() ; iter != issued.end() ; ++iter) {
+        (*iter)->complete(success);
+    }
+}
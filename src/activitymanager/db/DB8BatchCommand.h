@@ -0,0 +1,131 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __DB8_BATCH_COMMAND_H__
+#define __DB8_BATCH_COMMAND_H__
+
+#include <vector>
+
+#include <core/MojService.h>
+#include <db/ICompletion.h>
+
+#include "activity/Activity.h"
+#include "base/LunaCall.h"
+#include "db/AbstractPersistCommand.h"
+#include "db/AbstractPersistManager.h"
+
+class DB8Batch;
+
+/*
+ * One Activity's part of a batched MojoDB command.
+ *
+ * It is hooked and chained like any other Persist Command.  When its turn
+ * comes it only tells the batch it's ready; it completes when the batch's
+ * shared call returns.
+ */
+class DB8BatchCommand: public AbstractPersistCommand {
+public:
+    DB8BatchCommand(std::shared_ptr<DB8Batch> batch,
+                    std::shared_ptr<Activity> activity,
+                    std::shared_ptr<ICompletion> completion);
+    virtual ~DB8BatchCommand();
+
+    virtual void persist();
+
+protected:
+    friend class DB8Batch;
+
+    virtual std::string getMethod() const;
+    virtual bool isStore() const;
+
+    std::shared_ptr<DB8Batch> m_batch;
+    bool m_ready;
+
+    /* The Activity's properties as stored, without the reserved ones */
+    MojObject m_written;
+};
+
+/*
+ * Stores (put) or deletes (del) a set of Activities in a single MojoDB call.
+ *
+ * Commands are prepared for each Activity, then the batch is sealed.  The
+ * call is issued once every command in it has reached its turn in its own
+ * Activity's command chain, so ordering against other commands on the same
+ * Activities is kept.  MojoDB applies a put or del atomically, so if the
+ * call fails, each command is reissued on its own and succeeds or fails
+ * by itself.
+ *
+ * A store batch whose Activities are all already stored merges just their
+ * changed properties instead, and falls back to a put if the merge fails.
+ */
+class DB8Batch: public std::enable_shared_from_this<DB8Batch> {
+public:
+    DB8Batch(AbstractPersistManager::CommandType type);
+    virtual ~DB8Batch();
+
+    AbstractPersistManager::CommandType getType() const;
+
+    std::shared_ptr<AbstractPersistCommand> prepareCommand(
+            std::shared_ptr<Activity> activity, std::shared_ptr<ICompletion> completion);
+
+    /* Adds a command made elsewhere that's already had its turn, such as a
+     * queued store */
+    void adoptCommand(std::shared_ptr<DB8BatchCommand> cmd);
+
+    /* No more commands will be prepared */
+    void seal();
+
+    size_t size() const;
+
+protected:
+    friend class DB8BatchCommand;
+
+    void commandReady();
+    void issueIfReady();
+
+    /* Makes the MojoDB call, or the batch a split-off command goes in */
+    virtual void call(const LunaURL& method, const MojObject& params);
+    virtual std::shared_ptr<DB8Batch> createBatch() const;
+    virtual bool isPermanentFailure(MojServiceMessage *msg, const MojObject& response,
+                                    MojErr err) const;
+
+    void updateStoreParams(MojObject& params);
+    void reissueAsPut();
+    void split();
+    void updateDeleteParams(MojObject& params);
+    void persistResponse(MojServiceMessage *msg, const MojObject& response, MojErr err);
+    void storeResults(const MojObject& response);
+    void completeAll(bool success);
+
+    typedef std::vector<std::shared_ptr<DB8BatchCommand> > CommandList;
+
+    AbstractPersistManager::CommandType m_type;
+
+    /* Commands prepared, and those that made it into the call, in the
+     * order of the call's objects or ids */
+    CommandList m_commands;
+    CommandList m_issued;
+
+    size_t m_readyCount;
+    bool m_sealed;
+    bool m_issuing;
+    bool m_merging;
+
+    std::shared_ptr<LunaCall> m_call;
+    std::shared_ptr<LunaCall> m_failedCall;
+};
+
+#endif /* __DB8_BATCH_COMMAND_H__ */
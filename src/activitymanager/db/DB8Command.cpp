@@ -39,6 +39,8 @@ void DB8Command::persist()
     LOG_AM_DEBUG("[Activity %llu] [PersistCommand %s]: Issuing",
                  m_activity->getId(), getString().c_str());
 
+    m_issued = true;
+
     /* Perform update of Parameters, if desired - modify copy, not original,
      * to ensure old data isn't retained between calls */
     try {
@@ -28,9 +28,24 @@ public:
 
 protected:
     virtual std::string getMethod() const;
+    virtual bool isStore() const;
 
     virtual void updateParams(MojObject& params);
     virtual void persistResponse(MojServiceMessage *msg, const MojObject& response, MojErr err);
+
+    static const char *kPutMethod;
+    static const char *kMergeMethod;
+
+    /* Whether the call in flight is a merge; forcePut is set after a merge
+     * is refused for a stale _rev, so the retry puts the whole Activity
+     * without one */
+    bool m_merging;
+    bool m_forcePut;
+
+    /* The Activity's properties as sent, without the reserved ones */
+    MojObject m_written;
+
+    std::shared_ptr<LunaCall> m_failedCall;
 };
 
 class DB8DeleteCommand: public DB8Command {
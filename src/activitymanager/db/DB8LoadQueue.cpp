@@ -0,0 +1,206 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "db/DB8LoadQueue.h"
+
+#include "util/Logging.h"
+
+DB8LoadQueue::DB8LoadQueue(LoadCallback load, DoneCallback done)
+    : m_load(load)
+    , m_done(done)
+    , m_chunkSize(0)
+    , m_pending(0)
+    , m_last(false)
+    , m_source(0)
+    , m_pageCount(0)
+    , m_loaded(0)
+    , m_chunks(0)
+    , m_started(0)
+    , m_firstPage(0)
+    , m_duration(0)
+    , m_longestChunk(0)
+{
+}
+
+DB8LoadQueue::~DB8LoadQueue()
+{
+    if (m_source) {
+        g_source_remove(m_source);
+    }
+}
+
+void DB8LoadQueue::start(size_t chunkSize)
+{
+    cancel();
+
+    m_chunkSize = chunkSize;
+    m_pageCount = 0;
+    m_loaded = 0;
+    m_chunks = 0;
+    m_started = g_get_monotonic_time();
+    m_firstPage = 0;
+    m_duration = 0;
+    m_longestChunk = 0;
+}
+
+void DB8LoadQueue::addPage(const MojObject& results, bool last)
+{
+    LOG_AM_DEBUG("Queuing page of %zu loaded Activities%s",
+                 (size_t) results.size(), last ? " (last)" : "");
+
+    if (m_pageCount++ == 0) {
+        m_firstPage = g_get_monotonic_time() - m_started;
+    }
+
+    m_pages.push_back(results);
+    if (m_pages.size() == 1) {
+        m_next = m_pages.front().arrayBegin();
+    }
+
+    m_pending += results.size();
+    m_last = last;
+
+    schedule();
+}
+
+void DB8LoadQueue::cancel()
+{
+    if (m_source) {
+        g_source_remove(m_source);
+        m_source = 0;
+    }
+
+    m_pages.clear();
+    m_pending = 0;
+    m_last = false;
+}
+
+size_t DB8LoadQueue::getPending() const
+{
+    return m_pending;
+}
+
+void DB8LoadQueue::schedule()
+{
+    /* Idle priority, so replies (the next page among them) come first */
+    if (!m_source) {
+        m_source = g_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
+                                   &DB8LoadQueue::processCallback, this, NULL);
+    }
+}
+
+gboolean DB8LoadQueue::processCallback(gpointer data)
+{
+    DB8LoadQueue *self = static_cast<DB8LoadQueue *>(data);
+
+    self->m_source = 0;
+    self->process();
+
+    return G_SOURCE_REMOVE;
+}
+
+void DB8LoadQueue::process()
+{
+    int64_t begin = g_get_monotonic_time();
+    size_t count = 0;
+
+    while (!m_pages.empty()) {
+        if (m_next == m_pages.front().arrayEnd()) {
+            m_pages.pop_front();
+            if (!m_pages.empty()) {
+                m_next = m_pages.front().arrayBegin();
+            }
+
+            /* Without a chunk size, a chunk is a page */
+            if (!m_chunkSize && count) {
+                break;
+            }
+            continue;
+        }
+
+        if (m_chunkSize && (count >= m_chunkSize)) {
+            break;
+        }
+
+        const MojObject& rep = *m_next;
+        ++m_next;
+        --m_pending;
+        ++count;
+
+        m_load(rep);
+    }
+
+    m_loaded += count;
+    m_chunks++;
+
+    int64_t elapsed = g_get_monotonic_time() - begin;
+    if (elapsed > m_longestChunk) {
+        m_longestChunk = elapsed;
+    }
+
+    if (!m_pages.empty()) {
+        schedule();
+    } else if (m_last) {
+        finish();
+    }
+}
+
+void DB8LoadQueue::finish()
+{
+    m_last = false;
+    m_duration = g_get_monotonic_time() - m_started;
+
+    LOG_AM_DEBUG("Set up %lu loaded Activities from %lu pages in %lld ms",
+                 m_loaded, m_pageCount, (long long) (m_duration / 1000));
+
+    m_done();
+}
+
+MojErr DB8LoadQueue::infoToJson(MojObject& rep) const
+{
+    MojErr err;
+    MojObject load(MojObject::TypeObject);
+
+    err = load.putInt(_T("chunkSize"), (MojInt64) m_chunkSize);
+    MojErrCheck(err);
+
+    err = load.putInt(_T("pages"), (MojInt64) m_pageCount);
+    MojErrCheck(err);
+
+    err = load.putInt(_T("activities"), (MojInt64) m_loaded);
+    MojErrCheck(err);
+
+    err = load.putInt(_T("pending"), (MojInt64) m_pending);
+    MojErrCheck(err);
+
+    err = load.putInt(_T("chunks"), (MojInt64) m_chunks);
+    MojErrCheck(err);
+
+    err = load.putInt(_T("firstPageMs"), m_firstPage / 1000);
+    MojErrCheck(err);
+
+    err = load.putInt(_T("durationMs"), m_duration / 1000);
+    MojErrCheck(err);
+
+    err = load.putInt(_T("longestChunkUs"), m_longestChunk);
+    MojErrCheck(err);
+
+    err = rep.put(_T("startupLoad"), load);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
@@ -0,0 +1,89 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __DB8_LOAD_QUEUE_H__
+#define __DB8_LOAD_QUEUE_H__
+
+#include <deque>
+#include <functional>
+#include <glib.h>
+
+#include <core/MojObject.h>
+
+/*
+ * Sets up Activities loaded from MojoDB a chunk at a time.
+ *
+ * Pages of results are queued as they arrive, so the next page can be
+ * fetched while the ones before it are still being set up.  Each main loop
+ * iteration sets up at most a chunk of Activities from the queue, leaving
+ * bus traffic (including the next page) to be handled in between.  Once
+ * the last page has been set up, the done callback runs.
+ */
+class DB8LoadQueue {
+public:
+    typedef std::function<void (const MojObject& rep)> LoadCallback;
+    typedef std::function<void ()> DoneCallback;
+
+    DB8LoadQueue(LoadCallback load, DoneCallback done);
+    virtual ~DB8LoadQueue();
+
+    /* Starts a new load.  A chunk size of 0 sets up each page at once. */
+    void start(size_t chunkSize);
+
+    /* Queues a page of results; last if no page follows it */
+    void addPage(const MojObject& results, bool last);
+
+    /* Drops whatever hasn't been set up yet, without finishing */
+    void cancel();
+
+    size_t getPending() const;
+
+    MojErr infoToJson(MojObject& rep) const;
+
+protected:
+    static gboolean processCallback(gpointer data);
+
+    void schedule();
+    void process();
+    void finish();
+
+    LoadCallback m_load;
+    DoneCallback m_done;
+
+    size_t m_chunkSize;
+
+    /* Pages still to be set up.  m_next is the next result in the first. */
+    std::deque<MojObject> m_pages;
+    MojObject::ConstArrayIterator m_next;
+    size_t m_pending;
+    bool m_last;
+
+    guint m_source;
+
+    unsigned long m_pageCount;
+    unsigned long m_loaded;
+    unsigned long m_chunks;
+
+    /* Microseconds: start of the load, until the first page arrived,
+     * the whole load, and the longest chunk */
+    int64_t m_started;
+    int64_t m_firstPage;
+    int64_t m_duration;
+    int64_t m_longestChunk;
+};
+
+#endif /* __DB8_LOAD_QUEUE_H__ */
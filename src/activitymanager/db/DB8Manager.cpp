@@ -21,6 +21,8 @@
 #include <db/MojDbQuery.h>
 
 #include "conf/ActivityJson.h"
+#include "conf/Config.h"
+#include "conf/Environment.h"
 #include "service/BusConnection.h"
 #include "util/Logging.h"
 
@@ -28,13 +30,32 @@ const char *DB8Manager::kActivityKind = _T("com.webos.service.activity:1");
 
 const int DB8Manager::kPurgeBatchSize = MojDbQuery::MaxQueryLimit;
 
+/* MojErrDbRevisionMismatch */
+const MojErr DB8Manager::kRevisionMismatch = (MojErr) -3961;
+
 DB8Manager::DB8Manager()
     : m_listener(NULL)
+    , m_storeQueue(std::make_shared<DB8StoreQueue>())
+    , m_absorbedStores(0)
+    , m_loadQueue(std::bind(&DB8Manager::reconcileActivity, this, std::placeholders::_1),
+                  std::bind(&DB8Manager::activityLoadFinished, this))
+    , m_snapshot(Config::getInstance().getStateDir() + AM_SNAPSHOT_FILE)
+    , m_snapshotLoaded(false)
+    , m_loaded(false)
+    , m_snapshotReadySource(0)
+    , m_snapshotWriteSource(0)
 {
 }
 
 DB8Manager::~DB8Manager()
 {
+    if (m_snapshotReadySource) {
+        g_source_remove(m_snapshotReadySource);
+    }
+
+    if (m_snapshotWriteSource) {
+        g_source_remove(m_snapshotWriteSource);
+    }
 }
 
 std::shared_ptr<AbstractPersistCommand> DB8Manager::prepareStoreCommand(std::shared_ptr<Activity> activity,
@@ -43,6 +64,12 @@ std::shared_ptr<AbstractPersistCommand> DB8Manager::prepareStoreCommand(std::sha
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Preparing put command for [Activity %llu]", activity->getId());
 
+    unsigned int batchSize = Config::getInstance().getPersistBatchSize();
+    if (batchSize > 1) {
+        m_storeQueue->setLimits(batchSize, Config::getInstance().getPersistBatchDelay());
+        return m_storeQueue->prepareCommand(activity, completion);
+    }
+
     return std::make_shared<DB8StoreCommand>(activity, completion);
 }
 
@@ -55,6 +82,52 @@ std::shared_ptr<AbstractPersistCommand> DB8Manager::prepareDeleteCommand(std::sh
     return std::make_shared<DB8DeleteCommand>(activity, completion);
 }
 
+bool DB8Manager::absorbStore(std::shared_ptr<Activity> activity,
+                             std::shared_ptr<ICompletion> completion)
+{
+    std::shared_ptr<AbstractPersistCommand> last = activity->getLastPersistCommand();
+    if (!last || !last->absorb(completion)) {
+        return false;
+    }
+
+    m_absorbedStores++;
+    return true;
+}
+
+std::shared_ptr<DB8Batch> DB8Manager::prepareBatch(CommandType type)
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    return std::make_shared<DB8Batch>(type);
+}
+
+MojErr DB8Manager::infoToJson(MojObject& rep) const
+{
+    MojErr err = m_storeQueue->infoToJson(rep);
+    MojErrCheck(err);
+
+    err = rep.putInt(_T("storesAbsorbed"), (MojInt64) m_absorbedStores);
+    MojErrCheck(err);
+
+    err = m_loadQueue.infoToJson(rep);
+    MojErrCheck(err);
+
+    err = m_snapshot.infoToJson(rep);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
+
+bool DB8Manager::isRevisionMismatch(const MojObject& response, MojErr err)
+{
+    if (err == kRevisionMismatch) {
+        return true;
+    }
+
+    MojInt64 errorCode;
+    return response.get(_T("errorCode"), errorCode) && (errorCode == kRevisionMismatch);
+}
+
 std::shared_ptr<PersistToken> DB8Manager::createToken()
 {
     return std::make_shared<PersistTokenDB>();
@@ -79,6 +152,14 @@ void DB8Manager::loadActivities()
                        "Failed to make DB load query");
     }
 
+    m_loadQueue.start(Config::getInstance().getLoadChunkSize());
+
+    if (Config::getInstance().snapshotEnabled()) {
+        loadSnapshot();
+    } else {
+        m_snapshot.remove();
+    }
+
     m_call = std::make_shared<LunaPtrCall<DB8Manager>>(
             this,
             &DB8Manager::activityLoadResults,
@@ -106,7 +187,15 @@ void DB8Manager::activityLoadResults(MojServiceMessage *msg, const MojObject& re
             LOG_AM_ERROR(MSGID_LOAD_ACTIVITIES_FROM_DB_FAIL, 0,
                          "Uncorrectable error loading Activities from MojoDB: %s",
                          MojoObjectJson(response).c_str());
-            if (m_listener) m_listener->onFail();
+            m_loadQueue.cancel();
+
+            /* Already online, and running the Activities from the snapshot,
+             * which are the best there is now */
+            if (m_snapshotLoaded) {
+                m_snapshot.abandon();
+            } else if (m_listener) {
+                m_listener->onFail();
+            }
         } else {
             LOG_AM_WARNING(MSGID_ACTIVITIES_LOAD_ERR, 0,
                            "Error loading Activities from MojoDB, retrying: %s",
@@ -116,190 +205,25 @@ void DB8Manager::activityLoadResults(MojServiceMessage *msg, const MojObject& re
         return;
     }
 
-    /* Clear current call */
-    m_call.reset();
-
-    bool found;
-    MojErr err2;
     MojObject results;
-    found = response.get(_T("results"), results);
-
-    if (found) {
-        for (MojObject::ConstArrayIterator iter = results.arrayBegin() ;
-                iter != results.arrayEnd() ; ++iter) {
-            const MojObject& rep = *iter;
-            MojInt64 activityId;
-
-            bool found;
-            found = rep.get(_T("activityId"), activityId);
-            if (!found) {
-                LOG_AM_WARNING(MSGID_ACTIVITYID_NOT_FOUND, 0,
-                               "activityId not found loading Activities");
-                continue;
-            }
-
-            MojString id;
-            if (rep.get(_T("_id"), id, found)) {
-                LOG_AM_WARNING(MSGID_RETRIEVE_ID_FAIL, 0,
-                               "Error retrieving _id from results returned from MojoDB");
-                continue;
-            }
-
-            if (!found) {
-                LOG_AM_WARNING(MSGID_ID_NOT_FOUND, 0,
-                               "_id not found loading Activities from MojoDB");
-                continue;
-            }
-
-            MojInt64 rev;
-            found = rep.get(_T("_rev"), rev);
-            if (!found) {
-                LOG_AM_WARNING(MSGID_REV_NOT_FOUND, 0,
-                               "_rev not found loading Activities from MojoDB");
-                continue;
-            }
-
-            std::shared_ptr<PersistTokenDB> pt = std::make_shared<PersistTokenDB>(id, rev);
-
-            std::shared_ptr<Activity> act;
-
-            try {
-                act = ActivityExtractor::createActivity(rep, true);
-            } catch (const std::exception& except) {
-                LOG_AM_WARNING(MSGID_CREATE_ACTIVITY_EXCEPTION, 1,
-                               PMLOGKS("Exception",except.what()), "Activity: %s",
-                               MojoObjectJson(rep).c_str());
-                m_oldTokens.push_back(std::move(pt));
-                continue;
-            } catch (...) {
-                LOG_AM_WARNING(MSGID_UNKNOWN_EXCEPTION, 0,
-                               "Activity : %s. Unknown exception decoding encoded",
-                               MojoObjectJson(rep).c_str());
-                m_oldTokens.push_back(std::move(pt));
-                continue;
-            }
-            if (!act) {
-                return;
-            }
-            act->setPersistToken(pt);
-
-            /* Attempt to register this Activity's Id and Name, in order. */
-
-            try {
-                ActivityManager::getInstance().registerActivityId(act);
-            } catch (...) {
-                LOG_AM_ERROR(MSGID_ACTIVITY_ID_REG_FAIL, 1,
-                             PMLOGKFV("Activity", "%llu", act->getId()), "");
-
-                /* Another Activity is already registered.  Determine which
-                 * is newer, and kill the older one. */
-
-                std::shared_ptr<Activity> old = ActivityManager::getInstance().getActivity(act->getId());
-                std::shared_ptr<PersistTokenDB> oldPt =
-                        std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(old->getPersistToken());
-                if (oldPt && pt && act) {
-                    if (pt->getRev() > oldPt->getRev()) {
-                        LOG_AM_WARNING(
-                                MSGID_ACTIVITY_REPLACED,
-                                4,
-                                PMLOGKFV("Activity", "%llu", act->getId()),
-                                PMLOGKFV("revision", "%llu", (unsigned long long)pt->getRev()),
-                                PMLOGKFV("old_Activity", "%llu", old->getId()),
-                                PMLOGKFV("old_revision", "%llu", (unsigned long long)oldPt->getRev()),
-                                "");
-
-                        m_oldTokens.push_back(std::move(oldPt));
-                        ActivityManager::getInstance().unregisterActivityName(old);
-                        ActivityManager::getInstance().releaseActivity(old);
-
-                        ActivityManager::getInstance().registerActivityId(act);
-                    } else {
-                        LOG_AM_WARNING(
-                                MSGID_ACTIVITY_NOT_REPLACED,
-                                4,
-                                PMLOGKFV("Activity", "%llu", act->getId()),
-                                PMLOGKFV("revision", "%llu", (unsigned long long)pt->getRev()),
-                                PMLOGKFV("old_Activity", "%llu", old->getId()),
-                                PMLOGKFV("old_revision", "%llu", (unsigned long long)oldPt->getRev()),
-                                "");
-
-                        m_oldTokens.push_back(std::move(pt));
-                        ActivityManager::getInstance().releaseActivity(act);
-                        continue;
-                    }
-                }
-            }
-
-            try {
-                ActivityManager::getInstance().registerActivityName(act);
-            } catch (...) {
-                LOG_AM_ERROR(
-                        MSGID_ACTIVITY_NAME_REG_FAIL, 3,
-                        PMLOGKFV("Activity", "%llu", act->getId()),
-                        PMLOGKS("Creator_name", act->getCreator().getString().c_str()),
-                        PMLOGKS("Register_name", act->getName().c_str()), "");
-
-                /* Another Activity is already registered.  Determine which
-                 * is newer, and kill the older one. */
-
-                std::shared_ptr<Activity> old =
-                        ActivityManager::getInstance().getActivity(act->getName(), act->getCreator());
-
-                std::shared_ptr<PersistTokenDB> oldPt =
-                        std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(old->getPersistToken());
-                if (oldPt && pt && act) {
-                    if (pt->getRev() > oldPt->getRev()) {
-                        LOG_AM_WARNING(
-                                MSGID_ACTIVITY_REPLACED,
-                                4,
-                                PMLOGKFV("Activity","%llu",act->getId()),
-                                PMLOGKFV("revision","%llu", (unsigned long long)pt->getRev()),
-                                PMLOGKFV("old_Activity","%llu", old->getId()),
-                                PMLOGKFV("old_revision","%llu", (unsigned long long)oldPt->getRev()),
-                                "");
-
-                        m_oldTokens.push_back(std::move(oldPt));
-                        ActivityManager::getInstance().unregisterActivityName(old);
-                        ActivityManager::getInstance().releaseActivity(old);
-
-                        ActivityManager::getInstance().registerActivityName(act);
-                    } else {
-                        LOG_AM_WARNING(
-                                MSGID_ACTIVITY_NOT_REPLACED,
-                                4,
-                                PMLOGKFV("Activity","%llu", act->getId()),
-                                PMLOGKFV("revision","%llu", (unsigned long long)pt->getRev()),
-                                PMLOGKFV("old_Activity","%llu", old->getId()),
-                                PMLOGKFV("old_revision","%llu", (unsigned long long)oldPt->getRev()),
-                                "");
-
-                        m_oldTokens.push_back(std::move(pt));
-                        ActivityManager::getInstance().releaseActivity(act);
-                        continue;
-                    }
-                }
-            }
-
-            LOG_AM_DEBUG("[Activity %llu] (\"%s\"): _id %s, rev %llu loaded",
-                         act->getId(), act->getName().c_str(), id.data(),
-                         (unsigned long long )rev);
-
-            /* Request Activity be scheduled.  It won't transition to running
-             * until after the MojoDB load finishes (and the Activity Manager
-             * moves to the ready() and start()ed states). */
-            ActivityManager::getInstance().startActivity(act);
-        }
+    if (!response.get(_T("results"), results)) {
+        results = MojObject(MojObject::TypeArray);
     }
 
     MojString page;
+    bool found = false;
     MojErr errs = MojErrNone;
-    err2 = response.get(_T("page"), page, found);
+    MojErr err2 = response.get(_T("page"), page, found);
     if (err2) {
         LOG_AM_ERROR(MSGID_GET_PAGE_FAIL, 0,
                      "Error getting page parameter in MojoDB query response");
+        m_call.reset();
+        m_loadQueue.addPage(results, false);
         return;
     }
 
+    /* Ask for the next page before setting up this one, so MojoDB is busy
+     * finding it meanwhile */
     if (found) {
         LOG_AM_DEBUG("Preparing to request next page (\"%s\") of Activities",
                      page.data());
@@ -330,20 +254,355 @@ void DB8Manager::activityLoadResults(MojServiceMessage *msg, const MojObject& re
         m_call->call();
     } else {
         LOG_AM_DEBUG("All Activities successfully loaded from MojoDB");
+        m_call.reset();
+    }
 
-        if (!m_oldTokens.empty()) {
-            LOG_AM_DEBUG("Beginning purge of old Activities from database");
-            preparePurgeCall();
-            m_call->call();
+    m_loadQueue.addPage(results, !found);
+}
+
+void DB8Manager::reconcileActivity(const MojObject& rep)
+{
+    if (m_snapshotLoaded) {
+        std::shared_ptr<Activity> outdated;
+        if (!m_snapshot.reconcile(rep, outdated)) {
+            return;
+        }
+
+        if (outdated) {
+            LOG_AM_DEBUG("[Activity %llu] Replacing outdated Activity from snapshot",
+                         outdated->getId());
+            endActivity(outdated, true);
+        }
+    }
+
+    (void) loadActivity(rep);
+}
+
+/* Ends an Activity that's been set up, the way a client's cancel does: its
+ * subscribers are told, and its triggers, schedule and callback go with
+ * it.  One being replaced is released at once rather than when its end is
+ * dispatched, so the Activity replacing it can take its activityId. */
+void DB8Manager::endActivity(std::shared_ptr<Activity> act, bool replaced)
+{
+    act->plugAllSubscriptions();
+
+    ActivityManager::getInstance().cancelActivity(act);
+
+    if (act->isNameRegistered()) {
+        ActivityManager::getInstance().unregisterActivityName(act);
+    }
+
+    if (replaced) {
+        ActivityManager::getInstance().releaseActivity(act);
+    }
+
+    act->unplugAllSubscriptions();
+}
+
+/* A client's Activity created since the service went online, and not
+ * stored yet (or not persistent at all), has no revision to compare with
+ * one loaded from MojoDB */
+static bool isUnstored(const std::shared_ptr<PersistTokenDB>& pt)
+{
+    return !pt || !pt->isValid();
+}
+
+std::shared_ptr<Activity> DB8Manager::loadActivity(const MojObject& rep)
+{
+    MojInt64 activityId;
+
+    bool found;
+    found = rep.get(_T("activityId"), activityId);
+    if (!found) {
+        LOG_AM_WARNING(MSGID_ACTIVITYID_NOT_FOUND, 0,
+                       "activityId not found loading Activities");
+        return nullptr;
+    }
+
+    MojString id;
+    if (rep.get(_T("_id"), id, found)) {
+        LOG_AM_WARNING(MSGID_RETRIEVE_ID_FAIL, 0,
+                       "Error retrieving _id from results returned from MojoDB");
+        return nullptr;
+    }
+
+    if (!found) {
+        LOG_AM_WARNING(MSGID_ID_NOT_FOUND, 0,
+                       "_id not found loading Activities from MojoDB");
+        return nullptr;
+    }
+
+    MojInt64 rev;
+    found = rep.get(_T("_rev"), rev);
+    if (!found) {
+        LOG_AM_WARNING(MSGID_REV_NOT_FOUND, 0,
+                       "_rev not found loading Activities from MojoDB");
+        return nullptr;
+    }
+
+    std::shared_ptr<PersistTokenDB> pt = std::make_shared<PersistTokenDB>(id, rev);
+
+    std::shared_ptr<Activity> act;
+
+    try {
+        act = ActivityExtractor::createActivity(rep, true);
+    } catch (const std::exception& except) {
+        LOG_AM_WARNING(MSGID_CREATE_ACTIVITY_EXCEPTION, 1,
+                       PMLOGKS("Exception",except.what()), "Activity: %s",
+                       MojoObjectJson(rep).c_str());
+        m_oldTokens.push_back(std::move(pt));
+        return nullptr;
+    } catch (...) {
+        LOG_AM_WARNING(MSGID_UNKNOWN_EXCEPTION, 0,
+                       "Activity : %s. Unknown exception decoding encoded",
+                       MojoObjectJson(rep).c_str());
+        m_oldTokens.push_back(std::move(pt));
+        return nullptr;
+    }
+    if (!act) {
+        return nullptr;
+    }
+    act->setPersistToken(pt);
+
+    /* Stored as read, so the first store after can merge its changes */
+    pt->setWritten(rep);
+
+    /* Attempt to register this Activity's Id and Name, in order. */
+
+    try {
+        ActivityManager::getInstance().registerActivityId(act);
+    } catch (...) {
+        LOG_AM_ERROR(MSGID_ACTIVITY_ID_REG_FAIL, 1,
+                     PMLOGKFV("Activity", "%llu", act->getId()), "");
+
+        /* Another Activity is already registered.  Determine which
+         * is newer, and kill the older one. */
+
+        std::shared_ptr<Activity> old = ActivityManager::getInstance().getActivity(act->getId());
+        std::shared_ptr<PersistTokenDB> oldPt =
+                std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(old->getPersistToken());
+
+        /* IDs resume past the persisted high-water mark, so a client's
+         * Activity can only collide if that was lost.  The client has been
+         * told its Activity was created, so that one stands. */
+        if (isUnstored(oldPt)) {
+            LOG_AM_WARNING(MSGID_ACTIVITY_NOT_REPLACED, 2,
+                           PMLOGKFV("Activity", "%llu", act->getId()),
+                           PMLOGKFV("old_Activity", "%llu", old->getId()),
+                           "Created while loading and not yet stored; dropping the stored Activity");
+
+            /* Dropped rather than released, which would take the
+             * transitions queued for the client's under the same id */
+            m_oldTokens.push_back(std::move(pt));
+            return nullptr;
+        }
+
+        if (pt->getRev() > oldPt->getRev()) {
+            LOG_AM_WARNING(
+                    MSGID_ACTIVITY_REPLACED,
+                    4,
+                    PMLOGKFV("Activity", "%llu", act->getId()),
+                    PMLOGKFV("revision", "%llu", (unsigned long long)pt->getRev()),
+                    PMLOGKFV("old_Activity", "%llu", old->getId()),
+                    PMLOGKFV("old_revision", "%llu", (unsigned long long)oldPt->getRev()),
+                    "");
+
+            m_oldTokens.push_back(std::move(oldPt));
+            endActivity(old, true);
+
+            ActivityManager::getInstance().registerActivityId(act);
         } else {
-            m_call.reset();
-            ActivityManager::getInstance().enable(ActivityManager::kConfigurationLoaded);
+            LOG_AM_WARNING(
+                    MSGID_ACTIVITY_NOT_REPLACED,
+                    4,
+                    PMLOGKFV("Activity", "%llu", act->getId()),
+                    PMLOGKFV("revision", "%llu", (unsigned long long)pt->getRev()),
+                    PMLOGKFV("old_Activity", "%llu", old->getId()),
+                    PMLOGKFV("old_revision", "%llu", (unsigned long long)oldPt->getRev()),
+                    "");
+
+            /* Never registered, so dropped rather than released, which
+             * would take the older one's transitions with it */
+            m_oldTokens.push_back(std::move(pt));
+            return nullptr;
+        }
+    }
+
+    try {
+        ActivityManager::getInstance().registerActivityName(act);
+    } catch (...) {
+        LOG_AM_ERROR(
+                MSGID_ACTIVITY_NAME_REG_FAIL, 3,
+                PMLOGKFV("Activity", "%llu", act->getId()),
+                PMLOGKS("Creator_name", act->getCreator().getString().c_str()),
+                PMLOGKS("Register_name", act->getName().c_str()), "");
+
+        /* Another Activity is already registered.  Determine which
+         * is newer, and kill the older one. */
+
+        std::shared_ptr<Activity> old =
+                ActivityManager::getInstance().getActivity(act->getName(), act->getCreator());
+
+        std::shared_ptr<PersistTokenDB> oldPt =
+                std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(old->getPersistToken());
+
+        /* A client has created an Activity of the same name since the
+         * service went online.  It was told it was created, so it stands. */
+        if (isUnstored(oldPt)) {
+            LOG_AM_WARNING(MSGID_ACTIVITY_NOT_REPLACED, 2,
+                           PMLOGKFV("Activity", "%llu", act->getId()),
+                           PMLOGKFV("old_Activity", "%llu", old->getId()),
+                           "Created while loading and not yet stored; dropping the stored Activity");
+
+            m_oldTokens.push_back(std::move(pt));
+            ActivityManager::getInstance().releaseActivity(act);
+            return nullptr;
+        }
+
+        if (pt->getRev() > oldPt->getRev()) {
+            LOG_AM_WARNING(
+                    MSGID_ACTIVITY_REPLACED,
+                    4,
+                    PMLOGKFV("Activity","%llu",act->getId()),
+                    PMLOGKFV("revision","%llu", (unsigned long long)pt->getRev()),
+                    PMLOGKFV("old_Activity","%llu", old->getId()),
+                    PMLOGKFV("old_revision","%llu", (unsigned long long)oldPt->getRev()),
+                    "");
+
+            m_oldTokens.push_back(std::move(oldPt));
+            endActivity(old, true);
+
+            ActivityManager::getInstance().registerActivityName(act);
+        } else {
+            LOG_AM_WARNING(
+                    MSGID_ACTIVITY_NOT_REPLACED,
+                    4,
+                    PMLOGKFV("Activity","%llu", act->getId()),
+                    PMLOGKFV("revision","%llu", (unsigned long long)pt->getRev()),
+                    PMLOGKFV("old_Activity","%llu", old->getId()),
+                    PMLOGKFV("old_revision","%llu", (unsigned long long)oldPt->getRev()),
+                    "");
+
+            m_oldTokens.push_back(std::move(pt));
+            ActivityManager::getInstance().releaseActivity(act);
+            return nullptr;
+        }
+    }
+
+    LOG_AM_DEBUG("[Activity %llu] (\"%s\"): _id %s, rev %llu loaded",
+                 act->getId(), act->getName().c_str(), id.data(),
+                 (unsigned long long )rev);
+
+    /* Request Activity be scheduled.  It won't transition to running
+     * until the Activity Manager is enabled: once the Activities from the
+     * snapshot are set up, or else after the MojoDB load finishes. */
+    ActivityManager::getInstance().startActivity(act);
+
+    return act;
+}
+
+void DB8Manager::activityLoadFinished()
+{
+    LOG_AM_DEBUG("All loaded Activities set up");
+
+    if (m_snapshotLoaded) {
+        std::vector<std::shared_ptr<Activity> > stale = m_snapshot.takeStale();
+
+        /* Gone from MojoDB, so cancelled as a client would, but with
+         * nothing left to delete */
+        for (std::vector<std::shared_ptr<Activity> >::iterator iter = stale.begin() ;
+                iter != stale.end() ; ++iter) {
+            LOG_AM_WARNING(MSGID_SNAPSHOT_ERR, 1,
+                           PMLOGKFV("Activity", "%llu", (*iter)->getId()),
+                           "Cancelling Activity from snapshot that is no longer stored");
+
+            std::shared_ptr<PersistTokenDB> pt =
+                    std::dynamic_pointer_cast<PersistTokenDB, PersistToken>((*iter)->getPersistToken());
+            if (pt) {
+                pt->clear();
+            }
+            endActivity(*iter, false);
+        }
+    }
+
+    m_loaded = true;
+    writeSnapshot();
+
+    if (!m_oldTokens.empty()) {
+        LOG_AM_DEBUG("Beginning purge of old Activities from database");
+        preparePurgeCall();
+        m_call->call();
+    } else if (!m_snapshotLoaded) {
+        ActivityManager::getInstance().enable(ActivityManager::kConfigurationLoaded);
+    }
+
+    /* Already online with the Activities from the snapshot */
+    if (m_listener && !m_snapshotLoaded) m_listener->onFinish();
+}
+
+void DB8Manager::loadSnapshot()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    std::vector<MojObject> reps;
+    if (!m_snapshot.read(reps)) {
+        return;
+    }
+
+    for (std::vector<MojObject>::const_iterator iter = reps.begin() ; iter != reps.end() ; ++iter) {
+        std::shared_ptr<Activity> act = loadActivity(*iter);
+        if (act) {
+            m_snapshot.track(act);
         }
+    }
+
+    LOG_AM_DEBUG("Set up %zu Activities from snapshot, reconciling with MojoDB",
+                 reps.size());
+
+    /* Go online, and start scheduling, once the app has finished opening */
+    m_snapshotLoaded = true;
+    m_snapshotReadySource = g_idle_add_full(G_PRIORITY_HIGH,
+                                            &DB8Manager::snapshotReadyCallback, this, NULL);
+}
+
+gboolean DB8Manager::snapshotReadyCallback(gpointer data)
+{
+    DB8Manager *self = static_cast<DB8Manager *>(data);
+
+    self->m_snapshotReadySource = 0;
+
+    ActivityManager::getInstance().enable(ActivityManager::kConfigurationLoaded);
+    if (self->m_listener) self->m_listener->onFinish();
+
+    return G_SOURCE_REMOVE;
+}
+
+void DB8Manager::writeSnapshot()
+{
+    /* Until MojoDB has been read, the Activities set up are only part of
+     * what's stored */
+    if (!m_loaded || !Config::getInstance().snapshotEnabled()) {
+        return;
+    }
 
-        if (m_listener) m_listener->onFinish();
+    m_snapshot.write();
+
+    unsigned int interval = Config::getInstance().getSnapshotInterval();
+    if (interval && !m_snapshotWriteSource) {
+        m_snapshotWriteSource = g_timeout_add_seconds_full(G_PRIORITY_LOW, interval,
+                &DB8Manager::snapshotWriteCallback, this, NULL);
     }
 }
 
+gboolean DB8Manager::snapshotWriteCallback(gpointer data)
+{
+    DB8Manager *self = static_cast<DB8Manager *>(data);
+
+    self->m_snapshot.write();
+
+    return G_SOURCE_CONTINUE;
+}
+
 void DB8Manager::activityPurgeComplete(MojServiceMessage *msg, const MojObject& response, MojErr err)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
@@ -371,7 +630,11 @@ void DB8Manager::activityPurgeComplete(MojServiceMessage *msg, const MojObject&
     } else {
         LOG_AM_DEBUG("Done purging old Activities");
         m_call.reset();
-        ActivityManager::getInstance().enable(ActivityManager::kConfigurationLoaded);
+
+        /* Already enabled once the snapshot was set up */
+        if (!m_snapshotLoaded) {
+            ActivityManager::getInstance().enable(ActivityManager::kConfigurationLoaded);
+        }
     }
 }
 
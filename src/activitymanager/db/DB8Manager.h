@@ -25,6 +25,10 @@
 #include "activity/ActivityExtractor.h"
 #include "activity/ActivityManager.h"
 #include "base/LunaCall.h"
+#include "db/DB8BatchCommand.h"
+#include "db/DB8LoadQueue.h"
+#include "db/DB8Snapshot.h"
+#include "db/DB8StoreQueue.h"
 #include "db/PersistTokenDB.h"
 
 class DB8ManagerListener {
@@ -51,20 +55,46 @@ public:
     virtual std::shared_ptr<AbstractPersistCommand> prepareDeleteCommand(
             std::shared_ptr<Activity> activity, std::shared_ptr<ICompletion> completion);
 
+    /* Folds a store into the Activity's last command, if that's a store
+     * still waiting to be issued.  Returns false if a store command should
+     * be prepared instead. */
+    bool absorbStore(std::shared_ptr<Activity> activity, std::shared_ptr<ICompletion> completion);
+
+    /* Commands prepared from the batch are issued together, as one call */
+    virtual std::shared_ptr<DB8Batch> prepareBatch(CommandType type);
+
     virtual std::shared_ptr<PersistToken> createToken();
 
     virtual void loadActivities();
     virtual void addListener(DB8ManagerListener* listener);
 
+    /* Brings the snapshot up to date, if enabled and the load is done */
+    void writeSnapshot();
+
+    MojErr infoToJson(MojObject& rep) const;
+
+    /* Whether MojoDB refused a put or merge because the _rev it was sent
+     * isn't the stored object's */
+    static bool isRevisionMismatch(const MojObject& response, MojErr err);
+
     static const char *kActivityKind;
 
 protected:
     DB8Manager();
     void activityLoadResults(MojServiceMessage *msg, const MojObject& response, MojErr err);
+    std::shared_ptr<Activity> loadActivity(const MojObject& rep);
+    void reconcileActivity(const MojObject& rep);
+    void activityLoadFinished();
+    void endActivity(std::shared_ptr<Activity> act, bool replaced);
+
+    void loadSnapshot();
+    static gboolean snapshotReadyCallback(gpointer data);
+    static gboolean snapshotWriteCallback(gpointer data);
     void activityPurgeComplete(MojServiceMessage *msg, const MojObject& response, MojErr err);
     void activityConfiguratorComplete(MojServiceMessage *msg, const MojObject& response, MojErr err);
 
     static const int kPurgeBatchSize;
+    static const MojErr kRevisionMismatch;
 
     void preparePurgeCall();
     void populatePurgeIds(MojObject& ids);
@@ -78,6 +108,23 @@ protected:
     TokenQueue m_oldTokens;
 
     DB8ManagerListener* m_listener;
+
+    /* Stores wait here to be put together */
+    std::shared_ptr<DB8StoreQueue> m_storeQueue;
+
+    /* Stores folded into an earlier one rather than issued */
+    unsigned long m_absorbedStores;
+
+    /* Loaded pages wait here to be set up, while the next is fetched */
+    DB8LoadQueue m_loadQueue;
+
+    /* Activities set up from the snapshot go online without waiting for
+     * MojoDB, which is reconciled against them as it's read */
+    DB8Snapshot m_snapshot;
+    bool m_snapshotLoaded;
+    bool m_loaded;
+    guint m_snapshotReadySource;
+    guint m_snapshotWriteSource;
 };
 
 #endif /* _DB_MANAGER_H_ */
@@ -0,0 +1,260 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "db/DB8Snapshot.h"
+
+#include <glib.h>
+
+#include "activity/ActivityManager.h"
+#include "activity/state/AbstractActivityState.h"
+#include "util/Logging.h"
+#include "util/MojoObjectJson.h"
+
+DB8Snapshot::DB8Snapshot(const std::string& path)
+    : m_file(path)
+    , m_read(0)
+    , m_matched(0)
+    , m_kept(0)
+    , m_updated(0)
+    , m_added(0)
+    , m_stale(0)
+    , m_readTime(0)
+    , m_writes(0)
+    , m_lastCount(0)
+    , m_lastBytes(0)
+    , m_lastWriteTime(0)
+{
+}
+
+DB8Snapshot::~DB8Snapshot()
+{
+}
+
+bool DB8Snapshot::read(std::vector<MojObject>& reps)
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    int64_t begin = g_get_monotonic_time();
+
+    std::vector<std::string> records;
+    if (!m_file.read(records)) {
+        return false;
+    }
+
+    reps.reserve(records.size());
+    for (std::vector<std::string>::const_iterator iter = records.begin() ;
+            iter != records.end() ; ++iter) {
+        MojObject rep;
+        if (rep.fromJson(iter->c_str())) {
+            LOG_AM_WARNING(MSGID_SNAPSHOT_ERR, 1,
+                           PMLOGKS("file", m_file.getPath().c_str()),
+                           "Ignoring snapshot with unreadable Activity");
+            reps.clear();
+            return false;
+        }
+        reps.push_back(rep);
+    }
+
+    m_read = reps.size();
+    m_readTime = g_get_monotonic_time() - begin;
+
+    LOG_AM_DEBUG("Read %zu Activities from snapshot in %lld us",
+                 reps.size(), (long long) m_readTime);
+
+    return true;
+}
+
+bool DB8Snapshot::write()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    int64_t begin = g_get_monotonic_time();
+
+    ActivityManager::ActivityVec activities = ActivityManager::getInstance().getActivities();
+
+    std::vector<std::string> records;
+    records.reserve(activities.size());
+
+    for (ActivityManager::ActivityVec::const_iterator iter = activities.begin() ;
+            iter != activities.end() ; ++iter) {
+        std::shared_ptr<PersistTokenDB> pt =
+                std::dynamic_pointer_cast<PersistTokenDB, PersistToken>((*iter)->getPersistToken());
+
+        MojObject rep;
+        if (pt && pt->getWritten(rep)) {
+            records.push_back(MojoObjectJson(rep).str());
+        }
+    }
+
+    size_t bytes = m_file.write(records);
+    if (!bytes) {
+        return false;
+    }
+
+    m_writes++;
+    m_lastCount = records.size();
+    m_lastBytes = bytes;
+    m_lastWriteTime = g_get_monotonic_time() - begin;
+
+    LOG_AM_DEBUG("Wrote %zu Activities (%zu bytes) to snapshot in %lld us",
+                 m_lastCount, m_lastBytes, (long long) m_lastWriteTime);
+
+    return true;
+}
+
+void DB8Snapshot::remove()
+{
+    m_file.remove();
+}
+
+void DB8Snapshot::track(std::shared_ptr<Activity> act)
+{
+    std::shared_ptr<PersistTokenDB> pt =
+            std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(act->getPersistToken());
+    if (!pt || !pt->isValid()) {
+        return;
+    }
+
+    Tracked& tracked = m_tracked[pt->getId().data()];
+    tracked.m_activity = act;
+    tracked.m_token = pt;
+    tracked.m_rev = pt->getRev();
+}
+
+bool DB8Snapshot::reconcile(const MojObject& rep, std::shared_ptr<Activity>& outdated)
+{
+    outdated.reset();
+
+    MojString id;
+    MojInt64 rev;
+    bool found = false;
+
+    /* Anything malformed is left to be rejected as usual */
+    if (rep.get(_T("_id"), id, found) || !found || !rep.get(_T("_rev"), rev)) {
+        return true;
+    }
+
+    TrackedMap::iterator iter = m_tracked.find(id.data());
+    if (iter == m_tracked.end()) {
+        m_added++;
+        return true;
+    }
+
+    Tracked tracked = iter->second;
+    m_tracked.erase(iter);
+
+    /* Whoever holds the token now (a replacement, perhaps) has stored or
+     * deleted the object since; MojoDB's copy is older than that */
+    std::shared_ptr<PersistTokenDB> pt = tracked.m_token.lock();
+    if (!pt || !pt->isValid() || (pt->getRev() != tracked.m_rev)) {
+        m_kept++;
+        return false;
+    }
+
+    if (rev == tracked.m_rev) {
+        m_matched++;
+        return false;
+    }
+
+    LOG_AM_DEBUG("Snapshot of _id %s was at rev %lld, MojoDB has rev %lld",
+                 id.data(), (long long) tracked.m_rev, (long long) rev);
+
+    m_updated++;
+
+    std::shared_ptr<Activity> act = tracked.m_activity.lock();
+    if (!isEnded(act)) {
+        outdated = act;
+    }
+    return true;
+}
+
+std::vector<std::shared_ptr<Activity> > DB8Snapshot::takeStale()
+{
+    std::vector<std::shared_ptr<Activity> > stale;
+
+    for (TrackedMap::iterator iter = m_tracked.begin() ; iter != m_tracked.end() ; ++iter) {
+        std::shared_ptr<PersistTokenDB> pt = iter->second.m_token.lock();
+        std::shared_ptr<Activity> act = iter->second.m_activity.lock();
+
+        /* Stored again since, so MojoDB has it now, or ended already */
+        if (!pt || !pt->isValid() || (pt->getRev() != iter->second.m_rev) || isEnded(act)) {
+            continue;
+        }
+
+        stale.push_back(act);
+    }
+
+    m_tracked.clear();
+    m_stale += stale.size();
+
+    return stale;
+}
+
+void DB8Snapshot::abandon()
+{
+    m_tracked.clear();
+}
+
+bool DB8Snapshot::isEnded(const std::shared_ptr<Activity>& act)
+{
+    return !act || !act->isNameRegistered() ||
+            (act->getState() == ActivityStateDestroyed::getInstance());
+}
+
+MojErr DB8Snapshot::infoToJson(MojObject& rep) const
+{
+    MojErr err;
+    MojObject snapshot(MojObject::TypeObject);
+
+    err = snapshot.putInt(_T("read"), (MojInt64) m_read);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("readUs"), m_readTime);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("matched"), (MojInt64) m_matched);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("kept"), (MojInt64) m_kept);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("updated"), (MojInt64) m_updated);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("added"), (MojInt64) m_added);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("stale"), (MojInt64) m_stale);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("writes"), (MojInt64) m_writes);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("lastCount"), (MojInt64) m_lastCount);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("lastBytes"), (MojInt64) m_lastBytes);
+    MojErrCheck(err);
+
+    err = snapshot.putInt(_T("lastWriteUs"), m_lastWriteTime);
+    MojErrCheck(err);
+
+    err = rep.put(_T("snapshot"), snapshot);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __DB8_SNAPSHOT_H__
+#define __DB8_SNAPSHOT_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <core/MojObject.h>
+
+#include "activity/Activity.h"
+#include "db/PersistTokenDB.h"
+#include "util/SnapshotFile.h"
+
+/*
+ * A local copy of the persisted Activities, as last written to MojoDB.
+ *
+ * At startup the Activities in the snapshot are set up and scheduled
+ * without waiting for MojoDB.  MojoDB is still read in full afterwards,
+ * and each object found there is reconciled against the snapshot by _id
+ * and _rev:
+ *
+ * - matched: the same revision as the snapshot's.  Nothing to do.
+ * - kept: the Activity has been stored since, so MojoDB's copy is older.
+ *   Nothing to do.
+ * - updated: a different revision, so MojoDB's is newer.  It replaces the
+ *   Activity set up from the snapshot, which is ended.
+ * - added: not in the snapshot.  Set up as usual.
+ *
+ * Activities from the snapshot that MojoDB no longer has are stale, and
+ * are left over once the read is done, to be ended.
+ */
+class DB8Snapshot {
+public:
+    DB8Snapshot(const std::string& path);
+    virtual ~DB8Snapshot();
+
+    /* The stored objects in the snapshot, with their _id and _rev.
+     * Returns false if there's no usable snapshot. */
+    bool read(std::vector<MojObject>& reps);
+
+    /* Replaces the snapshot with every Activity whose stored object is
+     * known */
+    bool write();
+
+    void remove();
+
+    /* Remembers an Activity set up from the snapshot */
+    void track(std::shared_ptr<Activity> act);
+
+    /* Whether an object read from MojoDB still has to be set up.  If it
+     * replaces an Activity set up from the snapshot that hasn't been ended
+     * yet, that's returned in outdated. */
+    bool reconcile(const MojObject& rep, std::shared_ptr<Activity>& outdated);
+
+    /* Activities set up from the snapshot that MojoDB didn't have, and
+     * that haven't been ended yet.  Ends reconciliation. */
+    std::vector<std::shared_ptr<Activity> > takeStale();
+
+    /* Ends reconciliation when MojoDB can't be read, keeping the
+     * Activities from the snapshot as they are */
+    void abandon();
+
+    MojErr infoToJson(MojObject& rep) const;
+
+protected:
+    struct Tracked {
+        Tracked() : m_rev(-1) {}
+
+        std::weak_ptr<Activity> m_activity;
+        std::weak_ptr<PersistTokenDB> m_token;
+        MojInt64 m_rev;
+    };
+
+    /* Whether it's been ended already, by a client or in favour of another */
+    static bool isEnded(const std::shared_ptr<Activity>& act);
+
+    /* By _id */
+    typedef std::map<std::string, Tracked> TrackedMap;
+
+    SnapshotFile m_file;
+    TrackedMap m_tracked;
+
+    unsigned long m_read;
+    unsigned long m_matched;
+    unsigned long m_kept;
+    unsigned long m_updated;
+    unsigned long m_added;
+    unsigned long m_stale;
+    int64_t m_readTime;
+
+    unsigned long m_writes;
+    size_t m_lastCount;
+    size_t m_lastBytes;
+    int64_t m_lastWriteTime;
+};
+
+#endif /* __DB8_SNAPSHOT_H__ */
@@ -0,0 +1,228 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "db/DB8StoreQueue.h"
+
+#include "util/Logging.h"
+
+DB8QueuedStoreCommand::DB8QueuedStoreCommand(std::shared_ptr<DB8StoreQueue> queue,
+                                             std::shared_ptr<Activity> activity,
+                                             std::shared_ptr<ICompletion> completion)
+    : DB8BatchCommand(nullptr, activity, completion)
+    , m_queue(queue)
+    , m_timing(std::make_shared<Timing>(queue.get(), completion))
+{
+    m_completion = m_timing;
+}
+
+DB8QueuedStoreCommand::~DB8QueuedStoreCommand()
+{
+}
+
+void DB8QueuedStoreCommand::persist()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("[Activity %llu] [PersistCommand %s]: Queued to store",
+                 m_activity->getId(), getString().c_str());
+
+    if (m_timing->m_queued) {
+        return;
+    }
+
+    m_timing->m_queued = g_get_monotonic_time();
+    m_queue->enqueue(std::static_pointer_cast<DB8QueuedStoreCommand>(shared_from_this()));
+}
+
+std::string DB8QueuedStoreCommand::getMethod() const
+{
+    return "QueuedStore";
+}
+
+bool DB8QueuedStoreCommand::isStore() const
+{
+    return true;
+}
+
+DB8QueuedStoreCommand::Timing::Timing(DB8StoreQueue *queue,
+                                      std::shared_ptr<ICompletion> completion)
+    : m_queue(queue)
+    , m_completion(completion)
+    , m_queued(0)
+{
+}
+
+DB8QueuedStoreCommand::Timing::~Timing()
+{
+}
+
+void DB8QueuedStoreCommand::Timing::complete(bool succeeded)
+{
+    if (m_queued) {
+        m_queue->recordCommit(succeeded, m_queued);
+    }
+
+    m_completion->complete(succeeded);
+}
+
+DB8StoreQueue::DB8StoreQueue()
+    : m_batchSize(1)
+    , m_delay(0)
+    , m_flushSource(0)
+    , m_calls(0)
+    , m_stores(0)
+    , m_failures(0)
+{
+}
+
+DB8StoreQueue::~DB8StoreQueue()
+{
+    if (m_flushSource) {
+        g_source_remove(m_flushSource);
+    }
+}
+
+std::shared_ptr<AbstractPersistCommand> DB8StoreQueue::prepareCommand(
+        std::shared_ptr<Activity> activity, std::shared_ptr<ICompletion> completion)
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("Preparing queued put command for [Activity %llu]", activity->getId());
+
+    return std::make_shared<DB8QueuedStoreCommand>(shared_from_this(), activity, completion);
+}
+
+void DB8StoreQueue::setLimits(size_t batchSize, unsigned int delay)
+{
+    m_batchSize = (batchSize > 0) ? batchSize : 1;
+    m_delay = delay;
+
+    if (m_waiting.size() >= m_batchSize) {
+        flush();
+    }
+}
+
+void DB8StoreQueue::enqueue(std::shared_ptr<DB8QueuedStoreCommand> cmd)
+{
+    m_waiting.push_back(cmd);
+
+    if (m_waiting.size() >= m_batchSize) {
+        flush();
+    } else if (!m_flushSource) {
+        m_flushSource = g_timeout_add_full(G_PRIORITY_DEFAULT, m_delay,
+                                           &DB8StoreQueue::flushCallback, this, NULL);
+    }
+}
+
+void DB8StoreQueue::flush()
+{
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    if (m_flushSource) {
+        g_source_remove(m_flushSource);
+        m_flushSource = 0;
+    }
+
+    if (m_waiting.empty()) {
+        return;
+    }
+
+    LOG_AM_DEBUG("Flushing %zu queued stores", m_waiting.size());
+
+    CommandList waiting;
+    waiting.swap(m_waiting);
+
+    m_calls++;
+    m_stores += waiting.size();
+
+    issue(waiting);
+}
+
+/* The batch does the put, and completes each command with its result.  If
+ * MojoDB rejects the group, the batch puts each store on its own, so one
+ * bad object only fails its own store. */
+void DB8StoreQueue::issue(const CommandList& stores)
+{
+    std::shared_ptr<DB8Batch> batch =
+            std::make_shared<DB8Batch>(AbstractPersistManager::StoreCommandType);
+
+    for (CommandList::const_iterator iter = stores.begin() ; iter != stores.end() ; ++iter) {
+        batch->adoptCommand(*iter);
+    }
+
+    batch->seal();
+}
+
+void DB8StoreQueue::complete(std::shared_ptr<DB8QueuedStoreCommand> cmd, bool succeeded)
+{
+    cmd->complete(succeeded);
+}
+
+gboolean DB8StoreQueue::flushCallback(gpointer data)
+{
+    DB8StoreQueue *self = static_cast<DB8StoreQueue *>(data);
+
+    self->m_flushSource = 0;
+    self->flush();
+
+    return G_SOURCE_REMOVE;
+}
+
+void DB8StoreQueue::recordCommit(bool succeeded, int64_t queued)
+{
+    if (!succeeded) {
+        m_failures++;
+    }
+
+    m_commitLatency.record(g_get_monotonic_time() - queued);
+}
+
+MojErr DB8StoreQueue::infoToJson(MojObject& rep) const
+{
+    MojErr err;
+    MojObject queue(MojObject::TypeObject);
+
+    err = queue.putInt(_T("batchSize"), (MojInt64) m_batchSize);
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("delayMs"), (MojInt64) m_delay);
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("waiting"), (MojInt64) m_waiting.size());
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("calls"), (MojInt64) m_calls);
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("stores"), (MojInt64) m_stores);
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("failures"), (MojInt64) m_failures);
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("commitP50Us"), m_commitLatency.getPercentile(50.0));
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("commitP99Us"), m_commitLatency.getPercentile(99.0));
+    MojErrCheck(err);
+
+    err = queue.putInt(_T("commitMaxUs"), m_commitLatency.getMax());
+    MojErrCheck(err);
+
+    err = rep.put(_T("storeQueue"), queue);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
@@ -0,0 +1,124 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __DB8_STORE_QUEUE_H__
+#define __DB8_STORE_QUEUE_H__
+
+#include <glib.h>
+#include <vector>
+
+#include <core/MojObject.h>
+#include <db/ICompletion.h>
+
+#include "db/DB8BatchCommand.h"
+#include "util/LatencyHistogram.h"
+
+class DB8StoreQueue;
+
+/*
+ * A store that, when its turn comes in its Activity's command chain, waits
+ * in the Store Queue to be put together with the other stores waiting.
+ */
+class DB8QueuedStoreCommand: public DB8BatchCommand {
+public:
+    DB8QueuedStoreCommand(std::shared_ptr<DB8StoreQueue> queue,
+                          std::shared_ptr<Activity> activity,
+                          std::shared_ptr<ICompletion> completion);
+    virtual ~DB8QueuedStoreCommand();
+
+    virtual void persist();
+
+protected:
+    friend class DB8StoreQueue;
+
+    virtual std::string getMethod() const;
+    virtual bool isStore() const;
+
+    /* Times the store from its turn to its completion */
+    class Timing: public ICompletion {
+    public:
+        Timing(DB8StoreQueue *queue, std::shared_ptr<ICompletion> completion);
+        virtual ~Timing();
+
+        virtual void complete(bool succeeded);
+
+        DB8StoreQueue *m_queue;
+        std::shared_ptr<ICompletion> m_completion;
+        int64_t m_queued;
+    };
+
+    std::shared_ptr<DB8StoreQueue> m_queue;
+    std::shared_ptr<Timing> m_timing;
+};
+
+/*
+ * Group commit for stores.
+ *
+ * Stores from any Activities that are ready to be issued are held briefly,
+ * then put in a single MojoDB call.  The queue is flushed once it holds a
+ * full batch, or when the oldest store has waited the maximum delay.
+ * Each Activity only has one command issued at a time, so its stores still
+ * complete in order.
+ */
+class DB8StoreQueue: public std::enable_shared_from_this<DB8StoreQueue> {
+public:
+    DB8StoreQueue();
+    virtual ~DB8StoreQueue();
+
+    std::shared_ptr<AbstractPersistCommand> prepareCommand(
+            std::shared_ptr<Activity> activity, std::shared_ptr<ICompletion> completion);
+
+    /* Stores per call, and milliseconds the first store may wait */
+    void setLimits(size_t batchSize, unsigned int delay);
+
+    /* Issues everything waiting now */
+    void flush();
+
+    MojErr infoToJson(MojObject& rep) const;
+
+protected:
+    friend class DB8QueuedStoreCommand;
+
+    /* Queued stores are only issued, and serialize their Activity, when
+     * the queue is flushed */
+    void enqueue(std::shared_ptr<DB8QueuedStoreCommand> cmd);
+    void recordCommit(bool succeeded, int64_t queued);
+
+    static gboolean flushCallback(gpointer data);
+
+    typedef std::vector<std::shared_ptr<DB8QueuedStoreCommand> > CommandList;
+
+    /* Puts a flushed group of stores, completing each with its own result */
+    virtual void issue(const CommandList& stores);
+
+    static void complete(std::shared_ptr<DB8QueuedStoreCommand> cmd, bool succeeded);
+
+    size_t m_batchSize;
+    unsigned int m_delay;
+
+    CommandList m_waiting;
+    guint m_flushSource;
+
+    unsigned long m_calls;
+    unsigned long m_stores;
+    unsigned long m_failures;
+
+    /* Time from a store's turn to its completion */
+    LatencyHistogram m_commitLatency;
+};
+
+#endif /* __DB8_STORE_QUEUE_H__ */
@@ -21,6 +21,7 @@
 #include "PersistTokenDB.h"
 #include "conf/ActivityJson.h"
 #include "util/Logging.h"
+#include "util/MojoObjectString.h"
 
 /*
  * palm://com.palm.db/put
@@ -30,10 +31,22 @@
  *       "prop1" : VAL1, "prop2" : VAL2 },
  *     ... ]
  * }
+ *
+ * Once the Activity's object is known to be stored, only the properties
+ * that changed are sent:
+ *
+ * palm://com.palm.db/merge
+ *
+ * { "objects" : [{ "_id" : "XXX", "_rev" : 123, "prop2" : VAL2 }] }
  */
+const char *DB8StoreCommand::kPutMethod = "luna://com.webos.service.db/put";
+const char *DB8StoreCommand::kMergeMethod = "luna://com.webos.service.db/merge";
+
 DB8StoreCommand::DB8StoreCommand(std::shared_ptr<Activity> activity,
                                              std::shared_ptr<ICompletion> completion)
-    : DB8Command("luna://com.webos.service.db/put", activity, completion)
+    : DB8Command(kPutMethod, activity, completion)
+    , m_merging(false)
+    , m_forcePut(false)
 {
 }
 
@@ -46,6 +59,11 @@ std::string DB8StoreCommand::getMethod() const
     return "Store";
 }
 
+bool DB8StoreCommand::isStore() const
+{
+    return true;
+}
+
 void DB8StoreCommand::updateParams(MojObject& params)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
@@ -63,18 +81,40 @@ void DB8StoreCommand::updateParams(MojObject& params)
         throw std::runtime_error("Failed to convert Activity to JSON representation");
     }
 
+    /* Kept before the reserved properties go in, to compare the next
+     * store against */
+    m_written = rep;
+
     std::shared_ptr<PersistTokenDB> pt =
             std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(m_activity->getPersistToken());
-    if(pt && pt->isValid()) {
-        err = pt->toJson(rep);
+
+    MojObject delta;
+    m_merging = !m_forcePut && pt && pt->getDelta(rep, delta);
+
+    if (m_merging) {
+        m_method = kMergeMethod;
+
+        err = objectsArray.push(delta);
         MojErrAccumulate(errs, err);
-    }
+    } else {
+        m_method = kPutMethod;
+
+        if (pt && pt->isValid() && m_forcePut) {
+            /* Without the stale _rev the merge was refused for, so the put
+             * overwrites the stored object rather than failing the same way */
+            err = rep.putString(_T("_id"), pt->getId());
+            MojErrAccumulate(errs, err);
+        } else if (pt && pt->isValid()) {
+            err = pt->toJson(rep);
+            MojErrAccumulate(errs, err);
+        }
 
-    err = rep.putString(_T("_kind"), DB8Manager::kActivityKind);
-    MojErrAccumulate(errs, err);
+        err = rep.putString(_T("_kind"), DB8Manager::kActivityKind);
+        MojErrAccumulate(errs, err);
 
-    err = objectsArray.push(rep);
-    MojErrAccumulate(errs, err);
+        err = objectsArray.push(rep);
+        MojErrAccumulate(errs, err);
+    }
 
     err = params.put(_T("objects"), objectsArray);
     MojErrAccumulate(errs, err);
@@ -108,6 +148,26 @@ void DB8StoreCommand::persistResponse(MojServiceMessage *msg,
         return;
     }
 
+    if (err && m_merging && DB8Manager::isRevisionMismatch(response, err)) {
+        LOG_AM_WARNING(MSGID_PERSIST_MERGE_FALLBACK, 3,
+                       PMLOGKFV("activity", "%llu", m_activity->getId()),
+                       PMLOGKS("persist_command", getString().c_str()),
+                       PMLOGKS("Errtext", MojoObjectString(response, _T("errorText")).c_str()),
+                       "Stored Activity changed under the merge, storing whole Activity instead");
+
+        std::shared_ptr<PersistTokenDB> pt =
+                std::dynamic_pointer_cast<PersistTokenDB, PersistToken>(m_activity->getPersistToken());
+        if (pt) {
+            pt->clearWritten();
+        }
+
+        /* This is still the failed call's callback, so hold on to it */
+        m_failedCall = m_call;
+        m_forcePut = true;
+        persist();
+        return;
+    }
+
     if (err) {
         DB8Command::persistResponse(msg, response, err);
         return;
@@ -177,6 +237,7 @@ void DB8StoreCommand::persistResponse(MojServiceMessage *msg,
             } else {
                 pt->update(id, rev);
             }
+            pt->setWritten(m_written);
         } catch (...) {
             LOG_AM_ERROR(MSGID_PERSIST_TOKEN_VAL_UPDATE_FAIL, 2,
                         PMLOGKFV("activity","%llu",m_activity->getId()),
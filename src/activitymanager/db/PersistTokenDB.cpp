@@ -23,6 +23,7 @@
 PersistTokenDB::PersistTokenDB()
     : m_valid(false)
     , m_rev(-1)
+    , m_hasWritten(false)
 {
 }
 
@@ -30,6 +31,7 @@ PersistTokenDB::PersistTokenDB(const MojString& id, MojInt64 rev)
     : m_valid(true)
     , m_id(id)
     , m_rev(rev)
+    , m_hasWritten(false)
 {
 }
 
@@ -51,6 +53,7 @@ void PersistTokenDB::set(const MojString& id, MojInt64 rev)
     m_valid = true;
     m_id = id;
     m_rev = rev;
+    clearWritten();
 }
 
 void PersistTokenDB::update(const MojString& id, MojInt64 rev)
@@ -71,6 +74,7 @@ void PersistTokenDB::clear()
     m_valid = false;
     m_id.clear();
     m_rev = -1;
+    clearWritten();
 }
 
 MojInt64 PersistTokenDB::getRev() const
@@ -108,6 +112,102 @@ MojErr PersistTokenDB::toJson(MojObject& rep) const
     return MojErrNone;
 }
 
+void PersistTokenDB::setWritten(const MojObject& rep)
+{
+    clearWritten();
+
+    /* Reserved properties (_id, _rev, _kind) are the token's business */
+    for (MojObject::ConstIterator iter = rep.begin(); iter != rep.end(); ++iter) {
+        if (iter.key().data()[0] == '_') {
+            continue;
+        }
+
+        if (m_written.put(iter.key().data(), iter.value())) {
+            clearWritten();
+            return;
+        }
+    }
+
+    m_hasWritten = true;
+}
+
+void PersistTokenDB::clearWritten()
+{
+    m_written.clear();
+    m_hasWritten = false;
+}
+
+bool PersistTokenDB::getWritten(MojObject& rep) const
+{
+    if (!m_valid || !m_hasWritten) {
+        return false;
+    }
+
+    rep = m_written;
+    return (toJson(rep) == MojErrNone);
+}
+
+/* Fills delta with what has to be merged into written to make it current.
+ * MojoDB merges nested objects property by property, so those recurse;
+ * anything else that changed goes in whole.  Returns false if a merge
+ * can't do it: current has dropped a property at some level, and a merge
+ * can't take one away. */
+static bool diffObject(const MojObject& written, const MojObject& current,
+                       MojObject& delta, bool topLevel)
+{
+    for (MojObject::ConstIterator iter = written.begin(); iter != written.end(); ++iter) {
+        if (!current.contains(iter.key().data())) {
+            return false;
+        }
+    }
+
+    for (MojObject::ConstIterator iter = current.begin(); iter != current.end(); ++iter) {
+        /* Reserved properties (_id, _rev, _kind) are the token's business */
+        if (topLevel && (iter.key().data()[0] == '_')) {
+            continue;
+        }
+
+        MojObject was;
+        if (written.get(iter.key().data(), was)) {
+            if (was == iter.value()) {
+                continue;
+            }
+
+            if ((was.type() == MojObject::TypeObject) &&
+                (iter.value().type() == MojObject::TypeObject)) {
+                MojObject nested;
+                if (!diffObject(was, iter.value(), nested, false)) {
+                    return false;
+                }
+
+                if (delta.put(iter.key().data(), nested)) {
+                    return false;
+                }
+                continue;
+            }
+        }
+
+        if (delta.put(iter.key().data(), iter.value())) {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool PersistTokenDB::getDelta(const MojObject& rep, MojObject& delta) const
+{
+    if (!m_valid || !m_hasWritten) {
+        return false;
+    }
+
+    if (!diffObject(m_written, rep, delta, true)) {
+        return false;
+    }
+
+    return (toJson(delta) == MojErrNone);
+}
+
 std::string PersistTokenDB::getString() const
 {
     if (!m_valid) {
@@ -18,6 +18,7 @@
 #define __PERSIST_TOKEN_DB_H__
 
 #include <core/MojCoreDefs.h>
+#include <core/MojObject.h>
 
 #include "Main.h"
 #include "PersistToken.h"
@@ -39,12 +40,31 @@ public:
 
     MojErr toJson(MojObject& rep) const;
 
+    /* The properties last written for the object (less the reserved ones),
+     * so a store can tell which it changes.  Forgotten whenever the
+     * object's id changes. */
+    void setWritten(const MojObject& rep);
+    void clearWritten();
+
+    /* The object as last written, with its _id and _rev.  Returns false
+     * if that isn't known. */
+    bool getWritten(MojObject& rep) const;
+
+    /* Fills delta with the object's _id and _rev and the properties of rep
+     * that differ from those last written, to be merged.  Returns false if
+     * the whole object has to be put instead: what was written isn't
+     * known, or rep has dropped a property, nested ones included. */
+    bool getDelta(const MojObject& rep, MojObject& delta) const;
+
     std::string getString() const;
 
 protected:
     bool m_valid;
     MojString m_id;
     MojInt64 m_rev;
+
+    bool m_hasWritten;
+    MojObject m_written;
 };
 
 #endif /* __PERSIST_TOKEN_DB_H__ */
@@ -33,6 +33,7 @@
 #include "conf/Config.h"
 #include "util/Logging.h"
 #include "db/DB8Manager.h"
+#include "service/ActivityInfoStream.h"
 
 const MojChar* const ActivityCategoryHandler::CreateSchema =
     _T("{ \"type\": \"object\", ") \
@@ -40,6 +41,7 @@ const MojChar* const ActivityCategoryHandler::CreateSchema =
             _T(" \"activity\" : {") ACTIVITY_TYPE_SCHEMA _T("}, ") \
             _T(" \"subscribe\" : { \"type\": \"boolean\", \"optional\": true } , ") \
             _T(" \"detailedEvents\" : { \"type\": \"boolean\", \"optional\": true }, ") \
+            _T(" \"coalesceWindow\" : { \"type\": \"integer\", \"minimum\": 0, \"optional\": true }, ") \
             _T(" \"start\" : { \"type\": \"boolean\", \"optional\": true }, ") \
             _T(" \"replace\" : { \"type\": \"boolean\", \"optional\": true } ") \
         _T("}") \
@@ -68,7 +70,8 @@ const MojChar* const ActivityCategoryHandler::AdoptSchema =
             _T(" \"activityName\": { \"type\": \"string\", \"optional\": true }, ") \
             _T(" \"wait\": { \"type\": \"boolean\", \"optional\": true }, ") \
             _T(" \"subscribe\": { \"type\": \"boolean\", \"optional\": true }, ") \
-            _T(" \"detailedEvents\" : { \"type\": \"boolean\", \"optional\" : true } ") \
+            _T(" \"detailedEvents\" : { \"type\": \"boolean\", \"optional\" : true }, ") \
+            _T(" \"coalesceWindow\" : { \"type\": \"integer\", \"minimum\": 0, \"optional\": true } ") \
         _T("}") \
     _T("}");
 
@@ -117,7 +120,76 @@ const MojChar* const ActivityCategoryHandler::GetActivityInfoSchema =
             _T(" \"subscribers\" : { \"type\": \"boolean\" }, ") \
             _T(" \"details\" : { \"type\": \"boolean\" }, ") \
             _T(" \"current\" : { \"type\": \"boolean\" }, ") \
-            _T(" \"internal\" : { \"type\": \"boolean\" } ") \
+            _T(" \"internal\" : { \"type\": \"boolean\" }, ") \
+            _T(" \"state\" : { \"type\": \"string\", \"optional\": true }, ") \
+            _T(" \"creator\" : { \"type\": \"string\", \"optional\": true }, ") \
+            _T(" \"namePrefix\" : { \"type\": \"string\", \"optional\": true }, ") \
+            _T(" \"queue\" : { \"type\": \"string\", \"optional\": true }, ") \
+            _T(" \"cursor\" : { \"type\": \"integer\", \"minimum\": 0, \"optional\": true }, ") \
+            _T(" \"limit\" : { \"type\": \"integer\", \"minimum\": 1, \"optional\": true }, ") \
+            _T(" \"subscribe\" : { \"type\": \"boolean\", \"optional\": true } ") \
+        _T("}") \
+    _T("}");
+
+const MojChar* const ActivityCategoryHandler::CreateBatchSchema =
+    _T("{ \"type\": \"object\", ") \
+        _T(" \"properties\": { ") \
+            _T(" \"activities\": { \"type\": \"array\", \"items\": { \"type\": \"object\", ") \
+                _T(" \"properties\": { ") \
+                    _T(" \"activity\" : {") ACTIVITY_TYPE_SCHEMA _T("}, ") \
+                    _T(" \"subscribe\" : { \"type\": \"boolean\", \"optional\": true } , ") \
+                    _T(" \"start\" : { \"type\": \"boolean\", \"optional\": true }, ") \
+                    _T(" \"replace\" : { \"type\": \"boolean\", \"optional\": true } ") \
+                _T("}") \
+            _T("} } ") \
+        _T("}") \
+    _T("}");
+
+const MojChar* const ActivityCategoryHandler::StartBatchSchema =
+    _T("{ \"type\": \"object\", ") \
+        _T(" \"properties\": { ") \
+            _T(" \"activities\": { \"type\": \"array\", \"items\": { \"type\": \"object\", ") \
+                _T(" \"properties\": { ") \
+                    _T(" \"activityId\": { \"type\": \"integer\", \"optional\": true }, ") \
+                    _T(" \"activityName\": { \"type\": \"string\", \"optional\": true } ") \
+                _T("}") \
+            _T("} } ") \
+        _T("}") \
+    _T("}");
+
+const MojChar* const ActivityCategoryHandler::CompleteBatchSchema =
+    _T("{ \"type\": \"object\", ") \
+        _T(" \"properties\": { ") \
+            _T(" \"activities\": { \"type\": \"array\", \"items\": { \"type\": \"object\", ") \
+                _T(" \"properties\": { ") \
+                    _T(" \"activityId\": { \"type\": \"integer\", \"optional\": true }, ") \
+                    _T(" \"activityName\": { \"type\": \"string\", \"optional\": true }, ") \
+                    _T(" \"restart\": { \"type\": \"boolean\", \"optional\": true }, ") \
+                    _T(" \"callback\": { ") CALLBACK_TYPE_SCHEMA _T(", \"optional\": true }, ") \
+                    _T(" \"schedule\": { ") SCHEDULE_TYPE_SCHEMA _T(", \"optional\": true }, ") \
+                    _T(" \"trigger\": { ") TRIGGER_TYPE_SCHEMA _T(", \"optional\": true }, ") \
+                    _T(" \"metadata\": { ") METADATA_TYPE_SCHEMA _T(", \"optional\": true } ") \
+                _T("}") \
+            _T("} } ") \
+        _T("}") \
+    _T("}");
+
+const MojChar* const ActivityCategoryHandler::CancelBatchSchema =
+    _T("{ \"type\": \"object\", ") \
+        _T(" \"properties\": { ") \
+            _T(" \"activities\": { \"type\": \"array\", \"items\": { \"type\": \"object\", ") \
+                _T(" \"properties\": { ") \
+                    _T(" \"activityId\": { \"type\": \"integer\", \"optional\": true }, ") \
+                    _T(" \"activityName\": { \"type\": \"string\", \"optional\": true } ") \
+                _T("}") \
+            _T("} } ") \
+        _T("}") \
+    _T("}");
+
+const MojChar* const ActivityCategoryHandler::GetRequestLatencySchema =
+    _T("{ \"type\": \"object\", ") \
+        _T(" \"properties\": { ") \
+            _T(" \"reset\": { \"type\": \"boolean\", \"optional\": true } ") \
         _T("}") \
     _T("}");
 
@@ -131,6 +203,8 @@ const MojChar* const ActivityCategoryHandler::GetActivityInfoSchema =
  * - \ref com_palm_activitymanager_start
  * - \ref com_palm_activitymanager_stop
  * - \ref com_palm_activitymanager_cancel
+ * - \ref com_palm_activitymanager_batch
+ * - \ref com_palm_activitymanager_request_latency
  */
 
 const ActivityCategoryHandler::SchemaMethod ActivityCategoryHandler::s_methods[] = {
@@ -143,13 +217,21 @@ const ActivityCategoryHandler::SchemaMethod ActivityCategoryHandler::s_methods[]
     { _T("cancel"), (Callback) &ActivityCategoryHandler::cancelActivity, ActivityCategoryHandler::CancelSchema },
     { _T("pause"), (Callback) &ActivityCategoryHandler::pauseActivity, ActivityCategoryHandler::PauseSchema },
     { _T("getActivityInfo"), (Callback) &ActivityCategoryHandler::getActivityInfo, ActivityCategoryHandler::GetActivityInfoSchema },
+    { _T("createBatch"), (Callback) &ActivityCategoryHandler::createActivityBatch, ActivityCategoryHandler::CreateBatchSchema },
+    { _T("startBatch"), (Callback) &ActivityCategoryHandler::startActivityBatch, ActivityCategoryHandler::StartBatchSchema },
+    { _T("completeBatch"), (Callback) &ActivityCategoryHandler::completeActivityBatch, ActivityCategoryHandler::CompleteBatchSchema },
+    { _T("cancelBatch"), (Callback) &ActivityCategoryHandler::cancelActivityBatch, ActivityCategoryHandler::CancelBatchSchema },
     { _T("getManagerInfo"), (Callback) &ActivityCategoryHandler::getManagerInfo, NULL },
+    { _T("getRequestLatency"), (Callback) &ActivityCategoryHandler::getRequestLatency, ActivityCategoryHandler::GetRequestLatencySchema },
     { NULL, NULL, NULL }
 };
 
 ActivityCategoryHandler::ActivityCategoryHandler(
         std::shared_ptr<PermissionManager> pm)
     : m_pm(pm)
+    , m_duplicates([](const std::string& name, const BusId& creator) {
+          return ActivityManager::getInstance().hasActivity(name, creator);
+      })
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Constructing");
@@ -224,6 +306,7 @@ or exit to free memory if it may be awhile before the Activity is ready to run.
     "activity": Activity object,
     "subscribe": boolean,
     "detailedEvents": boolean,
+    "coalesceWindow": int,
     "start": boolean,
     "replace": boolean
 }
@@ -233,6 +316,9 @@ or exit to free memory if it may be awhile before the Activity is ready to run.
 \param subscribe Subscribe to Activity flag.
 \param detailedEvents Flag to have the Activity Manager generate "update" events
        when the state of one of this Activity's requirements changes.
+\param coalesceWindow Milliseconds during which "update" events are collapsed
+       into one, sent with the latest details when the window ends. Other
+       events are still sent right away. 0 (the default) sends every update.
 \param start Start Activity immediately flag.
 \param replace Cancel Activity and replace with Activity of same name flag.
 
@@ -285,7 +371,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::createActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Create: Message from %s: %s",
@@ -294,72 +380,14 @@ MojErr ActivityCategoryHandler::createActivity(MojServiceMessage *msg, MojObject
 
     MojErr err = MojErrNone;
 
-    MojObject spec;
-    err = payload.getRequired(_T("activity"), spec);
-    if (err) {
-        err = msg->replyError(MojErrInvalidArg, "Activity specification not present");
-        MojErrCheck(err);
-        return MojErrNone;
-    }
-
-    /* TODO : Refine this, when ACG migration is complete.
-     * Until then, we allow the creator is set only for the configurator. */
-    MojObject creator;
-    bool privilegedCreator = false;
-    if (Subscription::getServiceName(msg) == "com.webos.service.configurator" ||
-        Subscription::getServiceName(msg) == "com.palm.configurator")
-        privilegedCreator = true;
-
-    if (spec.get(_T("creator"), creator) && !privilegedCreator) {
-        LOG_AM_ERROR(MSGID_PBUS_CALLER_SETTING_CREATOR, 2,
-                     PMLOGKS("sender", Subscription::getServiceName(msg).c_str()),
-                     PMLOGKS("creator", MojoObjectJson(creator).c_str()),
-                     "Only configurator can set 'creator'");
-        err = msg->replyError(MojErrInvalidArg, "Only configurator can set 'creator'");
-        MojErrCheck(err);
-        return MojErrNone;
-    }
+    bool privilegedCreator = isPrivilegedCreator(msg);
 
-    /* First, parse and initialize the Activity.  No callouts to other
-     * Services will be generated until the Activity is scheduled to Start.
-     * It's very possible that the Create can fail (for various reasons)
-     * later, and that's fine... when the Activity is released it will be
-     * torn down. */
     std::shared_ptr<Activity> act;
+    std::string errorText;
 
-    try {
-        act = ActivityExtractor::createActivity(spec);
-
-        /* If creator wasn't already set by the caller. */
-        if (act->getCreator().getType() == BusNull) {
-            act->setCreator(Subscription::getBusId(msg));
-        }
-    } catch (const std::exception& except) {
-        err = msg->replyError(MojErrNoMem, except.what());
-        MojErrCheck(err);
-        return MojErrNone;
-    }
-
-
-    /* Next, check to make sure we can move forward with creating the Activity.
-     * This essentially means:
-     * - The creator is going to subscribe or the Activity is going to start
-     *   now *and* has a callback (or else no one will know that it's
-     *   starting).
-     * - That no other Activity with the same name currently exists for this
-     *   creator, unless "replace" has been specified.
-     */
-    bool subscribed = false;
-    payload.get(_T("subscribe"), subscribed);
-
-    bool start = false;
-    payload.get(_T("start"), start);
-
-    if (!subscribed && !(start && act->hasCallback())) {
-        ActivityManager::getInstance().releaseActivity(std::move(act));
-
-        err = msg->replyError(MojErrInvalidArg,
-                "Created Activity must specify \"start\" and a Callback if not subscribed");
+    MojErr errorCode = prepareCreate(msg, payload, privilegedCreator, act, errorText);
+    if (errorCode) {
+        err = msg->replyError(errorCode, errorText.c_str());
         MojErrCheck(err);
         return MojErrNone;
     }
@@ -382,7 +410,7 @@ MojErr ActivityCategoryHandler::createActivity(MojServiceMessage *msg, MojObject
 MojErr ActivityCategoryHandler::finishCreateActivityPermissionCheck(
         MojRefCountedPtr<MojServiceMessage> msg, MojObject& payload, std::shared_ptr<Activity> act,
         MojErr errorCode, std::string errorText) {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_DEBUG("Create permission: Message from %s: %s",
                  Subscription::getSubscriberString(msg).c_str(),
@@ -396,8 +424,113 @@ MojErr ActivityCategoryHandler::finishCreateActivityPermissionCheck(
         return MojErrNone;
     }
 
+    std::shared_ptr<ICompletion> completion =
+            std::make_shared<MojoMsgCompletion<ActivityCategoryHandler>>(
+                    this, &ActivityCategoryHandler::finishCreateActivity,
+                    msg.get(), payload, act);
+
+    errorCode = commitCreate(payload, act, completion, errorText);
+    if (errorCode) {
+        err = msg->replyError(errorCode, errorText.c_str());
+        MojErrCheck(err);
+        return MojErrNone;
+    }
+
+    ACTIVITY_SERVICEMETHOD_END(msg);
+
+    return MojErrNone;
+}
+
+bool ActivityCategoryHandler::isPrivilegedCreator(MojServiceMessage *msg)
+{
+    /* TODO : Refine this, when ACG migration is complete.
+     * Until then, we allow the creator is set only for the configurator. */
+    return (Subscription::getServiceName(msg) == "com.webos.service.configurator" ||
+            Subscription::getServiceName(msg) == "com.palm.configurator");
+}
+
+/* Parses and initializes the Activity for a create request (or one item of
+ * a batched create).  No callouts to other Services will be generated until
+ * the Activity is scheduled to Start.  It's very possible that the Create
+ * can fail (for various reasons) later, and that's fine... when the
+ * Activity is released it will be torn down. */
+MojErr ActivityCategoryHandler::prepareCreate(MojServiceMessage *msg, const MojObject& request,
+                                              bool privilegedCreator,
+                                              std::shared_ptr<Activity>& act,
+                                              std::string& errorText)
+{
+    MojObject spec;
+    if (!request.get(_T("activity"), spec)) {
+        errorText = "Activity specification not present";
+        return MojErrInvalidArg;
+    }
+
+    MojObject creator;
+    if (spec.get(_T("creator"), creator) && !privilegedCreator) {
+        LOG_AM_ERROR(MSGID_PBUS_CALLER_SETTING_CREATOR, 2,
+                     PMLOGKS("sender", Subscription::getServiceName(msg).c_str()),
+                     PMLOGKS("creator", MojoObjectJson(creator).c_str()),
+                     "Only configurator can set 'creator'");
+        errorText = "Only configurator can set 'creator'";
+        return MojErrInvalidArg;
+    }
+
+    /* Without "replace", a Create for a name that's in use fails anyway.
+     * Clients retrying in a loop hit that a lot, so turn them away before
+     * building the Activity.  The check after the permission check still
+     * stands, as the name may be taken by then, and covers Creates on
+     * behalf of another creator. */
+    if (m_duplicates.isTaken(request, spec, Subscription::getBusId(msg))) {
+        errorText = "Activity with that name already exists";
+        return MojErrExists;
+    }
+
+    try {
+        act = ActivityExtractor::createActivity(spec);
+
+        /* If creator wasn't already set by the caller. */
+        if (act->getCreator().getType() == BusNull) {
+            act->setCreator(Subscription::getBusId(msg));
+        }
+    } catch (const std::exception& except) {
+        errorText = except.what();
+        return MojErrNoMem;
+    }
+
+    /* Next, check to make sure we can move forward with creating the Activity.
+     * This essentially means the creator is going to subscribe or the
+     * Activity is going to start now *and* has a callback (or else no one
+     * will know that it's starting).  That no other Activity with the same
+     * name currently exists for this creator is checked on commit, after
+     * the permission check. */
+    bool subscribed = false;
+    request.get(_T("subscribe"), subscribed);
+
+    bool start = false;
+    request.get(_T("start"), start);
+
+    if (!subscribed && !(start && act->hasCallback())) {
+        ActivityManager::getInstance().releaseActivity(std::move(act));
+        errorText = "Created Activity must specify \"start\" and a Callback if not subscribed";
+        return MojErrInvalidArg;
+    }
+
+    return MojErrNone;
+}
+
+/* Registers a created Activity once its permissions have been checked,
+ * replacing any Activity of the same name and creator if "replace" was
+ * given (returned in replaced, if asked for), and has it stored (through
+ * the batch, if any).  The completion runs once it is. */
+MojErr ActivityCategoryHandler::commitCreate(const MojObject& request,
+                                             std::shared_ptr<Activity> act,
+                                             std::shared_ptr<ICompletion> completion,
+                                             std::string& errorText,
+                                             std::shared_ptr<DB8Batch> batch,
+                                             std::shared_ptr<Activity> *replaced)
+{
     bool replace = false;
-    payload.get(_T("replace"), replace);
+    request.get(_T("replace"), replace);
 
     std::shared_ptr<Activity> old;
     try {
@@ -413,10 +546,9 @@ MojErr ActivityCategoryHandler::finishCreateActivityPermissionCheck(
                        PMLOGKFV("old_activity","%llu",old->getId()), "");
 
         ActivityManager::getInstance().releaseActivity(act);
-        err = msg->replyError(MojErrExists, _T("Activity with that name already exists"));
-
-        MojErrCheck(err);
-        return MojErrNone;
+        m_duplicates.recordLate();
+        errorText = "Activity with that name already exists";
+        return MojErrExists;
     }
 
     /* "Paaaaaaast the point of no return.... no backward glaaaanceeesss!!!!!"
@@ -432,6 +564,9 @@ MojErr ActivityCategoryHandler::finishCreateActivityPermissionCheck(
 
     if (old) {
         LOG_AM_DEBUG("[Activity %llu] Replace old activity %llu", act->getId(), old->getId());
+        if (replaced) {
+            *replaced = old;
+        }
         old->plugAllSubscriptions();
         /* XXX protect against this failing */
         old->getState()->destroy(old);
@@ -444,15 +579,12 @@ MojErr ActivityCategoryHandler::finishCreateActivityPermissionCheck(
     ActivityManager::getInstance().registerActivityName(act);
 
     if (old) {
-        ensureReplaceCompletion(msg.get(), payload, old, act);
+        ensureReplaceCompletion(completion, old, act, batch);
         old->unplugAllSubscriptions();
     } else {
-        ensureCompletion(msg.get(), payload, AbstractPersistManager::StoreCommandType,
-                &ActivityCategoryHandler::finishCreateActivity, act);
+        ensureCompletion(AbstractPersistManager::StoreCommandType, completion, act, batch);
     }
 
-    ACTIVITY_SERVICEMETHOD_END(msg);
-
     return MojErrNone;
 }
 
@@ -460,6 +592,13 @@ void ActivityCategoryHandler::checkAccessRight(const std::string& requester,
                                                std::shared_ptr<AbstractCallback> c,
                                                std::vector<std::shared_ptr<ITrigger>> vec,
                                                PermissionManager::PermissionCallback permissionCB)
+{
+    m_pm->checkAccessRight(requester, getAccessUrls(c, vec), permissionCB);
+}
+
+std::vector<std::string> ActivityCategoryHandler::getAccessUrls(
+        std::shared_ptr<AbstractCallback> c,
+        const std::vector<std::shared_ptr<ITrigger>>& vec)
 {
     std::vector<std::string> urls;
 
@@ -475,7 +614,82 @@ void ActivityCategoryHandler::checkAccessRight(const std::string& requester,
         }
     }
 
-    m_pm->checkAccessRight(requester, urls, permissionCB);
+    return urls;
+}
+
+std::vector<std::string> ActivityCategoryHandler::getCompleteAccessUrls(
+        std::shared_ptr<Activity> act, const MojObject& payload)
+{
+    std::shared_ptr<AbstractCallback> callback;
+    MojObject callbackSpec;
+    if (payload.get(_T("callback"), callbackSpec))
+    {
+        if (callbackSpec.type() != MojObject::TypeBool)
+            callback = ActivityExtractor::createCallback(act, callbackSpec);
+    }
+
+    std::shared_ptr<ActivityCallback> _new =
+            std::dynamic_pointer_cast<ActivityCallback>(callback);
+
+    std::shared_ptr<ActivityCallback> _old =
+            std::dynamic_pointer_cast<ActivityCallback>(act->getCallback());
+
+    bool callbackChanged =
+            (_new && _old && _old->getMethod() != _new->getMethod()) || (!_old && _new);
+
+    std::vector<std::shared_ptr<ITrigger>> triggerVec;
+    MojObject triggerSpec;
+    if (payload.get(_T("trigger"), triggerSpec)) {
+        if (triggerSpec.type() != MojObject::TypeBool)
+            triggerVec = ActivityExtractor::createTriggers(act, triggerSpec);
+    }
+
+    return getAccessUrls((callbackChanged ? callback : std::shared_ptr<AbstractCallback>()),
+                         triggerVec);
+}
+
+void ActivityCategoryHandler::checkAccessRights(const std::string& requester,
+                                                const std::set<std::string>& urls,
+                                                AccessRightsCallback callback)
+{
+    if (urls.empty()) {
+        callback(AccessDenials());
+        return;
+    }
+
+    std::shared_ptr<AccessDenials> denials = std::make_shared<AccessDenials>();
+    std::shared_ptr<size_t> pending = std::make_shared<size_t>(urls.size());
+
+    for (const std::string& url : urls) {
+        m_pm->checkAccessRight(requester, std::vector<std::string>(1, url),
+            [denials, pending, callback, url] (MojErr errorCode, std::string errorText) -> MojErr {
+                if (errorCode) {
+                    (*denials)[url] = std::make_pair(errorCode, errorText);
+                }
+
+                if (--(*pending) == 0) {
+                    callback(*denials);
+                }
+
+                return MojErrNone;
+            });
+    }
+}
+
+bool ActivityCategoryHandler::isAccessDenied(const AccessDenials& denials,
+                                             const std::vector<std::string>& urls,
+                                             MojErr& errorCode, std::string& errorText)
+{
+    for (const std::string& url : urls) {
+        AccessDenials::const_iterator found = denials.find(url);
+        if (found != denials.end()) {
+            errorCode = found->second.first;
+            errorText = found->second.second;
+            return true;
+        }
+    }
+
+    return false;
 }
 
 void ActivityCategoryHandler::finishCreateActivity(MojRefCountedPtr<MojServiceMessage> msg,
@@ -483,7 +697,7 @@ void ActivityCategoryHandler::finishCreateActivity(MojRefCountedPtr<MojServiceMe
                                                    std::shared_ptr<Activity> act,
                                                    bool succeeded)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Create finishing: Message from %s: [Activity %llu]: %s",
@@ -620,7 +834,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::releaseActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Release: Message from %s: %s",
@@ -698,7 +912,8 @@ the Activity Manager before unsubscribing.
     "activityName": string,
     "wait": boolean,
     "subscribe": boolean,
-    "detailedEvents": boolean
+    "detailedEvents": boolean,
+    "coalesceWindow": int
 }
 \endcode
 
@@ -709,6 +924,8 @@ the Activity Manager before unsubscribing.
        \e Required.
 \param detailedEvents Flag to have the Activity Manager generate "update" events
        when the state of an Activity's requirement changes. \e Required.
+\param coalesceWindow Milliseconds during which "update" events are collapsed
+       into one, as for create.
 
 \subsection com_palm_activitymanager_adopt_returns Returns:
 \code
@@ -754,7 +971,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::adoptActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Adopt: Message from %s: %s",
@@ -898,7 +1115,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::completeActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Complete: Message from %s: %s",
@@ -920,40 +1137,13 @@ MojErr ActivityCategoryHandler::completeActivity(MojServiceMessage *msg, MojObje
 
     /* Check the permission of activity creator & activitymanager */
     if (restart) {
-
-        std::shared_ptr<AbstractCallback> callback;
-        MojObject callbackSpec;
-        if (payload.get(_T("callback"), callbackSpec))
-        {
-            if (callbackSpec.type() != MojObject::TypeBool)
-                callback = ActivityExtractor::createCallback(act, callbackSpec);
-        }
-
-        std::shared_ptr<ActivityCallback> _new =
-                std::dynamic_pointer_cast<ActivityCallback>(callback);
-
-        std::shared_ptr<ActivityCallback> _old =
-                std::dynamic_pointer_cast<ActivityCallback>(act->getCallback());
-
-        bool callbackChanged =
-                (_new && _old && _old->getMethod() != _new->getMethod()) || (!_old && _new);
-
-        std::vector<std::shared_ptr<ITrigger>> triggerVec;
-        MojObject triggerSpec;
-        if (payload.get(_T("trigger"), triggerSpec)) {
-            if (triggerSpec.type() != MojObject::TypeBool)
-                triggerVec = ActivityExtractor::createTriggers(act, triggerSpec);
-        }
-
         std::string requester = PermissionManager::getRequester(msg);
         PermissionManager::PermissionCallback permissionCallback =
                 std::bind(&ActivityCategoryHandler::finishCompleteActivityPermissionCheck, this,
                           MojRefCountedPtr<MojServiceMessage>(msg), payload, act, restart,
                           std::placeholders::_1, std::placeholders::_2);
-        checkAccessRight(requester,
-                         (callbackChanged ? callback : std::shared_ptr<AbstractCallback>()),
-                         triggerVec,
-                         permissionCallback);
+        m_pm->checkAccessRight(requester, getCompleteAccessUrls(act, payload),
+                               permissionCallback);
 
         return MojErrNone;
     }
@@ -971,7 +1161,7 @@ MojErr ActivityCategoryHandler::finishCompleteActivityPermissionCheck(
         MojRefCountedPtr<MojServiceMessage> msg, MojObject& payload, std::shared_ptr<Activity> act,
         bool restart, MojErr errorCode, std::string errorText)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_DEBUG("Complete permission: Message from %s: %s",
                  Subscription::getSubscriberString(msg).c_str(),
@@ -1037,7 +1227,7 @@ void ActivityCategoryHandler::finishCompleteActivity(MojRefCountedPtr<MojService
                                                      std::shared_ptr<Activity> act,
                                                      bool succeeded)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Complete finishing: Message from %s: [Activity %llu]: %s",
@@ -1127,7 +1317,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::startActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Start: Message from %s: %s",
@@ -1227,7 +1417,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::stopActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Stop: Message from %s: %s",
@@ -1276,7 +1466,7 @@ void ActivityCategoryHandler::finishStopActivity(MojRefCountedPtr<MojServiceMess
                                                  std::shared_ptr<Activity> act,
                                                  bool succeeded)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Stop finishing: Message from %s: [Activity %llu]: %s",
@@ -1365,7 +1555,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::cancelActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Cancel: Message from %s: %s",
@@ -1411,7 +1601,7 @@ void ActivityCategoryHandler::finishCancelActivity(MojRefCountedPtr<MojServiceMe
                                                    std::shared_ptr<Activity> act,
                                                    bool succeeded)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Cancel finishing: Message from %s: [Activity %llu] : %s",
@@ -1494,7 +1684,7 @@ Example response for a failed call:
 
 MojErr ActivityCategoryHandler::pauseActivity(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Pause: Message from %s: %s",
@@ -1533,94 +1723,628 @@ MojErr ActivityCategoryHandler::pauseActivity(MojServiceMessage *msg, MojObject&
 /*!
 \page com_palm_activitymanager
 \n
-\section com_palm_activitymanager_info info
+\section com_palm_activitymanager_batch createBatch, startBatch, completeBatch, cancelBatch
 
 \e Public.
 
-com.palm.activitymanager/info
+com.palm.activitymanager/createBatch\n
+com.palm.activitymanager/startBatch\n
+com.palm.activitymanager/completeBatch\n
+com.palm.activitymanager/cancelBatch
 
-Get activity manager related information:
-\li Activity Manager state:  Run queues and leaked Activities.
-\li List of Activities for which power is currently locked.
-\li State of the Resource Manager(s).
+Perform create, start, complete or cancel on several Activities in one call.
+Each item of "activities" takes the parameters of the corresponding single
+method, and gets its own result, in the same order. One item failing doesn't
+fail the others.
 
-\subsection com_palm_activitymanager_info_syntax Syntax:
+Callback and trigger permissions are checked once for each distinct URL in the
+batch, and the Activities' persistence is written to MojoDB in a single call.
+
+Batched Activities can't be subscribed to, so each item of createBatch must set
+"start" and specify a callback. startBatch replies once the Activities are
+queued to start. completeBatch doesn't take "force". At most 128 items are
+allowed per call.
+
+\subsection com_palm_activitymanager_batch_syntax Syntax:
 \code
 {
+    "activities": [ object array ]
 }
 \endcode
 
-\subsection com_palm_activitymanager_info_examples Examples:
+\param activities Parameters for each Activity, as for the single method.
+
+\subsection com_palm_activitymanager_batch_returns Returns:
 \code
-luna-send -i -f luna://com.palm.activitymanager/info '{ }'
+{
+    "errorCode": int,
+    "errorText": string,
+    "returnValue": boolean,
+    "results": [
+        {
+            "activityId": int,
+            "errorCode": int,
+            "errorText": string,
+            "replacedActivityId": int,
+            "returnValue": boolean
+        }
+    ]
+}
+\endcode
+
+\param errorCode Code for the error in case the call was not succesful.
+\param errorText Describes the error if the call was not succesful.
+\param returnValue Indicates if the call was succesful.
+\param results Result for each item, in the order of the request. A createBatch
+item that replaced an Activity, and then failed to be stored, gives the id of
+the replaced Activity as "replacedActivityId". That Activity has been cancelled.
+
+\subsection com_palm_activitymanager_batch_examples Examples:
+\code
+luna-send -i -f luna://com.palm.activitymanager/cancelBatch '{ "activities": [{ "activityId": 81 }, { "activityName": "gone" }] }'
 \endcode
 
 Example response for a succesful call:
 \code
 {
-    "queues": [
+    "results": [
         {
-            "activities": [
-                {
-                    "activityId": 28,
-                    "creator": {
-                        "serviceId": "com.palm.service.contacts.linker"
-                    },
-                    "name": "linkerWatch"
-                },
-                ...
-                {
-                    "activityId": 10,
-                    "creator": {
-                        "serviceId": "com.palm.db"
-                    },
-                    "name": "mojodbspace"
-                }
-            ],
-            "name": "scheduled"
+            "activityId": 81,
+            "returnValue": true
+        },
+        {
+            "errorCode": -1984,
+            "errorText": "Activity name/creator pair not found",
+            "returnValue": false
         }
     ],
-    "resourceManager": {
-        "entities": [
-            {
-                "activities": [
-                ],
-                "appId": "1",
-                "focused": false,
-                "priority": "none"
-            },
-            ...
-            {
-                "activities": [
-                ],
-                "anonId": "3",
-                "focused": false,
-                "priority": "none"
-            }
-        ],
-        "resources": {
-            "cpu": {
-                "containers": [
-                    {
-                        "entities": [
-                            {
-                                "focused": false,
-                                "priority": "none",
-                                "serviceId": "com.palm.accountservices"
-                            }
-                        ],
-                        "focused": false,
-                        "name": "com.palm.accountservices",
-                        "path": "\/dev\/cgroups\/com.palm.accountservices",
-                        "priority": "low"
-                    },
-                    ...
-                    {
-                        "entities": [
-                            {
-                                "focused": false,
-                                "priority": "none",
-                                "serviceId": "2"
+    "returnValue": true
+}
+\endcode
+
+Example response for a failed call:
+\code
+{
+    "errorCode": -986,
+    "errorText": "Too many Activities in batch",
+    "returnValue": false
+}
+\endcode
+*/
+
+MojErr ActivityCategoryHandler::createActivityBatch(MojServiceMessage *msg, MojObject& payload)
+{
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
+
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("Create batch: Message from %s: %s",
+                 Subscription::getSubscriberString(msg).c_str(),
+                 MojoObjectJson(payload).c_str());
+
+    std::vector<MojObject> items;
+    if (!getBatchItems(msg, payload, items)) {
+        return MojErrNone;
+    }
+
+    bool privilegedCreator = isPrivilegedCreator(msg);
+
+    std::string requester = privilegedCreator ? Subscription::getServiceName(msg) : PermissionManager::getRequester(msg);
+    std::string requesterExeName = PermissionManager::getRequesterExeName(msg);
+
+    std::shared_ptr<BatchReply> batch = std::make_shared<BatchReply>(msg, items.size());
+    std::vector<std::shared_ptr<Activity> > acts(items.size());
+    BatchUrls urls(items.size());
+    std::set<std::string> allUrls;
+
+    /* Two creates of the same name in one batch would have the second
+     * replace the first before its store was issued. */
+    std::set<std::pair<std::string, std::string> > names;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        bool subscribe = false;
+        items[i].get(_T("subscribe"), subscribe);
+        if (subscribe) {
+            batch->fail(i, MojErrInvalidArg, "Batched Activities can't be subscribed to");
+            continue;
+        }
+
+        std::shared_ptr<Activity> act;
+        std::string errorText;
+
+        MojErr errorCode = prepareCreate(msg, items[i], privilegedCreator, act, errorText);
+        if (errorCode) {
+            batch->fail(i, errorCode, errorText);
+            continue;
+        }
+
+        if (!names.insert(std::make_pair(act->getName(), act->getCreator().getString())).second) {
+            ActivityManager::getInstance().releaseActivity(std::move(act));
+            batch->fail(i, MojErrExists, "Activity with that name already in the batch");
+            continue;
+        }
+
+        act->setRequesterExeName(requesterExeName);
+
+        urls[i] = getAccessUrls(act->getCallback(), act->getTriggers());
+        allUrls.insert(urls[i].begin(), urls[i].end());
+        acts[i] = act;
+    }
+
+    checkAccessRights(requester, allUrls,
+                      std::bind(&ActivityCategoryHandler::finishCreateBatchPermissionCheck, this,
+                                MojRefCountedPtr<MojServiceMessage>(msg), items, acts, urls,
+                                batch, std::placeholders::_1));
+
+    ACTIVITY_SERVICEMETHOD_END(msg);
+
+    return MojErrNone;
+}
+
+void ActivityCategoryHandler::finishCreateBatchPermissionCheck(
+        MojRefCountedPtr<MojServiceMessage> msg,
+        std::vector<MojObject> items,
+        std::vector<std::shared_ptr<Activity> > acts,
+        BatchUrls urls,
+        std::shared_ptr<BatchReply> batch,
+        const AccessDenials& denials)
+{
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
+
+    LOG_AM_DEBUG("Create batch permission: Message from %s: %zu denied",
+                 Subscription::getSubscriberString(msg).c_str(), denials.size());
+
+    std::shared_ptr<DB8Batch> stores =
+            DB8Manager::getInstance().prepareBatch(AbstractPersistManager::StoreCommandType);
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::shared_ptr<Activity> act = acts[i];
+        if (!act) {
+            continue;
+        }
+
+        MojErr errorCode = MojErrNone;
+        std::string errorText;
+        if (isAccessDenied(denials, urls[i], errorCode, errorText)) {
+            ActivityManager::getInstance().releaseActivity(act);
+            batch->fail(i, errorCode, errorText);
+            continue;
+        }
+
+        std::shared_ptr<ICompletion> completion =
+                std::make_shared<BatchCompletion<ActivityCategoryHandler>>(
+                        this, &ActivityCategoryHandler::finishCreateBatchItem,
+                        batch, i, items[i], act);
+
+        try {
+            std::shared_ptr<Activity> replaced;
+            errorCode = commitCreate(items[i], act, completion, errorText, stores, &replaced);
+            if (errorCode) {
+                batch->fail(i, errorCode, errorText);
+            } else if (replaced) {
+                batch->setReplaced(i, replaced->getId());
+            }
+        } catch (const std::exception& except) {
+            batch->fail(i, MojErrInternal, except.what());
+        }
+    }
+
+    stores->seal();
+
+    ACTIVITY_SERVICEMETHODFINISH_END(msg);
+}
+
+void ActivityCategoryHandler::finishCreateBatchItem(std::shared_ptr<BatchReply> batch,
+                                                    size_t index,
+                                                    const MojObject& item,
+                                                    std::shared_ptr<Activity> act,
+                                                    bool succeeded)
+{
+    LOG_AM_DEBUG("Create batch finishing: [Activity %llu]: %s",
+                 act->getId(), succeeded ? "succeeded" : "failed");
+
+    /* Only this item's store failed; the rest of the batch stands.  The
+     * Activity is registered by now, so it's ended as a cancel would end
+     * it.  Any Activity it replaced is gone already, and is reported. */
+    if (!succeeded) {
+        act->plugAllSubscriptions();
+        ActivityManager::getInstance().cancelActivity(act);
+        if (act->isNameRegistered()) {
+            ActivityManager::getInstance().unregisterActivityName(act);
+        }
+        act->unplugAllSubscriptions();
+
+        batch->fail(index, MojErrInternal, "Failed to store Activity");
+        return;
+    }
+
+    ActivityManager::getInstance().startActivity(act);
+
+    if (!act->isRunning()) {
+        act->broadcastEvent(kActivityUpdateEvent);
+    }
+
+    batch->succeed(index, act->getId());
+}
+
+MojErr ActivityCategoryHandler::startActivityBatch(MojServiceMessage *msg, MojObject& payload)
+{
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
+
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("Start batch: Message from %s: %s",
+                 Subscription::getSubscriberString(msg).c_str(),
+                 MojoObjectJson(payload).c_str());
+
+    std::vector<MojObject> items;
+    if (!getBatchItems(msg, payload, items)) {
+        return MojErrNone;
+    }
+
+    std::shared_ptr<BatchReply> batch = std::make_shared<BatchReply>(msg, items.size());
+    std::set<activityId_t> seen;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::shared_ptr<Activity> act = lookupBatchActivity(msg, items[i], batch, i, seen);
+        if (!act) {
+            continue;
+        }
+
+        if (!validateCaller(Subscription::getBusId(msg), act)) {
+            batch->fail(i, MojErrAccessDenied, "caller is not a parent or creator");
+            continue;
+        }
+
+        MojErr err = ActivityManager::getInstance().startActivity(act);
+        if (err) {
+            LOG_AM_DEBUG("Start batch: Failed to start [Activity %llu]", act->getId());
+            batch->fail(i, err, "Failed to start Activity");
+        } else {
+            LOG_AM_DEBUG("Start batch: [Activity %llu] started", act->getId());
+            batch->succeed(i, act->getId());
+        }
+    }
+
+    ACTIVITY_SERVICEMETHOD_END(msg);
+
+    return MojErrNone;
+}
+
+MojErr ActivityCategoryHandler::completeActivityBatch(MojServiceMessage *msg, MojObject& payload)
+{
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
+
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("Complete batch: Message from %s: %s",
+                 Subscription::getSubscriberString(msg).c_str(),
+                 MojoObjectJson(payload).c_str());
+
+    std::vector<MojObject> items;
+    if (!getBatchItems(msg, payload, items)) {
+        return MojErrNone;
+    }
+
+    std::shared_ptr<BatchReply> batch = std::make_shared<BatchReply>(msg, items.size());
+    std::vector<std::shared_ptr<Activity> > acts(items.size());
+    BatchUrls urls(items.size());
+    std::set<std::string> allUrls;
+    std::set<activityId_t> seen;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::shared_ptr<Activity> act = lookupBatchActivity(msg, items[i], batch, i, seen);
+        if (!act) {
+            continue;
+        }
+
+        try {
+            MojErr err = checkSerial(msg, items[i], act);
+            if (err) {
+                batch->fail(i, err, "Invalid serial number");
+                continue;
+            }
+
+            bool restart = false;
+            items[i].get(_T("restart"), restart);
+            if (restart) {
+                urls[i] = getCompleteAccessUrls(act, items[i]);
+                allUrls.insert(urls[i].begin(), urls[i].end());
+            }
+        } catch (const std::exception& except) {
+            batch->fail(i, MojErrInternal, except.what());
+            continue;
+        }
+
+        acts[i] = act;
+    }
+
+    checkAccessRights(PermissionManager::getRequester(msg), allUrls,
+                      std::bind(&ActivityCategoryHandler::finishCompleteBatchPermissionCheck, this,
+                                MojRefCountedPtr<MojServiceMessage>(msg), items, acts, urls,
+                                batch, std::placeholders::_1));
+
+    ACTIVITY_SERVICEMETHOD_END(msg);
+
+    return MojErrNone;
+}
+
+void ActivityCategoryHandler::finishCompleteBatchPermissionCheck(
+        MojRefCountedPtr<MojServiceMessage> msg,
+        std::vector<MojObject> items,
+        std::vector<std::shared_ptr<Activity> > acts,
+        BatchUrls urls,
+        std::shared_ptr<BatchReply> batch,
+        const AccessDenials& denials)
+{
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
+
+    LOG_AM_DEBUG("Complete batch permission: Message from %s: %zu denied",
+                 Subscription::getSubscriberString(msg).c_str(), denials.size());
+
+    std::shared_ptr<DB8Batch> stores =
+            DB8Manager::getInstance().prepareBatch(AbstractPersistManager::StoreCommandType);
+    std::shared_ptr<DB8Batch> deletes =
+            DB8Manager::getInstance().prepareBatch(AbstractPersistManager::DeleteCommandType);
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::shared_ptr<Activity> act = acts[i];
+        if (!act) {
+            continue;
+        }
+
+        MojErr errorCode = MojErrNone;
+        std::string errorText;
+        if (isAccessDenied(denials, urls[i], errorCode, errorText)) {
+            batch->fail(i, errorCode, errorText);
+            continue;
+        }
+
+        bool restart = false;
+        items[i].get(_T("restart"), restart);
+
+        try {
+            if (restart) {
+                ActivityExtractor::updateActivity(act, items[i]);
+                act->setRestartFlag(true);
+            } else {
+                act->setTerminateFlag(true);
+            }
+
+            act->plugAllSubscriptions();
+
+            /* "force" is for testing, from the private bus, so isn't
+             * offered in batches */
+            MojErr err = act->complete(Subscription::getBusId(msg), false);
+            if (err == MojErrNone) {
+                LOG_AM_DEBUG("Complete batch: %s completing [Activity %llu]",
+                             Subscription::getSubscriberString(msg).c_str(), act->getId());
+
+                std::shared_ptr<ICompletion> completion =
+                        std::make_shared<BatchCompletion<ActivityCategoryHandler>>(
+                                this, &ActivityCategoryHandler::finishCompleteBatchItem,
+                                batch, i, items[i], act);
+
+                if (restart) {
+                    ensureCompletion(AbstractPersistManager::StoreCommandType,
+                                     completion, act, stores);
+                } else {
+                    ensureCompletion(AbstractPersistManager::DeleteCommandType,
+                                     completion, act, deletes);
+                }
+
+                act->unplugAllSubscriptions();
+            } else {
+                LOG_AM_DEBUG("Complete batch: %s failed to complete [Activity %llu]",
+                             Subscription::getSubscriberString(msg).c_str(), act->getId());
+
+                act->setTerminateFlag(false);
+                act->unplugAllSubscriptions();
+
+                batch->fail(i, err, "Failed to complete Activity");
+            }
+        } catch (const std::exception& except) {
+            act->unplugAllSubscriptions();
+            batch->fail(i, MojErrInternal, except.what());
+        }
+    }
+
+    stores->seal();
+    deletes->seal();
+
+    ACTIVITY_SERVICEMETHODFINISH_END(msg);
+}
+
+void ActivityCategoryHandler::finishCompleteBatchItem(std::shared_ptr<BatchReply> batch,
+                                                      size_t index,
+                                                      const MojObject& item,
+                                                      std::shared_ptr<Activity> act,
+                                                      bool succeeded)
+{
+    LOG_AM_DEBUG("Complete batch finishing: [Activity %llu]: %s",
+                 act->getId(), succeeded ? "succeeded" : "failed");
+
+    bool restart = false;
+    item.get(_T("restart"), restart);
+
+    if (!restart && act->isNameRegistered()) {
+        ActivityManager::getInstance().unregisterActivityName(act);
+    }
+
+    batch->succeed(index, act->getId());
+}
+
+MojErr ActivityCategoryHandler::cancelActivityBatch(MojServiceMessage *msg, MojObject& payload)
+{
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
+
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+    LOG_AM_DEBUG("Cancel batch: Message from %s: %s",
+                 Subscription::getSubscriberString(msg).c_str(),
+                 MojoObjectJson(payload).c_str());
+
+    std::vector<MojObject> items;
+    if (!getBatchItems(msg, payload, items)) {
+        return MojErrNone;
+    }
+
+    std::shared_ptr<BatchReply> batch = std::make_shared<BatchReply>(msg, items.size());
+    std::shared_ptr<DB8Batch> deletes =
+            DB8Manager::getInstance().prepareBatch(AbstractPersistManager::DeleteCommandType);
+    std::set<activityId_t> seen;
+
+    for (size_t i = 0; i < items.size(); ++i) {
+        std::shared_ptr<Activity> act = lookupBatchActivity(msg, items[i], batch, i, seen);
+        if (!act) {
+            continue;
+        }
+
+        if (!validateCaller(Subscription::getBusId(msg), act)) {
+            batch->fail(i, MojErrAccessDenied, "caller is not a parent or creator");
+            continue;
+        }
+
+        act->plugAllSubscriptions();
+
+        try {
+            MojErr err = ActivityManager::getInstance().cancelActivity(act);
+            if (err) {
+                LOG_AM_DEBUG("Cancel batch: Failed to cancel [Activity %llu]", act->getId());
+                batch->fail(i, err, "Failed to cancel Activity");
+            } else {
+                LOG_AM_DEBUG("Cancel batch: [Activity %llu] cancelling", act->getId());
+
+                std::shared_ptr<ICompletion> completion =
+                        std::make_shared<BatchCompletion<ActivityCategoryHandler>>(
+                                this, &ActivityCategoryHandler::finishCancelBatchItem,
+                                batch, i, items[i], act);
+
+                ensureCompletion(AbstractPersistManager::DeleteCommandType,
+                                 completion, act, deletes);
+            }
+        } catch (const std::exception& except) {
+            batch->fail(i, MojErrInternal, except.what());
+        }
+
+        act->unplugAllSubscriptions();
+    }
+
+    deletes->seal();
+
+    ACTIVITY_SERVICEMETHOD_END(msg);
+
+    return MojErrNone;
+}
+
+void ActivityCategoryHandler::finishCancelBatchItem(std::shared_ptr<BatchReply> batch,
+                                                    size_t index,
+                                                    const MojObject& item,
+                                                    std::shared_ptr<Activity> act,
+                                                    bool succeeded)
+{
+    LOG_AM_DEBUG("Cancel batch finishing: [Activity %llu] : %s",
+                 act->getId(), succeeded ? "succeeded" : "failed");
+
+    if (act->isNameRegistered()) {
+        ActivityManager::getInstance().unregisterActivityName(act);
+    }
+
+    batch->succeed(index, act->getId());
+}
+
+/*!
+\page com_palm_activitymanager
+\n
+\section com_palm_activitymanager_info info
+
+\e Public.
+
+com.palm.activitymanager/info
+
+Get activity manager related information:
+\li Activity Manager state:  Run queues and leaked Activities.
+\li List of Activities for which power is currently locked.
+\li State of the Resource Manager(s).
+\li MojoDB store queue: calls made, stores put, and commit latency, and
+stores absorbed by an earlier store of the same Activity.
+\li Request latency per method, as from \ref com_palm_activitymanager_request_latency.
+\li Creates refused for a name already in use, before ("early") and after
+("late") the Activity was built.
+
+\subsection com_palm_activitymanager_info_syntax Syntax:
+\code
+{
+}
+\endcode
+
+\subsection com_palm_activitymanager_info_examples Examples:
+\code
+luna-send -i -f luna://com.palm.activitymanager/info '{ }'
+\endcode
+
+Example response for a succesful call:
+\code
+{
+    "queues": [
+        {
+            "activities": [
+                {
+                    "activityId": 28,
+                    "creator": {
+                        "serviceId": "com.palm.service.contacts.linker"
+                    },
+                    "name": "linkerWatch"
+                },
+                ...
+                {
+                    "activityId": 10,
+                    "creator": {
+                        "serviceId": "com.palm.db"
+                    },
+                    "name": "mojodbspace"
+                }
+            ],
+            "name": "scheduled"
+        }
+    ],
+    "resourceManager": {
+        "entities": [
+            {
+                "activities": [
+                ],
+                "appId": "1",
+                "focused": false,
+                "priority": "none"
+            },
+            ...
+            {
+                "activities": [
+                ],
+                "anonId": "3",
+                "focused": false,
+                "priority": "none"
+            }
+        ],
+        "resources": {
+            "cpu": {
+                "containers": [
+                    {
+                        "entities": [
+                            {
+                                "focused": false,
+                                "priority": "none",
+                                "serviceId": "com.palm.accountservices"
+                            }
+                        ],
+                        "focused": false,
+                        "name": "com.palm.accountservices",
+                        "path": "\/dev\/cgroups\/com.palm.accountservices",
+                        "priority": "low"
+                    },
+                    ...
+                    {
+                        "entities": [
+                            {
+                                "focused": false,
+                                "priority": "none",
+                                "serviceId": "2"
                             },
                             {
                                 "anonId": "3",
@@ -1660,7 +2384,7 @@ Example response for a succesful call:
 
 MojErr ActivityCategoryHandler::getManagerInfo(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
@@ -1679,6 +2403,21 @@ MojErr ActivityCategoryHandler::getManagerInfo(MojServiceMessage *msg, MojObject
     err = RequirementManager::getInstance().infoToJson(reply);
     MojErrCheck(err);
 
+    err = m_pm->infoToJson(reply);
+    MojErrCheck(err);
+
+    err = ActivityExtractor::infoToJson(reply);
+    MojErrCheck(err);
+
+    err = RequestLatency::getInstance().infoToJson(reply);
+    MojErrCheck(err);
+
+    err = DB8Manager::getInstance().infoToJson(reply);
+    MojErrCheck(err);
+
+    err = m_duplicates.infoToJson(reply);
+    MojErrCheck(err);
+
     err = reply.putBool(MojServiceMessage::ReturnValueKey, true);
     MojErrCheck(err);
 
@@ -1693,9 +2432,92 @@ MojErr ActivityCategoryHandler::getManagerInfo(MojServiceMessage *msg, MojObject
     return MojErrNone;
 }
 
+/*!
+\page com_palm_activitymanager
+\n
+\section com_palm_activitymanager_request_latency getRequestLatency
+
+\e Public.
+
+com.palm.activitymanager/getRequestLatency
+
+Get the time from each request's arrival to its first reply, per method,
+since the Activity Manager started or the figures were last reset.  Times
+include waiting for permission checks and MojoDB.
+
+\subsection com_palm_activitymanager_request_latency_syntax Syntax:
+\code
+{
+    "reset": boolean
+}
+\endcode
+
+\param reset Clear the figures after replying with them. Optional.
+
+\subsection com_palm_activitymanager_request_latency_examples Examples:
+\code
+luna-send -i -f luna://com.palm.activitymanager/getRequestLatency '{ "reset": true }'
+\endcode
+
+Example response for a succesful call:
+\code
+{
+    "returnValue": true,
+    "methods": {
+        "create": {
+            "count": 412,
+            "p50Us": 1855,
+            "p90Us": 4095,
+            "p99Us": 12287,
+            "maxUs": 20113
+        },
+        ...
+    },
+    "pending": 3,
+    "untimed": 0
+}
+\endcode
+
+"pending" requests are still waiting for a reply.  "untimed" requests
+were replied to where they couldn't be timed, or waited too long.
+*/
+
+MojErr ActivityCategoryHandler::getRequestLatency(MojServiceMessage *msg, MojObject& payload)
+{
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
+
+    LOG_AM_TRACE("Entering function %s", __FUNCTION__);
+
+    bool reset = false;
+    payload.get(_T("reset"), reset);
+
+    MojObject reply(MojObject::TypeObject);
+
+    MojErr err = RequestLatency::getInstance().toJson(reply);
+    MojErrCheck(err);
+
+    err = reply.putBool(MojServiceMessage::ReturnValueKey, true);
+    MojErrCheck(err);
+
+    err = msg->reply(reply);
+    MojErrCheck(err);
+
+    if (reset) {
+        RequestLatency::getInstance().reset();
+    }
+
+    ACTIVITY_SERVICEMETHOD_END(msg);
+
+    return MojErrNone;
+}
+
+/* Without an activityId or activityName, lists the Activities matching the
+ * optional "state", "creator", "namePrefix" and "queue" filters, in ID order.
+ * With "limit", replies with one page and a "cursor" to pass back for the
+ * next one.  With "subscribe", streams the listing in chunks instead. */
 MojErr ActivityCategoryHandler::getActivityInfo(MojServiceMessage *msg, MojObject& payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Details: Message from %s: %s",
@@ -1740,21 +2562,35 @@ MojErr ActivityCategoryHandler::getActivityInfo(MojServiceMessage *msg, MojObjec
         err = reply.put(_T("activity"), activity);
         MojErrCheck(err);
     } else {
-        const ActivityManager::ActivityVec activities = ActivityManager::getInstance().getActivities();
+        ActivityQuery query;
+        err = getActivityQuery(payload, query);
+        MojErrCheck(err);
 
-        MojObject activityArray(MojObject::TypeArray);
-        for (ActivityManager::ActivityVec::const_iterator iter = activities.begin();
-                iter != activities.end(); ++iter) {
-            MojObject activity;
-            err = (*iter)->toJson(activity, flags);
-            MojErrCheck(err);
+        bool subscribe = false;
+        payload.get(_T("subscribe"), subscribe);
+        if (subscribe) {
+            std::make_shared<ActivityInfoStream>(msg, query, flags)->start();
+            return MojErrNone;
+        }
 
-            err = activityArray.push(activity);
+        ActivityManager::ActivityVec page;
+        bool more = false;
+        try {
+            more = ActivityManager::getInstance().queryActivities(query, page);
+        } catch (const std::exception& except) {
+            err = msg->replyError(MojErrInvalidArg, except.what());
             MojErrCheck(err);
+            return MojErrNone;
         }
 
-        err = reply.put(_T("activities"), activityArray);
+        err = ActivityInfoStream::pageToJson(page, flags, reply);
         MojErrCheck(err);
+
+        /* Pass back to get the next page */
+        if (more) {
+            err = reply.putInt(_T("cursor"), (MojInt64) page.back()->getId());
+            MojErrCheck(err);
+        }
     }
 
     err = reply.putBool(MojServiceMessage::ReturnValueKey, true);
@@ -1768,8 +2604,51 @@ MojErr ActivityCategoryHandler::getActivityInfo(MojServiceMessage *msg, MojObjec
     return MojErrNone;
 }
 
+MojErr ActivityCategoryHandler::getActivityQuery(const MojObject& payload, ActivityQuery& query)
+{
+    MojErr err = MojErrNone;
+    MojString value;
+    bool found = false;
+
+    err = payload.get(_T("state"), value, found);
+    MojErrCheck(err);
+    if (found) {
+        query.setState(value.data());
+    }
+
+    err = payload.get(_T("creator"), value, found);
+    MojErrCheck(err);
+    if (found) {
+        query.setCreator(value.data());
+    }
+
+    err = payload.get(_T("namePrefix"), value, found);
+    MojErrCheck(err);
+    if (found) {
+        query.setNamePrefix(value.data());
+    }
+
+    err = payload.get(_T("queue"), value, found);
+    MojErrCheck(err);
+    if (found) {
+        query.setQueue(value.data());
+    }
+
+    MojInt64 cursor = 0;
+    if (payload.get(_T("cursor"), cursor) && (cursor > 0)) {
+        query.setCursor((activityId_t) cursor);
+    }
+
+    MojInt64 limit = 0;
+    if (payload.get(_T("limit"), limit) && (limit > 0)) {
+        query.setLimit((size_t) limit);
+    }
+
+    return MojErrNone;
+}
+
 MojErr ActivityCategoryHandler::replyDeprecatedMethod(MojServiceMessage *msg, MojObject& payload) {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     MojErr err;
     err = msg->replyError(MojErrInternal, "Do not use this method because it is invalid");
@@ -1780,6 +2659,62 @@ MojErr ActivityCategoryHandler::replyDeprecatedMethod(MojServiceMessage *msg, Mo
     return MojErrNone;
 }
 
+bool ActivityCategoryHandler::getBatchItems(MojServiceMessage *msg,
+                                            MojObject& payload,
+                                            std::vector<MojObject>& items)
+{
+    MojErr err = MojErrNone;
+
+    MojObject activities;
+    if (!payload.get(_T("activities"), activities) ||
+        (activities.type() != MojObject::TypeArray)) {
+        err = msg->replyError(MojErrInvalidArg, "Activities array not present");
+    } else if (activities.size() > kMaxBatchSize) {
+        err = msg->replyError(MojErrInvalidArg, "Too many Activities in batch");
+    } else if (activities.size() == 0) {
+        MojObject reply;
+        err = reply.put(_T("results"), MojObject(MojObject::TypeArray));
+        if (!err) {
+            err = msg->replySuccess(reply);
+        }
+    } else {
+        for (MojObject::ConstArrayIterator iter = activities.arrayBegin();
+                iter != activities.arrayEnd(); ++iter) {
+            items.push_back(*iter);
+        }
+
+        return true;
+    }
+
+    if (err)
+        LOG_AM_ERROR(MSGID_ACTVTY_REPLY_ERR, 0, "Failed to generate reply to batch request");
+
+    return false;
+}
+
+std::shared_ptr<Activity> ActivityCategoryHandler::lookupBatchActivity(
+        MojServiceMessage *msg, const MojObject& item, std::shared_ptr<BatchReply> batch,
+        size_t index, std::set<activityId_t>& seen)
+{
+    std::shared_ptr<Activity> act;
+
+    try {
+        act = ActivityExtractor::lookupActivity(item, Subscription::getBusId(msg));
+    } catch (const std::exception& except) {
+        batch->fail(index, MojErrNotFound, except.what());
+        return std::shared_ptr<Activity>();
+    }
+
+    /* A second command on the same Activity would wait behind the first,
+     * which can't be issued until the whole batch is ready. */
+    if (!seen.insert(act->getId()).second) {
+        batch->fail(index, MojErrInvalidArg, "Activity appears more than once in the batch");
+        return std::shared_ptr<Activity>();
+    }
+
+    return act;
+}
+
 MojErr ActivityCategoryHandler::lookupActivity(MojServiceMessage *msg,
                                                MojObject& payload,
                                                std::shared_ptr<Activity>& act)
@@ -1829,6 +2764,15 @@ bool ActivityCategoryHandler::subscribeActivity(MojServiceMessage *msg,
     payload.get(_T("detailedEvents"), detailedEvents);
 
     sub = std::make_shared<Subscription>(act, detailedEvents, msg);
+
+    MojInt64 coalesceWindow = 0;
+    if (payload.get(_T("coalesceWindow"), coalesceWindow) && (coalesceWindow > 0)) {
+        if (coalesceWindow > kMaxCoalesceWindow) {
+            coalesceWindow = kMaxCoalesceWindow;
+        }
+        sub->setCoalesceWindow((unsigned) coalesceWindow);
+    }
+
     sub->enableSubscription();
     act->addSubscription(sub);
 
@@ -1875,6 +2819,17 @@ void ActivityCategoryHandler::ensureCompletion(MojServiceMessage *msg,
                                                AbstractPersistManager::CommandType type,
                                                CompletionFunction func,
                                                std::shared_ptr<Activity> act)
+{
+    std::shared_ptr<ICompletion> completion =
+            std::make_shared<MojoMsgCompletion<ActivityCategoryHandler>>(this, func, msg, payload, act);
+
+    ensureCompletion(type, completion, act);
+}
+
+void ActivityCategoryHandler::ensureCompletion(AbstractPersistManager::CommandType type,
+                                               std::shared_ptr<ICompletion> completion,
+                                               std::shared_ptr<Activity> act,
+                                               std::shared_ptr<DB8Batch> batch)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
@@ -1885,11 +2840,18 @@ void ActivityCategoryHandler::ensureCompletion(MojServiceMessage *msg,
             act->setPersistToken(DB8Manager::getInstance().createToken());
         }
 
-        std::shared_ptr<ICompletion> completion =
-                std::make_shared<MojoMsgCompletion<ActivityCategoryHandler>>(this, func, msg, payload, act);
+        /* A store still waiting its turn will write this state too */
+        if ((type == AbstractPersistManager::StoreCommandType) &&
+                DB8Manager::getInstance().absorbStore(act, completion)) {
+            return;
+        }
 
-        std::shared_ptr<AbstractPersistCommand> cmd =
-            DB8Manager::getInstance().prepareCommand(type, act, completion);
+        std::shared_ptr<AbstractPersistCommand> cmd;
+        if (batch && (batch->getType() == type)) {
+            cmd = batch->prepareCommand(act, completion);
+        } else {
+            cmd = DB8Manager::getInstance().prepareCommand(type, act, completion);
+        }
 
         if (act->isPersistCommandHooked()) {
             act->hookPersistCommand(cmd);
@@ -1899,23 +2861,28 @@ void ActivityCategoryHandler::ensureCompletion(MojServiceMessage *msg,
             cmd->persist();
         }
     } else if (act->isPersistCommandHooked()) {
-        std::shared_ptr<ICompletion> completion =
-                std::make_shared<MojoMsgCompletion<ActivityCategoryHandler>>(this, func, msg, payload, act);
-
         std::shared_ptr<AbstractPersistCommand> cmd =
                 DB8Manager::getInstance().prepareNoopCommand(act, completion);
 
         act->hookPersistCommand(cmd);
         act->getHookedPersistCommand()->append(cmd);
     } else {
-        ((*this).*func)(msg, payload, act, true);
+        completion->complete(true);
     }
 }
 
-/* XXX TEST ALL THE CASES HERE */
+/* XXX TEST ALL THE CASES HERE
+ *
+ * Each case issues at most one MojoDB call for the replace.  A persistent
+ * new Activity takes over the old one's Persist Token, so its put
+ * overwrites the old object in place, and the old Activity only needs a
+ * Noop to complete its chain.  A non-persistent new Activity only needs
+ * the old object deleted.  The one wait is behind a command already in
+ * flight for the old Activity, whose result the put needs for the object's
+ * current _id and _rev. */
 void ActivityCategoryHandler::ensureReplaceCompletion(
-        MojServiceMessage *msg, MojObject& payload, std::shared_ptr<Activity> oldActivity,
-        std::shared_ptr<Activity> newActivity)
+        std::shared_ptr<ICompletion> newCompletion, std::shared_ptr<Activity> oldActivity,
+        std::shared_ptr<Activity> newActivity, std::shared_ptr<DB8Batch> batch)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 
@@ -1947,16 +2914,12 @@ void ActivityCategoryHandler::ensureReplaceCompletion(
             newActivity->setPersistToken(DB8Manager::getInstance().createToken());
         }
 
-        std::shared_ptr<ICompletion> newCompletion =
-                std::make_shared<MojoMsgCompletion<ActivityCategoryHandler>>(
-                        this,
-                        &ActivityCategoryHandler::finishCreateActivity,
-                        msg,
-                        payload,
-                        newActivity);
-
-        std::shared_ptr<AbstractPersistCommand> newCmd =
-                DB8Manager::getInstance().prepareStoreCommand(newActivity, newCompletion);
+        std::shared_ptr<AbstractPersistCommand> newCmd;
+        if (batch && (batch->getType() == AbstractPersistManager::StoreCommandType)) {
+            newCmd = batch->prepareCommand(newActivity, newCompletion);
+        } else {
+            newCmd = DB8Manager::getInstance().prepareStoreCommand(newActivity, newCompletion);
+        }
 
         std::shared_ptr<ICompletion> oldCompletion =
                 std::make_shared<MojoRefCompletion<ActivityCategoryHandler>>(
@@ -1993,14 +2956,6 @@ void ActivityCategoryHandler::ensureReplaceCompletion(
          * someone tries to replace *it*.  That can't succeed until the
          * original command is succesfully replaced.  This noop command
          * will complete the replace. */
-        std::shared_ptr<ICompletion> newCompletion =
-                std::make_shared<MojoMsgCompletion<ActivityCategoryHandler>>(
-                        this,
-                        &ActivityCategoryHandler::finishCreateActivity,
-                        msg,
-                        payload,
-                        newActivity);
-
         std::shared_ptr<AbstractPersistCommand> newCmd =
                 DB8Manager::getInstance().prepareNoopCommand(newActivity, newCompletion);
 
@@ -2024,14 +2979,6 @@ void ActivityCategoryHandler::ensureReplaceCompletion(
          * Activity B, but since A hasn't finished yet, C shouldn't finish
          * either.  A crash might leave A existing while C existed
          * externally.  Which would be naughty. */
-        std::shared_ptr<ICompletion> newCompletion =
-                std::make_shared<MojoMsgCompletion<ActivityCategoryHandler>>(
-                        this,
-                        &ActivityCategoryHandler::finishCreateActivity,
-                        msg,
-                        payload,
-                        newActivity);
-
         std::shared_ptr<AbstractPersistCommand> newCmd =
                 DB8Manager::getInstance().prepareNoopCommand(newActivity, newCompletion);
 
@@ -2050,10 +2997,7 @@ void ActivityCategoryHandler::ensureReplaceCompletion(
         oldActivity->hookPersistCommand(oldCmd);
         oldActivity->getHookedPersistCommand()->append(newCmd);
     } else {
-        finishCreateActivity(MojRefCountedPtr<MojServiceMessage>(msg),
-                             payload,
-                             newActivity,
-                             true);
+        newCompletion->complete(true);
         finishReplaceActivity(oldActivity, true);
     }
 }
@@ -19,6 +19,8 @@
 
 #include <activity/trigger/TriggerFactory.h>
 #include <boost/function.hpp>
+#include <map>
+#include <set>
 #include <core/MojService.h>
 #include <core/MojServiceMessage.h>
 #include <db/AbstractPersistManager.h>
@@ -29,6 +31,9 @@
 #include "activity/ActivityManager.h"
 #include "base/AbstractCallback.h"
 #include "base/ITrigger.h"
+#include "db/DB8BatchCommand.h"
+#include "service/BatchReply.h"
+#include "service/DuplicateNames.h"
 #include "service/PermissionManager.h"
 #include "service/Subscription.h"
 
@@ -43,6 +48,16 @@ private:
     static const MojChar* const StopSchema;
     static const MojChar* const CancelSchema;
     static const MojChar* const GetActivityInfoSchema;
+    static const MojChar* const CreateBatchSchema;
+    static const MojChar* const StartBatchSchema;
+    static const MojChar* const CompleteBatchSchema;
+    static const MojChar* const CancelBatchSchema;
+    static const MojChar* const GetRequestLatencySchema;
+
+    static const size_t kMaxBatchSize = 128;
+
+    /* Longest update event coalescing window, in milliseconds */
+    static const unsigned kMaxCoalesceWindow = 60000;
 
 public:
     ActivityCategoryHandler(std::shared_ptr<PermissionManager> pm);
@@ -74,6 +89,16 @@ protected:
     MojErr cancelActivity(MojServiceMessage *msg, MojObject& payload);
     MojErr pauseActivity(MojServiceMessage *msg, MojObject& payload);
 
+    /* Shared by create and createBatch */
+    static bool isPrivilegedCreator(MojServiceMessage *msg);
+    MojErr prepareCreate(MojServiceMessage *msg, const MojObject& request,
+                         bool privilegedCreator, std::shared_ptr<Activity>& act,
+                         std::string& errorText);
+    MojErr commitCreate(const MojObject& request, std::shared_ptr<Activity> act,
+                        std::shared_ptr<ICompletion> completion, std::string& errorText,
+                        std::shared_ptr<DB8Batch> batch = nullptr,
+                        std::shared_ptr<Activity> *replaced = nullptr);
+
     /* Completion methods */
     void finishCreateActivity(MojRefCountedPtr<MojServiceMessage> msg,
                               const MojObject& payload,
@@ -93,17 +118,58 @@ protected:
                               std::shared_ptr<Activity> act,
                               bool succeeded);
 
+    /* Batched Methods
+     * Each takes an array of the corresponding single method's parameters
+     * and replies once, with a result per item.  Permission checks are made
+     * once per distinct callback/trigger URL, and the persistence writes
+     * for the whole batch go to MojoDB in one call (per put or del). */
+    MojErr createActivityBatch(MojServiceMessage *msg, MojObject& payload);
+    MojErr startActivityBatch(MojServiceMessage *msg, MojObject& payload);
+    MojErr completeActivityBatch(MojServiceMessage *msg, MojObject& payload);
+    MojErr cancelActivityBatch(MojServiceMessage *msg, MojObject& payload);
+
+    /* Access denied, by URL */
+    typedef std::map<std::string, std::pair<MojErr, std::string> > AccessDenials;
+    typedef std::function<void (const AccessDenials& denials)> AccessRightsCallback;
+    typedef std::vector<std::vector<std::string> > BatchUrls;
+
+    void finishCreateBatchPermissionCheck(MojRefCountedPtr<MojServiceMessage> msg,
+                                          std::vector<MojObject> items,
+                                          std::vector<std::shared_ptr<Activity> > acts,
+                                          BatchUrls urls,
+                                          std::shared_ptr<BatchReply> batch,
+                                          const AccessDenials& denials);
+    void finishCompleteBatchPermissionCheck(MojRefCountedPtr<MojServiceMessage> msg,
+                                            std::vector<MojObject> items,
+                                            std::vector<std::shared_ptr<Activity> > acts,
+                                            BatchUrls urls,
+                                            std::shared_ptr<BatchReply> batch,
+                                            const AccessDenials& denials);
+
+    void finishCreateBatchItem(std::shared_ptr<BatchReply> batch, size_t index,
+                               const MojObject& item, std::shared_ptr<Activity> act,
+                               bool succeeded);
+    void finishCompleteBatchItem(std::shared_ptr<BatchReply> batch, size_t index,
+                                 const MojObject& item, std::shared_ptr<Activity> act,
+                                 bool succeeded);
+    void finishCancelBatchItem(std::shared_ptr<BatchReply> batch, size_t index,
+                               const MojObject& item, std::shared_ptr<Activity> act,
+                               bool succeeded);
+
     /* Introspection */
     MojErr getActivityInfo(MojServiceMessage *msg, MojObject& payload);
 
     /* Debugging/Information Methods */
     MojErr getManagerInfo(MojServiceMessage *msg, MojObject& payload);
+    MojErr getRequestLatency(MojServiceMessage *msg, MojObject& payload);
 
     /* External Enable/Disable of for scheduling new Activities */
     MojErr enable(MojServiceMessage *msg, MojObject& payload);
     MojErr disable(MojServiceMessage *msg, MojObject& payload);
 
     /* Service Methods */
+    MojErr getActivityQuery(const MojObject& payload, ActivityQuery& query);
+
     MojErr lookupActivity(MojServiceMessage *msg,
                           MojObject& payload,
                           std::shared_ptr<Activity>& act);
@@ -129,19 +195,50 @@ protected:
                           AbstractPersistManager::CommandType type,
                           CompletionFunction func,
                           std::shared_ptr<Activity> act);
-    void ensureReplaceCompletion(MojServiceMessage *msg,
-                                 MojObject& payload,
+
+    void ensureCompletion(AbstractPersistManager::CommandType type,
+                          std::shared_ptr<ICompletion> completion,
+                          std::shared_ptr<Activity> act,
+                          std::shared_ptr<DB8Batch> batch = nullptr);
+    void ensureReplaceCompletion(std::shared_ptr<ICompletion> newCompletion,
                                  std::shared_ptr<Activity> oldActivity,
-                                 std::shared_ptr<Activity> newActivity);
+                                 std::shared_ptr<Activity> newActivity,
+                                 std::shared_ptr<DB8Batch> batch = nullptr);
 
     void checkAccessRight(const std::string& requester,
                           std::shared_ptr<AbstractCallback> c,
                           std::vector<std::shared_ptr<ITrigger>> vec,
                           PermissionManager::PermissionCallback permissionCB);
 
+    static std::vector<std::string> getAccessUrls(
+            std::shared_ptr<AbstractCallback> c,
+            const std::vector<std::shared_ptr<ITrigger>>& vec);
+    std::vector<std::string> getCompleteAccessUrls(std::shared_ptr<Activity> act,
+                                                   const MojObject& payload);
+
+    /* Check each distinct URL once, then call back with those denied */
+    void checkAccessRights(const std::string& requester,
+                           const std::set<std::string>& urls,
+                           AccessRightsCallback callback);
+    static bool isAccessDenied(const AccessDenials& denials,
+                               const std::vector<std::string>& urls,
+                               MojErr& errorCode, std::string& errorText);
+
+    /* Reads the batch items, or replies with an error */
+    bool getBatchItems(MojServiceMessage *msg, MojObject& payload,
+                       std::vector<MojObject>& items);
+    std::shared_ptr<Activity> lookupBatchActivity(MojServiceMessage *msg,
+                                                  const MojObject& item,
+                                                  std::shared_ptr<BatchReply> batch,
+                                                  size_t index,
+                                                  std::set<activityId_t>& seen);
+
     static const SchemaMethod s_methods[];
 
     std::shared_ptr<PermissionManager> m_pm;
+
+    /* Creates rejected for a name already in use */
+    DuplicateNames m_duplicates;
 };
 
 #endif /* __ACTIVITY_CATEGORY_HANDLER_H__ */
@@ -0,0 +1,181 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "ActivityInfoStream.h"
+
+#include "activity/Activity.h"
+#include "service/RequestLatency.h"
+#include "util/Logging.h"
+
+ActivityInfoStream::ActivityInfoStream(MojServiceMessage *msg, const ActivityQuery& query,
+                                       unsigned flags)
+    : m_msg(msg)
+    , m_query(query)
+    , m_flags(flags)
+{
+    if (!m_query.getLimit()) {
+        m_query.setLimit(kDefaultChunkSize);
+    }
+}
+
+ActivityInfoStream::~ActivityInfoStream()
+{
+}
+
+void ActivityInfoStream::start()
+{
+    /* The message takes a reference to the Cancel Handler */
+    MojRefCountedPtr<MojoCancelHandler> cancelHandler(
+            new MojoCancelHandler(shared_from_this(), m_msg.get()));
+
+    if (!sendNext()) {
+        return;
+    }
+
+    /* Between chunks, let everything else waiting on the main loop go
+     * first. */
+    g_idle_add_full(G_PRIORITY_DEFAULT_IDLE,
+                    &ActivityInfoStream::sendNextCallback,
+                    new std::shared_ptr<ActivityInfoStream>(shared_from_this()),
+                    &ActivityInfoStream::destroyCallback);
+}
+
+MojErr ActivityInfoStream::pageToJson(const ActivityManager::ActivityVec& page, unsigned flags,
+                                      MojObject& rep)
+{
+    MojErr err = MojErrNone;
+
+    MojObject activityArray(MojObject::TypeArray);
+    for (ActivityManager::ActivityVec::const_iterator iter = page.begin();
+            iter != page.end(); ++iter) {
+        MojObject activity;
+        err = (*iter)->toJson(activity, flags);
+        MojErrCheck(err);
+
+        err = activityArray.push(activity);
+        MojErrCheck(err);
+    }
+
+    err = rep.put(_T("activities"), activityArray);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
+
+bool ActivityInfoStream::sendNext()
+{
+    if (!m_msg.get()) {
+        return false;
+    }
+
+    MojErr err = MojErrNone;
+    MojObject reply;
+
+    ActivityManager::ActivityVec page;
+    bool more = false;
+
+    try {
+        more = ActivityManager::getInstance().queryActivities(m_query, page);
+    } catch (const std::exception& except) {
+        (void) m_msg->replyError(MojErrInvalidArg, except.what());
+        m_msg.reset();
+        return false;
+    }
+
+    err = pageToJson(page, m_flags, reply);
+    MojErrGoto(err, fail);
+
+    if (!page.empty()) {
+        m_query.setCursor(page.back()->getId());
+    }
+
+    err = reply.putInt(_T("cursor"), (MojInt64) m_query.getCursor());
+    MojErrGoto(err, fail);
+
+    err = reply.putBool(_T("done"), !more);
+    MojErrGoto(err, fail);
+
+    err = reply.putBool(_T("subscribed"), more);
+    MojErrGoto(err, fail);
+
+    err = reply.putBool(MojServiceMessage::ReturnValueKey, true);
+    MojErrGoto(err, fail);
+
+    err = m_msg->reply(reply);
+    MojErrGoto(err, fail);
+
+    /* The request's latency is to its first chunk */
+    RequestLatency::getInstance().finish(m_msg.get());
+
+    if (!more) {
+        m_msg.reset();
+    }
+
+    return more;
+
+fail:
+    LOG_AM_ERROR(MSGID_ACTVTY_REPLY_ERR, 0, "Failed to generate Activity info chunk");
+    m_msg.reset();
+    return false;
+}
+
+void ActivityInfoStream::handleCancel()
+{
+    LOG_AM_DEBUG("Activity info stream cancelled after [Activity %llu]", m_query.getCursor());
+
+    m_msg.reset();
+}
+
+gboolean ActivityInfoStream::sendNextCallback(gpointer data)
+{
+    std::shared_ptr<ActivityInfoStream> *stream =
+            static_cast<std::shared_ptr<ActivityInfoStream> *>(data);
+
+    return (*stream)->sendNext() ? TRUE : FALSE;
+}
+
+void ActivityInfoStream::destroyCallback(gpointer data)
+{
+    delete static_cast<std::shared_ptr<ActivityInfoStream> *>(data);
+}
+
+ActivityInfoStream::MojoCancelHandler::MojoCancelHandler(
+        std::shared_ptr<ActivityInfoStream> stream, MojServiceMessage *msg)
+    : m_stream(stream)
+    , m_msg(msg)
+    , m_cancelSlot(this, &ActivityInfoStream::MojoCancelHandler::handleCancel)
+{
+    msg->notifyCancel(m_cancelSlot);
+}
+
+ActivityInfoStream::MojoCancelHandler::~MojoCancelHandler()
+{
+}
+
+MojErr ActivityInfoStream::MojoCancelHandler::handleCancel(MojServiceMessage *msg)
+{
+    if (m_msg != msg) {
+        return MojErrInvalidArg;
+    }
+
+    std::shared_ptr<ActivityInfoStream> stream = m_stream.lock();
+    if (stream) {
+        stream->handleCancel();
+    }
+
+    return MojErrNone;
+}
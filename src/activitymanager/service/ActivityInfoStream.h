@@ -0,0 +1,78 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __ACTIVITY_INFO_STREAM_H__
+#define __ACTIVITY_INFO_STREAM_H__
+
+#include <glib.h>
+
+#include <core/MojService.h>
+#include <core/MojServiceMessage.h>
+
+#include "Main.h"
+#include "activity/ActivityManager.h"
+#include "activity/ActivityQuery.h"
+
+/*
+ * Streams a getActivityInfo listing to a subscribed caller in chunks, one
+ * per main loop iteration, so large listings neither build one huge reply
+ * nor hold up the main loop while they're serialized.
+ *
+ * Each chunk is a page of the query, resumed from the last ID sent, so the
+ * listing reflects Activities as they are when each chunk goes out.  The
+ * last chunk has "done" set.  The stream stops early if the caller cancels.
+ */
+class ActivityInfoStream : public std::enable_shared_from_this<ActivityInfoStream> {
+public:
+    ActivityInfoStream(MojServiceMessage *msg, const ActivityQuery& query, unsigned flags);
+    virtual ~ActivityInfoStream();
+
+    /* Sends the first chunk now, and queues the rest */
+    void start();
+
+    /* Serializes a page of Activities */
+    static MojErr pageToJson(const ActivityManager::ActivityVec& page, unsigned flags,
+                             MojObject& rep);
+
+    static const size_t kDefaultChunkSize = 50;
+
+protected:
+    bool sendNext();
+    void handleCancel();
+
+    static gboolean sendNextCallback(gpointer data);
+    static void destroyCallback(gpointer data);
+
+    class MojoCancelHandler: public MojSignalHandler {
+    public:
+        MojoCancelHandler(std::shared_ptr<ActivityInfoStream> stream, MojServiceMessage *msg);
+        virtual ~MojoCancelHandler();
+
+    private:
+        MojErr handleCancel(MojServiceMessage *msg);
+
+        std::weak_ptr<ActivityInfoStream> m_stream;
+        MojServiceMessage *m_msg;
+        MojServiceMessage::CancelSignal::Slot<MojoCancelHandler> m_cancelSlot;
+    };
+
+    MojRefCountedPtr<MojServiceMessage> m_msg;
+    ActivityQuery m_query;
+    unsigned m_flags;
+};
+
+#endif /* __ACTIVITY_INFO_STREAM_H__ */
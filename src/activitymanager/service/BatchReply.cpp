@@ -0,0 +1,142 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "BatchReply.h"
+
+#include "service/RequestLatency.h"
+#include "util/Logging.h"
+
+BatchReply::BatchReply(MojServiceMessage *msg, size_t count)
+    : m_msg(msg)
+    , m_results(count)
+    , m_done(count, false)
+    , m_pending(count)
+{
+}
+
+BatchReply::~BatchReply()
+{
+}
+
+MojServiceMessage *BatchReply::getMessage() const
+{
+    return m_msg.get();
+}
+
+void BatchReply::succeed(size_t index, activityId_t id)
+{
+    MojErr errs = MojErrNone;
+    MojObject result;
+
+    MojErr err = result.putBool(MojServiceMessage::ReturnValueKey, true);
+    MojErrAccumulate(errs, err);
+
+    err = result.putInt(_T("activityId"), (MojInt64) id);
+    MojErrAccumulate(errs, err);
+
+    if (errs) {
+        LOG_AM_ERROR(MSGID_ACTVTY_REPLY_ERR, 1, PMLOGKFV("Activity", "%llu", id),
+                     "Failed to generate batch item result");
+    }
+
+    setResult(index, result);
+}
+
+void BatchReply::fail(size_t index, MojErr errorCode, const std::string& errorText)
+{
+    MojErr errs = MojErrNone;
+    MojObject result;
+
+    MojErr err = result.putBool(MojServiceMessage::ReturnValueKey, false);
+    MojErrAccumulate(errs, err);
+
+    err = result.putInt(_T("errorCode"), (MojInt64) errorCode);
+    MojErrAccumulate(errs, err);
+
+    err = result.putString(_T("errorText"), errorText.c_str());
+    MojErrAccumulate(errs, err);
+
+    std::map<size_t, activityId_t>::const_iterator replaced = m_replaced.find(index);
+    if (replaced != m_replaced.end()) {
+        err = result.putInt(_T("replacedActivityId"), (MojInt64) replaced->second);
+        MojErrAccumulate(errs, err);
+    }
+
+    if (errs) {
+        LOG_AM_ERROR(MSGID_ACTVTY_REPLY_ERR, 0, "Failed to generate batch item result");
+    }
+
+    setResult(index, result);
+}
+
+void BatchReply::setReplaced(size_t index, activityId_t id)
+{
+    m_replaced[index] = id;
+}
+
+bool BatchReply::isDone(size_t index) const
+{
+    return (index >= m_done.size()) || m_done[index];
+}
+
+void BatchReply::setResult(size_t index, const MojObject& result)
+{
+    if (isDone(index)) {
+        return;
+    }
+
+    m_results[index] = result;
+    m_done[index] = true;
+
+    if (--m_pending > 0) {
+        return;
+    }
+
+    MojErr errs = MojErrNone;
+    MojObject results(MojObject::TypeArray);
+
+    for (std::vector<MojObject>::const_iterator iter = m_results.begin() ;
+            iter != m_results.end() ; ++iter) {
+        MojErr err = results.push(*iter);
+        MojErrAccumulate(errs, err);
+    }
+
+    m_results.clear();
+
+    if (errs) {
+        (void) m_msg->replyError(MojErrInternal, "Failed to generate batch results");
+        RequestLatency::getInstance().finish(m_msg.get());
+        return;
+    }
+
+    sendReply(results);
+}
+
+void BatchReply::sendReply(const MojObject& results)
+{
+    MojObject reply;
+    MojErr err = reply.put(_T("results"), results);
+    if (err) {
+        (void) m_msg->replyError(MojErrInternal, "Failed to generate batch results");
+    } else {
+        err = m_msg->replySuccess(reply);
+        if (err) {
+            LOG_AM_ERROR(MSGID_ACTVTY_REPLY_ERR, 0, "Failed to generate reply to batch request");
+        }
+    }
+
+    RequestLatency::getInstance().finish(m_msg.get());
+}
@@ -0,0 +1,114 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __BATCH_REPLY_H__
+#define __BATCH_REPLY_H__
+
+#include <map>
+#include <string>
+#include <vector>
+
+#include <core/MojServiceMessage.h>
+#include <db/ICompletion.h>
+
+#include "Main.h"
+
+class Activity;
+
+/*
+ * Collects the per-item results of a batched request, and replies once
+ * every item has one:
+ *
+ * { "returnValue": true,
+ *   "results": [{ "returnValue": true, "activityId": 12 },
+ *               { "returnValue": false, "errorCode": -1989, "errorText": "..." },
+ *               ... ] }
+ *
+ * Results are in the order of the request's items.  Each item's result is
+ * set exactly once; later attempts are ignored.  An item that replaced an
+ * Activity and then failed reports the replaced Activity's id as
+ * "replacedActivityId", as that Activity is gone by then.
+ */
+class BatchReply {
+public:
+    BatchReply(MojServiceMessage *msg, size_t count);
+    virtual ~BatchReply();
+
+    MojServiceMessage *getMessage() const;
+
+    void succeed(size_t index, activityId_t id);
+    void fail(size_t index, MojErr errorCode, const std::string& errorText);
+
+    /* The item has replaced another Activity */
+    void setReplaced(size_t index, activityId_t id);
+
+    bool isDone(size_t index) const;
+
+protected:
+    void setResult(size_t index, const MojObject& result);
+
+    /* Replies with every item's result */
+    virtual void sendReply(const MojObject& results);
+
+    MojRefCountedPtr<MojServiceMessage> m_msg;
+    std::vector<MojObject> m_results;
+    std::vector<bool> m_done;
+    size_t m_pending;
+
+    std::map<size_t, activityId_t> m_replaced;
+};
+
+/* Completes one item of a batch once its persistence command finishes */
+template <class T>
+class BatchCompletion : public ICompletion {
+public:
+    typedef void (T::* CallbackType)(std::shared_ptr<BatchReply> batch, size_t index,
+            const MojObject& item, std::shared_ptr<Activity> activity, bool succeeded);
+
+    BatchCompletion(T *category,
+                    CallbackType callback,
+                    std::shared_ptr<BatchReply> batch,
+                    size_t index,
+                    const MojObject& item,
+                    std::shared_ptr<Activity> activity)
+        : m_item(item)
+        , m_callback(callback)
+        , m_category(category)
+        , m_batch(batch)
+        , m_index(index)
+        , m_activity(activity)
+    {
+    }
+
+    virtual ~BatchCompletion() {}
+
+    virtual void complete(bool succeeded)
+    {
+        ((*m_category.get()).*m_callback)(m_batch, m_index, m_item, m_activity, succeeded);
+    }
+
+protected:
+    MojObject m_item;
+    CallbackType m_callback;
+
+    MojRefCountedPtr<T> m_category;
+    std::shared_ptr<BatchReply> m_batch;
+    size_t m_index;
+
+    std::shared_ptr<Activity> m_activity;
+};
+
+#endif /* __BATCH_REPLY_H__ */
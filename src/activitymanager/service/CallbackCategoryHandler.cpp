@@ -107,7 +107,7 @@ Example response for a failed call:
 MojErr CallbackCategoryHandler::scheduledWakeup(MojServiceMessage *msg,
                                                 MojObject &payload)
 {
-    ACTIVITY_SERVICEMETHOD_BEGIN();
+    ACTIVITY_SERVICEMETHOD_BEGIN(msg);
 
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
     LOG_AM_DEBUG("Callback: ScheduledWakeup");
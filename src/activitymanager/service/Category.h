@@ -17,7 +17,13 @@
 #ifndef __CATEGORY_H__
 #define __CATEGORY_H__
 
-#define ACTIVITY_SERVICEMETHOD_BEGIN() try { do {} while (0) \
+#include "service/RequestLatency.h"
+
+/* The latency scope is outside the try, so a reply from the catch still
+ * counts towards the request */
+#define ACTIVITY_SERVICEMETHOD_BEGIN(serviceMsg) \
+    RequestLatency::Scope latencyScope(serviceMsg); \
+    try { do {} while (0) \
 
 #define ACTIVITY_SERVICEMETHOD_END(serviceMsg) \
 } catch (const std::exception& except) { \
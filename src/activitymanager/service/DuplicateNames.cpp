@@ -0,0 +1,91 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "service/DuplicateNames.h"
+
+#include "util/Logging.h"
+
+DuplicateNames::DuplicateNames(Lookup lookup)
+    : m_lookup(lookup)
+    , m_early(0)
+    , m_late(0)
+{
+}
+
+DuplicateNames::~DuplicateNames()
+{
+}
+
+bool DuplicateNames::isTaken(const MojObject& request, const MojObject& spec,
+                             const BusId& caller)
+{
+    bool replace = false;
+    request.get(_T("replace"), replace);
+
+    if (replace || spec.contains(_T("creator"))) {
+        return false;
+    }
+
+    MojString name;
+    bool found = false;
+    MojErr err = spec.get(_T("name"), name, found);
+    if (err || !found) {
+        return false;
+    }
+
+    if (!m_lookup(name.data(), caller)) {
+        return false;
+    }
+
+    LOG_AM_DEBUG("Create: %s already has an Activity named \"%s\"",
+                 caller.getString().c_str(), name.data());
+
+    m_early++;
+    return true;
+}
+
+void DuplicateNames::recordLate()
+{
+    m_late++;
+}
+
+unsigned long DuplicateNames::getEarly() const
+{
+    return m_early;
+}
+
+unsigned long DuplicateNames::getLate() const
+{
+    return m_late;
+}
+
+MojErr DuplicateNames::infoToJson(MojObject& rep) const
+{
+    MojErr err;
+    MojObject duplicates(MojObject::TypeObject);
+
+    err = duplicates.putInt(_T("early"), (MojInt64) m_early);
+    MojErrCheck(err);
+
+    err = duplicates.putInt(_T("late"), (MojInt64) m_late);
+    MojErrCheck(err);
+
+    err = rep.put(_T("duplicateNames"), duplicates);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
@@ -0,0 +1,64 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __DUPLICATE_NAMES_H__
+#define __DUPLICATE_NAMES_H__
+
+#include <functional>
+#include <string>
+
+#include <core/MojObject.h>
+
+#include "base/BusId.h"
+
+/*
+ * Duplicate Activity names on create.
+ *
+ * Without "replace", a create for a name its creator already uses fails.
+ * Clients retrying in a loop hit that a lot, so a create by a caller for
+ * itself is turned away before its Activity is built (early).  Creates on
+ * behalf of another creator, and names taken while the permission check
+ * was in progress, are only found once the Activity has been built (late).
+ */
+class DuplicateNames {
+public:
+    /* Whether the creator has an Activity of that name */
+    typedef std::function<bool (const std::string& name, const BusId& creator)> Lookup;
+
+    DuplicateNames(Lookup lookup);
+    virtual ~DuplicateNames();
+
+    /* Whether a create request can be refused without building its
+     * Activity.  Counted as an early duplicate if so. */
+    bool isTaken(const MojObject& request, const MojObject& spec, const BusId& caller);
+
+    /* A duplicate found once the Activity was built */
+    void recordLate();
+
+    unsigned long getEarly() const;
+    unsigned long getLate() const;
+
+    MojErr infoToJson(MojObject& rep) const;
+
+protected:
+    Lookup m_lookup;
+
+    unsigned long m_early;
+    unsigned long m_late;
+};
+
+#endif /* __DUPLICATE_NAMES_H__ */
@@ -0,0 +1,81 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "PermissionCache.h"
+
+PermissionCache::PermissionCache(size_t capacity, int64_t ttl)
+    : m_ttl(ttl)
+    , m_entries(capacity)
+    , m_hits(0)
+    , m_misses(0)
+{
+}
+
+PermissionCache::~PermissionCache()
+{
+}
+
+bool PermissionCache::lookup(const std::string& requester, const std::string& url,
+                             int64_t now, bool& allowed)
+{
+    Key key(requester, url);
+
+    Entry *entry = m_entries.find(key);
+    if (!entry) {
+        m_misses++;
+        return false;
+    }
+
+    if (now >= entry->m_expires) {
+        m_entries.erase(key);
+        m_misses++;
+        return false;
+    }
+
+    allowed = entry->m_allowed;
+    m_hits++;
+    return true;
+}
+
+void PermissionCache::store(const std::string& requester, const std::string& url,
+                            bool allowed, int64_t now)
+{
+    Entry entry;
+    entry.m_allowed = allowed;
+    entry.m_expires = now + m_ttl;
+
+    m_entries.insert(Key(requester, url), entry);
+}
+
+void PermissionCache::clear()
+{
+    m_entries.clear();
+}
+
+void PermissionCache::setLimits(size_t capacity, int64_t ttl)
+{
+    m_ttl = ttl;
+    m_entries.setCapacity(capacity);
+}
+
+size_t PermissionCache::KeyHash::operator()(const Key& key) const
+{
+    /* Combined as boost::hash_combine does */
+    size_t h = std::hash<std::string>()(key.first);
+    h ^= std::hash<std::string>()(key.second) + 0x9e3779b9 + (h << 6) + (h >> 2);
+    return h;
+}
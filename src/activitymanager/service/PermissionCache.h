@@ -0,0 +1,78 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __PERMISSION_CACHE_H__
+#define __PERMISSION_CACHE_H__
+
+#include <stdint.h>
+#include <string>
+#include <utility>
+
+#include "util/LruCache.h"
+
+/*
+ * Recent permission decisions, keyed by requester and URL.
+ *
+ * Holds at most a fixed number of decisions, dropping the least recently
+ * used when full.  A decision is only trusted for a fixed time after it was
+ * made.  Times are microseconds on any monotonic clock the caller likes.
+ * A capacity of 0 disables caching.
+ */
+class PermissionCache {
+public:
+    PermissionCache(size_t capacity, int64_t ttl);
+    virtual ~PermissionCache();
+
+    /* Returns false, and counts a miss, when there's no fresh decision */
+    bool lookup(const std::string& requester, const std::string& url,
+                int64_t now, bool& allowed);
+    void store(const std::string& requester, const std::string& url,
+               bool allowed, int64_t now);
+
+    /* Forgets every decision.  Counters are kept. */
+    void clear();
+
+    /* Drops least recently used decisions to fit a new capacity */
+    void setLimits(size_t capacity, int64_t ttl);
+
+    size_t size() const { return m_entries.size(); }
+    size_t getCapacity() const { return m_entries.getCapacity(); }
+
+    unsigned long getHits() const { return m_hits; }
+    unsigned long getMisses() const { return m_misses; }
+
+private:
+    typedef std::pair<std::string, std::string> Key;
+
+    struct KeyHash {
+        size_t operator()(const Key& key) const;
+    };
+
+    struct Entry {
+        bool m_allowed;
+        int64_t m_expires;
+    };
+
+    int64_t m_ttl;
+
+    LruCache<Key, Entry, KeyHash> m_entries;
+
+    unsigned long m_hits;
+    unsigned long m_misses;
+};
+
+#endif /* __PERMISSION_CACHE_H__ */
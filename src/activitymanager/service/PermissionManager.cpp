@@ -21,14 +21,22 @@
 #include <boost/algorithm/string.hpp>
 
 #include "activity/ActivityManager.h"
+#include "conf/Config.h"
 #include "service/BusConnection.h"
 #include "util/Logging.h"
 
-static const char* bus_service_name = "com.webos.service.bus";
-static const char* bus_service_method = "isCallAllowed";
-static const unsigned CallTimeoutSec = 5;
+static const char* kCheckURL = "luna://com.webos.service.bus/isCallAllowed";
 
 PermissionManager::PermissionManager()
+    : m_inFlight(0)
+    , m_dispatchSource(0)
+    , m_deniedCount(0)
+    , m_failedCount(0)
+    , m_timeoutCount(0)
+    , m_cache(Config::getInstance().getPermissionCacheSize(),
+              (int64_t) Config::getInstance().getPermissionCacheTtl() * G_USEC_PER_SEC)
+    , m_cacheGeneration(Config::getInstance().getGeneration())
+    , m_decisionGeneration(0)
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
 }
@@ -36,13 +44,10 @@ PermissionManager::PermissionManager()
 PermissionManager::~PermissionManager()
 {
     LOG_AM_TRACE("Entering function %s", __FUNCTION__);
-}
 
-MojErr PermissionManager::syncCheck(const std::string& requester, const std::string& url)
-{
-    MojRefCountedPtr<PermissionManager::SyncChecker> checker(
-            new PermissionManager::SyncChecker());
-    return checker->check(requester, url);
+    if (m_dispatchSource) {
+        g_source_remove(m_dispatchSource);
+    }
 }
 
 std::string PermissionManager::getRequester(MojRefCountedPtr<MojServiceMessage> msg)
@@ -76,121 +81,445 @@ std::string PermissionManager::getRequesterExeName(MojRefCountedPtr<MojServiceMe
     return exeName;
 }
 
-PermissionManager::SyncChecker::SyncChecker()
-        : m_slot(this, &SyncChecker::receiveResponse)
-        , m_received(false)
-        , m_timerId(0)
+void PermissionManager::checkAccessRight(
+        std::string requester, std::vector<std::string> urls, PermissionCallback callback)
 {
+    std::shared_ptr<Request> request = std::make_shared<Request>(requester, callback);
+
+    PermissionCache& cache = getCache();
+    int64_t now = g_get_monotonic_time();
+
+    /* Each distinct URL is only asked about once, and only if there's no
+     * recent answer for it */
+    std::set<std::string> distinct(urls.begin(), urls.end());
+    for (const std::string& url : distinct) {
+        bool allowed = false;
+        if (!cache.lookup(requester, url, now, allowed)) {
+            request->m_urls.push_back(url);
+        } else if (!allowed) {
+            request->m_denied = true;
+            request->m_urls.clear();
+            break;
+        }
+    }
+
+    m_queue.push_back(request);
+
+    scheduleDispatch();
 }
 
-PermissionManager::SyncChecker::~SyncChecker()
+void PermissionManager::invalidateCache()
 {
+    LOG_AM_INFO(MSGID_ACG_CACHE_INVALIDATED, 1,
+                PMLOGKFV("entries", "%zu", m_cache.size()), "");
+
+    m_cache.clear();
+    m_decisionGeneration++;
 }
 
-MojErr PermissionManager::SyncChecker::check(const std::string& requester,
-                                             const std::string& url)
+MojErr PermissionManager::infoToJson(MojObject& rep) const
 {
-    MojErr err;
-    MojObject payload;
+    MojErr err = MojErrNone;
+    MojObject permissions;
 
-    err = payload.putString("uri", url.c_str());
+    err = permissions.putInt(_T("queued"), (MojInt64) m_queue.size());
     MojErrCheck(err);
-    err = payload.putString("requester", requester.c_str());
+
+    err = permissions.putInt(_T("inFlight"), (MojInt64) m_inFlight);
     MojErrCheck(err);
 
-    MojRefCountedPtr<MojServiceRequest> req;
-    err = BusConnection::getInstance().getService().createRequest(req);
+    err = permissions.putInt(_T("maxInFlight"),
+                             (MojInt64) Config::getInstance().getPermissionMaxInFlight());
     MojErrCheck(err);
 
-    err = req->send(m_slot, bus_service_name, bus_service_method, payload);
+    err = permissions.putInt(_T("denied"), (MojInt64) m_deniedCount);
     MojErrCheck(err);
 
-    m_timerId = g_timeout_add_seconds(CallTimeoutSec, &PermissionManager::SyncChecker::timeout, this);
+    err = permissions.putInt(_T("failed"), (MojInt64) m_failedCount);
+    MojErrCheck(err);
 
-    while (!m_received) {
-        g_main_context_iteration(g_main_context_default(), true);
-    }
+    err = permissions.putInt(_T("timedOut"), (MojInt64) m_timeoutCount);
+    MojErrCheck(err);
 
-    bool returnValue = false;
-    bool allowed = false;
+    /* Waiting in the queue, each isCallAllowed call, and whole requests */
+    MojObject queueWait;
+    err = m_queueLatency.toJson(queueWait);
+    MojErrCheck(err);
+
+    err = permissions.put(_T("queueWait"), queueWait);
+    MojErrCheck(err);
+
+    MojObject check;
+    err = m_checkLatency.toJson(check);
+    MojErrCheck(err);
+
+    err = permissions.put(_T("check"), check);
+    MojErrCheck(err);
+
+    MojObject request;
+    err = m_requestLatency.toJson(request);
+    MojErrCheck(err);
+
+    err = permissions.put(_T("request"), request);
+    MojErrCheck(err);
+
+    MojObject cache;
+    err = cache.putInt(_T("size"), (MojInt64) m_cache.size());
+    MojErrCheck(err);
+
+    err = cache.putInt(_T("capacity"), (MojInt64) m_cache.getCapacity());
+    MojErrCheck(err);
+
+    err = cache.putInt(_T("hits"), (MojInt64) m_cache.getHits());
+    MojErrCheck(err);
 
-    err = m_response.getRequired("returnValue", returnValue);
+    err = cache.putInt(_T("misses"), (MojInt64) m_cache.getMisses());
     MojErrCheck(err);
-    err = m_response.getRequired("allowed", allowed);
+
+    err = permissions.put(_T("cache"), cache);
+    MojErrCheck(err);
+
+    err = rep.put(_T("permissions"), permissions);
     MojErrCheck(err);
 
-    if (!returnValue) {
-        return MojErrLuna;
+    return MojErrNone;
+}
+
+MojErr PermissionManager::issueCheck(std::shared_ptr<Check> check, const MojObject& params,
+                                     std::shared_ptr<LunaCall>& call)
+{
+    call = std::make_shared<LunaWeakPtrCall<Check>>(check,
+            &PermissionManager::Check::handleResponse, false, LunaURL(kCheckURL), params);
+
+    return call->call();
+}
+
+PermissionCache& PermissionManager::getCache()
+{
+    const Config& config = Config::getInstance();
+
+    /* Decisions made under the old configuration aren't trusted */
+    if (config.getGeneration() != m_cacheGeneration) {
+        m_cacheGeneration = config.getGeneration();
+        m_cache.clear();
+        m_decisionGeneration++;
+        m_cache.setLimits(config.getPermissionCacheSize(),
+                          (int64_t) config.getPermissionCacheTtl() * G_USEC_PER_SEC);
     }
-    if (!allowed) {
-        return MojErrAccessDenied;
+
+    return m_cache;
+}
+
+gboolean PermissionManager::dispatchCallback(gpointer data)
+{
+    PermissionManager *self = static_cast<PermissionManager *>(data);
+
+    self->m_dispatchSource = 0;
+    self->dispatch();
+
+    return G_SOURCE_REMOVE;
+}
+
+void PermissionManager::scheduleDispatch()
+{
+    if (!m_dispatchSource) {
+        m_dispatchSource = g_idle_add_full(G_PRIORITY_DEFAULT,
+                                           &PermissionManager::dispatchCallback,
+                                           this, NULL);
     }
+}
 
-    return MojErrNone;
+void PermissionManager::dispatch()
+{
+    unsigned maxInFlight = Config::getInstance().getPermissionMaxInFlight();
+
+    while (!m_queue.empty()) {
+        std::shared_ptr<Request> request = m_queue.front();
+
+        /* Requests start in order.  One with more URLs than the limit
+         * still gets to go once nothing else is in flight. */
+        if (m_inFlight && ((m_inFlight + request->m_urls.size()) > maxInFlight)) {
+            break;
+        }
+
+        m_queue.pop_front();
+        m_queueLatency.add(g_get_monotonic_time() - request->m_queuedTime);
+
+        startRequest(request);
+    }
 }
 
-MojErr PermissionManager::SyncChecker::receiveResponse(MojServiceMessage *,
-                                                       MojObject& response,
-                                                       MojErr err)
+void PermissionManager::startRequest(std::shared_ptr<Request> request)
 {
-    m_response = response;
-    m_received = true;
-    g_source_remove(m_timerId);
+    if (request->m_denied) {
+        finishRequest(request, MojErrAccessDenied);
+        return;
+    }
+
+    if (request->m_urls.empty()) {
+        finishRequest(request, MojErrNone);
+        return;
+    }
+
+    m_active.insert(request);
+
+    unsigned timeout = Config::getInstance().getPermissionCheckTimeout();
+
+    for (const std::string& url : request->m_urls) {
+        /* A failure to issue an earlier check may have answered it */
+        if (m_active.find(request) == m_active.end()) {
+            break;
+        }
+
+        std::shared_ptr<Check> check = std::make_shared<Check>(shared_from_this(), request, url);
+        request->m_checks.push_back(check);
+        request->m_pending++;
+        m_inFlight++;
+
+        MojErr err = check->start(timeout);
+        if (err) {
+            LOG_AM_WARNING(MSGID_ACG_CHECK_ERR, 2,
+                           PMLOGKS("requester", request->m_requester.c_str()),
+                           PMLOGKS("url", url.c_str()),
+                           "Failed to issue permission check");
+            checkFinished(request, url, err, 0, check->m_generation);
+        }
+    }
+}
+
+void PermissionManager::checkFinished(std::shared_ptr<Request> request, const std::string& url,
+                                      MojErr err, int64_t latency, unsigned long generation)
+{
+    /* Only definite answers are remembered, not failures to get one, nor
+     * answers to checks issued before the cache was last dropped */
+    PermissionCache& cache = getCache();
+    if ((!err || (err == MojErrAccessDenied)) && (generation == m_decisionGeneration)) {
+        cache.store(request->m_requester, url, !err, g_get_monotonic_time());
+    }
+
+    /* Already answered, by another URL's denial */
+    if (m_active.find(request) == m_active.end()) {
+        return;
+    }
+
+    request->m_pending--;
+    m_inFlight--;
+
+    if (latency) {
+        m_checkLatency.add(latency);
+    }
+
+    if (err) {
+        LOG_AM_DEBUG("Permission check: '%s' may not call %s (%d)",
+                     request->m_requester.c_str(), url.c_str(), err);
+        finishRequest(request, err);
+    } else if (!request->m_pending) {
+        finishRequest(request, MojErrNone);
+    }
+
+    /* Room for more, but not from underneath the check that just ended */
+    scheduleDispatch();
+}
+
+void PermissionManager::finishRequest(std::shared_ptr<Request> request, MojErr err)
+{
+    m_active.erase(request);
+
+    /* Nobody's waiting on the rest anymore */
+    for (const std::shared_ptr<Check>& check : request->m_checks) {
+        check->cancel();
+    }
+
+    m_inFlight -= (unsigned) request->m_pending;
+    request->m_pending = 0;
+
+    m_requestLatency.add(g_get_monotonic_time() - request->m_queuedTime);
+
+    if (err == MojErrAccessDenied) {
+        m_deniedCount++;
+        request->m_callback(err, "'" + request->m_requester +
+                            "' doesn't have rights to call callback/trigger");
+    } else if (request->m_timedOut) {
+        request->m_callback(err, "Timed out checking whether '" + request->m_requester +
+                            "' may call callback/trigger");
+    } else if (err) {
+        m_failedCount++;
+        request->m_callback(err, "Failed to check whether '" + request->m_requester +
+                            "' may call callback/trigger");
+    } else {
+        request->m_callback(MojErrNone, "");
+    }
+}
+
+PermissionManager::Request::Request(const std::string& requester,
+                                    PermissionCallback callback)
+    : m_requester(requester)
+    , m_callback(callback)
+    , m_denied(false)
+    , m_pending(0)
+    , m_timedOut(false)
+    , m_queuedTime(g_get_monotonic_time())
+{
+}
+
+PermissionManager::Check::Check(std::shared_ptr<PermissionManager> manager,
+                                std::shared_ptr<Request> request, const std::string& url)
+    : m_manager(manager)
+    , m_request(request)
+    , m_url(url)
+    , m_startTime(0)
+    , m_finished(false)
+    , m_generation(manager->m_decisionGeneration)
+{
+}
+
+PermissionManager::Check::~Check()
+{
+}
+
+MojErr PermissionManager::Check::start(unsigned timeoutSeconds)
+{
+    std::shared_ptr<Request> request = m_request.lock();
+    if (!request) {
+        return MojErrInvalidArg;
+    }
+
+    MojErr err;
+    MojObject params;
+
+    err = params.putString("uri", m_url.c_str());
+    MojErrCheck(err);
+    err = params.putString("requester", request->m_requester.c_str());
+    MojErrCheck(err);
+
+    std::shared_ptr<PermissionManager> manager = m_manager.lock();
+    if (!manager) {
+        return MojErrInvalidArg;
+    }
+
+    m_startTime = g_get_monotonic_time();
+
+    err = manager->issueCheck(shared_from_this(), params, m_call);
+    MojErrCheck(err);
+
+    m_timeout = std::make_shared<Timeout<Check>>(shared_from_this(), timeoutSeconds,
+            &PermissionManager::Check::handleTimeout);
+    m_timeout->arm();
 
     return MojErrNone;
 }
 
-int PermissionManager::SyncChecker::timeout(void* ctx)
+void PermissionManager::Check::cancel()
 {
-    PermissionManager::SyncChecker *manager = (PermissionManager::SyncChecker *) ctx;
-    manager->m_received = true;
+    /* Don't tear down a call from inside its own response */
+    if (m_finished) {
+        return;
+    }
 
-    return G_SOURCE_REMOVE;
+    m_finished = true;
+
+    if (m_timeout) {
+        m_timeout->cancel();
+    }
+
+    if (m_call) {
+        m_call->cancel();
+    }
 }
 
-void PermissionManager::checkAccessRight(
-        std::string requester, std::vector<std::string> urls, PermissionCallback callback)
+void PermissionManager::Check::handleResponse(MojServiceMessage *msg, const MojObject& response,
+                                              MojErr err)
+{
+    answer(response, err);
+}
+
+void PermissionManager::Check::answer(const MojObject& response, MojErr err)
 {
-    m_queue.push_back(std::make_tuple(requester, urls, callback));
+    if (m_finished) {
+        return;
+    }
+
+    m_finished = true;
+
+    if (m_timeout) {
+        m_timeout->cancel();
+    }
+
+    bool returnValue = false;
+    bool allowed = false;
+
+    MojErr result = MojErrNone;
+    if (err) {
+        result = err;
+    } else if (!response.get("returnValue", returnValue) || !returnValue) {
+        result = MojErrLuna;
+    } else if (!response.get("allowed", allowed) || !allowed) {
+        result = MojErrAccessDenied;
+    }
 
-    g_timeout_add(0, &PermissionManager::processQueue, this);
+    std::shared_ptr<PermissionManager> manager = m_manager.lock();
+    std::shared_ptr<Request> request = m_request.lock();
+    if (manager && request) {
+        manager->checkFinished(request, m_url, result,
+                               g_get_monotonic_time() - m_startTime, m_generation);
+    }
 }
 
-int PermissionManager::processQueue(void* ctx)
+const std::string& PermissionManager::Check::getUrl() const
 {
-    static bool isWorking = false;
+    return m_url;
+}
+
+void PermissionManager::Check::handleTimeout()
+{
+    if (m_finished) {
+        return;
+    }
 
-    PermissionManager* self = static_cast<PermissionManager*>(ctx);
-    if (!self) {
-        LOG_AM_WARNING("ACG_CHECK_ERR", 0, "PermissionManager is is null");
-        return G_SOURCE_REMOVE;
+    m_finished = true;
+
+    if (m_call) {
+        m_call->cancel();
     }
 
-    if (isWorking || self->m_queue.empty()) {
-        return G_SOURCE_REMOVE;
+    std::shared_ptr<PermissionManager> manager = m_manager.lock();
+    std::shared_ptr<Request> request = m_request.lock();
+    if (!manager || !request) {
+        return;
     }
 
-    isWorking = true;
-    auto& item = self->m_queue.front();
+    LOG_AM_WARNING(MSGID_ACG_CHECK_TIMEOUT, 2,
+                   PMLOGKS("requester", request->m_requester.c_str()),
+                   PMLOGKS("url", m_url.c_str()),
+                   "No answer to permission check");
 
-    std::string& requester = std::get<0>(item);
-    std::vector<std::string>& vec = std::get<1>(item);
-    PermissionCallback& callback = std::get<2>(item);
-    MojErr err = MojErrNone;
-    std::string errorText = "' doesn't have rights to call callback/trigger";
+    manager->m_timeoutCount++;
+    request->m_timedOut = true;
+    manager->checkFinished(request, m_url, MojErrLuna,
+                           g_get_monotonic_time() - m_startTime, m_generation);
+}
 
-    for (const std::string& method : vec) {
-        if ((err = self->syncCheck(requester, method)) != MojErrNone) {
-            callback(err, "'" + requester + errorText);
-            goto Exit;
-        }
+void PermissionManager::LatencyStats::add(int64_t latency)
+{
+    m_count++;
+    m_total += latency;
+    if (latency > m_max) {
+        m_max = latency;
     }
+}
 
-    callback(MojErrNone, "");
+MojErr PermissionManager::LatencyStats::toJson(MojObject& rep) const
+{
+    MojErr err = MojErrNone;
 
-Exit:
-    self->m_queue.pop_front();
-    isWorking = false;
+    err = rep.putInt(_T("count"), (MojInt64) m_count);
+    MojErrCheck(err);
 
-    return G_SOURCE_CONTINUE;
+    err = rep.putInt(_T("avgUs"), m_count ? (MojInt64) (m_total / (int64_t) m_count) : 0);
+    MojErrCheck(err);
+
+    err = rep.putInt(_T("maxUs"), (MojInt64) m_max);
+    MojErrCheck(err);
+
+    return MojErrNone;
 }
@@ -18,6 +18,7 @@
 #define __PERMISSION_MANAGER_H__
 
 #include <deque>
+#include <set>
 
 #include <core/MojService.h>
 #include <core/MojServiceRequest.h>
@@ -25,8 +26,25 @@
 #include "activity/Activity.h"
 #include "activity/callback/ActivityCallback.h"
 #include "base/AbstractCallback.h"
+#include "base/LunaCall.h"
 #include "base/LunaURL.h"
+#include "base/Timeout.h"
+#include "service/PermissionCache.h"
 
+/*
+ * Checks with the bus hub (isCallAllowed) that a requester may call a set of
+ * callback/trigger URLs.
+ *
+ * Requests are queued and started in order, as long as there's room for
+ * their checks in flight.  All URLs of a request are checked in parallel,
+ * and it's answered on the first denial, or once every URL is allowed.
+ * Nothing blocks on the main loop while waiting.
+ *
+ * Recent answers are cached per requester and URL, so only URLs without
+ * one are checked.  The cache is dropped whenever configuration is loaded,
+ * or on request; answers to checks issued before then still answer their
+ * request, but aren't cached.
+ */
 class PermissionManager: public std::enable_shared_from_this<PermissionManager> {
 public:
     typedef std::function<MojErr (MojErr, std::string)> PermissionCallback;
@@ -34,34 +52,127 @@ public:
     PermissionManager();
     virtual ~PermissionManager();
 
-    MojErr syncCheck(const std::string& requester, const std::string& url);
-
+    /* The callback is always called later, from the main loop */
     void checkAccessRight(std::string requester, std::vector<std::string> urls,
                           PermissionCallback callback);
     static std::string getRequester(MojRefCountedPtr<MojServiceMessage> msg);
     static std::string getRequesterExeName(MojRefCountedPtr<MojServiceMessage> msg);
 
-private:
-    struct SyncChecker: public MojSignalHandler {
-        typedef MojServiceRequest::ExtendedReplySignal::Slot<SyncChecker> HandlerType;
+    /* Forget every cached decision */
+    void invalidateCache();
+
+    MojErr infoToJson(MojObject& rep) const;
+
+protected:
+    class Check;
+
+    struct Request {
+        Request(const std::string& requester, PermissionCallback callback);
 
-        SyncChecker();
-        virtual ~SyncChecker();
+        std::string m_requester;
+        PermissionCallback m_callback;
 
-        MojErr check(const std::string& requester, const std::string& url);
-        MojErr receiveResponse(MojServiceMessage *, MojObject& response, MojErr);
-        static int timeout(void* ctx);
+        /* Distinct URLs left to check, and whether a cached decision
+         * already denied one */
+        std::vector<std::string> m_urls;
+        bool m_denied;
 
-        HandlerType m_slot;
-        volatile bool m_received;
-        MojObject m_response;
-        unsigned m_timerId;
+        std::vector<std::shared_ptr<Check> > m_checks;
+        size_t m_pending;
+
+        /* A check got no answer in time */
+        bool m_timedOut;
+
+        /* Microseconds, monotonic */
+        int64_t m_queuedTime;
     };
 
-    static int processQueue(void* ctx);
+    /* One isCallAllowed call, for one URL of a request */
+    class Check: public std::enable_shared_from_this<Check> {
+    public:
+        Check(std::shared_ptr<PermissionManager> manager,
+              std::shared_ptr<Request> request, const std::string& url);
+        virtual ~Check();
+
+        MojErr start(unsigned timeoutSeconds);
+        void cancel();
+
+        /* The bus hub's answer, or the failure to get one */
+        void answer(const MojObject& response, MojErr err);
+
+        /* Gives up waiting for the answer */
+        void handleTimeout();
+
+        const std::string& getUrl() const;
+
+    protected:
+        friend class PermissionManager;
+
+        void handleResponse(MojServiceMessage *msg, const MojObject& response, MojErr err);
+
+        std::weak_ptr<PermissionManager> m_manager;
+        std::weak_ptr<Request> m_request;
+        std::string m_url;
+
+        std::shared_ptr<LunaCall> m_call;
+        std::shared_ptr<Timeout<Check> > m_timeout;
+
+        int64_t m_startTime;
+        bool m_finished;
+
+        /* The manager's cache generation when the check was issued */
+        unsigned long m_generation;
+    };
+
+    /* Latencies, in microseconds */
+    struct LatencyStats {
+        LatencyStats() : m_count(0), m_total(0), m_max(0) {}
+
+        void add(int64_t latency);
+        MojErr toJson(MojObject& rep) const;
+
+        unsigned long m_count;
+        int64_t m_total;
+        int64_t m_max;
+    };
+
+    /* Issues the isCallAllowed call for a check, which is answered with
+     * its response */
+    virtual MojErr issueCheck(std::shared_ptr<Check> check, const MojObject& params,
+                              std::shared_ptr<LunaCall>& call);
+
+    PermissionCache& getCache();
+
+    static gboolean dispatchCallback(gpointer data);
+    void scheduleDispatch();
+    void dispatch();
+    void startRequest(std::shared_ptr<Request> request);
+    void checkFinished(std::shared_ptr<Request> request, const std::string& url,
+                       MojErr err, int64_t latency, unsigned long generation);
+    void finishRequest(std::shared_ptr<Request> request, MojErr err);
+
+    std::deque<std::shared_ptr<Request> > m_queue;
+    std::set<std::shared_ptr<Request> > m_active;
+
+    unsigned m_inFlight;
+    guint m_dispatchSource;
+
+    LatencyStats m_queueLatency;
+    LatencyStats m_checkLatency;
+    LatencyStats m_requestLatency;
+
+    /* Requests denied, and requests that failed because a check couldn't
+     * be made or its answer wasn't understood.  Timeouts are counted per
+     * check. */
+    unsigned long m_deniedCount;
+    unsigned long m_failedCount;
+    unsigned long m_timeoutCount;
+
+    PermissionCache m_cache;
+    unsigned int m_cacheGeneration;
 
-    std::deque<std::tuple<std::string, std::vector<std::string>,
-            PermissionManager::PermissionCallback>> m_queue;
+    /* Counts each time the cache is dropped */
+    unsigned long m_decisionGeneration;
 };
 
 #endif //__PERMISSION_MANAGER_H__
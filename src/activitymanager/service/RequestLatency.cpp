@@ -0,0 +1,176 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "RequestLatency.h"
+
+#include <glib.h>
+
+RequestLatency::Scope::Scope(MojServiceMessage *msg)
+    : m_msg(msg)
+{
+    RequestLatency::getInstance().enter(m_msg);
+}
+
+RequestLatency::Scope::Scope(const MojRefCountedPtr<MojServiceMessage>& msg)
+    : m_msg(msg.get())
+{
+    RequestLatency::getInstance().enter(m_msg);
+}
+
+RequestLatency::Scope::~Scope()
+{
+    RequestLatency::getInstance().leave(m_msg);
+}
+
+RequestLatency::RequestLatency()
+    : m_untimed(0)
+{
+}
+
+RequestLatency::~RequestLatency()
+{
+}
+
+RequestLatency& RequestLatency::getInstance()
+{
+    static RequestLatency instance;
+    return instance;
+}
+
+void RequestLatency::enter(MojServiceMessage *msg)
+{
+    if (!msg || (msg->numReplies() > 0) || (m_pending.find(msg) != m_pending.end())) {
+        return;
+    }
+
+    if (m_pending.size() >= kMaxPending) {
+        sweep();
+    }
+
+    Pending& pending = m_pending[msg];
+    pending.m_msg = MojRefCountedPtr<MojServiceMessage>(msg);
+    pending.m_method = msg->method() ? msg->method() : "unknown";
+    pending.m_start = g_get_monotonic_time();
+}
+
+void RequestLatency::leave(MojServiceMessage *msg)
+{
+    PendingMap::iterator found = m_pending.find(msg);
+    if ((found != m_pending.end()) && (msg->numReplies() > 0)) {
+        record(found);
+    }
+}
+
+void RequestLatency::finish(MojServiceMessage *msg)
+{
+    PendingMap::iterator found = m_pending.find(msg);
+    if (found != m_pending.end()) {
+        record(found);
+    }
+}
+
+void RequestLatency::reset()
+{
+    m_methods.clear();
+    m_untimed = 0;
+}
+
+void RequestLatency::record(PendingMap::iterator found)
+{
+    m_methods[found->second.m_method].record(
+        g_get_monotonic_time() - found->second.m_start);
+    m_pending.erase(found);
+}
+
+void RequestLatency::sweep()
+{
+    /* Drop requests that were answered somewhere that isn't timed... */
+    for (PendingMap::iterator iter = m_pending.begin(); iter != m_pending.end();) {
+        if (iter->first->numReplies() > 0) {
+            m_pending.erase(iter++);
+            m_untimed++;
+        } else {
+            ++iter;
+        }
+    }
+
+    /* ...and if that's not enough, the longest waiting */
+    while (m_pending.size() >= kMaxPending) {
+        PendingMap::iterator oldest = m_pending.begin();
+        for (PendingMap::iterator iter = m_pending.begin(); iter != m_pending.end(); ++iter) {
+            if (iter->second.m_start < oldest->second.m_start) {
+                oldest = iter;
+            }
+        }
+
+        m_pending.erase(oldest);
+        m_untimed++;
+    }
+}
+
+MojErr RequestLatency::toJson(MojObject& rep) const
+{
+    MojErr err;
+    MojObject methods(MojObject::TypeObject);
+
+    for (MethodMap::const_iterator iter = m_methods.begin(); iter != m_methods.end(); ++iter) {
+        const LatencyHistogram& histogram = iter->second;
+        MojObject method(MojObject::TypeObject);
+
+        err = method.putInt(_T("count"), (MojInt64) histogram.getCount());
+        MojErrCheck(err);
+
+        err = method.putInt(_T("p50Us"), histogram.getPercentile(50.0));
+        MojErrCheck(err);
+
+        err = method.putInt(_T("p90Us"), histogram.getPercentile(90.0));
+        MojErrCheck(err);
+
+        err = method.putInt(_T("p99Us"), histogram.getPercentile(99.0));
+        MojErrCheck(err);
+
+        err = method.putInt(_T("maxUs"), histogram.getMax());
+        MojErrCheck(err);
+
+        err = methods.put(iter->first.c_str(), method);
+        MojErrCheck(err);
+    }
+
+    err = rep.put(_T("methods"), methods);
+    MojErrCheck(err);
+
+    err = rep.putInt(_T("pending"), (MojInt64) m_pending.size());
+    MojErrCheck(err);
+
+    err = rep.putInt(_T("untimed"), (MojInt64) m_untimed);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
+
+MojErr RequestLatency::infoToJson(MojObject& rep) const
+{
+    MojObject latency(MojObject::TypeObject);
+
+    MojErr err = toJson(latency);
+    MojErrCheck(err);
+
+    err = rep.put(_T("requestLatency"), latency);
+    MojErrCheck(err);
+
+    return MojErrNone;
+}
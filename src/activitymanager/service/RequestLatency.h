@@ -0,0 +1,90 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __REQUEST_LATENCY_H__
+#define __REQUEST_LATENCY_H__
+
+#include <map>
+#include <stdint.h>
+#include <string>
+
+#include <core/MojServiceMessage.h>
+
+#include "util/LatencyHistogram.h"
+
+/*
+ * Time from a service request's arrival to its first reply, per method.
+ *
+ * A request is timed from the first service method turn that sees it, and
+ * stops at the end of the first turn after which it has a reply - whether
+ * that's the method itself or a later completion (permission check,
+ * MojoDB) that resumes it.  Requests answered outside any service method,
+ * such as batches and streamed listings, are finished explicitly.
+ */
+class RequestLatency {
+public:
+    static RequestLatency& getInstance();
+
+    /* One service method turn with a request */
+    class Scope {
+    public:
+        Scope(MojServiceMessage *msg);
+        Scope(const MojRefCountedPtr<MojServiceMessage>& msg);
+        ~Scope();
+
+    private:
+        MojServiceMessage *m_msg;
+    };
+
+    void enter(MojServiceMessage *msg);
+    void leave(MojServiceMessage *msg);
+
+    /* The request has been replied to outside of a Scope */
+    void finish(MojServiceMessage *msg);
+
+    void reset();
+
+    MojErr toJson(MojObject& rep) const;
+    MojErr infoToJson(MojObject& rep) const;
+
+private:
+    RequestLatency();
+    virtual ~RequestLatency();
+
+    struct Pending {
+        MojRefCountedPtr<MojServiceMessage> m_msg;
+        std::string m_method;
+        int64_t m_start;
+    };
+
+    typedef std::map<MojServiceMessage *, Pending> PendingMap;
+    typedef std::map<std::string, LatencyHistogram> MethodMap;
+
+    void record(PendingMap::iterator found);
+    void sweep();
+
+    /* Requests still waiting for a reply are held onto, so bound them */
+    static const size_t kMaxPending = 256;
+
+    PendingMap m_pending;
+    MethodMap m_methods;
+
+    /* Requests that fell out of the pending set without being timed */
+    unsigned long m_untimed;
+};
+
+#endif /* __REQUEST_LATENCY_H__ */
@@ -20,6 +20,7 @@
 #include <luna/MojLunaMessage.h>
 
 #include "activity/Activity.h"
+#include "activity/EventReplies.h"
 #include "util/Logging.h"
 
 Subscription::Subscription(std::shared_ptr<Activity> activity,
@@ -62,44 +63,18 @@ const Subscriber& Subscription::getSubscriber() const
     return m_subscriber;
 }
 
-MojErr Subscription::sendEvent(ActivityEvent event)
+MojErr Subscription::sendEvent(ActivityEvent event, EventReplies& replies)
 {
     if (!m_msg.get()) {
         return MojErrInvalidArg;
     }
 
-    if (m_activity.expired()) {
-        return MojErrInternal;
-    }
-
-    std::shared_ptr<Activity> activity = m_activity.lock();
-
-    MojErr err = MojErrNone;
-    MojObject eventReply;
-
-    err = eventReply.putString(_T("event"), ActivityEventNames[event]);
-    MojErrCheck(err);
-
-    err = eventReply.putInt(_T("activityId"), activity->getId());
-    MojErrCheck(err);
-
-    err = eventReply.putBool(_T("subscribed"), true);
-    MojErrCheck(err);
+    const MojObject *eventReply = NULL;
 
-    err = eventReply.putBool(MojServiceMessage::ReturnValueKey, true);
+    MojErr err = replies.get(event, m_detailedEvents, eventReply);
     MojErrCheck(err);
 
-    if (m_detailedEvents) {
-        MojObject details(MojObject::TypeObject);
-
-        err = activity->activityInfoToJson(details);
-        MojErrCheck(err);
-
-        err = eventReply.put(_T("$activity"), details);
-        MojErrCheck(err);
-    }
-
-    err = m_msg->reply(eventReply);
+    err = m_msg->reply(*eventReply);
     MojErrCheck(err);
 
     return MojErrNone;
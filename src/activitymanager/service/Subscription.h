@@ -37,7 +37,7 @@ public:
 
     virtual void enableSubscription();
 
-    virtual MojErr sendEvent(ActivityEvent event);
+    virtual MojErr sendEvent(ActivityEvent event, EventReplies& replies);
 
     Subscriber& getSubscriber();
     const Subscriber& getSubscriber() const;
@@ -30,6 +30,7 @@
 #include "activity/ActivityManager.h"
 #include "conf/Setting.h"
 #include "requirement/RequirementManager.h"
+#include "service/PermissionManager.h"
 #include "util/Logging.h"
 
 ActivitySendHandler::ActivitySendHandler()
@@ -77,6 +78,12 @@ void ActivitySendHandler::initialize()
     g_io_add_watch(channel, (GIOCondition)(G_IO_IN), ActivitySendHandler::onRead, this);
 }
 
+void ActivitySendHandler::setPermissionManager(
+        std::shared_ptr<PermissionManager> permissionManager)
+{
+    m_permissionManager = permissionManager;
+}
+
 gboolean ActivitySendHandler::onRead(GIOChannel* channel, GIOCondition condition, gpointer data)
 {
     ActivitySendHandler* self = reinterpret_cast<ActivitySendHandler*>(data);
@@ -99,6 +106,19 @@ gboolean ActivitySendHandler::onRead(GIOChannel* channel, GIOCondition condition
     pbnjson::JValue triggers;
 
     std::shared_ptr<Activity> activity;
+
+    /* Not about any Activity */
+    if (request.hasKey("invalidatePermissions")) {
+        std::shared_ptr<PermissionManager> permissionManager = self->m_permissionManager.lock();
+        if (permissionManager) {
+            LOG_AM_DEBUG("AM_SEND invalidate permissions");
+            permissionManager->invalidateCache();
+        } else {
+            errorText = "Service is not online yet";
+        }
+        goto Return;
+    }
+
     if (request.hasKey("id")) {
         activityId_t id = request["id"].asNumber<int64_t>();
         try {
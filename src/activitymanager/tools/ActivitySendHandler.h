@@ -18,8 +18,11 @@
 #define __ACTIVITY_SEND_HANDLER_H__
 
 #include <glib.h>
+#include <memory>
 #include <string>
 
+class PermissionManager;
+
 class ActivitySendHandler {
 public:
     static ActivitySendHandler& getInstance()
@@ -32,6 +35,9 @@ public:
 
     void initialize();
 
+    /* Lets requests drop its cached permission decisions */
+    void setPermissionManager(std::shared_ptr<PermissionManager> permissionManager);
+
 private:
     ActivitySendHandler();
     ~ActivitySendHandler();
@@ -43,6 +49,8 @@ private:
     std::string m_ipcDir;
     std::string m_reqPipePath;
     std::string m_respPipePath;
+
+    std::weak_ptr<PermissionManager> m_permissionManager;
 };
 
 #endif /* __ACTIVITY_SEND_HANDLER_H__ */
@@ -0,0 +1,126 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "LatencyHistogram.h"
+
+#include <cmath>
+
+namespace {
+
+/* Each power of two is split into 1 << kSubBits buckets */
+const int kSubBits = 4;
+const int64_t kSubCount = 1 << kSubBits;
+const int kMaxExponent = 36;
+
+const size_t kBucketCount = kSubCount + (kMaxExponent - kSubBits) * kSubCount;
+
+}
+
+LatencyHistogram::LatencyHistogram()
+    : m_buckets(kBucketCount, 0)
+    , m_count(0)
+    , m_max(0)
+{
+}
+
+LatencyHistogram::~LatencyHistogram()
+{
+}
+
+void LatencyHistogram::record(int64_t us)
+{
+    if (us < 0) {
+        us = 0;
+    }
+
+    m_buckets[bucketFor(us)]++;
+    m_count++;
+
+    if (us > m_max) {
+        m_max = us;
+    }
+}
+
+void LatencyHistogram::reset()
+{
+    m_buckets.assign(kBucketCount, 0);
+    m_count = 0;
+    m_max = 0;
+}
+
+int64_t LatencyHistogram::getPercentile(double percentile) const
+{
+    if (m_count == 0) {
+        return 0;
+    }
+
+    uint64_t rank = (uint64_t) std::ceil(percentile / 100.0 * (double) m_count);
+    if (rank < 1) {
+        rank = 1;
+    } else if (rank > m_count) {
+        rank = m_count;
+    }
+
+    uint64_t seen = 0;
+    for (size_t i = 0; i < m_buckets.size(); i++) {
+        seen += m_buckets[i];
+        if (seen >= rank) {
+            /* The last bucket also holds everything clamped into it */
+            if (i == m_buckets.size() - 1) {
+                return m_max;
+            }
+
+            int64_t bound = upperBound(i);
+            return (bound < m_max) ? bound : m_max;
+        }
+    }
+
+    return m_max;
+}
+
+size_t LatencyHistogram::bucketFor(int64_t us)
+{
+    if (us < kSubCount) {
+        return (size_t) us;
+    }
+
+    int exponent = kSubBits;
+    while ((exponent < kMaxExponent - 1) && ((us >> (exponent + 1)) != 0)) {
+        exponent++;
+    }
+
+    if ((us >> (exponent + 1)) != 0) {
+        /* Clamp into the last bucket */
+        return kBucketCount - 1;
+    }
+
+    int64_t sub = (us >> (exponent - kSubBits)) & (kSubCount - 1);
+    return (size_t) (kSubCount + (exponent - kSubBits) * kSubCount + sub);
+}
+
+int64_t LatencyHistogram::upperBound(size_t bucket)
+{
+    if (bucket < (size_t) kSubCount) {
+        return (int64_t) bucket;
+    }
+
+    int exponent = kSubBits + (int) ((bucket - kSubCount) / kSubCount);
+    int64_t sub = (int64_t) ((bucket - kSubCount) % kSubCount);
+    int64_t width = (int64_t) 1 << (exponent - kSubBits);
+
+    return ((kSubCount + sub) * width) + width - 1;
+}
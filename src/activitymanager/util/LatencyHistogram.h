@@ -0,0 +1,57 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __LATENCY_HISTOGRAM_H__
+#define __LATENCY_HISTOGRAM_H__
+
+#include <cstddef>
+#include <stdint.h>
+#include <vector>
+
+/*
+ * Distribution of latencies, in microseconds.
+ *
+ * Buckets are log-linear: values below 16 are counted exactly, and each
+ * power of two above that is split into 16 buckets, so a percentile is
+ * reported within about 6% of the true value in fixed memory.  Values are
+ * clamped to about 19 hours.
+ */
+class LatencyHistogram {
+public:
+    LatencyHistogram();
+    virtual ~LatencyHistogram();
+
+    void record(int64_t us);
+    void reset();
+
+    uint64_t getCount() const { return m_count; }
+    int64_t getMax() const { return m_max; }
+
+    /* Upper bound of the bucket holding the given percentile (0-100),
+     * never more than the largest value recorded.  0 when empty. */
+    int64_t getPercentile(double percentile) const;
+
+private:
+    static size_t bucketFor(int64_t us);
+    static int64_t upperBound(size_t bucket);
+
+    std::vector<uint64_t> m_buckets;
+    uint64_t m_count;
+    int64_t m_max;
+};
+
+#endif /* __LATENCY_HISTOGRAM_H__ */
@@ -136,6 +136,8 @@
 #define MSGID_PERSIST_ATMPT_UNKNWN_EXCPTN               "PERSIST_ATMPT_UNKNWN_EXCPTN" /** Unknown exception while attempting to persist */
 #define MSGID_PERSIST_CMD_RESP_FAIL                     "PERSIST_CMD_RESP_FAIL" /** Mojo persist command failed */
 #define MSGID_PERSIST_CMD_TRANSIENT_ERR                 "PERSIST_CMD_TRANSIENT_ERR" /** Mojo persist command failed with transient error */
+#define MSGID_PERSIST_MERGE_FALLBACK                    "PERSIST_MERGE_FALLBACK" /** Mojo merge of changed properties failed, putting whole object */
+#define MSGID_PERSIST_BATCH_SPLIT                       "PERSIST_BATCH_SPLIT" /** Batched Mojo persist command failed, issuing its commands separately */
 #define MSGID_UNHOOK_CMD_ACTVTY_ERR                     "UNHOOK_CMD_ACTVTY_ERR" /** Attempt to unhook PersistCommand assigned to different activity */
 #define MSGID_UNHOOK_CMD_QUEUE_ORDERING_ERR             "UNHOOK_CMD_QUEUE_ORDERING_ERR" /** Request to unhook persistCommand which is not the first persist command in the queue */
 #define MSGID_HOOKED_PERSIST_CMD_NOT_FOUND              "HOOKED_PERSIST_CMD_NOT_FOUND" /** Attempt to retreive the current hooked persist command, but none is present */
@@ -147,6 +149,15 @@
 #define MSGID_TIMEOUT_ERR_UNKNOWN                       "TIMEOUT_ERR_UNKNOWN"  /* */
 
 
+/** ActivityIdAllocator.cpp */
+#define MSGID_ACTIVITY_ID_MARK_ERR                      "ACTIVITY_ID_MARK_ERR"  /* Activity ID high-water mark could not be read or written */
+#define MSGID_SNAPSHOT_ERR                              "SNAPSHOT_ERR"  /* Activity snapshot could not be read or written */
+
+/** ActivityManager.cpp */
+#define MSGID_ACTIVATION_DONE                           "ACTIVATION_DONE"  /* Finished arming the Activities queued before scheduling was enabled */
+#define MSGID_ACTIVITY_LEAKED                           "ACTIVITY_LEAKED"  /* Released Activity still referenced after a full leak sweep interval */
+#define MSGID_CONCURRENCY_CHANGED                       "CONCURRENCY_CHANGED"  /* Background concurrency levels adjusted for system pressure */
+
 /** TestCategory.cpp */
 #define MSGID_TEST_LEAK_ACTIVITY                        "TEST_LEAK_ACTIVITY"  /* */
 #define MSGID_TEST_RELEASE_ACTIVITY                     "TEST_RELEASE_ACTIVITY"  /* */
@@ -269,6 +280,11 @@
 #define MSGID_SERVICE_BUSY                      "SERVICE_BUSY"
 #define MSGID_SERVICE_DOWN                      "SERVICE_DOWN"
 
+///** PermissionManager */
+#define MSGID_ACG_CHECK_ERR                     "ACG_CHECK_ERR"  /* failed to issue or parse a permission check */
+#define MSGID_ACG_CHECK_TIMEOUT                 "ACG_CHECK_TIMEOUT"  /* no answer to a permission check in time */
+#define MSGID_ACG_CACHE_INVALIDATED             "ACG_CACHE_INVALIDATED"  /* cached permission decisions dropped */
+
 extern PmLogContext getactivitymanagercontext();
 
 #endif // __ACTIVITYMANAGER_LOGGING_H__
@@ -0,0 +1,117 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#ifndef __LRU_CACHE_H__
+#define __LRU_CACHE_H__
+
+#include <cstddef>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <utility>
+
+/*
+ * Map holding at most a fixed number of entries, dropping the least
+ * recently used when full.  Finding an entry makes it the most recently
+ * used.  A capacity of 0 holds nothing.
+ */
+template <class Key, class Value, class Hash = std::hash<Key> >
+class LruCache {
+public:
+    explicit LruCache(size_t capacity)
+        : m_capacity(capacity)
+    {
+    }
+
+    virtual ~LruCache() {}
+
+    /* Null when there's no entry for the key */
+    Value *find(const Key& key)
+    {
+        typename Index::iterator found = m_index.find(key);
+        if (found == m_index.end()) {
+            return nullptr;
+        }
+
+        m_entries.splice(m_entries.begin(), m_entries, found->second);
+        return &found->second->second;
+    }
+
+    void insert(const Key& key, const Value& value)
+    {
+        if (!m_capacity) {
+            return;
+        }
+
+        typename Index::iterator found = m_index.find(key);
+        if (found != m_index.end()) {
+            found->second->second = value;
+            m_entries.splice(m_entries.begin(), m_entries, found->second);
+            return;
+        }
+
+        m_entries.push_front(Entry(key, value));
+        m_index[key] = m_entries.begin();
+
+        trim();
+    }
+
+    void erase(const Key& key)
+    {
+        typename Index::iterator found = m_index.find(key);
+        if (found != m_index.end()) {
+            m_entries.erase(found->second);
+            m_index.erase(found);
+        }
+    }
+
+    void clear()
+    {
+        m_index.clear();
+        m_entries.clear();
+    }
+
+    /* Drops least recently used entries to fit a new capacity */
+    void setCapacity(size_t capacity)
+    {
+        m_capacity = capacity;
+        trim();
+    }
+
+    size_t size() const { return m_entries.size(); }
+    size_t getCapacity() const { return m_capacity; }
+
+private:
+    typedef std::pair<Key, Value> Entry;
+    typedef std::list<Entry> EntryList;
+    typedef std::unordered_map<Key, typename EntryList::iterator, Hash> Index;
+
+    void trim()
+    {
+        while (m_entries.size() > m_capacity) {
+            m_index.erase(m_entries.back().first);
+            m_entries.pop_back();
+        }
+    }
+
+    size_t m_capacity;
+
+    /* Most recently used first */
+    EntryList m_entries;
+    Index m_index;
+};
+
+#endif /* __LRU_CACHE_H__ */
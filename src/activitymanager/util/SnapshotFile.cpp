@@ -0,0 +1,203 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "SnapshotFile.h"
+
+#include <cstring>
+#include <glib.h>
+#include <glib/gstdio.h>
+
+#include "util/Logging.h"
+
+const char SnapshotFile::kMagic[4] = { 'A', 'M', 'S', 'S' };
+
+namespace {
+
+void append(std::string& out, const void *data, size_t length)
+{
+    out.append(static_cast<const char *>(data), length);
+}
+
+void pad(std::string& out)
+{
+    while (out.size() % 4) {
+        out.push_back('\0');
+    }
+}
+
+}
+
+SnapshotFile::SnapshotFile(const std::string& path)
+    : m_path(path)
+{
+}
+
+SnapshotFile::~SnapshotFile()
+{
+}
+
+const std::string& SnapshotFile::getPath() const
+{
+    return m_path;
+}
+
+size_t SnapshotFile::write(const std::vector<std::string>& records) const
+{
+    std::string body;
+    for (std::vector<std::string>::const_iterator iter = records.begin() ;
+            iter != records.end() ; ++iter) {
+        uint32_t length = (uint32_t) iter->size();
+        append(body, &length, sizeof(length));
+        body.append(*iter);
+        pad(body);
+    }
+
+    uint32_t version = kVersion;
+    uint32_t count = (uint32_t) records.size();
+    uint32_t checksum = crc32(body.data(), body.size());
+    uint64_t size = body.size();
+
+    std::string contents;
+    contents.reserve(kHeaderSize + body.size());
+    append(contents, kMagic, sizeof(kMagic));
+    append(contents, &version, sizeof(version));
+    append(contents, &count, sizeof(count));
+    append(contents, &checksum, sizeof(checksum));
+    append(contents, &size, sizeof(size));
+    contents.append(body);
+
+    gchar *dir = g_path_get_dirname(m_path.c_str());
+    g_mkdir_with_parents(dir, 0755);
+    g_free(dir);
+
+    GError *error = NULL;
+    if (!g_file_set_contents(m_path.c_str(), contents.data(), (gssize) contents.size(), &error)) {
+        LOG_AM_WARNING(MSGID_SNAPSHOT_ERR, 1,
+                       PMLOGKS("file", m_path.c_str()),
+                       "Failed to write snapshot: %s", error->message);
+        g_error_free(error);
+        return 0;
+    }
+
+    return contents.size();
+}
+
+bool SnapshotFile::read(std::vector<std::string>& records) const
+{
+    records.clear();
+
+    GError *error = NULL;
+    GMappedFile *file = g_mapped_file_new(m_path.c_str(), FALSE, &error);
+    if (!file) {
+        LOG_AM_DEBUG("No snapshot at %s: %s", m_path.c_str(), error->message);
+        g_error_free(error);
+        return false;
+    }
+
+    bool valid = parse(g_mapped_file_get_contents(file), g_mapped_file_get_length(file), records);
+    g_mapped_file_unref(file);
+
+    if (!valid) {
+        LOG_AM_WARNING(MSGID_SNAPSHOT_ERR, 1,
+                       PMLOGKS("file", m_path.c_str()),
+                       "Ignoring snapshot that is truncated, corrupt or of another version");
+        records.clear();
+    }
+
+    return valid;
+}
+
+bool SnapshotFile::parse(const char *data, size_t length, std::vector<std::string>& records) const
+{
+    uint32_t version;
+    uint32_t count;
+    uint32_t checksum;
+    uint64_t size;
+
+    if (!data || (length < kHeaderSize) || memcmp(data, kMagic, sizeof(kMagic))) {
+        return false;
+    }
+
+    memcpy(&version, data + 4, sizeof(version));
+    memcpy(&count, data + 8, sizeof(count));
+    memcpy(&checksum, data + 12, sizeof(checksum));
+    memcpy(&size, data + 16, sizeof(size));
+
+    if ((version != kVersion) || (size != length - kHeaderSize)) {
+        return false;
+    }
+
+    const char *body = data + kHeaderSize;
+    if (crc32(body, (size_t) size, 0) != checksum) {
+        return false;
+    }
+
+    /* Every record takes at least its length */
+    if (count > size / sizeof(uint32_t)) {
+        return false;
+    }
+    records.reserve(count);
+
+    size_t offset = 0;
+    for (uint32_t i = 0 ; i < count ; i++) {
+        uint32_t recordLength;
+        if (size - offset < sizeof(recordLength)) {
+            return false;
+        }
+        memcpy(&recordLength, body + offset, sizeof(recordLength));
+        offset += sizeof(recordLength);
+
+        if (size - offset < recordLength) {
+            return false;
+        }
+        records.push_back(std::string(body + offset, recordLength));
+        offset += recordLength;
+
+        offset = (offset + 3) & ~((size_t) 3);
+    }
+
+    return (offset == size);
+}
+
+void SnapshotFile::remove() const
+{
+    (void) g_unlink(m_path.c_str());
+}
+
+uint32_t SnapshotFile::crc32(const char *data, size_t length, uint32_t crc)
+{
+    static uint32_t table[256];
+    static bool tableReady = false;
+
+    if (!tableReady) {
+        for (uint32_t i = 0 ; i < 256 ; i++) {
+            uint32_t c = i;
+            for (int k = 0 ; k < 8 ; k++) {
+                c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+            }
+            table[i] = c;
+        }
+        tableReady = true;
+    }
+
+    crc = ~crc;
+    for (size_t i = 0 ; i < length ; i++) {
+        crc = table[(crc ^ (uint8_t) data[i]) & 0xFF] ^ (crc >> 8);
+    }
+
+    return ~crc;
+}
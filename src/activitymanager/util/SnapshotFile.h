@@ -0,0 +1,75 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#ifndef __SNAPSHOT_FILE_H__
+#define __SNAPSHOT_FILE_H__
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+/*
+ * A file of opaque records, written whole and checked whole.
+ *
+ * Layout, in host byte order, with each record aligned to 4 bytes:
+ *
+ *   char     magic[4]      "AMSS"
+ *   uint32_t version
+ *   uint32_t count         of records
+ *   uint32_t checksum      CRC-32 of everything after the header
+ *   uint64_t size          of everything after the header
+ *   count x { uint32_t length; char data[length]; padding }
+ *
+ * A file written by another version, or on a machine of the other byte
+ * order, fails the version check.  The file is replaced atomically, so a
+ * reader sees the old snapshot or the new one, never part of either.
+ *
+ * The file is mapped only to be checked; each record is copied out into
+ * a string for the caller, which still has to parse it.  Nothing is read
+ * in place, so the savings over MojoDB are the round trip, not the parse.
+ */
+class SnapshotFile {
+public:
+    static const uint32_t kVersion = 1;
+
+    SnapshotFile(const std::string& path);
+    virtual ~SnapshotFile();
+
+    const std::string& getPath() const;
+
+    /* Replaces the file with the records.  Returns the bytes written, or
+     * 0 on failure. */
+    size_t write(const std::vector<std::string>& records) const;
+
+    /* Returns false, with records empty, if there's no file or it isn't
+     * a complete, intact snapshot of this version */
+    bool read(std::vector<std::string>& records) const;
+
+    void remove() const;
+
+    static uint32_t crc32(const char *data, size_t length, uint32_t crc = 0);
+
+protected:
+    static const char kMagic[4];
+    static const size_t kHeaderSize = 24;
+
+    bool parse(const char *data, size_t length, std::vector<std::string>& records) const;
+
+    std::string m_path;
+};
+
+#endif /* __SNAPSHOT_FILE_H__ */
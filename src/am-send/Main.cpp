@@ -31,6 +31,7 @@ static gint64 option_id = 0;
 static gchar **option_requirement = NULL;
 static gchar **option_trigger = NULL;
 static gboolean option_clear = FALSE;
+static gboolean option_invalidate_permissions = FALSE;
 
 static const gchar *OPTION_DESCRIPTION =
         "am-send simulates specified activity's conditions are satisfied.\n"
@@ -43,7 +44,9 @@ static const gchar *OPTION_DESCRIPTION =
         "Simulate 't1' and 't2' triggers are satisfied:\n"
         "$ am-send --id 56 -t t1 -t t2\n"
         "Simulate 't3' is unsatisfied and 't4' is satisfied:\n"
-        "$ am-send --id 56 -t '{\"t3\":false}' -t '{\"t4\":true}'\n";
+        "$ am-send --id 56 -t '{\"t3\":false}' -t '{\"t4\":true}'\n"
+        "Drop cached permission decisions for callbacks and triggers:\n"
+        "$ am-send --invalidate-permissions\n";
 
 static GOptionEntry OPTION_ENTRIES[] = {
     {
@@ -62,6 +65,10 @@ static GOptionEntry OPTION_ENTRIES[] = {
          "clear", 0, 0, G_OPTION_ARG_NONE, &option_clear,
          "Clear user-defined conditions", NULL
     },
+    {
+         "invalidate-permissions", 0, 0, G_OPTION_ARG_NONE, &option_invalidate_permissions,
+         "Drop cached permission decisions", NULL
+    },
     {
         NULL
     }
@@ -88,7 +95,9 @@ int main(int argc, char *argv[])
         goto Exit;
     }
 
-    if (option_id > 0) {
+    if (option_invalidate_permissions) {
+        json.put("invalidatePermissions", true);
+    } else if (option_id > 0) {
         json.put("id", option_id);
     } else {
         std::cerr << "ID parsing error: id is required" << std::endl;
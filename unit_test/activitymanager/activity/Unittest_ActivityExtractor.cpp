@@ -0,0 +1,207 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "activity/ActivityExtractor.h"
+#include "activity/Activity.h"
+#include "activity/ActivityManager.h"
+#include "conf/ActivityJson.h"
+#include "util/MojoObjectJson.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+/*
+ * Triggers, Callbacks and Schedules built from a cached spec template must
+ * be the same as those built from a spec parsed afresh.
+ */
+class UnittestActivityExtractor : public testing::Test {
+protected:
+    UnittestActivityExtractor()
+        : uncachedCount(0)
+    {
+    }
+
+    virtual ~UnittestActivityExtractor()
+    {
+        for (size_t i = 0 ; i < acts.size() ; ++i) {
+            ActivityManager::getInstance().releaseActivity(acts[i]);
+        }
+    }
+
+    MojObject givenSpec(const char *json)
+    {
+        MojObject spec;
+        EXPECT_EQ(MojErrNone, spec.fromJson(json));
+        return spec;
+    }
+
+    /* The same spec, with a property the parsers ignore, so that it has a
+     * cache key of its own and is always parsed afresh */
+    MojObject uncached(const MojObject& spec)
+    {
+        MojObject copy;
+        MojObject parts;
+
+        if (spec.get(_T("and"), parts) || spec.get(_T("or"), parts)) {
+            MojObject array(MojObject::TypeArray);
+            for (MojObject::ConstArrayIterator iter = parts.arrayBegin() ;
+                    iter != parts.arrayEnd() ; ++iter) {
+                EXPECT_EQ(MojErrNone, array.push(uncached(*iter)));
+            }
+            EXPECT_EQ(MojErrNone, copy.put(spec.contains(_T("and")) ? _T("and") : _T("or"), array));
+            return copy;
+        }
+
+        copy = spec;
+        EXPECT_EQ(MojErrNone, copy.putInt(_T("uncached"), ++uncachedCount));
+        return copy;
+    }
+
+    string whenCreated(const char *part, const MojObject& partSpec, bool continuous = false)
+    {
+        MojObject spec;
+        EXPECT_EQ(MojErrNone, spec.putString(_T("name"), "extractor"));
+        EXPECT_EQ(MojErrNone, spec.putString(_T("description"), "template test"));
+        if (continuous) {
+            MojObject type;
+            EXPECT_EQ(MojErrNone, type.putBool(_T("continuous"), true));
+            EXPECT_EQ(MojErrNone, spec.put(_T("type"), type));
+        }
+        EXPECT_EQ(MojErrNone, spec.put(part, partSpec));
+
+        shared_ptr<Activity> act = ActivityExtractor::createActivity(spec);
+        acts.push_back(act);
+
+        MojObject rep;
+        EXPECT_EQ(MojErrNone, act->toJson(rep, ACTIVITY_JSON_DETAIL | ACTIVITY_JSON_PERSIST));
+
+        MojObject built;
+        EXPECT_TRUE(rep.get(part, built));
+        return MojoObjectJson(built).str();
+    }
+
+    MojInt64 getHits(const char *cache)
+    {
+        MojObject rep;
+        MojObject specCache;
+        MojObject templates;
+        EXPECT_EQ(MojErrNone, ActivityExtractor::infoToJson(rep));
+        EXPECT_TRUE(rep.get(_T("specCache"), specCache));
+        EXPECT_TRUE(specCache.get(cache, templates));
+
+        MojInt64 hits = 0;
+        EXPECT_TRUE(templates.get(_T("hits"), hits));
+        return hits;
+    }
+
+    /* Built twice from the spec, so the second comes from the cache, and
+     * once more from an uncached copy */
+    void expectSameAsFresh(const char *part, const char *cache, const char *json,
+                           bool continuous = false)
+    {
+        SCOPED_TRACE(json);
+
+        MojObject spec = givenSpec(json);
+
+        string first = whenCreated(part, spec, continuous);
+        MojInt64 hits = getHits(cache);
+        string cached = whenCreated(part, spec, continuous);
+        EXPECT_LT(hits, getHits(cache));
+
+        string fresh = whenCreated(part, uncached(spec), continuous);
+
+        EXPECT_EQ(fresh, first);
+        EXPECT_EQ(fresh, cached);
+    }
+
+    int uncachedCount;
+    vector<shared_ptr<Activity>> acts;
+};
+
+TEST_F(UnittestActivityExtractor, TriggersMatchFreshParse)
+{
+    const char *specs[] = {
+        "{\"method\":\"luna://com.webos.service.test/watch\"}",
+        "{\"method\":\"luna://com.webos.service.test/watch\","
+            "\"params\":{\"subscribe\":true},\"key\":\"fired\"}",
+        "{\"method\":\"luna://com.webos.service.test/watch\","
+            "\"compare\":{\"key\":\"level\",\"value\":5}}",
+        "{\"method\":\"luna://com.webos.service.test/watch\","
+            "\"where\":{\"prop\":\"level\",\"op\":\">\",\"val\":5}}",
+        "{\"method\":\"luna://com.webos.service.test/watch\","
+            "\"key\":\"fired\",\"name\":\"watcher\"}",
+        "{\"and\":[{\"method\":\"luna://com.webos.service.test/a\",\"key\":\"fired\"},"
+            "{\"method\":\"luna://com.webos.service.test/b\",\"key\":\"fired\"}]}",
+        "{\"or\":[{\"method\":\"luna://com.webos.service.test/a\",\"key\":\"fired\"},"
+            "{\"method\":\"luna://com.webos.service.test/b\","
+            "\"compare\":{\"key\":\"level\",\"value\":5}}]}"
+    };
+
+    for (size_t i = 0 ; i < sizeof(specs) / sizeof(specs[0]) ; ++i) {
+        expectSameAsFresh("trigger", "triggers", specs[i]);
+    }
+}
+
+TEST_F(UnittestActivityExtractor, CallbacksMatchFreshParse)
+{
+    const char *specs[] = {
+        "{\"method\":\"luna://com.webos.service.test/run\"}",
+        "{\"method\":\"luna://com.webos.service.test/run\",\"params\":{\"id\":1}}",
+        "{\"method\":\"luna://com.webos.service.test/run\",\"ignoreReturn\":false}",
+        "{\"method\":\"luna://com.webos.service.test/run\",\"ignoreReturn\":true}"
+    };
+
+    for (size_t i = 0 ; i < sizeof(specs) / sizeof(specs[0]) ; ++i) {
+        expectSameAsFresh("callback", "callbacks", specs[i]);
+        expectSameAsFresh("callback", "callbacks", specs[i], true);
+    }
+}
+
+TEST_F(UnittestActivityExtractor, SchedulesMatchFreshParse)
+{
+    /* UTC and local times, and each of the interval flags, alone and
+     * overridden by "local" */
+    const char *specs[] = {
+        "{\"start\":\"2026-01-02 03:04:05Z\"}",
+        "{\"start\":\"2026-01-02 03:04:05\"}",
+        "{\"start\":\"2026-01-02 03:04:05Z\",\"local\":true}",
+        "{\"start\":\"2026-01-02 03:04:05\",\"local\":false}",
+        "{\"interval\":\"1h\"}",
+        "{\"interval\":\"1h\",\"local\":true}",
+        "{\"interval\":\"1h\",\"skip\":true}",
+        "{\"start\":\"2026-01-02 03:04:05Z\",\"interval\":\"15m\",\"precise\":true}",
+        "{\"start\":\"2026-01-02 03:04:05\",\"interval\":\"15m\",\"precise\":true}",
+        "{\"start\":\"2026-01-02 03:04:05Z\",\"interval\":\"15m\",\"precise\":true,"
+            "\"end\":\"2026-02-02 03:04:05Z\"}",
+        "{\"interval\":\"90s\",\"precise\":true}",
+        "{\"start\":\"2026-01-02 03:04:05Z\",\"interval\":\"1d\",\"precise\":true,"
+            "\"relative\":true}",
+        "{\"start\":\"2026-01-02 03:04:05Z\",\"interval\":\"1h\",\"precise\":true,"
+            "\"lastFinished\":\"2026-01-03 03:04:05Z\"}",
+        "{\"start\":\"2026-01-02 03:04:05\",\"interval\":\"1h\",\"precise\":true,"
+            "\"skip\":true,\"local\":false}"
+    };
+
+    for (size_t i = 0 ; i < sizeof(specs) / sizeof(specs[0]) ; ++i) {
+        expectSameAsFresh("schedule", "schedules", specs[i]);
+    }
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "activity/ActivityIdAllocator.h"
+#include "activity/ActivityManager.h"
+
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+using namespace std;
+
+class UnittestActivityIdAllocator : public testing::Test {
+protected:
+    UnittestActivityIdAllocator()
+    {
+        markPath = "/tmp/Unittest_ActivityIdAllocator." + to_string(getpid()) + ".mark";
+        remove(markPath.c_str());
+    }
+
+    virtual ~UnittestActivityIdAllocator()
+    {
+        remove(markPath.c_str());
+    }
+
+    string markPath;
+};
+
+TEST_F(UnittestActivityIdAllocator, Sequential)
+{
+    ActivityIdAllocator allocator;
+
+    EXPECT_EQ(1ULL, allocator.allocate());
+    EXPECT_EQ(2ULL, allocator.allocate());
+    EXPECT_EQ(3ULL, allocator.allocate());
+}
+
+TEST_F(UnittestActivityIdAllocator, SkipsReloadedIds)
+{
+    ActivityIdAllocator allocator;
+    allocator.allocate();
+
+    allocator.reserve(500);
+    allocator.reserve(20);
+
+    EXPECT_EQ(501ULL, allocator.allocate());
+}
+
+TEST_F(UnittestActivityIdAllocator, ResumesAfterRestart)
+{
+    activityId_t last;
+    {
+        ActivityIdAllocator allocator(markPath);
+        allocator.load();
+        for (int i = 0 ; i < 10 ; ++i) {
+            last = allocator.allocate();
+        }
+    }
+
+    ActivityIdAllocator restarted(markPath);
+    restarted.load();
+
+    /* Nothing handed out before the restart may be handed out again */
+    activityId_t next = restarted.allocate();
+    EXPECT_GT(next, last);
+    EXPECT_LE(next, last + ActivityIdAllocator::kReserveBlock + 1);
+}
+
+TEST_F(UnittestActivityIdAllocator, PersistsOnlyOnceGivenAPath)
+{
+    ActivityIdAllocator allocator;
+    allocator.allocate();
+    EXPECT_FALSE(g_file_test(markPath.c_str(), G_FILE_TEST_EXISTS));
+
+    allocator.setPath(markPath);
+    allocator.load();
+    for (activityId_t i = 0 ; i < ActivityIdAllocator::kReserveBlock ; ++i) {
+        allocator.allocate();
+    }
+    EXPECT_TRUE(g_file_test(markPath.c_str(), G_FILE_TEST_EXISTS));
+}
+
+TEST_F(UnittestActivityIdAllocator, PersistsOncePerBlock)
+{
+    ActivityIdAllocator allocator(markPath);
+    allocator.load();
+
+    allocator.allocate();
+    activityId_t mark = allocator.getHighWaterMark();
+
+    for (activityId_t i = 1 ; i < ActivityIdAllocator::kReserveBlock ; ++i) {
+        allocator.allocate();
+    }
+    EXPECT_EQ(mark, allocator.getHighWaterMark());
+
+    allocator.allocate();
+    EXPECT_EQ(mark + ActivityIdAllocator::kReserveBlock, allocator.getHighWaterMark());
+}
+
+TEST_F(UnittestActivityIdAllocator, Benchmark)
+{
+    /* Create path after reloading 50k persisted Activities, which hold a
+     * dense range of IDs above those already handed out */
+    const activityId_t kReloaded = 50000;
+    const size_t kCreates = 1000;
+
+    ActivityManager& manager = ActivityManager::getInstance();
+    activityId_t first = manager.getNewActivity(false)->getId() + 1;
+
+    vector<shared_ptr<Activity>> acts;
+    for (activityId_t id = first ; id < first + kReloaded ; ++id) {
+        shared_ptr<Activity> act = manager.getNewActivity(id, false);
+        manager.registerActivityId(act);
+        acts.push_back(act);
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    vector<shared_ptr<Activity>> created;
+    for (size_t i = 0 ; i < kCreates ; ++i) {
+        created.push_back(manager.getNewActivity(false));
+    }
+    chrono::duration<double, micro> allocating = chrono::steady_clock::now() - start;
+
+    cout << "[ ActivityIdAllocator ] " << kCreates << " creates after reloading "
+         << kReloaded << ": " << allocating.count() << " us" << endl;
+
+    /* Past every reloaded ID, without having probed for one */
+    EXPECT_EQ(first + kReloaded, created.front()->getId());
+    EXPECT_EQ(first + kReloaded + kCreates - 1, created.back()->getId());
+
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        manager.releaseActivity(acts[i]);
+    }
+}
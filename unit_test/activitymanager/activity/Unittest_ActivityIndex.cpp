@@ -0,0 +1,294 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "activity/ActivityIndex.h"
+#include "activity/Activity.h"
+
+#include <chrono>
+#include <iostream>
+#include <sstream>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestActivityIndex : public testing::Test {
+protected:
+    UnittestActivityIndex()
+    {
+    }
+
+    virtual ~UnittestActivityIndex()
+    {
+    }
+
+    shared_ptr<Activity> givenActivity(activityId_t id, const string& name,
+                                       const BusId& creator)
+    {
+        shared_ptr<Activity> act = make_shared<Activity>(id);
+        act->setName(name);
+        act->setCreator(creator);
+        return act;
+    }
+
+    vector<shared_ptr<Activity>> givenActivities(size_t count)
+    {
+        vector<shared_ptr<Activity>> acts;
+        acts.reserve(count);
+        for (size_t i = 0 ; i < count ; ++i) {
+            ostringstream name;
+            name << "com.webos.service.test.activity." << i;
+            acts.push_back(givenActivity(i + 1, name.str(), CREATORS[i % 4]));
+        }
+        return acts;
+    }
+
+    static double nsPerOp(chrono::steady_clock::time_point start, size_t ops)
+    {
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        return elapsed.count() / (double) ops;
+    }
+
+    ActivityIndex index;
+
+    const BusId CREATORS[4] = {
+        BusId("com.webos.app.test", BusApp),
+        BusId("com.webos.service.test", BusService),
+        BusId("com.webos.service.other", BusService),
+        BusId("com.webos.app.other", BusApp)
+    };
+};
+
+TEST_F(UnittestActivityIndex, FindById)
+{
+    vector<shared_ptr<Activity>> acts = givenActivities(1000);
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        EXPECT_TRUE(index.insert(acts[i]));
+    }
+
+    EXPECT_EQ(acts.size(), index.size());
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        EXPECT_EQ(acts[i], index.find(acts[i]->getId()));
+    }
+    EXPECT_FALSE(index.find(acts.size() + 1));
+}
+
+TEST_F(UnittestActivityIndex, DuplicateId)
+{
+    shared_ptr<Activity> act = givenActivity(7, "first", CREATORS[0]);
+    shared_ptr<Activity> dup = givenActivity(7, "second", CREATORS[0]);
+
+    EXPECT_TRUE(index.insert(act));
+    EXPECT_FALSE(index.insert(dup));
+
+    /* Erasing the duplicate instance must leave the original in place */
+    EXPECT_FALSE(index.erase(*dup));
+    EXPECT_EQ(act, index.find(7));
+}
+
+TEST_F(UnittestActivityIndex, EraseKeepsProbeChains)
+{
+    vector<shared_ptr<Activity>> acts = givenActivities(5000);
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        index.insert(acts[i]);
+        index.insertName(acts[i]);
+    }
+
+    for (size_t i = 0 ; i < acts.size() ; i += 2) {
+        EXPECT_TRUE(index.erase(*acts[i]));
+        EXPECT_TRUE(index.eraseName(*acts[i]));
+    }
+
+    EXPECT_EQ(acts.size() / 2, index.size());
+    EXPECT_EQ(acts.size() / 2, index.nameSize());
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        shared_ptr<Activity> expected = (i % 2) ? acts[i] : shared_ptr<Activity>();
+        EXPECT_EQ(expected, index.find(acts[i]->getId()));
+        EXPECT_EQ(expected, index.find(acts[i]->getName(), acts[i]->getCreator()));
+    }
+}
+
+TEST_F(UnittestActivityIndex, FindByNameAndCreator)
+{
+    shared_ptr<Activity> app = givenActivity(1, "sync", CREATORS[0]);
+    shared_ptr<Activity> service = givenActivity(2, "sync", CREATORS[1]);
+
+    EXPECT_TRUE(index.insertName(app));
+    EXPECT_TRUE(index.insertName(service));
+    EXPECT_FALSE(index.insertName(givenActivity(3, "sync", CREATORS[0])));
+
+    EXPECT_EQ(app, index.find("sync", CREATORS[0]));
+    EXPECT_EQ(service, index.find("sync", CREATORS[1]));
+    EXPECT_FALSE(index.find("sync", CREATORS[2]));
+
+    /* Name only lookup, as used for anonymous callers */
+    EXPECT_TRUE(index.find("sync", BusId("anon", BusAnon), true));
+
+    index.eraseName(*app);
+    EXPECT_EQ(service, index.find("sync", BusId("anon", BusAnon), true));
+}
+
+TEST_F(UnittestActivityIndex, SharedNameAcrossCreators)
+{
+    const size_t kCreators = 5000;
+
+    vector<shared_ptr<Activity>> acts;
+    for (size_t i = 0 ; i < kCreators ; ++i) {
+        ostringstream creator;
+        creator << "com.webos.app.test" << i;
+        acts.push_back(givenActivity(i + 1, "sync", BusId(creator.str(), BusApp)));
+        ASSERT_TRUE(index.insertName(acts.back()));
+    }
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        ASSERT_EQ(acts[i], index.find("sync", acts[i]->getCreator()));
+    }
+    double findNs = nsPerOp(start, acts.size());
+
+    for (size_t i = 0 ; i < acts.size() ; i += 2) {
+        EXPECT_TRUE(index.eraseName(*acts[i]));
+    }
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        EXPECT_EQ((i % 2) ? acts[i] : shared_ptr<Activity>(),
+                  index.find("sync", acts[i]->getCreator()));
+    }
+
+    EXPECT_TRUE(index.find("sync", BusId("anon", BusAnon), true));
+
+    cout << "[ ActivityIndex ] " << kCreators << " creators sharing one name:"
+         << " find(name, creator) " << findNs << " ns" << endl;
+}
+
+TEST_F(UnittestActivityIndex, FindByNameOnly)
+{
+    const BusId anon("anon", BusAnon);
+
+    vector<shared_ptr<Activity>> acts = givenActivities(10000);
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        ASSERT_TRUE(index.insertName(acts[i]));
+    }
+
+    shared_ptr<Activity> shared = givenActivity(20001, acts[0]->getName(), CREATORS[1]);
+    ASSERT_TRUE(index.insertName(shared));
+
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 1 ; i < acts.size() ; ++i) {
+        ASSERT_EQ(acts[i], index.find(acts[i]->getName(), anon, true));
+    }
+    double findNs = nsPerOp(start, acts.size() - 1);
+
+    /* Either Activity using the name will do, until both are gone */
+    shared_ptr<Activity> found = index.find(acts[0]->getName(), anon, true);
+    EXPECT_TRUE((found == acts[0]) || (found == shared));
+    EXPECT_TRUE(index.eraseName(*acts[0]));
+    EXPECT_EQ(shared, index.find(acts[0]->getName(), anon, true));
+    EXPECT_TRUE(index.eraseName(*shared));
+    EXPECT_FALSE(index.find(acts[0]->getName(), anon, true));
+
+    for (size_t i = 1 ; i < acts.size() ; i += 2) {
+        EXPECT_TRUE(index.eraseName(*acts[i]));
+    }
+    for (size_t i = 1 ; i < acts.size() ; ++i) {
+        EXPECT_EQ((i % 2) ? shared_ptr<Activity>() : acts[i],
+                  index.find(acts[i]->getName(), anon, true));
+    }
+
+    index.clear();
+    EXPECT_FALSE(index.find(acts[2]->getName(), anon, true));
+
+    cout << "[ ActivityIndex ] " << acts.size() << " activities:"
+         << " find(name) " << findNs << " ns" << endl;
+}
+
+TEST_F(UnittestActivityIndex, ForEachAfterInIdOrder)
+{
+    const activityId_t ids[] = { 40, 7, 300, 12, 99, 5, 150 };
+    vector<shared_ptr<Activity>> acts;
+    for (size_t i = 0 ; i < sizeof(ids) / sizeof(ids[0]) ; ++i) {
+        acts.push_back(givenActivity(ids[i], "a", CREATORS[0]));
+        ASSERT_TRUE(index.insert(acts.back()));
+    }
+    EXPECT_TRUE(index.erase(*acts[4]));
+
+    vector<activityId_t> seen;
+    index.forEachAfter(7, [&seen](const Activity& act) {
+        seen.push_back(act.getId());
+        return true;
+    });
+    EXPECT_EQ(vector<activityId_t>({ 12, 40, 150, 300 }), seen);
+
+    /* Stops when asked to */
+    seen.clear();
+    index.forEachAfter(0, [&seen](const Activity& act) {
+        seen.push_back(act.getId());
+        return seen.size() < 2;
+    });
+    EXPECT_EQ(vector<activityId_t>({ 5, 7 }), seen);
+
+    index.clear();
+    seen.clear();
+    index.forEachAfter(0, [&seen](const Activity& act) {
+        seen.push_back(act.getId());
+        return true;
+    });
+    EXPECT_TRUE(seen.empty());
+}
+
+TEST_F(UnittestActivityIndex, Benchmark)
+{
+    const size_t counts[] = { 1000, 10000, 100000 };
+
+    for (size_t n = 0 ; n < sizeof(counts) / sizeof(counts[0]) ; ++n) {
+        ActivityIndex bench;
+        vector<shared_ptr<Activity>> acts = givenActivities(counts[n]);
+
+        chrono::steady_clock::time_point start = chrono::steady_clock::now();
+        for (size_t i = 0 ; i < acts.size() ; ++i) {
+            bench.insert(acts[i]);
+            bench.insertName(acts[i]);
+        }
+        double insertNs = nsPerOp(start, acts.size());
+
+        start = chrono::steady_clock::now();
+        for (size_t i = 0 ; i < acts.size() ; ++i) {
+            ASSERT_TRUE(bench.find(acts[i]->getId()));
+        }
+        double findIdNs = nsPerOp(start, acts.size());
+
+        start = chrono::steady_clock::now();
+        for (size_t i = 0 ; i < acts.size() ; ++i) {
+            ASSERT_TRUE(bench.find(acts[i]->getName(), acts[i]->getCreator()));
+        }
+        double findNameNs = nsPerOp(start, acts.size());
+
+        start = chrono::steady_clock::now();
+        for (size_t i = 0 ; i < acts.size() ; ++i) {
+            bench.eraseName(*acts[i]);
+            bench.erase(*acts[i]);
+        }
+        double eraseNs = nsPerOp(start, acts.size());
+
+        EXPECT_EQ(0U, bench.size());
+        EXPECT_EQ(0U, bench.nameSize());
+
+        cout << "[ ActivityIndex ] " << acts.size() << " activities:"
+             << " insert " << insertNs << " ns,"
+             << " find(id) " << findIdNs << " ns,"
+             << " find(name, creator) " << findNameNs << " ns,"
+             << " erase " << eraseNs << " ns" << endl;
+    }
+}
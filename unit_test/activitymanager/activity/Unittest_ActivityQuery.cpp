@@ -0,0 +1,187 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "activity/ActivityQuery.h"
+#include "activity/Activity.h"
+#include "activity/ActivityManager.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestActivityQuery : public testing::Test {
+protected:
+    UnittestActivityQuery()
+    {
+    }
+
+    virtual ~UnittestActivityQuery()
+    {
+    }
+
+    shared_ptr<Activity> givenActivity(activityId_t id, const string& name,
+                                       const BusId& creator)
+    {
+        shared_ptr<Activity> act = make_shared<Activity>(id);
+        act->setName(name);
+        act->setCreator(creator);
+        return act;
+    }
+
+    ActivityQuery::ActivityVec givenActivities(const vector<activityId_t>& ids)
+    {
+        ActivityQuery::ActivityVec acts;
+        for (activityId_t id : ids) {
+            acts.push_back(givenActivity(id, "name", BusId("com.example", BusApp)));
+        }
+        return acts;
+    }
+};
+
+TEST_F(UnittestActivityQuery, EmptyQueryMatchesAll)
+{
+    ActivityQuery query;
+
+    EXPECT_TRUE(query.matches(*givenActivity(1, "a", BusId("com.example", BusApp))));
+    EXPECT_FALSE(query.hasQueue());
+}
+
+TEST_F(UnittestActivityQuery, NamePrefix)
+{
+    ActivityQuery query;
+    query.setNamePrefix("sync.");
+
+    EXPECT_TRUE(query.matches(*givenActivity(1, "sync.mail", BusId("com.example", BusApp))));
+    EXPECT_TRUE(query.matches(*givenActivity(2, "sync.", BusId("com.example", BusApp))));
+    EXPECT_FALSE(query.matches(*givenActivity(3, "sync", BusId("com.example", BusApp))));
+    EXPECT_FALSE(query.matches(*givenActivity(4, "backup", BusId("com.example", BusApp))));
+}
+
+TEST_F(UnittestActivityQuery, CreatorByIdOrTypedString)
+{
+    shared_ptr<Activity> act = givenActivity(1, "a", BusId("com.example", BusService));
+
+    ActivityQuery bare;
+    bare.setCreator("com.example");
+    EXPECT_TRUE(bare.matches(*act));
+
+    ActivityQuery typed;
+    typed.setCreator("serviceId:com.example");
+    EXPECT_TRUE(typed.matches(*act));
+
+    ActivityQuery wrongType;
+    wrongType.setCreator("appId:com.example");
+    EXPECT_FALSE(wrongType.matches(*act));
+}
+
+TEST_F(UnittestActivityQuery, State)
+{
+    /* New Activities start out in state "none" */
+    shared_ptr<Activity> act = givenActivity(1, "a", BusId("com.example", BusApp));
+
+    ActivityQuery none;
+    none.setState("none");
+    EXPECT_TRUE(none.matches(*act));
+
+    ActivityQuery running;
+    running.setState("running");
+    EXPECT_FALSE(running.matches(*act));
+}
+
+TEST_F(UnittestActivityQuery, CursorSkipsEarlierIds)
+{
+    ActivityQuery query;
+    query.setCursor(5);
+
+    EXPECT_FALSE(query.matches(*givenActivity(5, "a", BusId("com.example", BusApp))));
+    EXPECT_TRUE(query.matches(*givenActivity(6, "a", BusId("com.example", BusApp))));
+}
+
+TEST_F(UnittestActivityQuery, UnlimitedPageIsSorted)
+{
+    ActivityQuery query;
+    ActivityQuery::ActivityVec acts = givenActivities({ 9, 3, 7, 1 });
+
+    EXPECT_FALSE(query.selectPage(acts));
+    ASSERT_EQ(4U, acts.size());
+    EXPECT_EQ(1ULL, acts[0]->getId());
+    EXPECT_EQ(3ULL, acts[1]->getId());
+    EXPECT_EQ(7ULL, acts[2]->getId());
+    EXPECT_EQ(9ULL, acts[3]->getId());
+}
+
+TEST_F(UnittestActivityQuery, LimitKeepsLowestIds)
+{
+    ActivityQuery query;
+    query.setLimit(2);
+
+    ActivityQuery::ActivityVec acts = givenActivities({ 9, 3, 7, 1, 5 });
+    EXPECT_TRUE(query.selectPage(acts));
+    ASSERT_EQ(2U, acts.size());
+    EXPECT_EQ(1ULL, acts[0]->getId());
+    EXPECT_EQ(3ULL, acts[1]->getId());
+
+    /* Exactly a page left */
+    ActivityQuery::ActivityVec rest = givenActivities({ 9, 7 });
+    EXPECT_FALSE(query.selectPage(rest));
+    ASSERT_EQ(2U, rest.size());
+    EXPECT_EQ(7ULL, rest[0]->getId());
+}
+
+TEST_F(UnittestActivityQuery, ManagerPagesFromTheCursor)
+{
+    const size_t kActivities = 250;
+    const size_t kPage = 40;
+
+    ActivityManager& manager = ActivityManager::getInstance();
+    activityId_t first = manager.getNewActivity(false)->getId() + 1;
+
+    vector<shared_ptr<Activity>> acts;
+    for (activityId_t id = first ; id < first + kActivities ; ++id) {
+        shared_ptr<Activity> act = manager.getNewActivity(id, false);
+        act->setName((id % 2) ? "query.odd" : "query.even");
+        manager.registerActivityId(act);
+        acts.push_back(act);
+    }
+
+    ActivityQuery query;
+    query.setNamePrefix("query.odd");
+    query.setLimit(kPage);
+    query.setCursor(first - 1);
+
+    vector<activityId_t> listed;
+    bool more = true;
+    while (more) {
+        ActivityManager::ActivityVec page;
+        more = manager.queryActivities(query, page);
+        ASSERT_FALSE(page.empty());
+        EXPECT_LE(page.size(), kPage);
+        for (size_t i = 0 ; i < page.size() ; ++i) {
+            listed.push_back(page[i]->getId());
+        }
+        query.setCursor(page.back()->getId());
+    }
+
+    ASSERT_EQ(kActivities / 2, listed.size());
+    for (size_t i = 0 ; i < listed.size() ; ++i) {
+        EXPECT_EQ(first + (first % 2 ? 0 : 1) + (2 * i), listed[i]);
+    }
+
+    for (size_t i = 0 ; i < acts.size() ; ++i) {
+        manager.releaseActivity(acts[i]);
+    }
+}
@@ -0,0 +1,139 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "activity/ConcurrencyController.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+/* Synthetic pressure, set by the test before each sample */
+class FakePressureSource : public IPressureSource {
+public:
+    FakePressureSource()
+        : m_available(true)
+        , m_cpu(0)
+        , m_memory(0)
+    {
+    }
+
+    virtual bool read(double& cpu, double& memory)
+    {
+        cpu = m_cpu;
+        memory = m_memory;
+        return m_available;
+    }
+
+    bool m_available;
+    double m_cpu;
+    double m_memory;
+};
+
+class UnittestConcurrencyController : public testing::Test {
+protected:
+    UnittestConcurrencyController()
+        : source(make_shared<FakePressureSource>())
+    {
+        info.enabled = true;
+        info.backgroundMin = 1;
+        info.backgroundMax = 4;
+        info.interactiveMin = 1;
+        info.interactiveMax = 6;
+        info.pressureHigh = 40;
+        info.pressureLow = 10;
+    }
+
+    virtual ~UnittestConcurrencyController()
+    {
+    }
+
+    void givenPressure(double cpu, double memory)
+    {
+        source->m_cpu = cpu;
+        source->m_memory = memory;
+    }
+
+    ConcurrencyInfo info;
+    shared_ptr<FakePressureSource> source;
+};
+
+TEST_F(UnittestConcurrencyController, RaisesWhenIdle)
+{
+    ConcurrencyController controller(info, source, 1, 2);
+
+    givenPressure(0, 0);
+    for (int i = 0 ; i < 10 ; ++i) {
+        controller.update();
+    }
+
+    EXPECT_EQ(4U, controller.getBackgroundLevel());
+    EXPECT_EQ(6U, controller.getBackgroundInteractiveLevel());
+    EXPECT_FALSE(controller.update());
+}
+
+TEST_F(UnittestConcurrencyController, HalvesUnderPressure)
+{
+    ConcurrencyController controller(info, source, 4, 6);
+
+    givenPressure(80, 0);
+    EXPECT_TRUE(controller.update());
+    EXPECT_EQ(2U, controller.getBackgroundLevel());
+    EXPECT_EQ(3U, controller.getBackgroundInteractiveLevel());
+
+    /* Memory pressure counts as much as CPU pressure */
+    givenPressure(0, 50);
+    EXPECT_TRUE(controller.update());
+    EXPECT_EQ(1U, controller.getBackgroundLevel());
+    EXPECT_EQ(1U, controller.getBackgroundInteractiveLevel());
+
+    /* Never below the configured minimum */
+    EXPECT_FALSE(controller.update());
+    EXPECT_EQ(1U, controller.getBackgroundLevel());
+    EXPECT_DOUBLE_EQ(50, controller.getPressure());
+}
+
+TEST_F(UnittestConcurrencyController, HoldsBetweenThresholds)
+{
+    ConcurrencyController controller(info, source, 2, 2);
+
+    givenPressure(25, 5);
+    EXPECT_FALSE(controller.update());
+    EXPECT_EQ(2U, controller.getBackgroundLevel());
+    EXPECT_EQ(2U, controller.getBackgroundInteractiveLevel());
+}
+
+TEST_F(UnittestConcurrencyController, StartsWithinBounds)
+{
+    ConcurrencyController controller(info, source, 10, 0);
+
+    EXPECT_EQ(4U, controller.getBackgroundLevel());
+    EXPECT_EQ(1U, controller.getBackgroundInteractiveLevel());
+    EXPECT_LT(controller.getPressure(), 0);
+}
+
+TEST_F(UnittestConcurrencyController, UnavailableSourceKeepsLevels)
+{
+    ConcurrencyController controller(info, source, 2, 2);
+
+    source->m_available = false;
+    givenPressure(0, 0);
+    EXPECT_FALSE(controller.update());
+    EXPECT_EQ(2U, controller.getBackgroundLevel());
+
+    controller.setSource(shared_ptr<IPressureSource>());
+    EXPECT_FALSE(controller.update());
+    EXPECT_EQ(2U, controller.getBackgroundLevel());
+}
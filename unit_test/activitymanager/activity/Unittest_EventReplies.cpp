@@ -0,0 +1,114 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "activity/EventReplies.h"
+#include "activity/Activity.h"
+
+#include <chrono>
+#include <iostream>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestEventReplies : public testing::Test {
+protected:
+    UnittestEventReplies()
+        : activity(make_shared<Activity>(1))
+    {
+        activity->setName("com.webos.service.test.sync");
+        activity->setCreator(BusId("com.webos.service.test", BusService));
+        activity->setMetadata("{\"account\":\"test@example.com\",\"folders\":[1,2,3,4]}");
+    }
+
+    virtual ~UnittestEventReplies()
+    {
+    }
+
+    static double nsPerOp(chrono::steady_clock::time_point start, size_t ops)
+    {
+        chrono::duration<double, nano> elapsed = chrono::steady_clock::now() - start;
+        return elapsed.count() / (double) ops;
+    }
+
+    shared_ptr<Activity> activity;
+};
+
+TEST_F(UnittestEventReplies, OneReplyPerEvent)
+{
+    EventReplies replies(activity);
+
+    const MojObject *first = NULL;
+    const MojObject *second = NULL;
+    const MojObject *basic = NULL;
+
+    ASSERT_EQ(MojErrNone, replies.get(kActivityStartEvent, true, first));
+    ASSERT_EQ(MojErrNone, replies.get(kActivityStartEvent, true, second));
+    ASSERT_EQ(MojErrNone, replies.get(kActivityStartEvent, false, basic));
+
+    EXPECT_EQ(first, second);
+    EXPECT_NE(first, basic);
+    EXPECT_TRUE(first->contains(_T("$activity")));
+    EXPECT_FALSE(basic->contains(_T("$activity")));
+
+    MojString event;
+    bool found = false;
+    ASSERT_EQ(MojErrNone, first->get(_T("event"), event, found));
+    EXPECT_TRUE(found);
+    EXPECT_STREQ(ActivityEventNames[kActivityStartEvent], event.data());
+}
+
+TEST_F(UnittestEventReplies, ExpiredActivity)
+{
+    EventReplies replies(activity);
+    activity.reset();
+
+    const MojObject *reply = NULL;
+    EXPECT_EQ(MojErrInternal, replies.get(kActivityStartEvent, true, reply));
+}
+
+TEST_F(UnittestEventReplies, Benchmark)
+{
+    const size_t kSubscribers = 50;
+    const size_t kBroadcasts = 1000;
+
+    const MojObject *reply = NULL;
+
+    /* Every subscriber building its own reply */
+    chrono::steady_clock::time_point start = chrono::steady_clock::now();
+    for (size_t i = 0 ; i < kBroadcasts ; ++i) {
+        for (size_t j = 0 ; j < kSubscribers ; ++j) {
+            EventReplies own(activity);
+            ASSERT_EQ(MojErrNone, own.get(kActivityUpdateEvent, true, reply));
+        }
+    }
+    double perSubscriberNs = nsPerOp(start, kBroadcasts);
+
+    /* One reply per broadcast, shared */
+    start = chrono::steady_clock::now();
+    for (size_t i = 0 ; i < kBroadcasts ; ++i) {
+        EventReplies shared(activity);
+        for (size_t j = 0 ; j < kSubscribers ; ++j) {
+            ASSERT_EQ(MojErrNone, shared.get(kActivityUpdateEvent, true, reply));
+        }
+    }
+    double sharedNs = nsPerOp(start, kBroadcasts);
+
+    cout << "[ EventReplies ] " << kSubscribers << " detailed subscribers:"
+         << " built per subscriber " << perSubscriberNs << " ns,"
+         << " built once " << sharedNs << " ns per broadcast" << endl;
+}
@@ -0,0 +1,220 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "activity/FairShareQueue.h"
+#include "activity/Activity.h"
+
+#include <algorithm>
+#include <iostream>
+#include <map>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestFairShareQueue : public testing::Test {
+protected:
+    UnittestFairShareQueue()
+        : nextId(1)
+        , nextKey(0)
+    {
+    }
+
+    virtual ~UnittestFairShareQueue()
+    {
+    }
+
+    shared_ptr<Activity> givenReady(FairShareQueue& queue, const BusId& creator)
+    {
+        shared_ptr<Activity> act = make_shared<Activity>(nextId++);
+        act->setCreator(creator);
+        queue.push(*act, nextKey++);
+        acts.push_back(act);
+        return act;
+    }
+
+    /* Run everything queued, one Activity at a time (one background run
+     * slot), and return the order they ran in by creator. */
+    vector<string> whenDrained(FairShareQueue& queue)
+    {
+        vector<string> order;
+        while (Activity *act = queue.select()) {
+            order.push_back(act->getCreator().getId());
+            FairShareQueue::remove(*act);
+        }
+        return order;
+    }
+
+    activityId_t nextId;
+    int64_t nextKey;
+    vector<shared_ptr<Activity>> acts;
+
+    const BusId NOISY = BusId("com.webos.service.noisy", BusService);
+    const BusId QUIET = BusId("com.webos.app.quiet", BusApp);
+};
+
+TEST_F(UnittestFairShareQueue, RoundRobinBetweenCreators)
+{
+    FairShareQueue queue;
+
+    for (int i = 0 ; i < 4 ; ++i) {
+        givenReady(queue, NOISY);
+    }
+    givenReady(queue, QUIET);
+    givenReady(queue, QUIET);
+
+    vector<string> order = whenDrained(queue);
+
+    ASSERT_EQ(6U, order.size());
+    EXPECT_NE(order[0], order[1]);
+    EXPECT_NE(order[2], order[3]);
+    EXPECT_TRUE(queue.empty());
+}
+
+TEST_F(UnittestFairShareQueue, WeightedShare)
+{
+    FairShareQueue queue;
+    FairShareQueue::WeightMap weights;
+    weights[NOISY.getId()] = 3;
+    queue.setWeights(weights);
+
+    for (int i = 0 ; i < 6 ; ++i) {
+        givenReady(queue, NOISY);
+        givenReady(queue, QUIET);
+    }
+
+    vector<string> order = whenDrained(queue);
+
+    /* The first 8 slots should go 3:1 */
+    ASSERT_EQ(12U, order.size());
+    EXPECT_EQ(6, count(order.begin(), order.begin() + 8, NOISY.getId()));
+}
+
+TEST_F(UnittestFairShareQueue, UnlinkedActivitiesAreSkipped)
+{
+    FairShareQueue queue;
+
+    shared_ptr<Activity> gone = givenReady(queue, QUIET);
+    givenReady(queue, NOISY);
+
+    /* Leaves the queue behind the scheduler's back, as when it becomes
+     * unready or is released */
+    FairShareQueue::remove(*gone);
+
+    EXPECT_EQ(1U, queue.size());
+    vector<string> order = whenDrained(queue);
+    ASSERT_EQ(1U, order.size());
+    EXPECT_EQ(NOISY.getId(), order[0]);
+}
+
+TEST_F(UnittestFairShareQueue, AgingOvertakesNewerHigherPriority)
+{
+    const int64_t kInterval = 1000;
+    const int64_t kArrival = 500;
+
+    FairShareQueue queue;
+    map<Activity *, int64_t> readyAt;
+
+    auto givenReadyAt = [&](int64_t now, ActivityPriority_t priority) {
+        shared_ptr<Activity> act = make_shared<Activity>(nextId++);
+        act->setCreator(QUIET);
+        act->setPriority(priority);
+        queue.push(*act, FairShareQueue::agedKey(now, priority, kInterval));
+        acts.push_back(act);
+        readyAt[act.get()] = now;
+        return act;
+    };
+
+    /* One low priority Activity behind a backlog of high priority ones */
+    shared_ptr<Activity> low = givenReadyAt(0, ActivityPriorityLowest);
+    for (int i = 0 ; i < 3 ; ++i) {
+        givenReadyAt(0, ActivityPriorityHighest);
+    }
+
+    /* A new high priority Activity arrives every half interval, and one
+     * Activity runs each time */
+    bool lowRan = false;
+    int newerBeforeLow = 0;
+    for (int64_t now = kArrival ; (now < 100 * kInterval) && !lowRan ; now += kArrival) {
+        givenReadyAt(now, ActivityPriorityHighest);
+
+        Activity *next = queue.select();
+        ASSERT_TRUE(next);
+        FairShareQueue::remove(*next);
+
+        if (next == low.get()) {
+            lowRan = true;
+        } else {
+            /* Only what became ready within the priority gap of it */
+            EXPECT_LT(readyAt[next], (ActivityPriorityHighest - ActivityPriorityLowest) * kInterval);
+            if (readyAt[next] > 0) {
+                newerBeforeLow++;
+            }
+        }
+    }
+
+    EXPECT_TRUE(lowRan);
+    EXPECT_GT(newerBeforeLow, 0);
+}
+
+TEST_F(UnittestFairShareQueue, Benchmark)
+{
+    /* One creator floods the queue with 1000 Activities, then 10 quiet
+     * creators queue 5 each.  With one background slot and every
+     * Activity taking one tick, compare how long the quiet creators wait
+     * with plain FIFO versus the fair share queue. */
+    const size_t kNoisy = 1000;
+    const size_t kQuietCreators = 10;
+    const size_t kQuietEach = 5;
+
+    FairShareQueue queue;
+    for (size_t i = 0 ; i < kNoisy ; ++i) {
+        givenReady(queue, NOISY);
+    }
+    for (size_t i = 0 ; i < kQuietEach ; ++i) {
+        for (size_t c = 0 ; c < kQuietCreators ; ++c) {
+            givenReady(queue, BusId("com.webos.app.quiet" + to_string(c), BusApp));
+        }
+    }
+
+    vector<size_t> fifoWaits;
+    vector<size_t> fairWaits;
+
+    vector<string> order = whenDrained(queue);
+    for (size_t tick = 0 ; tick < order.size() ; ++tick) {
+        if (order[tick] != NOISY.getId()) {
+            fairWaits.push_back(tick);
+        }
+    }
+    for (size_t i = 0 ; i < kQuietCreators * kQuietEach ; ++i) {
+        fifoWaits.push_back(kNoisy + i);
+    }
+
+    ASSERT_EQ(fifoWaits.size(), fairWaits.size());
+    sort(fairWaits.begin(), fairWaits.end());
+
+    size_t p50 = fairWaits.size() / 2;
+    size_t p99 = (fairWaits.size() * 99) / 100;
+
+    cout << "[ FairShareQueue ] quiet creator wait (ticks):"
+         << " fifo p50 " << fifoWaits[p50] << " p99 " << fifoWaits[p99]
+         << " max " << fifoWaits.back() << ";"
+         << " fair p50 " << fairWaits[p50] << " p99 " << fairWaits[p99]
+         << " max " << fairWaits.back() << endl;
+
+    EXPECT_LT(fairWaits.back(), fifoWaits.front());
+}
@@ -0,0 +1,134 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "activity/SpecCache.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestSpecCache : public testing::Test {
+protected:
+    UnittestSpecCache()
+    {
+    }
+
+    virtual ~UnittestSpecCache()
+    {
+    }
+
+    void givenCached(SpecCache<string>& cache, const string& spec)
+    {
+        cache.insert(spec, make_shared<const string>("parsed " + spec));
+    }
+};
+
+TEST_F(UnittestSpecCache, SharesParsedSpecs)
+{
+    SpecCache<string> cache(4);
+
+    EXPECT_FALSE(cache.find("{\"method\":\"luna://a/b\"}"));
+
+    givenCached(cache, "{\"method\":\"luna://a/b\"}");
+
+    shared_ptr<const string> first = cache.find("{\"method\":\"luna://a/b\"}");
+    shared_ptr<const string> second = cache.find("{\"method\":\"luna://a/b\"}");
+    ASSERT_TRUE(first != nullptr);
+    EXPECT_EQ("parsed {\"method\":\"luna://a/b\"}", *first);
+    EXPECT_EQ(first, second);
+
+    EXPECT_FALSE(cache.find("{\"method\":\"luna://a/c\"}"));
+
+    EXPECT_EQ(2UL, cache.getHits());
+    EXPECT_EQ(2UL, cache.getMisses());
+}
+
+TEST_F(UnittestSpecCache, EvictsLeastRecentlyUsed)
+{
+    SpecCache<string> cache(2);
+
+    givenCached(cache, "a");
+    givenCached(cache, "b");
+    EXPECT_TRUE(cache.find("a") != nullptr);
+    givenCached(cache, "c");
+
+    EXPECT_EQ(2U, cache.size());
+    EXPECT_TRUE(cache.find("a") != nullptr);
+    EXPECT_FALSE(cache.find("b"));
+    EXPECT_TRUE(cache.find("c") != nullptr);
+}
+
+TEST_F(UnittestSpecCache, ReplacingKeepsOneEntry)
+{
+    SpecCache<string> cache(2);
+
+    givenCached(cache, "a");
+    cache.insert("a", make_shared<const string>("reparsed"));
+
+    EXPECT_EQ(1U, cache.size());
+    EXPECT_EQ("reparsed", *cache.find("a"));
+}
+
+TEST_F(UnittestSpecCache, ZeroCapacityDisables)
+{
+    SpecCache<string> cache(0);
+
+    givenCached(cache, "a");
+
+    EXPECT_EQ(0U, cache.size());
+    EXPECT_FALSE(cache.find("a"));
+}
+
+TEST_F(UnittestSpecCache, ShrinkingEvictsLeastRecentlyUsed)
+{
+    SpecCache<string> cache(4);
+
+    givenCached(cache, "a");
+    givenCached(cache, "b");
+    givenCached(cache, "c");
+    EXPECT_TRUE(cache.find("a") != nullptr);
+
+    cache.setCapacity(2);
+
+    EXPECT_EQ(2U, cache.size());
+    EXPECT_TRUE(cache.find("a") != nullptr);
+    EXPECT_FALSE(cache.find("b"));
+    EXPECT_TRUE(cache.find("c") != nullptr);
+
+    cache.setCapacity(0);
+    givenCached(cache, "d");
+    EXPECT_EQ(0U, cache.size());
+
+    cache.setCapacity(2);
+    givenCached(cache, "d");
+    EXPECT_EQ(1U, cache.size());
+}
+
+TEST_F(UnittestSpecCache, ClearKeepsCounters)
+{
+    SpecCache<string> cache(2);
+
+    givenCached(cache, "a");
+    EXPECT_TRUE(cache.find("a") != nullptr);
+
+    cache.clear();
+
+    EXPECT_EQ(0U, cache.size());
+    EXPECT_FALSE(cache.find("a"));
+    EXPECT_EQ(1UL, cache.getHits());
+    EXPECT_EQ(1UL, cache.getMisses());
+}
@@ -0,0 +1,233 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "activity/TransitionQueue.h"
+
+#include <set>
+#include <vector>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestTransitionQueue : public testing::Test {
+protected:
+    UnittestTransitionQueue()
+    {
+    }
+
+    virtual ~UnittestTransitionQueue()
+    {
+    }
+
+    virtual void TearDown()
+    {
+        queue.reset();
+        /* Nothing may be left behind for the next test */
+        while (g_main_context_iteration(NULL, FALSE));
+    }
+
+    void givenQueue(unsigned batchSize)
+    {
+        queue.reset(new TransitionQueue(
+                [this](TransitionQueue::Type type, activityId_t id) { onDispatch(type, id); },
+                batchSize));
+    }
+
+    /* Stands in for the Activity table: a transition for an id that is no
+     * longer in it would be a lookup of a released Activity. */
+    void onDispatch(TransitionQueue::Type type, activityId_t id)
+    {
+        EXPECT_TRUE(live.count(id)) << "Dispatched released Activity " << id;
+        dispatched.push_back(id);
+
+        if (onDispatchHook) {
+            onDispatchHook(type, id);
+        }
+    }
+
+    void push(activityId_t id, TransitionQueue::Type type = TransitionQueue::EnterState)
+    {
+        live.insert(id);
+        queue->push(type, id);
+    }
+
+    void release(activityId_t id)
+    {
+        live.erase(id);
+        queue->cancel(id);
+    }
+
+    /* Runs one main loop iteration; returns how many transitions it dispatched */
+    size_t iterate()
+    {
+        size_t before = dispatched.size();
+        g_main_context_iteration(NULL, FALSE);
+        return dispatched.size() - before;
+    }
+
+    unique_ptr<TransitionQueue> queue;
+    set<activityId_t> live;
+    vector<activityId_t> dispatched;
+    std::function<void (TransitionQueue::Type, activityId_t)> onDispatchHook;
+};
+
+TEST_F(UnittestTransitionQueue, DispatchesInQueuedOrder)
+{
+    givenQueue(0);
+
+    push(3);
+    push(1, TransitionQueue::Start);
+    push(2);
+    EXPECT_TRUE(queue->isScheduled());
+    EXPECT_EQ(G_PRIORITY_HIGH, queue->getPriority());
+
+    EXPECT_EQ(3u, iterate());
+    EXPECT_EQ((vector<activityId_t> { 3, 1, 2 }), dispatched);
+    EXPECT_FALSE(queue->isScheduled());
+    EXPECT_EQ(0u, queue->getPending());
+}
+
+TEST_F(UnittestTransitionQueue, HonoursBatchBudgetPerIteration)
+{
+    givenQueue(4);
+
+    for (activityId_t id = 1 ; id <= 10 ; id++) {
+        push(id);
+    }
+
+    EXPECT_EQ(4u, iterate());
+    EXPECT_EQ(6u, queue->getPending());
+    EXPECT_EQ(4u, iterate());
+    EXPECT_EQ(2u, iterate());
+    EXPECT_FALSE(queue->isScheduled());
+
+    vector<activityId_t> expected;
+    for (activityId_t id = 1 ; id <= 10 ; id++) {
+        expected.push_back(id);
+    }
+    EXPECT_EQ(expected, dispatched);
+}
+
+TEST_F(UnittestTransitionQueue, DropsToDefaultPriorityWhenBudgetRunsOut)
+{
+    givenQueue(2);
+
+    push(1);
+    push(2);
+    EXPECT_EQ(G_PRIORITY_HIGH, queue->getPriority());
+
+    /* Exactly a batch: drained without dropping priority */
+    EXPECT_EQ(2u, iterate());
+    EXPECT_FALSE(queue->isScheduled());
+
+    push(3);
+    push(4);
+    push(5);
+    EXPECT_EQ(2u, iterate());
+    EXPECT_TRUE(queue->isScheduled());
+    EXPECT_EQ(G_PRIORITY_DEFAULT, queue->getPriority());
+
+    /* The remainder now shares an iteration with default priority work */
+    bool ranDefault = false;
+    g_idle_add_full(G_PRIORITY_DEFAULT, [](gpointer data) -> gboolean {
+        *static_cast<bool *>(data) = true;
+        return G_SOURCE_REMOVE;
+    }, &ranDefault, NULL);
+    EXPECT_EQ(1u, iterate());
+    EXPECT_TRUE(ranDefault);
+    EXPECT_FALSE(queue->isScheduled());
+
+    /* ...but a fresh backlog starts out at high priority again */
+    push(6);
+    EXPECT_EQ(G_PRIORITY_HIGH, queue->getPriority());
+}
+
+TEST_F(UnittestTransitionQueue, QueuedWhileDispatchingCountsAgainstBatch)
+{
+    givenQueue(3);
+
+    /* Entering a state commonly sets the next one */
+    onDispatchHook = [this](TransitionQueue::Type type, activityId_t id) {
+        if (type == TransitionQueue::Start) {
+            push(id, TransitionQueue::EnterState);
+        }
+    };
+
+    push(1, TransitionQueue::Start);
+    push(2, TransitionQueue::Start);
+
+    EXPECT_EQ(3u, iterate());
+    EXPECT_EQ((vector<activityId_t> { 1, 2, 1 }), dispatched);
+    EXPECT_EQ(1u, iterate());
+    EXPECT_FALSE(queue->isScheduled());
+}
+
+TEST_F(UnittestTransitionQueue, DropsTransitionsOfReleasedActivity)
+{
+    givenQueue(2);
+
+    push(1);
+    push(2);
+    push(1);
+    push(3);
+
+    release(1);
+    EXPECT_EQ(2u, queue->getPending());
+
+    while (queue->isScheduled()) {
+        iterate();
+    }
+    EXPECT_EQ((vector<activityId_t> { 2, 3 }), dispatched);
+}
+
+TEST_F(UnittestTransitionQueue, ReleasedWhileItsBatchDispatches)
+{
+    givenQueue(0);
+
+    /* The first transition ends and releases another Activity whose
+     * transition is behind it in the same batch. */
+    onDispatchHook = [this](TransitionQueue::Type type, activityId_t id) {
+        if (id == 1) {
+            release(2);
+        }
+    };
+
+    push(1);
+    push(2);
+    push(3);
+    push(2);
+
+    EXPECT_EQ(2u, iterate());
+    EXPECT_EQ((vector<activityId_t> { 1, 3 }), dispatched);
+    EXPECT_FALSE(queue->isScheduled());
+}
+
+TEST_F(UnittestTransitionQueue, ReleasingLastPendingLeavesSourceHarmless)
+{
+    givenQueue(1);
+
+    push(1);
+    push(2);
+    EXPECT_EQ(1u, iterate());
+
+    release(2);
+    EXPECT_EQ(0u, queue->getPending());
+
+    EXPECT_EQ(0u, iterate());
+    EXPECT_FALSE(queue->isScheduled());
+}
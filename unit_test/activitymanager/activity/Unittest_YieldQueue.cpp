@@ -0,0 +1,156 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "activity/YieldQueue.h"
+#include "activity/Activity.h"
+
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestYieldQueue : public testing::Test {
+protected:
+    UnittestYieldQueue()
+        : nextId(1)
+    {
+    }
+
+    virtual ~UnittestYieldQueue()
+    {
+    }
+
+    shared_ptr<Activity> givenRunning(YieldQueue& queue, int64_t started,
+                                      ActivityPriority_t priority = ActivityPriorityNormal)
+    {
+        shared_ptr<Activity> act = make_shared<Activity>(nextId++);
+        act->setPriority(priority);
+        queue.push(*act, started);
+        acts.push_back(act);
+        return act;
+    }
+
+    activityId_t whenVictim(YieldQueue& queue)
+    {
+        Activity *victim = queue.selectVictim();
+        return victim ? victim->getId() : 0;
+    }
+
+    activityId_t nextId;
+    vector<shared_ptr<Activity>> acts;
+};
+
+TEST_F(UnittestYieldQueue, LongestRunningFirst)
+{
+    YieldQueue queue(YieldQueue::PolicyLongestRunning);
+
+    givenRunning(queue, 300);
+    givenRunning(queue, 100, ActivityPriorityLowest);
+    givenRunning(queue, 200);
+
+    EXPECT_EQ(2ULL, whenVictim(queue));
+    EXPECT_EQ(3ULL, whenVictim(queue));
+    EXPECT_EQ(1ULL, whenVictim(queue));
+    EXPECT_EQ(0ULL, whenVictim(queue));
+}
+
+TEST_F(UnittestYieldQueue, LowestPriorityFirst)
+{
+    YieldQueue queue(YieldQueue::PolicyLowestPriority);
+
+    givenRunning(queue, 100, ActivityPriorityHigh);
+    givenRunning(queue, 300, ActivityPriorityLow);
+    givenRunning(queue, 200, ActivityPriorityLow);
+
+    /* Ties go to the longest running */
+    EXPECT_EQ(3ULL, whenVictim(queue));
+    EXPECT_EQ(2ULL, whenVictim(queue));
+    EXPECT_EQ(1ULL, whenVictim(queue));
+}
+
+TEST_F(UnittestYieldQueue, ShortestRunningFirst)
+{
+    YieldQueue queue(YieldQueue::PolicyShortestRunning);
+
+    givenRunning(queue, 100);
+    givenRunning(queue, 300);
+    givenRunning(queue, 200);
+
+    EXPECT_EQ(2ULL, whenVictim(queue));
+    EXPECT_EQ(3ULL, whenVictim(queue));
+    EXPECT_EQ(1ULL, whenVictim(queue));
+}
+
+TEST_F(UnittestYieldQueue, CountsYieldingUntilRemoved)
+{
+    YieldQueue queue;
+
+    shared_ptr<Activity> first = givenRunning(queue, 100);
+    shared_ptr<Activity> second = givenRunning(queue, 200);
+
+    queue.selectVictim();
+    queue.selectVictim();
+    EXPECT_EQ(2U, queue.getYieldingCount());
+    EXPECT_TRUE(queue.empty());
+
+    queue.remove(*first);
+    EXPECT_EQ(1U, queue.getYieldingCount());
+
+    /* Removing twice (or an Activity that never yielded) doesn't count */
+    queue.remove(*first);
+    EXPECT_EQ(1U, queue.getYieldingCount());
+
+    /* Run again after yielding */
+    queue.push(*second, 300);
+    EXPECT_EQ(0U, queue.getYieldingCount());
+    EXPECT_FALSE(queue.empty());
+}
+
+TEST_F(UnittestYieldQueue, EndedCandidatesLeave)
+{
+    YieldQueue queue;
+
+    shared_ptr<Activity> first = givenRunning(queue, 100);
+    givenRunning(queue, 200);
+
+    queue.remove(*first);
+
+    EXPECT_EQ(2ULL, whenVictim(queue));
+    EXPECT_EQ(0ULL, whenVictim(queue));
+    EXPECT_EQ(1U, queue.getYieldingCount());
+}
+
+TEST_F(UnittestYieldQueue, ChangingPolicyReorders)
+{
+    YieldQueue queue(YieldQueue::PolicyLongestRunning);
+
+    givenRunning(queue, 100);
+    givenRunning(queue, 200);
+
+    queue.setPolicy(YieldQueue::PolicyShortestRunning);
+
+    EXPECT_EQ(2ULL, whenVictim(queue));
+}
+
+TEST_F(UnittestYieldQueue, PolicyNames)
+{
+    YieldQueue::Policy policy;
+
+    EXPECT_TRUE(YieldQueue::getPolicy("lowest-priority", policy));
+    EXPECT_EQ(YieldQueue::PolicyLowestPriority, policy);
+    EXPECT_FALSE(YieldQueue::getPolicy("random", policy));
+}
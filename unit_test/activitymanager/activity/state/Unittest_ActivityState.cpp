@@ -0,0 +1,131 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "activity/Activity.h"
+#include "activity/state/AbstractActivityState.h"
+#include "activity/state/ActivityStateNone.h"
+
+#include <iostream>
+#include <set>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestActivityState : public testing::Test {
+protected:
+    UnittestActivityState()
+    {
+    }
+
+    virtual ~UnittestActivityState()
+    {
+    }
+
+    /* The Activities aren't registered, so the queued transitions into
+     * each state find nothing to enter */
+    virtual void TearDown()
+    {
+        while (g_main_context_iteration(NULL, FALSE));
+    }
+
+    vector<shared_ptr<Activity>> givenActivities(size_t count)
+    {
+        vector<shared_ptr<Activity>> acts;
+        for (size_t i = 0 ; i < count ; ++i) {
+            acts.push_back(make_shared<Activity>(kFirstId + i));
+        }
+        return acts;
+    }
+
+    /* Returns the microseconds taken */
+    int64_t whenSet(vector<shared_ptr<Activity>>& acts,
+                    shared_ptr<AbstractActivityState> state)
+    {
+        int64_t begin = g_get_monotonic_time();
+        for (size_t i = 0 ; i < acts.size() ; ++i) {
+            acts[i]->setState(state);
+        }
+        return g_get_monotonic_time() - begin;
+    }
+
+    size_t countStates(const vector<shared_ptr<Activity>>& acts)
+    {
+        set<AbstractActivityState *> states;
+        for (size_t i = 0 ; i < acts.size() ; ++i) {
+            states.insert(acts[i]->getState().get());
+        }
+        return states.size();
+    }
+
+    static const activityId_t kFirstId = 5000;
+};
+
+TEST_F(UnittestActivityState, StatesAreShared)
+{
+    EXPECT_EQ(ActivityStateCreated::getInstance(), ActivityStateCreated::getInstance());
+    EXPECT_EQ(ActivityStateExpired::getInstance(), ActivityStateExpired::getInstance());
+    EXPECT_EQ(ActivityStateFailed::getInstance(), ActivityStateFailed::getInstance());
+    EXPECT_NE((void *) ActivityStateCreated::getInstance().get(),
+              (void *) ActivityStateSatisfied::getInstance().get());
+}
+
+TEST_F(UnittestActivityState, TransitionIsPerActivity)
+{
+    shared_ptr<Activity> act1 = make_shared<Activity>(1);
+    shared_ptr<Activity> act2 = make_shared<Activity>(2);
+
+    EXPECT_EQ(act1->getState(), act2->getState());
+    EXPECT_EQ("none", act1->getState()->toString(*act1));
+
+    string name;
+    EXPECT_FALSE(AbstractActivityState::getActivityTransitionName(
+            AbstractActivityState::kActivityTransitionNone, name));
+    EXPECT_TRUE(AbstractActivityState::getActivityTransitionName(
+            AbstractActivityState::kActivityTransitionSatisfying, name));
+    EXPECT_EQ("satisfying", name);
+}
+
+/* Takes Activities through create, run and complete: created ->
+ * unsatisfied -> satisfied -> expired -> destroyed.  Each state entered is
+ * the shared one, so an Activity only takes a reference to it. */
+TEST_F(UnittestActivityState, ActivitiesShareEachStateTheyEnter)
+{
+    const size_t kActivities = 1000;
+    vector<shared_ptr<Activity>> acts = givenActivities(kActivities);
+
+    shared_ptr<AbstractActivityState> satisfied = ActivityStateSatisfied::getInstance();
+    long unused = satisfied.use_count();
+
+    int64_t elapsed = 0;
+    elapsed += whenSet(acts, ActivityStateCreated::getInstance());
+    elapsed += whenSet(acts, ActivityStateUnsatisfied::getInstance());
+    elapsed += whenSet(acts, ActivityStateSatisfied::getInstance());
+
+    EXPECT_EQ(1U, countStates(acts));
+    EXPECT_EQ(satisfied, acts[0]->getState());
+    EXPECT_EQ(unused + (long) kActivities, satisfied.use_count());
+
+    elapsed += whenSet(acts, ActivityStateExpired::getInstance());
+    elapsed += whenSet(acts, ActivityStateDestroyed::getInstance());
+
+    EXPECT_EQ(1U, countStates(acts));
+    EXPECT_EQ(unused, satisfied.use_count());
+
+    cout << "[ ActivityState ] " << (double) elapsed / (kActivities * 5)
+         << " us per transition over " << kActivities << " Activities" << endl;
+}
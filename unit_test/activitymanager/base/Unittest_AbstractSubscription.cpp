@@ -0,0 +1,134 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "base/AbstractSubscription.h"
+#include "activity/Activity.h"
+
+#include <vector>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+
+/* Records what would have been sent */
+class RecordingSubscription : public AbstractSubscription {
+public:
+    RecordingSubscription(shared_ptr<Activity> activity)
+        : AbstractSubscription(activity, true)
+        , m_subscriber("com.webos.service.test", BusService)
+    {
+    }
+
+    virtual void enableSubscription() {}
+
+    virtual Subscriber& getSubscriber() { return m_subscriber; }
+    virtual const Subscriber& getSubscriber() const { return m_subscriber; }
+
+    virtual MojErr sendEvent(ActivityEvent event, EventReplies& replies)
+    {
+        m_sent.push_back(event);
+        return MojErrNone;
+    }
+
+    vector<ActivityEvent> m_sent;
+
+protected:
+    virtual void handleCancel() {}
+
+    Subscriber m_subscriber;
+};
+
+class UnittestAbstractSubscription : public testing::Test {
+protected:
+    UnittestAbstractSubscription()
+        : activity(make_shared<Activity>(1))
+        , subscription(make_shared<RecordingSubscription>(activity))
+    {
+    }
+
+    virtual ~UnittestAbstractSubscription()
+    {
+    }
+
+    void whenWindowEnds()
+    {
+        gint64 until = g_get_monotonic_time() + 50 * 1000;
+        while (g_get_monotonic_time() < until) {
+            g_main_context_iteration(NULL, FALSE);
+        }
+    }
+
+    shared_ptr<Activity> activity;
+    shared_ptr<RecordingSubscription> subscription;
+};
+
+TEST_F(UnittestAbstractSubscription, SendsEveryUpdateByDefault)
+{
+    subscription->queueEvent(kActivityUpdateEvent);
+    subscription->queueEvent(kActivityUpdateEvent);
+    subscription->queueEvent(kActivityUpdateEvent);
+
+    EXPECT_EQ(3U, subscription->m_sent.size());
+}
+
+TEST_F(UnittestAbstractSubscription, CoalescesUpdatesInWindow)
+{
+    subscription->setCoalesceWindow(20);
+
+    subscription->queueEvent(kActivityUpdateEvent);
+    subscription->queueEvent(kActivityUpdateEvent);
+    subscription->queueEvent(kActivityUpdateEvent);
+    ASSERT_EQ(1U, subscription->m_sent.size());
+
+    whenWindowEnds();
+
+    /* The held back updates went out as one */
+    ASSERT_EQ(2U, subscription->m_sent.size());
+    EXPECT_EQ(kActivityUpdateEvent, subscription->m_sent[1]);
+}
+
+TEST_F(UnittestAbstractSubscription, LifecycleEventsFlushInOrder)
+{
+    subscription->setCoalesceWindow(20);
+
+    subscription->queueEvent(kActivityUpdateEvent);
+    subscription->queueEvent(kActivityUpdateEvent);
+    subscription->queueEvent(kActivityStartEvent);
+
+    ASSERT_EQ(3U, subscription->m_sent.size());
+    EXPECT_EQ(kActivityUpdateEvent, subscription->m_sent[0]);
+    EXPECT_EQ(kActivityUpdateEvent, subscription->m_sent[1]);
+    EXPECT_EQ(kActivityStartEvent, subscription->m_sent[2]);
+
+    /* Nothing was left held back */
+    whenWindowEnds();
+    EXPECT_EQ(3U, subscription->m_sent.size());
+}
+
+TEST_F(UnittestAbstractSubscription, CancelDropsHeldUpdate)
+{
+    subscription->setCoalesceWindow(20);
+
+    subscription->queueEvent(kActivityUpdateEvent);
+    subscription->queueEvent(kActivityUpdateEvent);
+
+    subscription->handleCancelWrapper();
+    whenWindowEnds();
+
+    EXPECT_EQ(1U, subscription->m_sent.size());
+}
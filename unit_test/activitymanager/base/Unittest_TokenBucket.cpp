@@ -0,0 +1,98 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "base/TokenBucket.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestTokenBucket : public testing::Test {
+protected:
+    UnittestTokenBucket()
+    {
+    }
+
+    virtual ~UnittestTokenBucket()
+    {
+    }
+
+    unsigned whenConsumed(TokenBucket& bucket, int64_t now, unsigned attempts)
+    {
+        unsigned consumed = 0;
+        for (unsigned i = 0 ; i < attempts ; ++i) {
+            if (bucket.tryConsume(now)) {
+                consumed++;
+            }
+        }
+        return consumed;
+    }
+};
+
+TEST_F(UnittestTokenBucket, BurstThenRate)
+{
+    TokenBucket bucket(50, 10);
+    bucket.reset(1000);
+
+    /* A full bucket allows a burst, then nothing more at the same time */
+    EXPECT_EQ(10U, whenConsumed(bucket, 1000, 100));
+    EXPECT_FALSE(bucket.tryConsume(1000));
+
+    /* 50 per second is one every 20ms */
+    EXPECT_EQ(20U, bucket.getDelay(1000));
+    EXPECT_EQ(10U, bucket.getDelay(1010));
+    EXPECT_EQ(0U, bucket.getDelay(1020));
+    EXPECT_EQ(5U, whenConsumed(bucket, 1100, 100));
+}
+
+TEST_F(UnittestTokenBucket, NeverExceedsBurst)
+{
+    TokenBucket bucket(50, 10);
+    bucket.reset(0);
+
+    EXPECT_EQ(10U, whenConsumed(bucket, 0, 100));
+    EXPECT_EQ(10U, whenConsumed(bucket, 60000, 100));
+}
+
+TEST_F(UnittestTokenBucket, SustainedRate)
+{
+    TokenBucket bucket(50, 10);
+    bucket.reset(0);
+
+    /* Arm 300 Activities as fast as the bucket allows */
+    int64_t now = 0;
+    unsigned armed = 0;
+    while (armed < 300) {
+        if (bucket.tryConsume(now)) {
+            armed++;
+        } else {
+            now += bucket.getDelay(now);
+        }
+    }
+
+    /* The first 10 go at once, the other 290 at 50 per second */
+    EXPECT_NEAR(5800, (double) now, 20);
+}
+
+TEST_F(UnittestTokenBucket, Unlimited)
+{
+    TokenBucket bucket(0, 10);
+    bucket.reset(0);
+
+    EXPECT_TRUE(bucket.isUnlimited());
+    EXPECT_EQ(1000U, whenConsumed(bucket, 0, 1000));
+    EXPECT_EQ(0U, bucket.getDelay(0));
+}
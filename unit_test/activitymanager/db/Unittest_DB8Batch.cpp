@@ -0,0 +1,365 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "activity/Activity.h"
+#include "db/DB8BatchCommand.h"
+#include "db/PersistTokenDB.h"
+
+using namespace std;
+
+namespace {
+
+/* MojoDB's error for a _rev that's no longer current */
+const MojErr kRevisionMismatch = (MojErr) -3961;
+
+class RecordingCompletion : public ICompletion {
+public:
+    RecordingCompletion(vector<string>& log, const string& name)
+        : m_log(log)
+        , m_name(name)
+    {
+    }
+
+    virtual void complete(bool succeeded)
+    {
+        m_log.push_back(m_name + (succeeded ? ":ok" : ":failed"));
+    }
+
+private:
+    vector<string>& m_log;
+    string m_name;
+};
+
+class FakeDB8Batch;
+
+/* A MojoDB call a batch made, for the test to answer */
+struct FakeCall {
+    shared_ptr<FakeDB8Batch> batch;
+    string method;
+    MojObject params;
+};
+
+/* Holds its calls instead of making them, along with those of the batches
+ * split off it.  Every failure is permanent. */
+class FakeDB8Batch : public DB8Batch {
+public:
+    FakeDB8Batch(AbstractPersistManager::CommandType type,
+                 shared_ptr<vector<FakeCall> > calls)
+        : DB8Batch(type)
+        , m_calls(calls)
+    {
+    }
+
+    void respond(const MojObject& response, MojErr err)
+    {
+        persistResponse(NULL, response, err);
+    }
+
+protected:
+    virtual void call(const LunaURL& method, const MojObject& params)
+    {
+        FakeCall made;
+        made.batch = static_pointer_cast<FakeDB8Batch>(shared_from_this());
+        made.method = method.getString();
+        made.params = params;
+        m_calls->push_back(made);
+    }
+
+    virtual shared_ptr<DB8Batch> createBatch() const
+    {
+        return make_shared<FakeDB8Batch>(m_type, m_calls);
+    }
+
+    virtual bool isPermanentFailure(MojServiceMessage *msg, const MojObject& response,
+                                    MojErr err) const
+    {
+        return err != MojErrNone;
+    }
+
+    shared_ptr<vector<FakeCall> > m_calls;
+};
+
+}
+
+class UnittestDB8Batch : public testing::Test {
+protected:
+    UnittestDB8Batch()
+        : calls(make_shared<vector<FakeCall> >())
+        , nextId(1)
+    {
+    }
+
+    virtual ~UnittestDB8Batch()
+    {
+    }
+
+    shared_ptr<FakeDB8Batch> givenBatch(AbstractPersistManager::CommandType type =
+            AbstractPersistManager::StoreCommandType)
+    {
+        return make_shared<FakeDB8Batch>(type, calls);
+    }
+
+    /* Persistent, and not stored yet */
+    shared_ptr<Activity> givenActivity()
+    {
+        shared_ptr<Activity> act = make_shared<Activity>(nextId++);
+        act->setName("sync" + to_string(act->getId()));
+        act->setCreator(BusId("com.example.mail", BusService));
+        act->setPersistent(true);
+        act->setPersistToken(make_shared<PersistTokenDB>());
+        return act;
+    }
+
+    /* Put the whole Activity in a batch of its own, as MojoDB returned it */
+    shared_ptr<Activity> givenStored()
+    {
+        shared_ptr<Activity> act = givenActivity();
+
+        shared_ptr<FakeDB8Batch> batch = givenBatch();
+        whenAdded(batch, act, "stored");
+        batch->seal();
+        whenAnswered(calls->size() - 1, vector<MojInt64>(1, 1));
+        log.clear();
+
+        return act;
+    }
+
+    /* Issued once it's first in its Activity's chain, as the service does */
+    void whenAdded(shared_ptr<DB8Batch> batch, shared_ptr<Activity> act, const string& name)
+    {
+        shared_ptr<AbstractPersistCommand> cmd =
+                batch->prepareCommand(act, make_shared<RecordingCompletion>(log, name));
+        act->hookPersistCommand(cmd);
+        cmd->persist();
+    }
+
+    /* Answers a put or merge with an _id and _rev per object; a rev of 0
+     * leaves that object's result out of its entry */
+    void whenAnswered(size_t call, const vector<MojInt64>& revs)
+    {
+        MojObject results(MojObject::TypeArray);
+        for (size_t i = 0 ; i < revs.size() ; i++) {
+            MojObject result;
+            string id = "++Hx" + to_string(call) + "_" + to_string(i);
+            EXPECT_EQ(MojErrNone, result.putString(_T("id"), id.c_str()));
+            if (revs[i]) {
+                EXPECT_EQ(MojErrNone, result.putInt(_T("rev"), revs[i]));
+            }
+            EXPECT_EQ(MojErrNone, results.push(result));
+        }
+
+        MojObject response;
+        EXPECT_EQ(MojErrNone, response.put(_T("results"), results));
+        (*calls)[call].batch->respond(response, MojErrNone);
+    }
+
+    void whenFailed(size_t call, MojErr err)
+    {
+        MojObject response;
+        EXPECT_EQ(MojErrNone, response.putInt(_T("errorCode"), (MojInt64) err));
+        (*calls)[call].batch->respond(response, err);
+    }
+
+    size_t getCount(size_t call, const MojChar *key)
+    {
+        MojObject array;
+        EXPECT_TRUE((*calls)[call].params.get(key, array));
+        return array.size();
+    }
+
+    shared_ptr<PersistTokenDB> getToken(shared_ptr<Activity> act)
+    {
+        return dynamic_pointer_cast<PersistTokenDB, PersistToken>(act->getPersistToken());
+    }
+
+    shared_ptr<vector<FakeCall> > calls;
+    activityId_t nextId;
+    vector<string> log;
+};
+
+TEST_F(UnittestDB8Batch, PutsEveryActivityInOneCall)
+{
+    shared_ptr<FakeDB8Batch> batch = givenBatch();
+    shared_ptr<Activity> a = givenActivity();
+    shared_ptr<Activity> b = givenActivity();
+    shared_ptr<Activity> c = givenActivity();
+
+    whenAdded(batch, a, "a");
+    whenAdded(batch, b, "b");
+    whenAdded(batch, c, "c");
+    EXPECT_TRUE(calls->empty());
+
+    batch->seal();
+    ASSERT_EQ(1U, calls->size());
+    EXPECT_EQ("luna://com.webos.service.db/put", (*calls)[0].method);
+    EXPECT_EQ(3U, getCount(0, _T("objects")));
+
+    vector<MojInt64> revs;
+    revs.push_back(11);
+    revs.push_back(12);
+    revs.push_back(13);
+    whenAnswered(0, revs);
+
+    ASSERT_EQ(3U, log.size());
+    EXPECT_EQ("a:ok", log[0]);
+    EXPECT_EQ("b:ok", log[1]);
+    EXPECT_EQ("c:ok", log[2]);
+    EXPECT_EQ(12, getToken(b)->getRev());
+    EXPECT_FALSE(b->isPersistCommandHooked());
+}
+
+TEST_F(UnittestDB8Batch, WaitsForEveryCommandsTurn)
+{
+    shared_ptr<FakeDB8Batch> batch = givenBatch();
+    shared_ptr<Activity> a = givenActivity();
+    shared_ptr<Activity> b = givenActivity();
+
+    /* b already has a command waiting on the first batch */
+    shared_ptr<FakeDB8Batch> first = givenBatch();
+    whenAdded(first, b, "first");
+
+    whenAdded(batch, a, "a");
+    shared_ptr<AbstractPersistCommand> cmd =
+            batch->prepareCommand(b, make_shared<RecordingCompletion>(log, "b"));
+    b->hookPersistCommand(cmd);
+    b->getHookedPersistCommand()->append(cmd);
+    batch->seal();
+    EXPECT_TRUE(calls->empty());
+
+    first->seal();
+    ASSERT_EQ(1U, calls->size());
+    whenAnswered(0, vector<MojInt64>(1, 5));
+
+    ASSERT_EQ(2U, calls->size());
+    EXPECT_EQ(2U, getCount(1, _T("objects")));
+}
+
+TEST_F(UnittestDB8Batch, MissingResultFailsOnlyItsItem)
+{
+    shared_ptr<FakeDB8Batch> batch = givenBatch();
+    whenAdded(batch, givenActivity(), "a");
+    whenAdded(batch, givenActivity(), "b");
+    whenAdded(batch, givenActivity(), "c");
+    batch->seal();
+
+    vector<MojInt64> revs;
+    revs.push_back(21);
+    revs.push_back(0);
+    revs.push_back(23);
+    whenAnswered(0, revs);
+
+    ASSERT_EQ(3U, log.size());
+    EXPECT_EQ("a:ok", log[0]);
+    EXPECT_EQ("b:failed", log[1]);
+    EXPECT_EQ("c:ok", log[2]);
+}
+
+TEST_F(UnittestDB8Batch, FailedCallIsSplitIntoSingleCalls)
+{
+    shared_ptr<FakeDB8Batch> batch = givenBatch();
+    whenAdded(batch, givenActivity(), "a");
+    whenAdded(batch, givenActivity(), "b");
+    whenAdded(batch, givenActivity(), "c");
+    batch->seal();
+
+    /* One bad object fails the whole put */
+    whenFailed(0, MojErrInvalidArg);
+    EXPECT_TRUE(log.empty());
+    ASSERT_EQ(4U, calls->size());
+    for (size_t i = 1 ; i < 4 ; i++) {
+        EXPECT_EQ("luna://com.webos.service.db/put", (*calls)[i].method);
+        EXPECT_EQ(1U, getCount(i, _T("objects")));
+    }
+
+    /* Only the bad one fails again on its own */
+    whenAnswered(1, vector<MojInt64>(1, 31));
+    whenFailed(2, MojErrInvalidArg);
+    whenAnswered(3, vector<MojInt64>(1, 33));
+
+    ASSERT_EQ(3U, log.size());
+    EXPECT_EQ("a:ok", log[0]);
+    EXPECT_EQ("b:failed", log[1]);
+    EXPECT_EQ("c:ok", log[2]);
+    EXPECT_EQ(4U, calls->size());
+}
+
+TEST_F(UnittestDB8Batch, StoredActivitiesAreMerged)
+{
+    shared_ptr<Activity> a = givenStored();
+    shared_ptr<Activity> b = givenStored();
+    size_t first = calls->size();
+
+    shared_ptr<FakeDB8Batch> batch = givenBatch();
+    whenAdded(batch, a, "a");
+    whenAdded(batch, b, "b");
+    batch->seal();
+
+    ASSERT_EQ(first + 1, calls->size());
+    EXPECT_EQ("luna://com.webos.service.db/merge", (*calls)[first].method);
+    EXPECT_EQ(2U, getCount(first, _T("objects")));
+}
+
+TEST_F(UnittestDB8Batch, RevisionMismatchFallsBackToPut)
+{
+    shared_ptr<Activity> a = givenStored();
+    shared_ptr<Activity> b = givenStored();
+    size_t first = calls->size();
+
+    shared_ptr<FakeDB8Batch> batch = givenBatch();
+    whenAdded(batch, a, "a");
+    whenAdded(batch, b, "b");
+    batch->seal();
+
+    whenFailed(first, kRevisionMismatch);
+    EXPECT_TRUE(log.empty());
+    ASSERT_EQ(first + 2, calls->size());
+    EXPECT_EQ("luna://com.webos.service.db/put", (*calls)[first + 1].method);
+    EXPECT_EQ(2U, getCount(first + 1, _T("objects")));
+
+    whenAnswered(first + 1, vector<MojInt64>(2, 40));
+    ASSERT_EQ(2U, log.size());
+    EXPECT_EQ("a:ok", log[0]);
+    EXPECT_EQ("b:ok", log[1]);
+}
+
+TEST_F(UnittestDB8Batch, UnstoredActivityIsNotDeleted)
+{
+    shared_ptr<Activity> stored = givenStored();
+
+    shared_ptr<FakeDB8Batch> batch = givenBatch(AbstractPersistManager::DeleteCommandType);
+    whenAdded(batch, stored, "stored");
+    whenAdded(batch, givenActivity(), "unstored");
+    batch->seal();
+
+    /* Fails as it's issued, without holding up the other */
+    ASSERT_EQ(1U, log.size());
+    EXPECT_EQ("unstored:failed", log[0]);
+
+    size_t last = calls->size() - 1;
+    EXPECT_EQ("luna://com.webos.service.db/del", (*calls)[last].method);
+    EXPECT_EQ(1U, getCount(last, _T("ids")));
+
+    (*calls)[last].batch->respond(MojObject(), MojErrNone);
+    ASSERT_EQ(2U, log.size());
+    EXPECT_EQ("stored:ok", log[1]);
+    EXPECT_FALSE(getToken(stored)->isValid());
+}
@@ -0,0 +1,253 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+#include "db/DB8LoadQueue.h"
+
+using namespace std;
+
+namespace {
+
+/* Stands in for MojoDB's find: answers each page request after a fixed
+ * latency, on the main loop */
+class FakeDB8 {
+public:
+    typedef std::function<void (const MojObject& results, bool last)> PageCallback;
+
+    FakeDB8(size_t pages, size_t pageSize, unsigned int latencyMs)
+        : m_pages(pages)
+        , m_pageSize(pageSize)
+        , m_latency(latencyMs)
+        , m_next(0)
+    {
+    }
+
+    void find(PageCallback callback)
+    {
+        m_callback = callback;
+        g_timeout_add(m_latency, &FakeDB8::respond, this);
+    }
+
+protected:
+    static gboolean respond(gpointer data)
+    {
+        FakeDB8 *self = static_cast<FakeDB8 *>(data);
+
+        MojObject results(MojObject::TypeArray);
+        for (size_t i = 0 ; i < self->m_pageSize ; i++) {
+            MojObject rep;
+            EXPECT_EQ(MojErrNone, rep.putInt(_T("activityId"),
+                    (MojInt64) (self->m_next * self->m_pageSize + i)));
+            EXPECT_EQ(MojErrNone, results.push(rep));
+        }
+
+        bool last = (++self->m_next == self->m_pages);
+        self->m_callback(results, last);
+
+        return G_SOURCE_REMOVE;
+    }
+
+    size_t m_pages;
+    size_t m_pageSize;
+    unsigned int m_latency;
+    size_t m_next;
+    PageCallback m_callback;
+};
+
+/* Simulates the cost of setting up one Activity */
+void spin(int64_t us)
+{
+    int64_t until = g_get_monotonic_time() + us;
+    while (g_get_monotonic_time() < until);
+}
+
+}
+
+class UnittestDB8LoadQueue : public testing::Test {
+protected:
+    UnittestDB8LoadQueue()
+        : m_done(false)
+        , m_queue(std::bind(&UnittestDB8LoadQueue::load, this, std::placeholders::_1),
+                  std::bind(&UnittestDB8LoadQueue::finished, this))
+    {
+    }
+
+    virtual ~UnittestDB8LoadQueue()
+    {
+    }
+
+    void load(const MojObject& rep)
+    {
+        MojInt64 id = -1;
+        rep.get(_T("activityId"), id);
+        m_loaded.push_back(id);
+    }
+
+    void finished()
+    {
+        m_done = true;
+    }
+
+    MojObject makePage(MojInt64 first, size_t count)
+    {
+        MojObject results(MojObject::TypeArray);
+        for (size_t i = 0 ; i < count ; i++) {
+            MojObject rep;
+            EXPECT_EQ(MojErrNone, rep.putInt(_T("activityId"), first + (MojInt64) i));
+            EXPECT_EQ(MojErrNone, results.push(rep));
+        }
+        return results;
+    }
+
+    vector<MojInt64> m_loaded;
+    bool m_done;
+    DB8LoadQueue m_queue;
+};
+
+TEST_F(UnittestDB8LoadQueue, SetsUpAChunkPerIteration)
+{
+    m_queue.start(2);
+    m_queue.addPage(makePage(0, 3), false);
+    m_queue.addPage(makePage(3, 2), true);
+
+    EXPECT_TRUE(m_loaded.empty());
+    EXPECT_EQ(5U, m_queue.getPending());
+
+    g_main_context_iteration(NULL, TRUE);
+    EXPECT_EQ(2U, m_loaded.size());
+    EXPECT_FALSE(m_done);
+
+    while (!m_done) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+
+    ASSERT_EQ(5U, m_loaded.size());
+    for (size_t i = 0 ; i < m_loaded.size() ; i++) {
+        EXPECT_EQ((MojInt64) i, m_loaded[i]);
+    }
+    EXPECT_EQ(0U, m_queue.getPending());
+}
+
+TEST_F(UnittestDB8LoadQueue, WithoutChunkSizeSetsUpAPageAtOnce)
+{
+    m_queue.start(0);
+    m_queue.addPage(makePage(0, 3), false);
+    m_queue.addPage(makePage(3, 4), true);
+
+    g_main_context_iteration(NULL, TRUE);
+    EXPECT_EQ(3U, m_loaded.size());
+
+    g_main_context_iteration(NULL, TRUE);
+    EXPECT_EQ(7U, m_loaded.size());
+    EXPECT_TRUE(m_done);
+}
+
+TEST_F(UnittestDB8LoadQueue, EmptyLastPageFinishes)
+{
+    m_queue.start(4);
+    m_queue.addPage(MojObject(MojObject::TypeArray), true);
+
+    g_main_context_iteration(NULL, TRUE);
+    EXPECT_TRUE(m_loaded.empty());
+    EXPECT_TRUE(m_done);
+}
+
+TEST_F(UnittestDB8LoadQueue, CancelDropsPending)
+{
+    m_queue.start(1);
+    m_queue.addPage(makePage(0, 3), true);
+    m_queue.cancel();
+
+    EXPECT_FALSE(g_main_context_iteration(NULL, FALSE));
+    EXPECT_TRUE(m_loaded.empty());
+    EXPECT_FALSE(m_done);
+    EXPECT_EQ(0U, m_queue.getPending());
+}
+
+/* Startup time of loading pages one after another and setting each up in
+ * full before asking for the next, against fetching the next page while
+ * setting up the current one in chunks */
+TEST_F(UnittestDB8LoadQueue, StartupBenchmark)
+{
+    const size_t kPages = 10;
+    const size_t kPageSize = 50;
+    const unsigned int kLatencyMs = 5;
+    const int64_t kSetupUs = 100;
+
+    GMainLoop *loop = g_main_loop_new(NULL, FALSE);
+
+    /* Serial: the way pages used to be loaded */
+    FakeDB8 serialDb(kPages, kPageSize, kLatencyMs);
+    FakeDB8::PageCallback serial = [&](const MojObject& results, bool last) {
+        for (MojObject::ConstArrayIterator iter = results.arrayBegin() ;
+                iter != results.arrayEnd() ; ++iter) {
+            spin(kSetupUs);
+        }
+
+        if (last) {
+            g_main_loop_quit(loop);
+        } else {
+            serialDb.find(serial);
+        }
+    };
+
+    int64_t begin = g_get_monotonic_time();
+    serialDb.find(serial);
+    g_main_loop_run(loop);
+    int64_t serialUs = g_get_monotonic_time() - begin;
+
+    /* Pipelined: ask for the next page, then queue this one */
+    FakeDB8 pipelinedDb(kPages, kPageSize, kLatencyMs);
+    size_t setUp = 0;
+    DB8LoadQueue queue([&](const MojObject&) { spin(kSetupUs); setUp++; },
+                       [&]() { g_main_loop_quit(loop); });
+
+    FakeDB8::PageCallback pipelined = [&](const MojObject& results, bool last) {
+        if (!last) {
+            pipelinedDb.find(pipelined);
+        }
+        queue.addPage(results, last);
+    };
+
+    begin = g_get_monotonic_time();
+    queue.start(32);
+    pipelinedDb.find(pipelined);
+    g_main_loop_run(loop);
+    int64_t pipelinedUs = g_get_monotonic_time() - begin;
+
+    g_main_loop_unref(loop);
+
+    MojObject info;
+    EXPECT_EQ(MojErrNone, queue.infoToJson(info));
+    MojObject load;
+    ASSERT_TRUE(info.get(_T("startupLoad"), load));
+    MojInt64 longestChunkUs = 0;
+    EXPECT_TRUE(load.get(_T("longestChunkUs"), longestChunkUs));
+
+    cout << "Startup load of " << kPages * kPageSize << " Activities: serial "
+         << serialUs / 1000 << " ms, pipelined " << pipelinedUs / 1000
+         << " ms, longest chunk " << longestChunkUs << " us" << endl;
+
+    EXPECT_EQ(kPages * kPageSize, setUp);
+    EXPECT_LT(pipelinedUs, serialUs);
+}
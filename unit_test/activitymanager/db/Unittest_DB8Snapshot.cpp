@@ -0,0 +1,329 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "activity/ActivityManager.h"
+#include "activity/state/AbstractActivityState.h"
+#include "db/DB8Manager.h"
+#include "db/DB8Snapshot.h"
+#include "db/PersistTokenDB.h"
+
+using namespace std;
+
+namespace {
+
+/* Exposes the load and reconcile steps, without MojoDB or the snapshot
+ * file */
+class FakeDB8Manager : public DB8Manager {
+public:
+    FakeDB8Manager()
+    {
+        m_snapshotLoaded = true;
+    }
+
+    /* Set up from the snapshot, and scheduled */
+    shared_ptr<Activity> givenFromSnapshot(const MojObject& rep)
+    {
+        shared_ptr<Activity> act = loadActivity(rep);
+        if (act) {
+            m_snapshot.track(act);
+        }
+        return act;
+    }
+
+    void whenRead(const MojObject& rep)
+    {
+        reconcileActivity(rep);
+    }
+
+    size_t getPurgeCount() const
+    {
+        return m_oldTokens.size();
+    }
+};
+
+}
+
+class UnittestDB8Snapshot : public testing::Test {
+protected:
+    UnittestDB8Snapshot()
+        : snapshot("")
+        , creator("com.example.mail", BusService)
+    {
+    }
+
+    virtual ~UnittestDB8Snapshot()
+    {
+        for (size_t i = 0 ; i < registered.size() ; i++) {
+            if (isRegistered(registered[i])) {
+                ActivityManager::getInstance().releaseActivity(registered[i]);
+            }
+        }
+    }
+
+    /* An Activity's object as stored in MojoDB */
+    MojObject givenRep(activityId_t activityId, const string& name,
+                       const string& id, MojInt64 rev)
+    {
+        MojObject creatorRep;
+        EXPECT_EQ(MojErrNone, creatorRep.putString(_T("serviceId"), "com.example.mail"));
+
+        MojObject type;
+        EXPECT_EQ(MojErrNone, type.putBool(_T("background"), true));
+        EXPECT_EQ(MojErrNone, type.putBool(_T("persist"), true));
+
+        MojObject rep;
+        EXPECT_EQ(MojErrNone, rep.putInt(_T("activityId"), (MojInt64) activityId));
+        EXPECT_EQ(MojErrNone, rep.putString(_T("name"), name.c_str()));
+        EXPECT_EQ(MojErrNone, rep.putString(_T("description"), "Mail sync"));
+        EXPECT_EQ(MojErrNone, rep.put(_T("creator"), creatorRep));
+        EXPECT_EQ(MojErrNone, rep.put(_T("type"), type));
+        EXPECT_EQ(MojErrNone, rep.putString(_T("_id"), id.c_str()));
+        EXPECT_EQ(MojErrNone, rep.putInt(_T("_rev"), rev));
+        return rep;
+    }
+
+    /* Registered as it's set up from the snapshot, and tracked */
+    shared_ptr<Activity> givenTracked(activityId_t activityId, const string& name,
+                                      const string& id, MojInt64 rev)
+    {
+        shared_ptr<Activity> act = givenClientActivity(activityId, name);
+
+        MojString tokenId;
+        tokenId.assign(id.c_str());
+        act->setPersistToken(make_shared<PersistTokenDB>(tokenId, rev));
+
+        snapshot.track(act);
+        return act;
+    }
+
+    /* Created by a client since the service went online */
+    shared_ptr<Activity> givenClientActivity(activityId_t activityId, const string& name)
+    {
+        shared_ptr<Activity> act =
+                ActivityManager::getInstance().getNewActivity(activityId, false);
+        act->setName(name);
+        act->setCreator(creator);
+
+        ActivityManager::getInstance().registerActivityId(act);
+        ActivityManager::getInstance().registerActivityName(act);
+        registered.push_back(act);
+        return act;
+    }
+
+    shared_ptr<PersistTokenDB> getToken(shared_ptr<Activity> act)
+    {
+        return dynamic_pointer_cast<PersistTokenDB, PersistToken>(act->getPersistToken());
+    }
+
+    MojInt64 getCount(const char *counter)
+    {
+        MojObject rep;
+        EXPECT_EQ(MojErrNone, snapshot.infoToJson(rep));
+
+        MojObject counters;
+        EXPECT_TRUE(rep.get(_T("snapshot"), counters));
+
+        MojInt64 count = -1;
+        EXPECT_TRUE(counters.get(counter, count));
+        return count;
+    }
+
+    bool isRegistered(shared_ptr<Activity> act)
+    {
+        try {
+            return ActivityManager::getInstance().getActivity(act->getId()) == act;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    bool isLive(shared_ptr<Activity> act)
+    {
+        return ActivityManager::getInstance().hasActivity(act->getName(), creator) &&
+                (ActivityManager::getInstance().getActivity(act->getName(), creator) == act);
+    }
+
+    DB8Snapshot snapshot;
+    BusId creator;
+    vector<shared_ptr<Activity>> registered;
+};
+
+TEST_F(UnittestDB8Snapshot, MatchedActivityIsLeftAlone)
+{
+    givenTracked(901, "sync", "++Hx01", 10);
+
+    shared_ptr<Activity> outdated;
+    EXPECT_FALSE(snapshot.reconcile(givenRep(901, "sync", "++Hx01", 10), outdated));
+    EXPECT_FALSE(outdated);
+    EXPECT_EQ(1, getCount("matched"));
+}
+
+TEST_F(UnittestDB8Snapshot, KeptActivityStoredSinceIsLeftAlone)
+{
+    shared_ptr<Activity> act = givenTracked(902, "sync", "++Hx02", 10);
+    MojString id;
+    id.assign("++Hx02");
+    getToken(act)->update(id, 14);
+
+    /* MojoDB read the object before the store */
+    shared_ptr<Activity> outdated;
+    EXPECT_FALSE(snapshot.reconcile(givenRep(902, "sync", "++Hx02", 10), outdated));
+    EXPECT_FALSE(outdated);
+    EXPECT_EQ(1, getCount("kept"));
+}
+
+TEST_F(UnittestDB8Snapshot, ReplacedByClientIsLeftAlone)
+{
+    shared_ptr<Activity> old = givenTracked(903, "sync", "++Hx03", 10);
+
+    /* A client replaced it while MojoDB was being read: the new Activity
+     * takes over the token and stores itself under it */
+    ActivityManager::getInstance().cancelActivity(old);
+    ActivityManager::getInstance().unregisterActivityName(old);
+    shared_ptr<Activity> replacement = givenClientActivity(904, "sync");
+    replacement->setPersistToken(old->getPersistToken());
+    MojString id;
+    id.assign("++Hx03");
+    getToken(replacement)->update(id, 15);
+
+    shared_ptr<Activity> outdated;
+    EXPECT_FALSE(snapshot.reconcile(givenRep(903, "sync", "++Hx03", 10), outdated));
+    EXPECT_FALSE(outdated);
+    EXPECT_EQ(1, getCount("kept"));
+}
+
+TEST_F(UnittestDB8Snapshot, UpdatedActivityIsReplaced)
+{
+    shared_ptr<Activity> act = givenTracked(905, "sync", "++Hx05", 10);
+
+    shared_ptr<Activity> outdated;
+    EXPECT_TRUE(snapshot.reconcile(givenRep(905, "sync", "++Hx05", 12), outdated));
+    EXPECT_EQ(act, outdated);
+    EXPECT_EQ(1, getCount("updated"));
+}
+
+TEST_F(UnittestDB8Snapshot, UpdatedActivityEndedByClientIsNotEndedAgain)
+{
+    shared_ptr<Activity> act = givenTracked(918, "sync", "++Hx18", 10);
+    ActivityManager::getInstance().cancelActivity(act);
+    ActivityManager::getInstance().unregisterActivityName(act);
+
+    shared_ptr<Activity> outdated;
+    EXPECT_TRUE(snapshot.reconcile(givenRep(918, "sync", "++Hx18", 12), outdated));
+    EXPECT_FALSE(outdated);
+}
+
+TEST_F(UnittestDB8Snapshot, AddedActivityIsSetUp)
+{
+    givenTracked(906, "sync", "++Hx06", 10);
+
+    shared_ptr<Activity> outdated;
+    EXPECT_TRUE(snapshot.reconcile(givenRep(907, "backup", "++Hx07", 11), outdated));
+    EXPECT_FALSE(outdated);
+    EXPECT_EQ(1, getCount("added"));
+}
+
+TEST_F(UnittestDB8Snapshot, StaleActivitiesLeftOver)
+{
+    givenTracked(908, "sync", "++Hx08", 10);
+    shared_ptr<Activity> gone = givenTracked(909, "backup", "++Hx09", 11);
+    shared_ptr<Activity> storedSince = givenTracked(910, "upload", "++Hx10", 12);
+    MojString id;
+    id.assign("++Hx10");
+    getToken(storedSince)->update(id, 16);
+    shared_ptr<Activity> cancelled = givenTracked(919, "download", "++Hx19", 13);
+    ActivityManager::getInstance().cancelActivity(cancelled);
+    ActivityManager::getInstance().unregisterActivityName(cancelled);
+
+    shared_ptr<Activity> outdated;
+    EXPECT_FALSE(snapshot.reconcile(givenRep(908, "sync", "++Hx08", 10), outdated));
+
+    vector<shared_ptr<Activity>> stale = snapshot.takeStale();
+    ASSERT_EQ(1U, stale.size());
+    EXPECT_EQ(gone, stale[0]);
+    EXPECT_EQ(1, getCount("stale"));
+
+    /* Reconciliation is over */
+    EXPECT_TRUE(snapshot.takeStale().empty());
+}
+
+TEST_F(UnittestDB8Snapshot, AbandonedActivitiesAreKept)
+{
+    shared_ptr<Activity> first = givenTracked(911, "sync", "++Hx11", 10);
+    shared_ptr<Activity> second = givenTracked(912, "backup", "++Hx12", 11);
+
+    snapshot.abandon();
+
+    EXPECT_TRUE(snapshot.takeStale().empty());
+    EXPECT_EQ(0, getCount("stale"));
+    EXPECT_TRUE(isLive(first));
+    EXPECT_TRUE(isLive(second));
+}
+
+TEST_F(UnittestDB8Snapshot, OutdatedActivityIsEndedAndReplaced)
+{
+    FakeDB8Manager manager;
+    shared_ptr<Activity> outdated = manager.givenFromSnapshot(givenRep(913, "sync", "++Hx13", 10));
+    ASSERT_TRUE(outdated);
+    registered.push_back(outdated);
+
+    manager.whenRead(givenRep(913, "sync", "++Hx13", 12));
+
+    EXPECT_EQ(ActivityStateDestroyed::getInstance(), outdated->getState());
+    EXPECT_FALSE(outdated->isNameRegistered());
+
+    shared_ptr<Activity> loaded = ActivityManager::getInstance().getActivity(913);
+    registered.push_back(loaded);
+    EXPECT_NE(outdated, loaded);
+    EXPECT_TRUE(isLive(loaded));
+    EXPECT_EQ(12, getToken(loaded)->getRev());
+}
+
+TEST_F(UnittestDB8Snapshot, ClientCreateDuringReconcileStands)
+{
+    FakeDB8Manager manager;
+
+    /* Not persistent, so it has no token at all */
+    shared_ptr<Activity> client = givenClientActivity(914, "sync");
+
+    manager.whenRead(givenRep(915, "sync", "++Hx15", 10));
+
+    EXPECT_TRUE(isLive(client));
+    EXPECT_THROW(ActivityManager::getInstance().getActivity(915), std::runtime_error);
+    EXPECT_EQ(1U, manager.getPurgeCount());
+}
+
+TEST_F(UnittestDB8Snapshot, UnstoredClientCreateDuringReconcileStands)
+{
+    FakeDB8Manager manager;
+
+    /* Persistent, with its first store still in flight */
+    shared_ptr<Activity> client = givenClientActivity(916, "sync");
+    client->setPersistToken(make_shared<PersistTokenDB>());
+
+    manager.whenRead(givenRep(917, "sync", "++Hx17", 10));
+
+    EXPECT_TRUE(isLive(client));
+    EXPECT_THROW(ActivityManager::getInstance().getActivity(917), std::runtime_error);
+    EXPECT_EQ(1U, manager.getPurgeCount());
+}
@@ -0,0 +1,364 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+#include "activity/Activity.h"
+#include "db/DB8StoreQueue.h"
+
+using namespace std;
+
+namespace {
+
+class RecordingCompletion : public ICompletion {
+public:
+    RecordingCompletion(vector<string>& log, const string& name)
+        : m_log(log)
+        , m_name(name)
+    {
+    }
+
+    virtual void complete(bool succeeded)
+    {
+        m_log.push_back(m_name + (succeeded ? ":ok" : ":failed"));
+    }
+
+private:
+    vector<string>& m_log;
+    string m_name;
+};
+
+/* Holds flushed groups instead of putting them, for the test to answer */
+class FakeStoreQueue : public DB8StoreQueue {
+public:
+    size_t getGroups() const
+    {
+        return m_groups.size();
+    }
+
+    size_t getGroupSize(size_t group) const
+    {
+        return m_groups[group].size();
+    }
+
+    void answer(size_t group, const vector<bool>& results)
+    {
+        ASSERT_EQ(m_groups[group].size(), results.size());
+
+        CommandList stores = m_groups[group];
+        for (size_t i = 0 ; i < stores.size() ; i++) {
+            complete(stores[i], results[i]);
+        }
+    }
+
+    void answerAll(size_t group, bool succeeded)
+    {
+        answer(group, vector<bool>(m_groups[group].size(), succeeded));
+    }
+
+protected:
+    virtual void issue(const CommandList& stores)
+    {
+        m_groups.push_back(stores);
+    }
+
+    vector<CommandList> m_groups;
+};
+
+/* Stands in for MojoDB: answers one put at a time, each after a fixed
+ * latency plus a cost per object, on the main loop */
+class FakeDB8StoreQueue : public DB8StoreQueue {
+public:
+    FakeDB8StoreQueue(unsigned int latencyMs, int64_t objectUs)
+        : m_latency(latencyMs)
+        , m_objectUs(objectUs)
+        , m_busy(false)
+    {
+    }
+
+protected:
+    virtual void issue(const CommandList& stores)
+    {
+        m_pending.push_back(stores);
+        next();
+    }
+
+    void next()
+    {
+        if (m_busy || m_pending.empty()) {
+            return;
+        }
+
+        m_busy = true;
+        g_timeout_add(m_latency, &FakeDB8StoreQueue::respond, this);
+    }
+
+    static gboolean respond(gpointer data)
+    {
+        FakeDB8StoreQueue *self = static_cast<FakeDB8StoreQueue *>(data);
+
+        CommandList stores = self->m_pending.front();
+        self->m_pending.pop_front();
+
+        int64_t until = g_get_monotonic_time() + self->m_objectUs * (int64_t) stores.size();
+        while (g_get_monotonic_time() < until);
+
+        self->m_busy = false;
+        for (size_t i = 0 ; i < stores.size() ; i++) {
+            complete(stores[i], true);
+        }
+        self->next();
+
+        return G_SOURCE_REMOVE;
+    }
+
+    unsigned int m_latency;
+    int64_t m_objectUs;
+    bool m_busy;
+    deque<CommandList> m_pending;
+};
+
+}
+
+class UnittestDB8StoreQueue : public testing::Test {
+protected:
+    UnittestDB8StoreQueue()
+        : queue(make_shared<FakeStoreQueue>())
+        , nextId(1)
+    {
+    }
+
+    virtual ~UnittestDB8StoreQueue()
+    {
+    }
+
+    virtual void TearDown()
+    {
+        while (g_main_context_iteration(NULL, FALSE));
+    }
+
+    shared_ptr<Activity> givenActivity()
+    {
+        return make_shared<Activity>(nextId++);
+    }
+
+    /* Chains a store as the service does: it's issued once it's first in
+     * its Activity's chain */
+    void whenStored(shared_ptr<DB8StoreQueue> storeQueue, shared_ptr<Activity> act,
+                    const string& name)
+    {
+        shared_ptr<AbstractPersistCommand> cmd = storeQueue->prepareCommand(
+                act, make_shared<RecordingCompletion>(log, name));
+
+        if (act->isPersistCommandHooked()) {
+            act->hookPersistCommand(cmd);
+            act->getHookedPersistCommand()->append(cmd);
+        } else {
+            act->hookPersistCommand(cmd);
+            cmd->persist();
+        }
+    }
+
+    void whenStored(shared_ptr<Activity> act, const string& name)
+    {
+        whenStored(queue, act, name);
+    }
+
+    MojInt64 getInfo(shared_ptr<DB8StoreQueue> storeQueue, const MojChar *key)
+    {
+        MojObject rep;
+        EXPECT_EQ(MojErrNone, storeQueue->infoToJson(rep));
+
+        MojObject info;
+        EXPECT_TRUE(rep.get(_T("storeQueue"), info));
+
+        MojInt64 value = -1;
+        EXPECT_TRUE(info.get(key, value));
+        return value;
+    }
+
+    shared_ptr<FakeStoreQueue> queue;
+    activityId_t nextId;
+    vector<string> log;
+};
+
+TEST_F(UnittestDB8StoreQueue, FlushesAFullBatchAtOnce)
+{
+    queue->setLimits(3, 1000);
+
+    whenStored(givenActivity(), "a");
+    whenStored(givenActivity(), "b");
+    EXPECT_EQ(0U, queue->getGroups());
+    EXPECT_EQ(2, getInfo(queue, _T("waiting")));
+
+    whenStored(givenActivity(), "c");
+    ASSERT_EQ(1U, queue->getGroups());
+    EXPECT_EQ(3U, queue->getGroupSize(0));
+    EXPECT_EQ(0, getInfo(queue, _T("waiting")));
+
+    /* The delay timer went with the flush */
+    EXPECT_FALSE(g_main_context_iteration(NULL, FALSE));
+    EXPECT_EQ(1U, queue->getGroups());
+}
+
+TEST_F(UnittestDB8StoreQueue, FlushesAfterTheDelay)
+{
+    queue->setLimits(32, 5);
+
+    int64_t begin = g_get_monotonic_time();
+    whenStored(givenActivity(), "a");
+    whenStored(givenActivity(), "b");
+    EXPECT_EQ(0U, queue->getGroups());
+
+    while (!queue->getGroups()) {
+        g_main_context_iteration(NULL, TRUE);
+    }
+    int64_t waited = g_get_monotonic_time() - begin;
+
+    EXPECT_EQ(2U, queue->getGroupSize(0));
+    EXPECT_GE(waited, 4000);
+    EXPECT_LT(waited, 1000000);
+}
+
+TEST_F(UnittestDB8StoreQueue, SetLimitsFlushesWhatNowFills)
+{
+    queue->setLimits(8, 1000);
+
+    whenStored(givenActivity(), "a");
+    whenStored(givenActivity(), "b");
+    whenStored(givenActivity(), "c");
+    EXPECT_EQ(0U, queue->getGroups());
+
+    queue->setLimits(2, 1000);
+    ASSERT_EQ(1U, queue->getGroups());
+    EXPECT_EQ(3U, queue->getGroupSize(0));
+
+    /* A batch size of 0 is taken as 1: every store is put on its own */
+    queue->setLimits(0, 1000);
+    EXPECT_EQ(1, getInfo(queue, _T("batchSize")));
+    whenStored(givenActivity(), "d");
+    ASSERT_EQ(2U, queue->getGroups());
+    EXPECT_EQ(1U, queue->getGroupSize(1));
+}
+
+TEST_F(UnittestDB8StoreQueue, CompletesEachStoreWithItsOwnResult)
+{
+    queue->setLimits(3, 1000);
+
+    whenStored(givenActivity(), "a");
+    whenStored(givenActivity(), "b");
+    whenStored(givenActivity(), "c");
+    ASSERT_EQ(1U, queue->getGroups());
+
+    queue->answer(0, { true, false, true });
+
+    ASSERT_EQ(3U, log.size());
+    EXPECT_EQ("a:ok", log[0]);
+    EXPECT_EQ("b:failed", log[1]);
+    EXPECT_EQ("c:ok", log[2]);
+
+    EXPECT_EQ(1, getInfo(queue, _T("calls")));
+    EXPECT_EQ(3, getInfo(queue, _T("stores")));
+    EXPECT_EQ(1, getInfo(queue, _T("failures")));
+}
+
+TEST_F(UnittestDB8StoreQueue, ActivityStoresStayInOrder)
+{
+    queue->setLimits(2, 1000);
+
+    shared_ptr<Activity> act = givenActivity();
+    whenStored(act, "first");
+    whenStored(act, "second");
+    whenStored(givenActivity(), "other");
+
+    /* The second store waits its turn behind the first */
+    ASSERT_EQ(1U, queue->getGroups());
+    EXPECT_EQ(2U, queue->getGroupSize(0));
+
+    queue->answerAll(0, true);
+    EXPECT_EQ(2U, log.size());
+
+    queue->flush();
+    ASSERT_EQ(2U, queue->getGroups());
+    EXPECT_EQ(1U, queue->getGroupSize(1));
+
+    queue->answerAll(1, true);
+    ASSERT_EQ(3U, log.size());
+    EXPECT_EQ("first:ok", log[0]);
+    EXPECT_EQ("other:ok", log[1]);
+    EXPECT_EQ("second:ok", log[2]);
+    EXPECT_FALSE(act->isPersistCommandHooked());
+}
+
+/* Time for a burst of Activities to each store once, putting each store on
+ * its own against grouping them */
+TEST_F(UnittestDB8StoreQueue, BurstBenchmark)
+{
+    const size_t kActivities = 500;
+    const unsigned int kLatencyMs = 2;
+    const int64_t kObjectUs = 20;
+
+    struct Run {
+        size_t batchSize;
+        unsigned int delay;
+        int64_t elapsedUs;
+        MojInt64 calls;
+        MojInt64 p99Us;
+    } runs[] = {
+        { 1, 0, 0, 0, 0 },
+        { 32, 5, 0, 0, 0 }
+    };
+
+    for (Run& run : runs) {
+        shared_ptr<FakeDB8StoreQueue> db = make_shared<FakeDB8StoreQueue>(kLatencyMs, kObjectUs);
+        db->setLimits(run.batchSize, run.delay);
+
+        vector<shared_ptr<Activity> > acts;
+        for (size_t i = 0 ; i < kActivities ; i++) {
+            acts.push_back(givenActivity());
+        }
+
+        log.clear();
+        int64_t begin = g_get_monotonic_time();
+        for (size_t i = 0 ; i < kActivities ; i++) {
+            whenStored(db, acts[i], "store");
+        }
+        while (log.size() < kActivities) {
+            g_main_context_iteration(NULL, TRUE);
+        }
+        run.elapsedUs = g_get_monotonic_time() - begin;
+
+        run.calls = getInfo(db, _T("calls"));
+        run.p99Us = getInfo(db, _T("commitP99Us"));
+
+        cout << "Burst of " << kActivities << " stores, batch " << run.batchSize
+             << " / " << run.delay << " ms: " << run.elapsedUs / 1000 << " ms, "
+             << run.calls << " calls, commit p99 " << run.p99Us << " us" << endl;
+    }
+
+    EXPECT_EQ((MojInt64) kActivities, runs[0].calls);
+    EXPECT_LE(runs[1].calls, (MojInt64) (kActivities / 32 + 1));
+    EXPECT_LT(runs[1].elapsedUs, runs[0].elapsedUs);
+    EXPECT_LT(runs[1].p99Us, runs[0].p99Us);
+}
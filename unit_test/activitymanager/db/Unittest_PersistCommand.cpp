@@ -0,0 +1,162 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "db/AbstractPersistCommand.h"
+#include "activity/Activity.h"
+
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+namespace {
+
+class RecordingCompletion : public ICompletion {
+public:
+    RecordingCompletion(vector<string>& log, const string& name)
+        : m_log(log)
+        , m_name(name)
+    {
+    }
+
+    virtual void complete(bool succeeded)
+    {
+        m_log.push_back(m_name + (succeeded ? ":ok" : ":failed"));
+    }
+
+private:
+    vector<string>& m_log;
+    string m_name;
+};
+
+class FakeCommand : public AbstractPersistCommand {
+public:
+    FakeCommand(shared_ptr<Activity> activity, shared_ptr<ICompletion> completion, bool store)
+        : AbstractPersistCommand(activity, completion)
+        , m_store(store)
+    {
+    }
+
+    virtual void persist()
+    {
+        m_issued = true;
+    }
+
+    void finish(bool success)
+    {
+        complete(success);
+    }
+
+protected:
+    virtual string getMethod() const { return "Fake"; }
+    virtual bool isStore() const { return m_store; }
+
+    bool m_store;
+};
+
+}
+
+class UnittestPersistCommand : public testing::Test {
+protected:
+    UnittestPersistCommand()
+        : act(make_shared<Activity>(1))
+    {
+    }
+
+    virtual ~UnittestPersistCommand()
+    {
+    }
+
+    shared_ptr<FakeCommand> givenHooked(const string& name, bool store = true)
+    {
+        shared_ptr<FakeCommand> cmd = make_shared<FakeCommand>(act, completion(name), store);
+        act->hookPersistCommand(cmd);
+        return cmd;
+    }
+
+    shared_ptr<ICompletion> completion(const string& name)
+    {
+        return make_shared<RecordingCompletion>(log, name);
+    }
+
+    shared_ptr<Activity> act;
+    vector<string> log;
+};
+
+TEST_F(UnittestPersistCommand, WaitingStoreAbsorbsLaterStores)
+{
+    shared_ptr<FakeCommand> cmd = givenHooked("first");
+
+    EXPECT_TRUE(cmd->absorb(completion("second")));
+    EXPECT_TRUE(cmd->absorb(completion("third")));
+
+    cmd->persist();
+    cmd->finish(true);
+
+    ASSERT_EQ(3U, log.size());
+    EXPECT_EQ("first:ok", log[0]);
+    EXPECT_EQ("second:ok", log[1]);
+    EXPECT_EQ("third:ok", log[2]);
+    EXPECT_FALSE(act->isPersistCommandHooked());
+}
+
+TEST_F(UnittestPersistCommand, AbsorbedShareFailure)
+{
+    shared_ptr<FakeCommand> cmd = givenHooked("first");
+
+    EXPECT_TRUE(cmd->absorb(completion("second")));
+
+    cmd->persist();
+    cmd->finish(false);
+
+    ASSERT_EQ(2U, log.size());
+    EXPECT_EQ("second:failed", log[1]);
+}
+
+TEST_F(UnittestPersistCommand, IssuedStoreDoesNotAbsorb)
+{
+    shared_ptr<FakeCommand> cmd = givenHooked("first");
+
+    cmd->persist();
+    EXPECT_FALSE(cmd->absorb(completion("second")));
+
+    cmd->finish(true);
+    EXPECT_EQ(1U, log.size());
+}
+
+TEST_F(UnittestPersistCommand, OnlyStoresAbsorb)
+{
+    shared_ptr<FakeCommand> cmd = givenHooked("delete", false);
+
+    EXPECT_FALSE(cmd->absorb(completion("store")));
+
+    cmd->finish(true);
+}
+
+TEST_F(UnittestPersistCommand, ChainedStoreDoesNotAbsorb)
+{
+    shared_ptr<FakeCommand> first = givenHooked("first");
+    shared_ptr<FakeCommand> second = givenHooked("second", false);
+    first->append(second);
+
+    EXPECT_FALSE(first->absorb(completion("third")));
+
+    first->finish(true);
+    second->finish(true);
+}
@@ -0,0 +1,215 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include <iostream>
+#include <string>
+
+#include <gtest/gtest.h>
+#include <pbnjson.hpp>
+
+#include "db/PersistTokenDB.h"
+#include "util/MojoObjectJson.h"
+
+using namespace pbnjson;
+using namespace std;
+
+class UnittestPersistDelta : public testing::Test {
+protected:
+    UnittestPersistDelta()
+    {
+    }
+
+    virtual ~UnittestPersistDelta()
+    {
+    }
+
+    /* What a stored, scheduled Activity looks like, less the reserved
+     * properties */
+    MojObject makeRep(const string& lastFinished)
+    {
+        JValue rep = JDomParser::fromString(
+                "{ \"name\": \"syncMail\","
+                "  \"description\": \"Periodic mail sync for the primary account\","
+                "  \"creator\": { \"serviceId\": \"com.example.mail\" },"
+                "  \"type\": { \"background\": true, \"persist\": true, \"explicit\": true },"
+                "  \"requirements\": { \"internet\": true, \"charging\": false },"
+                "  \"trigger\": { \"method\": \"luna://com.example.mail/watch\","
+                "                 \"params\": { \"folder\": \"inbox\" }, \"where\": {"
+                "                 \"prop\": \"changed\", \"op\": \"=\", \"val\": true } },"
+                "  \"callback\": { \"method\": \"luna://com.example.mail/sync\","
+                "                  \"params\": { \"account\": \"primary\", \"full\": false } },"
+                "  \"schedule\": { \"interval\": \"15m\", \"precise\": false,"
+                "                  \"lastFinished\": \"" + lastFinished + "\" } }");
+
+        return MojoObjectJson::convertJValueToMojObj(rep);
+    }
+
+    size_t putBytes(const PersistTokenDB& pt, const MojObject& rep)
+    {
+        MojObject full = rep;
+        EXPECT_EQ(MojErrNone, pt.toJson(full));
+        EXPECT_EQ(MojErrNone, full.putString(_T("_kind"), "com.webos.service.activity:1"));
+        return MojoObjectJson(full).str().size();
+    }
+
+    PersistTokenDB makeToken()
+    {
+        MojString id;
+        id.assign("++HxsB4GTxrkCyVX");
+        return PersistTokenDB(id, 42);
+    }
+};
+
+TEST_F(UnittestPersistDelta, NoDeltaUntilWritten)
+{
+    PersistTokenDB unstored;
+    MojObject delta;
+    EXPECT_FALSE(unstored.getDelta(makeRep("2024-01-01 10:00:00"), delta));
+
+    PersistTokenDB pt = makeToken();
+    EXPECT_FALSE(pt.getDelta(makeRep("2024-01-01 10:00:00"), delta));
+}
+
+TEST_F(UnittestPersistDelta, DeltaHoldsOnlyChangedProperties)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    MojObject delta;
+    ASSERT_TRUE(pt.getDelta(makeRep("2024-01-01 10:15:00"), delta));
+
+    EXPECT_TRUE(delta.contains(_T("_id")));
+    EXPECT_TRUE(delta.contains(_T("_rev")));
+    EXPECT_TRUE(delta.contains(_T("schedule")));
+    EXPECT_FALSE(delta.contains(_T("_kind")));
+    EXPECT_FALSE(delta.contains(_T("callback")));
+    EXPECT_FALSE(delta.contains(_T("trigger")));
+    EXPECT_EQ(3U, delta.size());
+}
+
+TEST_F(UnittestPersistDelta, UnchangedStoreSendsOnlyToken)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    MojObject delta;
+    ASSERT_TRUE(pt.getDelta(makeRep("2024-01-01 10:00:00"), delta));
+    EXPECT_EQ(2U, delta.size());
+}
+
+TEST_F(UnittestPersistDelta, DroppedPropertyNeedsPut)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    MojObject rep = makeRep("2024-01-01 10:15:00");
+    bool found = false;
+    EXPECT_EQ(MojErrNone, rep.del(_T("requirements"), found));
+    EXPECT_TRUE(found);
+
+    MojObject delta;
+    EXPECT_FALSE(pt.getDelta(rep, delta));
+}
+
+TEST_F(UnittestPersistDelta, DroppedNestedPropertyNeedsPut)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    /* A merge would keep the stored requirements.charging */
+    MojObject rep = makeRep("2024-01-01 10:00:00");
+    MojObject requirements;
+    ASSERT_TRUE(rep.get(_T("requirements"), requirements));
+    bool found = false;
+    EXPECT_EQ(MojErrNone, requirements.del(_T("charging"), found));
+    EXPECT_TRUE(found);
+    EXPECT_EQ(MojErrNone, rep.put(_T("requirements"), requirements));
+
+    MojObject delta;
+    EXPECT_FALSE(pt.getDelta(rep, delta));
+}
+
+TEST_F(UnittestPersistDelta, NestedDeltaHoldsOnlyChangedProperties)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    MojObject delta;
+    ASSERT_TRUE(pt.getDelta(makeRep("2024-01-01 10:15:00"), delta));
+
+    MojObject schedule;
+    ASSERT_TRUE(delta.get(_T("schedule"), schedule));
+    EXPECT_TRUE(schedule.contains(_T("lastFinished")));
+    EXPECT_EQ(1U, schedule.size());
+}
+
+TEST_F(UnittestPersistDelta, AddedNestedPropertyIsMerged)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    MojObject rep = makeRep("2024-01-01 10:00:00");
+    MojObject requirements;
+    ASSERT_TRUE(rep.get(_T("requirements"), requirements));
+    EXPECT_EQ(MojErrNone, requirements.putBool(_T("wifi"), true));
+    EXPECT_EQ(MojErrNone, rep.put(_T("requirements"), requirements));
+
+    MojObject delta;
+    ASSERT_TRUE(pt.getDelta(rep, delta));
+    EXPECT_EQ(3U, delta.size());
+
+    MojObject merged;
+    ASSERT_TRUE(delta.get(_T("requirements"), merged));
+    EXPECT_TRUE(merged.contains(_T("wifi")));
+    EXPECT_EQ(1U, merged.size());
+}
+
+TEST_F(UnittestPersistDelta, NewIdForgetsWritten)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    MojString id;
+    id.assign("++HxsC0aaaaaaaaa");
+    pt.set(id, 50);
+
+    MojObject delta;
+    EXPECT_FALSE(pt.getDelta(makeRep("2024-01-01 10:15:00"), delta));
+
+    pt.setWritten(makeRep("2024-01-01 10:15:00"));
+    pt.clear();
+    EXPECT_FALSE(pt.getDelta(makeRep("2024-01-01 10:15:00"), delta));
+}
+
+TEST_F(UnittestPersistDelta, BytesWrittenPerCompletion)
+{
+    PersistTokenDB pt = makeToken();
+    pt.setWritten(makeRep("2024-01-01 10:00:00"));
+
+    /* A completion updates the schedule's lastFinished and nothing else */
+    MojObject rep = makeRep("2024-01-01 10:15:00");
+
+    MojObject delta;
+    ASSERT_TRUE(pt.getDelta(rep, delta));
+
+    size_t put = putBytes(pt, rep);
+    size_t merge = MojoObjectJson(delta).str().size();
+
+    cout << "Bytes written per completion: put " << put << ", merge " << merge << endl;
+
+    EXPECT_LT(merge * 2, put);
+}
@@ -0,0 +1,272 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include "activity/ActivityManager.h"
+#include "service/ActivityCategoryHandler.h"
+#include "service/BatchReply.h"
+
+using namespace std;
+
+namespace {
+
+/* Keeps the results instead of replying */
+class FakeBatchReply : public BatchReply {
+public:
+    FakeBatchReply(size_t count)
+        : BatchReply(NULL, count)
+        , m_replied(false)
+    {
+    }
+
+    bool isReplied() const
+    {
+        return m_replied;
+    }
+
+    MojObject getResult(size_t index) const
+    {
+        MojObject result;
+        MojObject::ConstArrayIterator iter = m_sent.arrayBegin();
+        for (size_t i = 0 ; (iter != m_sent.arrayEnd()) && (i < index) ; i++) {
+            ++iter;
+        }
+        if (iter != m_sent.arrayEnd()) {
+            result = *iter;
+        }
+        return result;
+    }
+
+protected:
+    virtual void sendReply(const MojObject& results)
+    {
+        m_sent = results;
+        m_replied = true;
+    }
+
+    MojObject m_sent;
+    bool m_replied;
+};
+
+/* Exposes the batch items' completions, as their stores finish */
+class FakeCategoryHandler : public ActivityCategoryHandler {
+public:
+    FakeCategoryHandler()
+        : ActivityCategoryHandler(nullptr)
+    {
+    }
+
+    void whenCreateStored(shared_ptr<BatchReply> batch, size_t index,
+                          shared_ptr<Activity> act, bool succeeded)
+    {
+        MojObject item;
+        finishCreateBatchItem(batch, index, item, act, succeeded);
+    }
+
+    void whenCompleteStored(shared_ptr<BatchReply> batch, size_t index,
+                            shared_ptr<Activity> act, bool restart)
+    {
+        MojObject item;
+        EXPECT_EQ(MojErrNone, item.putBool(_T("restart"), restart));
+        finishCompleteBatchItem(batch, index, item, act, true);
+    }
+
+    void whenCancelDeleted(shared_ptr<BatchReply> batch, size_t index,
+                           shared_ptr<Activity> act)
+    {
+        MojObject item;
+        finishCancelBatchItem(batch, index, item, act, true);
+    }
+};
+
+}
+
+class UnittestActivityCategoryHandler : public testing::Test {
+protected:
+    UnittestActivityCategoryHandler()
+        : handler(new FakeCategoryHandler())
+        , creator("com.example.mail", BusService)
+    {
+    }
+
+    virtual ~UnittestActivityCategoryHandler()
+    {
+        for (size_t i = 0 ; i < registered.size() ; i++) {
+            if (isRegistered(registered[i])) {
+                ActivityManager::getInstance().releaseActivity(registered[i]);
+            }
+        }
+    }
+
+    /* Created in a batch, and registered while its store is under way */
+    shared_ptr<Activity> givenCreated(activityId_t activityId, const string& name)
+    {
+        shared_ptr<Activity> act =
+                ActivityManager::getInstance().getNewActivity(activityId, false);
+        act->setName(name);
+        act->setCreator(creator);
+
+        ActivityManager::getInstance().registerActivityId(act);
+        ActivityManager::getInstance().registerActivityName(act);
+        registered.push_back(act);
+        return act;
+    }
+
+    bool isRegistered(shared_ptr<Activity> act)
+    {
+        try {
+            return ActivityManager::getInstance().getActivity(act->getId()) == act;
+        } catch (const std::runtime_error&) {
+            return false;
+        }
+    }
+
+    bool isLive(shared_ptr<Activity> act)
+    {
+        return ActivityManager::getInstance().hasActivity(act->getName(), creator) &&
+                (ActivityManager::getInstance().getActivity(act->getName(), creator) == act);
+    }
+
+    bool getReturnValue(const MojObject& result)
+    {
+        bool returnValue = false;
+        EXPECT_TRUE(result.get(MojServiceMessage::ReturnValueKey, returnValue));
+        return returnValue;
+    }
+
+    MojInt64 getInt(const MojObject& result, const MojChar *key)
+    {
+        MojInt64 value = -1;
+        EXPECT_TRUE(result.get(key, value));
+        return value;
+    }
+
+    MojRefCountedPtr<FakeCategoryHandler> handler;
+    BusId creator;
+    vector<shared_ptr<Activity>> registered;
+};
+
+TEST_F(UnittestActivityCategoryHandler, RepliesOnceEveryItemHasAResult)
+{
+    shared_ptr<FakeBatchReply> batch = make_shared<FakeBatchReply>(3);
+
+    batch->succeed(2, 1203);
+    batch->fail(0, MojErrInvalidArg, "Bad item");
+    EXPECT_FALSE(batch->isReplied());
+
+    /* Only the first result for an item counts */
+    batch->fail(2, MojErrInternal, "Too late");
+    EXPECT_FALSE(batch->isReplied());
+
+    batch->succeed(1, 1202);
+    ASSERT_TRUE(batch->isReplied());
+
+    EXPECT_FALSE(getReturnValue(batch->getResult(0)));
+    EXPECT_EQ(MojErrInvalidArg, getInt(batch->getResult(0), _T("errorCode")));
+    EXPECT_TRUE(getReturnValue(batch->getResult(1)));
+    EXPECT_EQ(1202, getInt(batch->getResult(1), _T("activityId")));
+    EXPECT_TRUE(getReturnValue(batch->getResult(2)));
+    EXPECT_EQ(1203, getInt(batch->getResult(2), _T("activityId")));
+}
+
+TEST_F(UnittestActivityCategoryHandler, StoredCreateSucceeds)
+{
+    shared_ptr<FakeBatchReply> batch = make_shared<FakeBatchReply>(1);
+    shared_ptr<Activity> act = givenCreated(1211, "sync");
+
+    handler->whenCreateStored(batch, 0, act, true);
+
+    ASSERT_TRUE(batch->isReplied());
+    EXPECT_TRUE(getReturnValue(batch->getResult(0)));
+    EXPECT_EQ(1211, getInt(batch->getResult(0), _T("activityId")));
+    EXPECT_TRUE(isLive(act));
+}
+
+TEST_F(UnittestActivityCategoryHandler, FailedCreateIsEnded)
+{
+    shared_ptr<FakeBatchReply> batch = make_shared<FakeBatchReply>(2);
+    shared_ptr<Activity> failed = givenCreated(1221, "sync");
+    shared_ptr<Activity> stored = givenCreated(1222, "backup");
+
+    handler->whenCreateStored(batch, 0, failed, false);
+    handler->whenCreateStored(batch, 1, stored, true);
+
+    ASSERT_TRUE(batch->isReplied());
+    EXPECT_FALSE(getReturnValue(batch->getResult(0)));
+    EXPECT_EQ(MojErrInternal, getInt(batch->getResult(0), _T("errorCode")));
+    EXPECT_FALSE(batch->getResult(0).contains(_T("replacedActivityId")));
+    EXPECT_TRUE(getReturnValue(batch->getResult(1)));
+
+    /* Not left holding its name, so it can be created again */
+    EXPECT_FALSE(failed->isNameRegistered());
+    EXPECT_FALSE(ActivityManager::getInstance().hasActivity("sync", creator));
+    EXPECT_TRUE(isLive(stored));
+
+    shared_ptr<Activity> again = givenCreated(1223, "sync");
+    EXPECT_TRUE(isLive(again));
+}
+
+TEST_F(UnittestActivityCategoryHandler, FailedCreateReportsTheActivityItReplaced)
+{
+    shared_ptr<FakeBatchReply> batch = make_shared<FakeBatchReply>(2);
+    shared_ptr<Activity> failed = givenCreated(1231, "sync");
+    shared_ptr<Activity> stored = givenCreated(1232, "backup");
+    batch->setReplaced(0, 1230);
+    batch->setReplaced(1, 1229);
+
+    handler->whenCreateStored(batch, 0, failed, false);
+    handler->whenCreateStored(batch, 1, stored, true);
+
+    ASSERT_TRUE(batch->isReplied());
+    EXPECT_EQ(1230, getInt(batch->getResult(0), _T("replacedActivityId")));
+
+    /* The one that stood replaced its Activity as asked */
+    EXPECT_FALSE(batch->getResult(1).contains(_T("replacedActivityId")));
+}
+
+TEST_F(UnittestActivityCategoryHandler, CompletedItemsGiveUpTheirNamesUnlessRestarted)
+{
+    shared_ptr<FakeBatchReply> batch = make_shared<FakeBatchReply>(2);
+    shared_ptr<Activity> done = givenCreated(1241, "sync");
+    shared_ptr<Activity> restarted = givenCreated(1242, "backup");
+
+    handler->whenCompleteStored(batch, 0, done, false);
+    handler->whenCompleteStored(batch, 1, restarted, true);
+
+    ASSERT_TRUE(batch->isReplied());
+    EXPECT_TRUE(getReturnValue(batch->getResult(0)));
+    EXPECT_TRUE(getReturnValue(batch->getResult(1)));
+    EXPECT_FALSE(done->isNameRegistered());
+    EXPECT_TRUE(isLive(restarted));
+}
+
+TEST_F(UnittestActivityCategoryHandler, CancelledItemsGiveUpTheirNames)
+{
+    shared_ptr<FakeBatchReply> batch = make_shared<FakeBatchReply>(1);
+    shared_ptr<Activity> act = givenCreated(1251, "sync");
+
+    handler->whenCancelDeleted(batch, 0, act);
+
+    ASSERT_TRUE(batch->isReplied());
+    EXPECT_EQ(1251, getInt(batch->getResult(0), _T("activityId")));
+    EXPECT_FALSE(act->isNameRegistered());
+}
@@ -0,0 +1,149 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "service/DuplicateNames.h"
+
+#include <set>
+#include <string>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestDuplicateNames : public testing::Test {
+protected:
+    UnittestDuplicateNames()
+        : caller("com.app", BusApp)
+        , lookups(0)
+        , duplicates([this](const string& name, const BusId& creator) {
+              lookups++;
+              return taken.count(make_pair(name, creator.getString())) > 0;
+          })
+    {
+    }
+
+    virtual ~UnittestDuplicateNames()
+    {
+    }
+
+    void givenTaken(const string& name, const BusId& creator)
+    {
+        taken.insert(make_pair(name, creator.getString()));
+    }
+
+    bool whenCreated(const string& name, bool replace = false, bool withCreator = false)
+    {
+        MojObject request;
+        MojObject spec;
+
+        EXPECT_EQ(MojErrNone, spec.putString(_T("name"), name.c_str()));
+        if (withCreator) {
+            MojObject creator;
+            EXPECT_EQ(MojErrNone, creator.putString(_T("serviceId"), "com.other"));
+            EXPECT_EQ(MojErrNone, spec.put(_T("creator"), creator));
+        }
+        if (replace) {
+            EXPECT_EQ(MojErrNone, request.putBool(_T("replace"), true));
+        }
+        EXPECT_EQ(MojErrNone, request.put(_T("activity"), spec));
+
+        return duplicates.isTaken(request, spec, caller);
+    }
+
+    BusId caller;
+    set<pair<string, string> > taken;
+    unsigned lookups;
+    DuplicateNames duplicates;
+};
+
+TEST_F(UnittestDuplicateNames, RefusesNameTheCallerUses)
+{
+    givenTaken("sync", caller);
+
+    EXPECT_TRUE(whenCreated("sync"));
+    EXPECT_TRUE(whenCreated("sync"));
+    EXPECT_EQ(2UL, duplicates.getEarly());
+    EXPECT_EQ(0UL, duplicates.getLate());
+}
+
+TEST_F(UnittestDuplicateNames, NameIsPerCreator)
+{
+    givenTaken("sync", BusId("com.other", BusApp));
+
+    EXPECT_FALSE(whenCreated("sync"));
+    EXPECT_FALSE(whenCreated("backup"));
+    EXPECT_EQ(0UL, duplicates.getEarly());
+}
+
+TEST_F(UnittestDuplicateNames, ReplaceIsNeverRefused)
+{
+    givenTaken("sync", caller);
+
+    EXPECT_FALSE(whenCreated("sync", true));
+    EXPECT_EQ(0U, lookups);
+    EXPECT_EQ(0UL, duplicates.getEarly());
+}
+
+TEST_F(UnittestDuplicateNames, ExplicitCreatorIsLeftToTheLateCheck)
+{
+    givenTaken("sync", caller);
+
+    /* The creator named isn't the caller; only the full path resolves it */
+    EXPECT_FALSE(whenCreated("sync", false, true));
+    EXPECT_EQ(0U, lookups);
+
+    duplicates.recordLate();
+    EXPECT_EQ(0UL, duplicates.getEarly());
+    EXPECT_EQ(1UL, duplicates.getLate());
+}
+
+TEST_F(UnittestDuplicateNames, UnnamedIsLeftToTheFullPath)
+{
+    MojObject request;
+    MojObject spec;
+    EXPECT_EQ(MojErrNone, spec.putString(_T("description"), "no name"));
+
+    EXPECT_FALSE(duplicates.isTaken(request, spec, caller));
+
+    /* Malformed: reported by the parser, not here */
+    EXPECT_EQ(MojErrNone, spec.putInt(_T("name"), 7));
+    EXPECT_FALSE(duplicates.isTaken(request, spec, caller));
+
+    EXPECT_EQ(0UL, duplicates.getEarly());
+}
+
+TEST_F(UnittestDuplicateNames, ReportsBothCounters)
+{
+    givenTaken("sync", caller);
+    EXPECT_TRUE(whenCreated("sync"));
+    duplicates.recordLate();
+    duplicates.recordLate();
+
+    MojObject rep;
+    EXPECT_EQ(MojErrNone, duplicates.infoToJson(rep));
+
+    MojObject counts;
+    ASSERT_TRUE(rep.get(_T("duplicateNames"), counts));
+
+    MojInt64 early = 0;
+    MojInt64 late = 0;
+    EXPECT_TRUE(counts.get(_T("early"), early));
+    EXPECT_TRUE(counts.get(_T("late"), late));
+    EXPECT_EQ(1, early);
+    EXPECT_EQ(2, late);
+}
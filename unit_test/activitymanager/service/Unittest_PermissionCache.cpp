@@ -0,0 +1,133 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "service/PermissionCache.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestPermissionCache : public testing::Test {
+protected:
+    UnittestPermissionCache()
+    {
+    }
+
+    virtual ~UnittestPermissionCache()
+    {
+    }
+
+    bool whenLookup(PermissionCache& cache, const string& requester, const string& url,
+                    int64_t now, bool& allowed)
+    {
+        allowed = false;
+        return cache.lookup(requester, url, now, allowed);
+    }
+};
+
+TEST_F(UnittestPermissionCache, RemembersDecisions)
+{
+    PermissionCache cache(4, 100);
+    bool allowed;
+
+    EXPECT_FALSE(whenLookup(cache, "com.app", "luna://com.a/m", 0, allowed));
+
+    cache.store("com.app", "luna://com.a/m", true, 0);
+    cache.store("com.app", "luna://com.b/m", false, 0);
+
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.a/m", 10, allowed));
+    EXPECT_TRUE(allowed);
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.b/m", 10, allowed));
+    EXPECT_FALSE(allowed);
+
+    /* Keyed by requester too */
+    EXPECT_FALSE(whenLookup(cache, "com.other", "luna://com.a/m", 10, allowed));
+
+    EXPECT_EQ(2UL, cache.getHits());
+    EXPECT_EQ(2UL, cache.getMisses());
+}
+
+TEST_F(UnittestPermissionCache, DecisionsExpire)
+{
+    PermissionCache cache(4, 100);
+    bool allowed;
+
+    cache.store("com.app", "luna://com.a/m", true, 0);
+
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.a/m", 99, allowed));
+    EXPECT_FALSE(whenLookup(cache, "com.app", "luna://com.a/m", 100, allowed));
+    EXPECT_EQ(0U, cache.size());
+
+    /* Storing again starts a fresh lifetime */
+    cache.store("com.app", "luna://com.a/m", true, 100);
+    cache.store("com.app", "luna://com.a/m", true, 150);
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.a/m", 220, allowed));
+    EXPECT_EQ(1U, cache.size());
+}
+
+TEST_F(UnittestPermissionCache, EvictsLeastRecentlyUsed)
+{
+    PermissionCache cache(2, 100);
+    bool allowed;
+
+    cache.store("com.app", "luna://com.a/m", true, 0);
+    cache.store("com.app", "luna://com.b/m", true, 0);
+
+    /* Using 'a' leaves 'b' the oldest */
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.a/m", 1, allowed));
+    cache.store("com.app", "luna://com.c/m", true, 1);
+
+    EXPECT_EQ(2U, cache.size());
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.a/m", 2, allowed));
+    EXPECT_FALSE(whenLookup(cache, "com.app", "luna://com.b/m", 2, allowed));
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.c/m", 2, allowed));
+}
+
+TEST_F(UnittestPermissionCache, ClearKeepsCounters)
+{
+    PermissionCache cache(4, 100);
+    bool allowed;
+
+    cache.store("com.app", "luna://com.a/m", true, 0);
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.a/m", 1, allowed));
+
+    cache.clear();
+
+    EXPECT_EQ(0U, cache.size());
+    EXPECT_FALSE(whenLookup(cache, "com.app", "luna://com.a/m", 1, allowed));
+    EXPECT_EQ(1UL, cache.getHits());
+    EXPECT_EQ(1UL, cache.getMisses());
+}
+
+TEST_F(UnittestPermissionCache, ShrinkingAndDisabling)
+{
+    PermissionCache cache(3, 100);
+    bool allowed;
+
+    cache.store("com.app", "luna://com.a/m", true, 0);
+    cache.store("com.app", "luna://com.b/m", true, 0);
+    cache.store("com.app", "luna://com.c/m", true, 0);
+
+    cache.setLimits(1, 100);
+    EXPECT_EQ(1U, cache.size());
+    EXPECT_TRUE(whenLookup(cache, "com.app", "luna://com.c/m", 1, allowed));
+
+    cache.setLimits(0, 100);
+    cache.store("com.app", "luna://com.d/m", true, 1);
+    EXPECT_EQ(0U, cache.size());
+    EXPECT_FALSE(whenLookup(cache, "com.app", "luna://com.d/m", 1, allowed));
+}
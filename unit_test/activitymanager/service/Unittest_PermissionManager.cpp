@@ -0,0 +1,324 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+#include "service/PermissionManager.h"
+#include "conf/Config.h"
+
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+using namespace std;
+
+namespace {
+
+const MojErr kUnanswered = (MojErr) -1;
+
+/* Holds isCallAllowed calls instead of making them, for the test to answer */
+class FakePermissionManager : public PermissionManager {
+public:
+    size_t getIssued() const
+    {
+        return m_checks.size();
+    }
+
+    const string& getUrl(size_t index) const
+    {
+        return m_checks[index]->getUrl();
+    }
+
+    void answer(size_t index, bool allowed)
+    {
+        MojObject response;
+        EXPECT_EQ(MojErrNone, response.putBool(_T("returnValue"), true));
+        EXPECT_EQ(MojErrNone, response.putBool(_T("allowed"), allowed));
+        m_checks[index]->answer(response, MojErrNone);
+    }
+
+    void fail(size_t index)
+    {
+        m_checks[index]->answer(MojObject(), MojErrLuna);
+    }
+
+    void timeOut(size_t index)
+    {
+        m_checks[index]->handleTimeout();
+    }
+
+    MojInt64 getCount(const char *counter) const
+    {
+        MojObject rep;
+        MojObject permissions;
+        MojInt64 count = -1;
+        EXPECT_EQ(MojErrNone, infoToJson(rep));
+        EXPECT_TRUE(rep.get(_T("permissions"), permissions));
+        EXPECT_TRUE(permissions.get(counter, count));
+        return count;
+    }
+
+protected:
+    virtual MojErr issueCheck(shared_ptr<Check> check, const MojObject& params,
+                              shared_ptr<LunaCall>& call)
+    {
+        m_checks.push_back(check);
+        return MojErrNone;
+    }
+
+    vector<shared_ptr<Check> > m_checks;
+};
+
+}
+
+class UnittestPermissionManager : public testing::Test {
+protected:
+    UnittestPermissionManager()
+        : pm(make_shared<FakePermissionManager>())
+    {
+    }
+
+    virtual ~UnittestPermissionManager()
+    {
+    }
+
+    virtual void TearDown()
+    {
+        pm.reset();
+        while (g_main_context_iteration(NULL, FALSE));
+    }
+
+    /* Returns where the request's answer will be recorded */
+    size_t whenChecked(const string& requester, const vector<string>& urls)
+    {
+        size_t index = results.size();
+        results.push_back(kUnanswered);
+        messages.push_back(string());
+
+        pm->checkAccessRight(requester, urls, [this, index](MojErr err, string message) -> MojErr {
+            EXPECT_EQ(kUnanswered, results[index]) << "Answered twice";
+            results[index] = err;
+            messages[index] = message;
+            return MojErrNone;
+        });
+
+        return index;
+    }
+
+    void runMainLoop()
+    {
+        while (g_main_context_iteration(NULL, FALSE));
+    }
+
+    shared_ptr<FakePermissionManager> pm;
+    vector<MojErr> results;
+    vector<string> messages;
+};
+
+TEST_F(UnittestPermissionManager, AnswersFromTheMainLoop)
+{
+    /* Nothing to check, but the caller still isn't answered re-entrantly */
+    size_t request = whenChecked("com.app", vector<string>());
+    EXPECT_EQ(kUnanswered, results[request]);
+
+    runMainLoop();
+    EXPECT_EQ(MojErrNone, results[request]);
+    EXPECT_EQ(0U, pm->getIssued());
+}
+
+TEST_F(UnittestPermissionManager, ChecksUrlsInParallel)
+{
+    size_t request = whenChecked("com.app",
+            { "luna://com.a/m", "luna://com.b/m", "luna://com.a/m" });
+    runMainLoop();
+
+    /* Each distinct URL once, all at the same time */
+    ASSERT_EQ(2U, pm->getIssued());
+    EXPECT_EQ("luna://com.a/m", pm->getUrl(0));
+    EXPECT_EQ("luna://com.b/m", pm->getUrl(1));
+
+    pm->answer(1, true);
+    EXPECT_EQ(kUnanswered, results[request]);
+
+    pm->answer(0, true);
+    EXPECT_EQ(MojErrNone, results[request]);
+}
+
+TEST_F(UnittestPermissionManager, FirstDenialAnswers)
+{
+    size_t request = whenChecked("com.app", { "luna://com.a/m", "luna://com.b/m" });
+    runMainLoop();
+    ASSERT_EQ(2U, pm->getIssued());
+
+    pm->answer(1, false);
+    EXPECT_EQ(MojErrAccessDenied, results[request]);
+
+    /* The other check is no longer waited on */
+    pm->answer(0, true);
+    EXPECT_EQ(MojErrAccessDenied, results[request]);
+}
+
+TEST_F(UnittestPermissionManager, FailureToCheckDenies)
+{
+    size_t request = whenChecked("com.app", { "luna://com.a/m" });
+    runMainLoop();
+    ASSERT_EQ(1U, pm->getIssued());
+
+    pm->fail(0);
+    EXPECT_NE(MojErrNone, results[request]);
+    EXPECT_NE(kUnanswered, results[request]);
+
+    /* Failures aren't remembered, so the URL is asked about again */
+    whenChecked("com.app", { "luna://com.a/m" });
+    runMainLoop();
+    EXPECT_EQ(2U, pm->getIssued());
+}
+
+TEST_F(UnittestPermissionManager, BoundsChecksInFlight)
+{
+    unsigned maxInFlight = Config::getInstance().getPermissionMaxInFlight();
+    ASSERT_GT(maxInFlight, 0U);
+
+    vector<size_t> requests;
+    for (unsigned i = 0 ; i < maxInFlight + 2 ; i++) {
+        requests.push_back(whenChecked("com.app", { "luna://com.a/m" + to_string(i) }));
+    }
+    runMainLoop();
+
+    ASSERT_EQ(maxInFlight, pm->getIssued());
+
+    /* Each answer makes room for the next request, in order */
+    pm->answer(0, true);
+    EXPECT_EQ(MojErrNone, results[requests[0]]);
+    runMainLoop();
+    ASSERT_EQ(maxInFlight + 1, pm->getIssued());
+    EXPECT_EQ("luna://com.a/m" + to_string(maxInFlight), pm->getUrl(maxInFlight));
+
+    pm->answer(1, false);
+    runMainLoop();
+    ASSERT_EQ(maxInFlight + 2, pm->getIssued());
+    EXPECT_EQ("luna://com.a/m" + to_string(maxInFlight + 1), pm->getUrl(maxInFlight + 1));
+
+    for (size_t i = 2 ; i < pm->getIssued() ; i++) {
+        pm->answer(i, true);
+    }
+    for (size_t i = 0 ; i < requests.size() ; i++) {
+        EXPECT_EQ((i == 1) ? MojErrAccessDenied : MojErrNone, results[requests[i]]);
+    }
+}
+
+TEST_F(UnittestPermissionManager, LargeRequestWaitsForRoom)
+{
+    unsigned maxInFlight = Config::getInstance().getPermissionMaxInFlight();
+
+    size_t first = whenChecked("com.app", { "luna://com.a/m" });
+
+    /* More URLs than may be in flight: goes once nothing else is */
+    vector<string> urls;
+    for (unsigned i = 0 ; i <= maxInFlight ; i++) {
+        urls.push_back("luna://com.b/m" + to_string(i));
+    }
+    size_t large = whenChecked("com.app", urls);
+    runMainLoop();
+    ASSERT_EQ(1U, pm->getIssued());
+
+    pm->answer(0, true);
+    EXPECT_EQ(MojErrNone, results[first]);
+    runMainLoop();
+    ASSERT_EQ(urls.size() + 1, pm->getIssued());
+
+    for (size_t i = 1 ; i < pm->getIssued() ; i++) {
+        pm->answer(i, true);
+    }
+    EXPECT_EQ(MojErrNone, results[large]);
+}
+
+TEST_F(UnittestPermissionManager, RemembersDecisions)
+{
+    size_t request = whenChecked("com.app", { "luna://com.a/m", "luna://com.b/m" });
+    runMainLoop();
+    pm->answer(0, true);
+    pm->answer(1, false);
+    EXPECT_EQ(MojErrAccessDenied, results[request]);
+
+    /* Both answers are cached */
+    request = whenChecked("com.app", { "luna://com.a/m" });
+    size_t denied = whenChecked("com.app", { "luna://com.a/m", "luna://com.b/m" });
+    runMainLoop();
+    EXPECT_EQ(2U, pm->getIssued());
+    EXPECT_EQ(MojErrNone, results[request]);
+    EXPECT_EQ(MojErrAccessDenied, results[denied]);
+
+    /* Per requester */
+    whenChecked("com.other", { "luna://com.a/m" });
+    runMainLoop();
+    EXPECT_EQ(3U, pm->getIssued());
+
+    pm->invalidateCache();
+    whenChecked("com.app", { "luna://com.a/m" });
+    runMainLoop();
+    EXPECT_EQ(4U, pm->getIssued());
+}
+
+TEST_F(UnittestPermissionManager, AnswersIssuedBeforeInvalidatingArentRemembered)
+{
+    size_t request = whenChecked("com.app", { "luna://com.a/m", "luna://com.b/m" });
+    runMainLoop();
+    ASSERT_EQ(2U, pm->getIssued());
+
+    pm->answer(0, true);
+    pm->invalidateCache();
+    pm->answer(1, true);
+
+    /* The request still gets its answer */
+    EXPECT_EQ(MojErrNone, results[request]);
+
+    /* Neither is remembered: one was dropped with the cache, and the other
+     * answered a check issued before it was */
+    whenChecked("com.app", { "luna://com.a/m", "luna://com.b/m" });
+    runMainLoop();
+    ASSERT_EQ(4U, pm->getIssued());
+    EXPECT_EQ("luna://com.a/m", pm->getUrl(2));
+    EXPECT_EQ("luna://com.b/m", pm->getUrl(3));
+}
+
+TEST_F(UnittestPermissionManager, CountsDenialsFailuresAndTimeoutsApart)
+{
+    size_t denied = whenChecked("com.app", { "luna://com.a/m" });
+    size_t failed = whenChecked("com.app", { "luna://com.b/m" });
+    size_t timedOut = whenChecked("com.app", { "luna://com.c/m" });
+    runMainLoop();
+    ASSERT_EQ(3U, pm->getIssued());
+
+    pm->answer(0, false);
+    pm->fail(1);
+    pm->timeOut(2);
+
+    EXPECT_EQ(MojErrAccessDenied, results[denied]);
+    EXPECT_NE(string::npos, messages[denied].find("doesn't have rights"));
+
+    EXPECT_NE(MojErrNone, results[failed]);
+    EXPECT_NE(MojErrAccessDenied, results[failed]);
+    EXPECT_EQ(string::npos, messages[failed].find("doesn't have rights"));
+
+    EXPECT_NE(MojErrNone, results[timedOut]);
+    EXPECT_NE(MojErrAccessDenied, results[timedOut]);
+    EXPECT_NE(string::npos, messages[timedOut].find("Timed out"));
+
+    EXPECT_EQ(1, pm->getCount("denied"));
+    EXPECT_EQ(1, pm->getCount("failed"));
+    EXPECT_EQ(1, pm->getCount("timedOut"));
+}
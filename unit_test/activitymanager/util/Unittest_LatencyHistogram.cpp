@@ -0,0 +1,116 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "util/LatencyHistogram.h"
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestLatencyHistogram : public testing::Test {
+protected:
+    UnittestLatencyHistogram()
+    {
+    }
+
+    virtual ~UnittestLatencyHistogram()
+    {
+    }
+
+    void givenRange(LatencyHistogram& histogram, int64_t first, int64_t last)
+    {
+        for (int64_t us = first; us <= last; us++) {
+            histogram.record(us);
+        }
+    }
+};
+
+TEST_F(UnittestLatencyHistogram, EmptyIsZero)
+{
+    LatencyHistogram histogram;
+
+    EXPECT_EQ(0ULL, histogram.getCount());
+    EXPECT_EQ(0LL, histogram.getMax());
+    EXPECT_EQ(0LL, histogram.getPercentile(50.0));
+}
+
+TEST_F(UnittestLatencyHistogram, SmallValuesAreExact)
+{
+    LatencyHistogram histogram;
+
+    givenRange(histogram, 1, 10);
+
+    EXPECT_EQ(10ULL, histogram.getCount());
+    EXPECT_EQ(5LL, histogram.getPercentile(50.0));
+    EXPECT_EQ(9LL, histogram.getPercentile(90.0));
+    EXPECT_EQ(10LL, histogram.getPercentile(100.0));
+}
+
+TEST_F(UnittestLatencyHistogram, PercentilesWithinBucketError)
+{
+    LatencyHistogram histogram;
+
+    givenRange(histogram, 1, 100000);
+
+    /* Never under the true value, and at most 1/16 over */
+    int64_t p50 = histogram.getPercentile(50.0);
+    EXPECT_GE(p50, 50000LL);
+    EXPECT_LE(p50, 50000LL + 50000LL / 16);
+
+    int64_t p99 = histogram.getPercentile(99.0);
+    EXPECT_GE(p99, 99000LL);
+    EXPECT_LE(p99, 100000LL);
+
+    EXPECT_EQ(100000LL, histogram.getMax());
+}
+
+TEST_F(UnittestLatencyHistogram, CappedAtMax)
+{
+    LatencyHistogram histogram;
+
+    histogram.record(1000);
+
+    EXPECT_EQ(1000LL, histogram.getPercentile(50.0));
+    EXPECT_EQ(1000LL, histogram.getPercentile(99.0));
+}
+
+TEST_F(UnittestLatencyHistogram, ClampsOutOfRange)
+{
+    LatencyHistogram histogram;
+
+    histogram.record(-5);
+    histogram.record(1LL << 40);
+
+    EXPECT_EQ(2ULL, histogram.getCount());
+    EXPECT_EQ(0LL, histogram.getPercentile(50.0));
+    EXPECT_EQ(1LL << 40, histogram.getMax());
+    EXPECT_EQ(1LL << 40, histogram.getPercentile(100.0));
+}
+
+TEST_F(UnittestLatencyHistogram, Reset)
+{
+    LatencyHistogram histogram;
+
+    givenRange(histogram, 1, 100);
+    histogram.reset();
+
+    EXPECT_EQ(0ULL, histogram.getCount());
+    EXPECT_EQ(0LL, histogram.getMax());
+
+    histogram.record(7);
+    EXPECT_EQ(7LL, histogram.getPercentile(50.0));
+}
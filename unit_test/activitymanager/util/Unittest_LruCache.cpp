@@ -0,0 +1,94 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include "util/LruCache.h"
+
+#include <string>
+
+#include <gtest/gtest.h>
+
+using namespace std;
+
+class UnittestLruCache : public testing::Test {
+protected:
+    UnittestLruCache()
+        : cache(2)
+    {
+    }
+
+    virtual ~UnittestLruCache()
+    {
+    }
+
+    LruCache<string, int> cache;
+};
+
+TEST_F(UnittestLruCache, FindsWhatWasInserted)
+{
+    EXPECT_EQ(nullptr, cache.find("a"));
+
+    cache.insert("a", 1);
+    ASSERT_NE(nullptr, cache.find("a"));
+    EXPECT_EQ(1, *cache.find("a"));
+
+    cache.insert("a", 2);
+    EXPECT_EQ(1U, cache.size());
+    EXPECT_EQ(2, *cache.find("a"));
+}
+
+TEST_F(UnittestLruCache, FindingKeepsEntries)
+{
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    EXPECT_NE(nullptr, cache.find("a"));
+    cache.insert("c", 3);
+
+    EXPECT_EQ(2U, cache.size());
+    EXPECT_NE(nullptr, cache.find("a"));
+    EXPECT_EQ(nullptr, cache.find("b"));
+    EXPECT_NE(nullptr, cache.find("c"));
+}
+
+TEST_F(UnittestLruCache, EraseFreesRoom)
+{
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    cache.erase("a");
+    cache.erase("missing");
+    cache.insert("c", 3);
+
+    EXPECT_EQ(2U, cache.size());
+    EXPECT_NE(nullptr, cache.find("b"));
+    EXPECT_NE(nullptr, cache.find("c"));
+}
+
+TEST_F(UnittestLruCache, ShrinkingAndDisabling)
+{
+    cache.setCapacity(3);
+    cache.insert("a", 1);
+    cache.insert("b", 2);
+    cache.insert("c", 3);
+
+    cache.setCapacity(1);
+    EXPECT_EQ(1U, cache.size());
+    EXPECT_NE(nullptr, cache.find("c"));
+
+    cache.setCapacity(0);
+    cache.insert("d", 4);
+    EXPECT_EQ(0U, cache.size());
+    EXPECT_EQ(0U, cache.getCapacity());
+}
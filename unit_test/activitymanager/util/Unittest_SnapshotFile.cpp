@@ -0,0 +1,139 @@
+// Copyright (c) 2024 LG Electronics, Inc.
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+// http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+//
+// SPDX-License-Identifier: Apache-2.0
+
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include <glib.h>
+#include <gtest/gtest.h>
+
+#include "util/SnapshotFile.h"
+
+using namespace std;
+
+class UnittestSnapshotFile : public testing::Test {
+protected:
+    UnittestSnapshotFile()
+        : m_path(string(g_get_tmp_dir()) + "/Unittest_SnapshotFile.snapshot")
+        , m_file(m_path)
+    {
+    }
+
+    virtual ~UnittestSnapshotFile()
+    {
+        m_file.remove();
+    }
+
+    string readRaw()
+    {
+        gchar *contents = NULL;
+        gsize length = 0;
+        EXPECT_TRUE(g_file_get_contents(m_path.c_str(), &contents, &length, NULL));
+        string raw(contents, length);
+        g_free(contents);
+        return raw;
+    }
+
+    void writeRaw(const string& raw)
+    {
+        EXPECT_TRUE(g_file_set_contents(m_path.c_str(), raw.data(), (gssize) raw.size(), NULL));
+    }
+
+    string m_path;
+    SnapshotFile m_file;
+};
+
+TEST_F(UnittestSnapshotFile, Crc32)
+{
+    EXPECT_EQ(0xCBF43926U, SnapshotFile::crc32("123456789", 9));
+    EXPECT_EQ(0U, SnapshotFile::crc32("", 0));
+}
+
+TEST_F(UnittestSnapshotFile, RoundTrip)
+{
+    vector<string> records;
+    records.push_back("{\"activityId\":1}");
+    records.push_back("");
+    records.push_back(string("a\0b", 3));
+    records.push_back(string(1000, 'x'));
+
+    EXPECT_LT(0U, m_file.write(records));
+
+    vector<string> read;
+    ASSERT_TRUE(m_file.read(read));
+    EXPECT_EQ(records, read);
+}
+
+TEST_F(UnittestSnapshotFile, RoundTripEmpty)
+{
+    EXPECT_LT(0U, m_file.write(vector<string>()));
+
+    vector<string> read(1, "stale");
+    EXPECT_TRUE(m_file.read(read));
+    EXPECT_TRUE(read.empty());
+}
+
+TEST_F(UnittestSnapshotFile, MissingFile)
+{
+    m_file.remove();
+
+    vector<string> read;
+    EXPECT_FALSE(m_file.read(read));
+    EXPECT_TRUE(read.empty());
+}
+
+TEST_F(UnittestSnapshotFile, CorruptRecordRejected)
+{
+    vector<string> records(2, "{\"activityId\":12}");
+    m_file.write(records);
+
+    string raw = readRaw();
+    raw[raw.size() - 4] ^= 0x20;
+    writeRaw(raw);
+
+    vector<string> read;
+    EXPECT_FALSE(m_file.read(read));
+    EXPECT_TRUE(read.empty());
+}
+
+TEST_F(UnittestSnapshotFile, TruncatedRejected)
+{
+    vector<string> records(3, "{\"activityId\":12}");
+    m_file.write(records);
+
+    string raw = readRaw();
+    writeRaw(raw.substr(0, raw.size() - 8));
+
+    vector<string> read;
+    EXPECT_FALSE(m_file.read(read));
+
+    writeRaw(raw.substr(0, 10));
+    EXPECT_FALSE(m_file.read(read));
+}
+
+TEST_F(UnittestSnapshotFile, OtherVersionRejected)
+{
+    m_file.write(vector<string>(1, "{}"));
+
+    string raw = readRaw();
+    raw[4] = (char) (SnapshotFile::kVersion + 1);
+    writeRaw(raw);
+
+    vector<string> read;
+    EXPECT_FALSE(m_file.read(read));
+}